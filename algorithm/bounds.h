@@ -0,0 +1,198 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_ALGORITHM_BOUNDS_H_
+#define THIRD_PARTY_HYBRID_RCC_ALGORITHM_BOUNDS_H_
+
+#include <cmath>
+#include <limits>
+
+#include "Eigen/Core"
+#include "stats/distributions/multivariate/continuous/gaussian.h"
+#include "stats/distributions/multivariate/continuous/laplace.h"
+#include "stats/distributions/multivariate/continuous/logistic.h"
+#include "stats/distributions/multivariate/continuous/student_t.h"
+#include "stats/distributions/multivariate/continuous/truncated_gaussian.h"
+#include "stats/distributions/multivariate/continuous/uniform.h"
+#include "stats/distributions/multivariate/discrete/categorical.h"
+
+// Deterministic bounds on density ratios of independent distributions.
+//
+// Every supported family has a log-density that is, per dimension, a
+// quadratic c2 x^2 + c1 x + c0 on an interval [lower, upper] and -inf outside
+// of it. The log-ratio of two such densities is again a quadratic on the
+// support of the denominator, so its infimum and supremum can be found
+// exactly by checking the end points and the vertex of each dimension.
+// Categorical distributions are bounded by the minimum over their categories,
+// and uniform posteriors against the unimodal Laplace, logistic and Student's
+// t priors by the prior density at the ends of the posterior's support.
+namespace rcc {
+namespace internal {
+struct LogQuadratic {
+  Eigen::ArrayXd c2, c1, c0, lower, upper;
+};
+
+inline LogQuadratic log_quadratic(
+    const stats::multivariates::IndependentGaussian &g) {
+  Eigen::ArrayXd mu = g.mean(), var = g.var();
+  auto [lower, upper] = g.support();
+  return LogQuadratic{-0.5 / var, mu / var,
+                      -0.5 * mu * mu / var - 0.5 * (2 * M_PI * var).log(),
+                      lower, upper};
+}
+
+inline LogQuadratic log_quadratic(
+    const stats::multivariates::IndependentTruncatedGaussian &g) {
+  int dim = g.univariates().size();
+  Eigen::ArrayXd mu(dim), var(dim), log_z(dim);
+  for (int d = 0; d < dim; d++) {
+    const auto &u = g.univariates()[d];
+    auto [a, b] = u.support();
+    mu[d] = u.Gaussian::mean();
+    var[d] = u.Gaussian::var();
+    log_z[d] = std::log(u.Gaussian::cdf(b) - u.Gaussian::cdf(a));
+  }
+  auto [lower, upper] = g.support();
+  return LogQuadratic{
+      -0.5 / var, mu / var,
+      -0.5 * mu * mu / var - 0.5 * (2 * M_PI * var).log() - log_z, lower,
+      upper};
+}
+
+inline LogQuadratic log_quadratic(
+    const stats::multivariates::IndependentUniform &g) {
+  auto [lower, upper] = g.support();
+  Eigen::ArrayXd zero = Eigen::ArrayXd::Zero(lower.size());
+  return LogQuadratic{zero, zero, -(upper - lower).log(), lower, upper};
+}
+
+// Evaluates c2 x^2 + c1 x + c0, taking the limit when x = +-inf.
+inline Eigen::ArrayXd quadratic_at(const Eigen::ArrayXd &c2,
+                                   const Eigen::ArrayXd &c1,
+                                   const Eigen::ArrayXd &c0,
+                                   const Eigen::ArrayXd &x) {
+  const double inf = std::numeric_limits<double>::infinity();
+  Eigen::ArrayXd value = (c2 * x + c1) * x + c0;
+  Eigen::ArrayXd limit = (c2 != 0).select(
+      c2.sign() * inf, (c1 != 0).select(c1.sign() * x.sign() * inf, c0));
+  return x.isFinite().select(value, limit);
+}
+
+// Per dimension infimum of c2 x^2 + c1 x + c0 over [lower, upper].
+inline Eigen::ArrayXd quadratic_min(const Eigen::ArrayXd &c2,
+                                    const Eigen::ArrayXd &c1,
+                                    const Eigen::ArrayXd &c0,
+                                    const Eigen::ArrayXd &lower,
+                                    const Eigen::ArrayXd &upper) {
+  Eigen::ArrayXd vertex = (-c1 / (2 * c2)).max(lower).min(upper);
+  Eigen::ArrayXd ends =
+      quadratic_at(c2, c1, c0, lower).min(quadratic_at(c2, c1, c0, upper));
+  return (c2 > 0).select(quadratic_at(c2, c1, c0, vertex), ends);
+}
+
+// Per dimension supremum of c2 x^2 + c1 x + c0 over [lower, upper].
+inline Eigen::ArrayXd quadratic_max(const Eigen::ArrayXd &c2,
+                                    const Eigen::ArrayXd &c1,
+                                    const Eigen::ArrayXd &c0,
+                                    const Eigen::ArrayXd &lower,
+                                    const Eigen::ArrayXd &upper) {
+  return -quadratic_min(-c2, -c1, -c0, lower, upper);
+}
+
+// Per dimension inf log p(x)/q(x) over the support of q. The result is
+// -inf whenever the support of q is not contained in the support of p.
+// A relative margin of 1e-12 is subtracted so that rounding in the
+// coefficients can not turn the bound into an over-estimate.
+inline Eigen::ArrayXd minimum_log_weight(const LogQuadratic &q,
+                                         const LogQuadratic &p) {
+  const double inf = std::numeric_limits<double>::infinity();
+  Eigen::ArrayXd logW = quadratic_min(p.c2 - q.c2, p.c1 - q.c1, p.c0 - q.c0,
+                                      q.lower, q.upper);
+  logW -= 1e-12 * (1 + logW.abs());
+  return (q.lower < p.lower || q.upper > p.upper).select(-inf, logW);
+}
+
+// Per dimension min log p_k/q_k over the categories with q_k > 0.
+inline Eigen::ArrayXd minimum_log_weight(
+    const stats::multivariates::IndependentCategorical &q,
+    const stats::multivariates::IndependentCategorical &p) {
+  const double inf = std::numeric_limits<double>::infinity();
+  return (q.log_probs() > -inf)
+      .select(p.log_probs() - q.log_probs(), inf)
+      .rowwise()
+      .minCoeff();
+}
+
+// Per dimension inf log p(x)/q(x) over the bounded support of a uniform q,
+// for a p whose density is unimodal, so that it is smallest at an end point.
+// The same relative margin is subtracted as for the quadratics.
+template <typename Unimodal>
+inline Eigen::ArrayXd minimum_log_weight_at_ends(
+    const stats::multivariates::IndependentUniform &q, const Unimodal &p) {
+  auto [lower, upper] = q.support();
+  Eigen::ArrayXd logW =
+      p.logpdf(lower).min(p.logpdf(upper)) + (upper - lower).log();
+  return logW - 1e-12 * (1 + logW.abs());
+}
+
+inline Eigen::ArrayXd minimum_log_weight(
+    const stats::multivariates::IndependentUniform &q,
+    const stats::multivariates::IndependentLaplace &p) {
+  return minimum_log_weight_at_ends(q, p);
+}
+
+inline Eigen::ArrayXd minimum_log_weight(
+    const stats::multivariates::IndependentUniform &q,
+    const stats::multivariates::IndependentLogistic &p) {
+  return minimum_log_weight_at_ends(q, p);
+}
+
+inline Eigen::ArrayXd minimum_log_weight(
+    const stats::multivariates::IndependentUniform &q,
+    const stats::multivariates::IndependentStudentT &p) {
+  return minimum_log_weight_at_ends(q, p);
+}
+
+template <typename Q, typename P>
+inline Eigen::ArrayXd minimum_log_weight(const Q &q, const P &p) {
+  return minimum_log_weight(log_quadratic(q), log_quadratic(p));
+}
+
+// Per dimension sup log q(x)/p(x) over the support of q, +inf whenever the
+// support of q is not contained in the support of p. The same relative
+// margin is added so that the bound can not become an under-estimate.
+inline Eigen::ArrayXd maximum_log_ratio(const LogQuadratic &q,
+                                        const LogQuadratic &p) {
+  const double inf = std::numeric_limits<double>::infinity();
+  Eigen::ArrayXd logR = quadratic_max(q.c2 - p.c2, q.c1 - p.c1, q.c0 - p.c0,
+                                      q.lower, q.upper);
+  logR += 1e-12 * (1 + logR.abs());
+  return (q.lower < p.lower || q.upper > p.upper).select(inf, logR);
+}
+
+template <typename Q, typename P>
+inline Eigen::ArrayXd maximum_log_ratio(const Q &q, const P &p) {
+  return maximum_log_ratio(log_quadratic(q), log_quadratic(p));
+}
+
+// Certified lower bound of p(x)/q(x) over the support of q.
+template <typename Q, typename P>
+inline double certified_w_min(const Q &q, const P &p) {
+  return std::exp(minimum_log_weight(q, p).sum());
+}
+}  // namespace internal
+}  // namespace rcc
+#endif  // THIRD_PARTY_HYBRID_RCC_ALGORITHM_BOUNDS_H_
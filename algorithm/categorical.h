@@ -0,0 +1,168 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_ALGORITHM_CATEGORICAL_H_
+#define THIRD_PARTY_HYBRID_RCC_ALGORITHM_CATEGORICAL_H_
+
+#include <math.h>
+
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <tuple>
+
+#include "Eigen/Core"
+#include "algorithm/bounds.h"
+#include "algorithm/helper.h"
+#include "stats/distributions/multivariate/continuous/uniform.h"
+#include "stats/distributions/multivariate/discrete/categorical.h"
+#include "stats/distributions/multivariate/multivariate.h"
+#include "include/pcg_random.hpp"
+
+// Reverse channel coding of independent categorical distributions.
+//
+// Candidates are drawn from p with the alias method and scored by gathering
+// log q_k - log p_k from a table built once per call, so the inner loop has
+// no transcendental functions besides log t.
+namespace rcc {
+namespace internal {
+inline double gather_log_ratio(
+    const Eigen::ArrayXXd &log_ratio,
+    const stats::DiscreteMultiVariable::instanceType &z) {
+  double sum = 0;
+  for (int d = 0; d < z.size(); d++) sum += log_ratio(d, z[d]);
+  return sum;
+}
+}  // namespace internal
+
+namespace algorithm {
+template <typename STD_URBG>
+std::tuple<stats::DiscreteMultiVariable::instanceType, int, int>
+sample_categorical_pfr(const stats::multivariates::IndependentCategorical &q,
+                       const stats::multivariates::IndependentCategorical &p,
+                       double w_min, uint32_t N_max, STD_URBG &urbg,
+                       bool verbose = false) {
+  assert(q.dim() == p.dim() && q.num_categories() == p.num_categories());
+  stats::ExponentialDistribution exponential(1);
+  int dim = p.dim();
+  stats::multivariates::IndependentUniform U(dim);
+  auto rng = U.make_rng(urbg);
+  internal::skip_to_arrival_stream(urbg);
+  Eigen::ArrayXXd log_ratio = q.log_probs() - p.log_probs();
+
+  double t = 0;
+  double s = std::numeric_limits<double>::infinity();
+  int n = 0;
+  int i = 0;
+  stats::DiscreteMultiVariable::instanceType z;
+
+  while (static_cast<uint32_t>(i) < N_max && s > t * w_min) {
+    auto z_ = p.sample(U.rvs(rng));
+    if (verbose) {
+      std::cerr << i << ": " << z_.transpose() << std::endl;
+    }
+    t += exponential(urbg);
+    double s_ = std::log(t) - internal::gather_log_ratio(log_ratio, z_);
+    if (isnan(s_))
+      s_ = std::numeric_limits<double>::infinity();
+    else
+      s_ = std::exp(s_);
+
+    if (i == 0 || s_ < s) {
+      n = i;
+      s = s_;
+      z = z_;
+    }
+    i++;
+  }
+  return std::tuple<stats::DiscreteMultiVariable::instanceType, int, int>(z, n,
+                                                                         i);
+}
+
+template <typename STD_URBG>
+std::tuple<stats::DiscreteMultiVariable::instanceType, int, int>
+sample_categorical_sis(const stats::multivariates::IndependentCategorical &q,
+                       const stats::multivariates::IndependentCategorical &p,
+                       double w_min, int N_max, STD_URBG &urbg,
+                       bool verbose = false) {
+  assert(q.dim() == p.dim() && q.num_categories() == p.num_categories());
+  stats::ExponentialDistribution exponential(1);
+  int dim = p.dim();
+  stats::multivariates::IndependentUniform U(dim);
+  auto rng = U.make_rng(urbg);
+  internal::skip_to_arrival_stream(urbg);
+  Eigen::ArrayXXd log_ratio = q.log_probs() - p.log_probs();
+
+  double t = 0;
+  int n = 0;
+  double s_star = std::numeric_limits<double>::infinity();
+  int n_star = 1;
+  stats::DiscreteMultiVariable::instanceType z_star;
+
+  do {
+    auto z = p.sample(U.rvs(rng));
+    if (verbose) {
+      std::cerr << n << "/" << N_max << ": " << z.transpose() << std::endl;
+    }
+
+    double w = N_max / static_cast<double>(N_max - n);
+    t += w * exponential(urbg);
+    double s = std::log(t) - internal::gather_log_ratio(log_ratio, z);
+    if (isnan(s))
+      s = std::numeric_limits<double>::infinity();
+    else
+      s = std::exp(s);
+
+    if (n == 0 || s < s_star) {
+      s_star = s;
+      n_star = n;
+      z_star = z;
+    }
+    n++;
+  } while (s_star > t * w_min && n < N_max);
+  return std::tuple<stats::DiscreteMultiVariable::instanceType, int, int>(
+      z_star, n_star, n);
+}
+
+// Reconstructs the n-th candidate. Each uniform takes exactly one engine
+// step, so the uniform stream is advanced past the first n candidates.
+template <typename AdvanceURBG>
+stats::DiscreteMultiVariable::instanceType decode_categorical(
+    int n, const stats::multivariates::IndependentCategorical &p,
+    AdvanceURBG urbg) {
+  urbg.advance(static_cast<uint64_t>(n) * p.dim());
+  stats::multivariates::IndependentUniform U(p.dim());
+  auto rng = U.make_rng(urbg);
+  return p.sample(U.rvs(rng));
+}
+
+template <typename STD_URBG>
+std::tuple<stats::DiscreteMultiVariable::instanceType, int, int>
+sample_categorical(const stats::multivariates::IndependentCategorical &q,
+                   const stats::multivariates::IndependentCategorical &p,
+                   bool pfr, STD_URBG rs = pcg32(0), uint32_t N_max = 0,
+                   bool verbose = false) {
+  double w_min = internal::certified_w_min(q, p);
+  if (pfr)
+    return sample_categorical_pfr(q, p, w_min, N_max, rs, verbose);
+  else
+    return sample_categorical_sis(q, p, w_min, N_max, rs, verbose);
+}
+}  // namespace algorithm
+}  // namespace rcc
+#endif  // THIRD_PARTY_HYBRID_RCC_ALGORITHM_CATEGORICAL_H_
@@ -0,0 +1,198 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_ALGORITHM_CODEBOOK_H_
+#define THIRD_PARTY_HYBRID_RCC_ALGORITHM_CODEBOOK_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include "Eigen/Core"
+#include "algorithm/reverse_channel.h"
+#include "stats/distributions/multivariate/continuous/gaussian.h"
+#include "stats/distributions/multivariate/continuous/uniform.h"
+
+// The first N candidates of sample_pfr, materialized for reuse.
+//
+// The candidates z_i = p.ppf(u_i) and their arrival times t_i depend only on
+// p and the seed, so they can be shared by every q encoded against the same
+// (p, seed). For a Gaussian q the PFR score is
+//
+//   log t_i + log p(z_i) - log q(z_i)
+//     = a_i + sum_d (z_id - mu_d)^2 / (2 sigma_d^2) + const,
+//
+// with a_i = log t_i + log p(z_i) precomputed. The candidates are kept in a
+// k-d tree whose nodes store their bounding box and the minimum a_i below
+// them, which together bound the score of the whole node from below, so the
+// argmin is found by branch and bound instead of a linear scan.
+//
+// The argmin over the first N candidates is what sample_pfr returns with
+// N_max = N: once it stops at t_i * w_min >= s, no later candidate can score
+// below s because p/q >= w_min everywhere. This does not hold for sample_sis,
+// whose arrival times depend on the running index of the best candidate and
+// therefore on q.
+namespace rcc {
+namespace algorithm {
+class CandidateCodebook {
+ public:
+  template <typename STD_URBG>
+  CandidateCodebook(ContinuousDistribution<double> &p, int N, STD_URBG &urbg,
+                    int leaf_size = 16)
+      : dim_(p.mean().size()), leaf_size_(leaf_size) {
+    assert(N > 0 && leaf_size > 0);
+    // Same streams as sample_pfr.
+    stats::ExponentialDistribution exponential(1);
+    stats::multivariates::IndependentUniform U(dim_);
+    auto rng = U.make_rng(urbg);
+    internal::skip_to_arrival_stream(urbg);
+    candidates_.resize(dim_, N);
+    offset_.resize(N);
+    double t = 0;
+    for (int i = 0; i < N; i++) {
+      Eigen::ArrayXd z = p.ppf(U.rvs(rng));
+      t += exponential(urbg);
+      candidates_.col(i) = z;
+      offset_[i] = std::log(t) + p.logpdf(z).sum();
+    }
+    index_.resize(N);
+    std::iota(index_.begin(), index_.end(), 0);
+    build(0, N);
+    // Store the candidates in tree order so that leaves are contiguous.
+    Eigen::ArrayXXd candidates(dim_, N);
+    Eigen::ArrayXd offset(N);
+    for (int j = 0; j < N; j++) {
+      candidates.col(j) = candidates_.col(index_[j]);
+      offset[j] = offset_[index_[j]];
+    }
+    candidates_.swap(candidates);
+    offset_.swap(offset);
+  }
+
+  int size() const { return offset_.size(); }
+  int dim() const { return dim_; }
+
+  // Returns the best candidate for q, its index in generation order and the
+  // number of candidates whose score was evaluated. The first two equal
+  // those of sample_gaussian(q, p, true, rs, size()) unless two scores tie
+  // to rounding, as the scores are summed in a different order.
+  std::tuple<Eigen::ArrayXd, int, int> search(
+      const stats::multivariates::IndependentGaussian &q) const {
+    assert(q.mean().size() == dim_);
+    Search s{q.mean(), 0.5 / q.var()};
+    visit(0, node_bound(0, s), s);
+    return std::tuple<Eigen::ArrayXd, int, int>(
+        candidates_.col(s.best_position), index_[s.best_position],
+        s.evaluated);
+  }
+
+ private:
+  struct Node {
+    int begin, end;
+    int left = -1, right = -1;
+    double min_offset;
+  };
+  struct Search {
+    Eigen::ArrayXd mu, half_precision;
+    double best = std::numeric_limits<double>::infinity();
+    int best_position = 0;
+    int evaluated = 0;
+  };
+
+  int build(int begin, int end) {
+    int id = nodes_.size();
+    nodes_.push_back(Node{begin, end});
+    Eigen::ArrayXd lower = Eigen::ArrayXd::Constant(
+        dim_, std::numeric_limits<double>::infinity());
+    Eigen::ArrayXd upper = -lower;
+    double min_offset = std::numeric_limits<double>::infinity();
+    for (int j = begin; j < end; j++) {
+      lower = lower.min(candidates_.col(index_[j]));
+      upper = upper.max(candidates_.col(index_[j]));
+      min_offset = std::min(min_offset, offset_[index_[j]]);
+    }
+    lower_.conservativeResize(dim_, id + 1);
+    upper_.conservativeResize(dim_, id + 1);
+    lower_.col(id) = lower;
+    upper_.col(id) = upper;
+    nodes_[id].min_offset = min_offset;
+    if (end - begin <= leaf_size_) return id;
+
+    int split;
+    (upper - lower).maxCoeff(&split);
+    int mid = begin + (end - begin) / 2;
+    std::nth_element(index_.begin() + begin, index_.begin() + mid,
+                     index_.begin() + end, [&](int a, int b) {
+                       return candidates_(split, a) < candidates_(split, b);
+                     });
+    int left = build(begin, mid);
+    int right = build(mid, end);
+    nodes_[id].left = left;
+    nodes_[id].right = right;
+    return id;
+  }
+
+  double node_bound(int id, const Search &s) const {
+    Eigen::ArrayXd gap =
+        (lower_.col(id) - s.mu).max(s.mu - upper_.col(id)).max(0);
+    return nodes_[id].min_offset + (s.half_precision * gap * gap).sum();
+  }
+
+  void visit(int id, double bound, Search &s) const {
+    if (bound > s.best) return;
+    const Node &node = nodes_[id];
+    if (node.left < 0) {
+      for (int j = node.begin; j < node.end; j++) {
+        double score = offset_[j] + (s.half_precision *
+                                     (candidates_.col(j) - s.mu).square())
+                                        .sum();
+        s.evaluated++;
+        if (score < s.best ||
+            (score == s.best && index_[j] < index_[s.best_position])) {
+          s.best = score;
+          s.best_position = j;
+        }
+      }
+      return;
+    }
+    double left = node_bound(node.left, s);
+    double right = node_bound(node.right, s);
+    if (left <= right) {
+      visit(node.left, left, s);
+      visit(node.right, right, s);
+    } else {
+      visit(node.right, right, s);
+      visit(node.left, left, s);
+    }
+  }
+
+  int dim_, leaf_size_;
+  // Column j is the candidate at tree position j, index_[j] its index in
+  // generation order.
+  Eigen::ArrayXXd candidates_;
+  Eigen::ArrayXd offset_;
+  std::vector<int> index_;
+  std::vector<Node> nodes_;
+  Eigen::ArrayXXd lower_, upper_;
+};
+}  // namespace algorithm
+}  // namespace rcc
+#endif  // THIRD_PARTY_HYBRID_RCC_ALGORITHM_CODEBOOK_H_
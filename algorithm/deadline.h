@@ -0,0 +1,59 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_ALGORITHM_DEADLINE_H_
+#define THIRD_PARTY_HYBRID_RCC_ALGORITHM_DEADLINE_H_
+
+#include <chrono>
+
+namespace rcc {
+namespace algorithm {
+// Wall-clock budget of a sampler. The samplers read the clock once every
+// kCheckInterval candidates so that the check stays out of the profile.
+class Deadline {
+ public:
+  using Clock = std::chrono::steady_clock;
+  static constexpr int kCheckInterval = 16;
+
+  Deadline() : at_(Clock::time_point::max()) {}
+  explicit Deadline(Clock::time_point at) : at_(at) {}
+  static Deadline after(Clock::duration budget) {
+    return Deadline(Clock::now() + budget);
+  }
+
+  bool is_set() const { return at_ != Clock::time_point::max(); }
+  Clock::time_point at() const { return at_; }
+  // True when candidate i should not be evaluated anymore. Candidate 0 is
+  // always evaluated so that there is something to return.
+  bool expired(int i) const {
+    return is_set() && i > 0 && i % kCheckInterval == 0 && Clock::now() >= at_;
+  }
+
+ private:
+  Clock::time_point at_;
+};
+
+// What sample_gaussian_hybrid returns when the deadline fires first.
+enum class Fallback {
+  // The best candidate found so far.
+  kBestCandidate,
+  // Dithered quantization of the mean of q with the first candidate's dither
+  // and the same M. It decodes with decode_hybrid as sample index 0.
+  kDitheredQuantization,
+};
+}  // namespace algorithm
+}  // namespace rcc
+#endif  // THIRD_PARTY_HYBRID_RCC_ALGORITHM_DEADLINE_H_
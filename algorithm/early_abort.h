@@ -0,0 +1,183 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_ALGORITHM_EARLY_ABORT_H_
+#define THIRD_PARTY_HYBRID_RCC_ALGORITHM_EARLY_ABORT_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <tuple>
+#include <vector>
+
+#include "Eigen/Core"
+#include "algorithm/deadline.h"
+#include "algorithm/helper.h"
+#include "algorithm/options.h"
+#include "stats/distributions/multivariate/continuous/gaussian.h"
+#include "stats/distributions/multivariate/continuous/truncated_gaussian.h"
+
+// Hybrid sampler that scores candidates dimension by dimension and abandons
+// them as soon as they can no longer win.
+//
+// A candidate replaces the best one only if log t - sum_d g_d(y_d) < s,
+// where g_d(y_d) = log q_d(phi_d) - log p_d(phi_d) - log M_d. Given upper
+// bounds G_d >= g_d, after scoring the dimensions in a prefix P the
+// candidate can still win only if
+//
+//   log t - sum_{d in P} g_d(y_d) - sum_{d not in P} G_d < s,
+//
+// so the first prefix that violates this rejects it without touching the
+// remaining dimensions. The bounds are the per dimension maxima of log q/p
+// from internal::maximum_log_ratio, computed by the caller. Dimensions are
+// scored in decreasing order of their expected gap G_d - g_d, estimated on
+// a few points of the candidate interval, so that the bound tightens as
+// fast as possible.
+//
+// Candidates that survive every prefix are summed in index order exactly
+// like sample_hybrid_fixed, and the test is loosened by a margin that
+// covers the difference in summation order and the rounding of Scalar, so
+// the sampler returns the same candidate and uses the same streams. The
+// saving grows with the dimension and with the number of candidates: late
+// in a long run the best score is tight and most candidates are rejected
+// after a few dimensions.
+namespace rcc {
+namespace algorithm {
+// Same arguments and results as sample_hybrid_fixed, for any dimension.
+// log_ratio_bound holds the per dimension upper bounds of log q/p over the
+// support of q. dimension_evaluations, if given, receives the number of
+// quantile evaluations summed over all candidates.
+template <typename STD_URBG, typename Scalar>
+std::tuple<Eigen::Array<Scalar, Eigen::Dynamic, 1>, int,
+           Eigen::Array<Scalar, Eigen::Dynamic, 1>, int>
+sample_hybrid_early_abort(
+    const stats::multivariates::BasicIndependentTruncatedGaussian<Scalar> &q,
+    const stats::multivariates::BasicIndependentGaussian<Scalar> &p,
+    const Eigen::Array<Scalar, Eigen::Dynamic, 1> &M, uint32_t N_max,
+    double w_min, bool pfr, STD_URBG urbg,
+    const Eigen::ArrayXd &log_ratio_bound,
+    const Deadline &deadline = Deadline(), SamplerStatus *status = nullptr,
+    int64_t *dimension_evaluations = nullptr) {
+  using Array = Eigen::Array<Scalar, Eigen::Dynamic, 1>;
+  const int dim = M.size();
+  assert(log_ratio_bound.size() == dim);
+  stats::ExponentialDistribution exponential(1);
+  stats::UniformDistribution uniform(0, 1);
+  STD_URBG uniform_urbg = urbg;
+  internal::skip_to_arrival_stream(urbg);
+
+  auto [q_a, q_b] = q.support();
+  Array c = (p.cdf(q_a) * M + p.cdf(q_b) * M) / 2;
+  c = c.max(0.5).min(M - Scalar(0.5));
+  Array logM = M.log();
+  const auto &q_uni = q.univariates();
+  const auto &p_uni = p.univariates();
+  auto g = [&](int d, Scalar y) {
+    Scalar phi = p_uni[d].ppf(y / M[d]);
+    return q_uni[d].logpdf(phi) + (-p_uni[d].logpdf(phi) - logM[d]);
+  };
+
+  // Bounds of g and the expected gap to them, from kProbes evenly spaced
+  // points of the candidate interval. A point outside the support rejects
+  // a candidate outright and counts as a gap of kMaxGap.
+  constexpr int kProbes = 8;
+  constexpr double kMaxGap = 50;
+  Eigen::ArrayXd bound = log_ratio_bound - logM.template cast<double>();
+  Eigen::ArrayXd gap = Eigen::ArrayXd::Zero(dim);
+  for (int d = 0; d < dim; d++) {
+    for (int j = 0; j < kProbes; j++) {
+      double value = g(d, c[d] + Scalar((j + 0.5) / kProbes - 0.5));
+      gap[d] += std::isfinite(value) ? std::min(bound[d] - value, kMaxGap)
+                                     : kMaxGap;
+    }
+  }
+  std::vector<int> order(dim);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](int a, int b) { return gap[a] > gap[b]; });
+  // remaining[j] is the bound of the dimensions order[j..dim) and
+  // remaining_abs[j] the sum of its magnitudes.
+  std::vector<double> remaining(dim + 1, 0), remaining_abs(dim + 1, 0);
+  for (int j = dim - 1; j >= 0; j--) {
+    remaining[j] = remaining[j + 1] + bound[order[j]];
+    remaining_abs[j] = remaining_abs[j + 1] + std::abs(bound[order[j]]);
+  }
+  // Relative slack, against the magnitudes summed, for summing in a
+  // different order and for the rounding of Scalar.
+  const double slack = 1e3 * (dim + 1) * std::numeric_limits<Scalar>::epsilon();
+
+  double t = 0;
+  double s = std::numeric_limits<double>::infinity();
+  int n = 0;
+  int i = 0;
+  int64_t evaluations = 0;
+  double exp_s = std::numeric_limits<double>::infinity();
+  double prodM = M.template cast<double>().prod();
+  Array u(dim), k_(dim), y_(dim), log_ratio(dim), k, y;
+
+  while (static_cast<uint32_t>(i) < N_max && exp_s > t * w_min * prodM &&
+         !deadline.expired(i)) {
+    for (int d = 0; d < dim; d++) u[d] = uniform(uniform_urbg);
+    k_ = (c - u + Scalar(0.5)).floor();
+    y_ = k_ + u;
+
+    double w = pfr ? 1 : N_max / static_cast<double>(N_max - n);
+    t += w * exponential(urbg);
+    double log_t = std::log(t);
+    double scale = 1 + std::abs(s) + std::abs(log_t);
+    double partial = 0, partial_abs = 0;
+    bool rejected = false;
+    for (int j = 0; j < dim; j++) {
+      int d = order[j];
+      log_ratio[d] = g(d, y_[d]);
+      partial += log_ratio[d];
+      partial_abs += std::abs(log_ratio[d]);
+      evaluations++;
+      double margin = slack * (scale + partial_abs + remaining_abs[j + 1]);
+      if (i > 0 && !(log_t - partial - remaining[j + 1] < s + margin)) {
+        rejected = true;
+        break;
+      }
+    }
+    if (!rejected) {
+      double s_ = log_t - log_ratio.template cast<double>().sum();
+      if (i == 0 || s_ < s) {
+        n = i;
+        s = s_;
+        k = k_;
+        y = y_;
+        exp_s = std::exp(s);
+      }
+    }
+    i++;
+  }
+  if (status) {
+    status->t = t;
+    status->s = exp_s / prodM;
+    status->w_min_stop = !(exp_s > t * w_min * prodM);
+    status->deadline_stop =
+        !status->w_min_stop && static_cast<uint32_t>(i) < N_max;
+  }
+  if (dimension_evaluations) *dimension_evaluations = evaluations;
+  Array z = p.ppf(Array(y / M));
+  return std::tuple<Array, int, Array, int>(z, n, k, i);
+}
+}  // namespace algorithm
+}  // namespace rcc
+#endif  // THIRD_PARTY_HYBRID_RCC_ALGORITHM_EARLY_ABORT_H_
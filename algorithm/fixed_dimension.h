@@ -0,0 +1,144 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_ALGORITHM_FIXED_DIMENSION_H_
+#define THIRD_PARTY_HYBRID_RCC_ALGORITHM_FIXED_DIMENSION_H_
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Eigen/Core"
+#include "algorithm/deadline.h"
+#include "algorithm/helper.h"
+#include "algorithm/options.h"
+#include "stats/distributions/multivariate/continuous/gaussian.h"
+#include "stats/distributions/multivariate/continuous/truncated_gaussian.h"
+
+// Hybrid sampler for a truncated Gaussian q and a Gaussian p whose dimension
+// is a compile time constant. The candidate loop works on fixed size arrays
+// and calls the univariates directly, so it neither allocates nor goes
+// through the virtual multivariate interface. It consumes the random streams
+// exactly like sample_hybrid_pfr and sample_hybrid_sis, so the result decodes
+// with decode_hybrid.
+namespace rcc {
+namespace internal {
+// Largest dimension with a fixed size instantiation.
+constexpr int kMaxFixedDimension = 16;
+
+// Calls f(std::integral_constant<int, dim>()) for 1 <= dim <=
+// kMaxFixedDimension.
+template <int D = 1, typename F>
+auto with_fixed_dimension(int dim, F &&f) {
+  if constexpr (D == kMaxFixedDimension) {
+    assert(dim == D);
+    return f(std::integral_constant<int, D>());
+  } else {
+    if (dim == D) return f(std::integral_constant<int, D>());
+    return with_fixed_dimension<D + 1>(dim, std::forward<F>(f));
+  }
+}
+}  // namespace internal
+
+namespace algorithm {
+// pfr selects between the stopping rules of sample_hybrid_pfr (true) and
+// sample_hybrid_sis (false).
+template <int D, typename STD_URBG, typename Scalar>
+std::tuple<Eigen::Array<Scalar, Eigen::Dynamic, 1>, int,
+           Eigen::Array<Scalar, Eigen::Dynamic, 1>, int>
+sample_hybrid_fixed(
+    const stats::multivariates::BasicIndependentTruncatedGaussian<Scalar> &q,
+    const stats::multivariates::BasicIndependentGaussian<Scalar> &p,
+    const Eigen::Array<Scalar, Eigen::Dynamic, 1> &M, uint32_t N_max,
+    double w_min, bool pfr, STD_URBG urbg,
+    const Deadline &deadline = Deadline(), SamplerStatus *status = nullptr) {
+  using Array = Eigen::Array<Scalar, Eigen::Dynamic, 1>;
+  using Fixed = Eigen::Array<Scalar, D, 1>;
+  assert(M.size() == D);
+  stats::ExponentialDistribution exponential(1);
+  stats::UniformDistribution uniform(0, 1);
+  STD_URBG uniform_urbg = urbg;
+  internal::skip_to_arrival_stream(urbg);
+
+  // One-off vector math runs on dynamic arrays, exactly as in the generic
+  // samplers, and is copied over.
+  auto [q_a, q_b] = q.support();
+  Array c_ = (p.cdf(q_a) * M + p.cdf(q_b) * M) / 2;
+  c_ = c_.max(0.5).min(M - Scalar(0.5));
+  Array logM_ = M.log();
+  const Fixed c = c_, logM = logM_, m = M;
+  const auto &q_uni = q.univariates();
+  const auto &p_uni = p.univariates();
+
+  double t = 0;
+  double s = std::numeric_limits<double>::infinity();
+  int n = 0;
+  int i = 0;
+  double exp_s = std::numeric_limits<double>::infinity();
+  double prodM = M.template cast<double>().prod();
+  Fixed u, phi, log_ratio;
+  Fixed k = Fixed::Zero(), y = Fixed::Zero();
+
+  while (static_cast<uint32_t>(i) < N_max && exp_s > t * w_min * prodM &&
+         !deadline.expired(i)) {
+    for (int d = 0; d < D; d++) u[d] = uniform(uniform_urbg);
+    Fixed k_ = (c - u + Scalar(0.5)).floor();
+    Fixed y_ = k_ + u;
+
+    double w = pfr ? 1 : N_max / static_cast<double>(N_max - n);
+    t += w * exponential(urbg);
+    Fixed x = y_ / m;
+    for (int d = 0; d < D; d++) {
+      phi[d] = p_uni[d].ppf(x[d]);
+      log_ratio[d] = q_uni[d].logpdf(phi[d]) +
+                     (-p_uni[d].logpdf(phi[d]) - logM[d]);
+    }
+    double s_ = std::log(t) - log_ratio.template cast<double>().sum();
+    if (i == 0 || s_ < s) {
+      n = i;
+      s = s_;
+      k = k_;
+      y = y_;
+      exp_s = std::exp(s);
+    }
+    i++;
+  }
+  if (i == 0) {
+    // N_max == 0 scores no candidate. Return candidate 0 unscored, which
+    // still decodes as sample index 0.
+    for (int d = 0; d < D; d++) u[d] = uniform(uniform_urbg);
+    k = (c - u + Scalar(0.5)).floor();
+    y = k + u;
+  }
+  if (status) {
+    status->t = t;
+    status->s = exp_s / prodM;
+    status->w_min_stop = !(exp_s > t * w_min * prodM);
+    status->deadline_stop =
+        !status->w_min_stop && static_cast<uint32_t>(i) < N_max;
+  }
+  Array z = p.ppf(Array(y / m));
+  return std::tuple<Array, int, Array, int>(z, n, Array(k), i);
+}
+}  // namespace algorithm
+}  // namespace rcc
+#endif  // THIRD_PARTY_HYBRID_RCC_ALGORITHM_FIXED_DIMENSION_H_
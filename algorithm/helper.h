@@ -20,6 +20,7 @@
 #include <math.h>
 
 #include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <limits>
 #include <memory>
@@ -66,6 +67,21 @@ inline double riemann_zeta(double s) {
 
 namespace rcc {
 namespace internal {
+// The samplers draw candidate uniforms from a copy of the engine, one step
+// each, and arrival times from the engine itself after skipping this many
+// steps, so the two streams do not overlap for the first 2^40 uniforms of an
+// encode. The engine must have advance(), as the pcg engines do.
+constexpr uint64_t kArrivalStreamOffset = uint64_t(1) << 40;
+
+template <typename AdvanceURBG>
+inline void skip_to_arrival_stream(AdvanceURBG &urbg) {
+  urbg.advance(kArrivalStreamOffset);
+}
+
+// Dimensions that sample_gaussian_hybrid elides draw their uniforms from
+// the engine after skipping this many steps, past the arrival stream.
+constexpr uint64_t kElidedStreamOffset = uint64_t(1) << 41;
+
 inline double estimate_w(
     stats::ProbabilityDistribution<stats::ContinuousMultiVariable> &p,
     stats::ProbabilityDistribution<stats::ContinuousMultiVariable> &q,
@@ -78,11 +94,21 @@ inline double estimate_w(
   return w_min;
 }
 
+// -log2 P(n) of the Zipf law that codingCostHyprid assumes for the sample
+// index of a block with mutual information mi and log2 prod(M) = log2M bits.
+inline double zipf_index_bits(double mi, double log2M, uint64_t n) {
+  static double e = std::exp(1);
+  double exponent = 1.0 + 1.0 / (1.0 + std::log2(e) / e + mi - log2M);
+  double log2Pn = -exponent * std::log2(n + 1);
+  log2Pn = log2Pn - std::log2(riemann_zeta(exponent));
+  return -log2Pn;
+}
+
 inline std::tuple<double, double, double> codingCostHyprid(
     const stats::ProbabilityDistribution<stats::ContinuousMultiVariable> *&q,
     const stats::ProbabilityDistribution<stats::ContinuousMultiVariable> &p,
     const Eigen::ArrayXd &M, int n) {
-  static double log2 = std::log(2), e = std::exp(1);
+  static double log2 = std::log(2);
   double marg_diff_entropy = p.entropy().sum() / log2;
   double cond_diff_entropy = q->entropy().sum() / log2;
   double mi = marg_diff_entropy - cond_diff_entropy;
@@ -90,11 +116,7 @@ inline std::tuple<double, double, double> codingCostHyprid(
   double log2M = M.log2().sum();
   double coding_cost_bound = mi + std::log2(mi - log2M + 1) + 4;
 
-  double exponent = 1.0 + 1.0 / (1.0 + std::log2(e) / e + mi - log2M);
-  double log2Pn = -exponent * std::log2(n + 1);
-  log2Pn = log2Pn - std::log2(riemann_zeta(exponent));
-
-  double coding_cost_zipf = -log2Pn + log2M;
+  double coding_cost_zipf = zipf_index_bits(mi, log2M, n) + log2M;
   return std::tuple<double, double, double>(coding_cost_zipf, mi,
                                             coding_cost_bound);
 }
@@ -0,0 +1,343 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_ALGORITHM_INDEX_CODER_H_
+#define THIRD_PARTY_HYBRID_RCC_ALGORITHM_INDEX_CODER_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "algorithm/helper.h"
+
+// Adaptive arithmetic coding of sample indices.
+//
+// internal::codingCostHyprid prices the sample index n of a block with a
+// Zipf law fixed by the mutual information and log2 M. The actual
+// distribution of n depends on how the blocks of a layer were tuned, so the
+// fixed law over- or under-estimates it. IndexEncoder learns it instead,
+// while coding, with a binary range coder whose probabilities adapt to the
+// indices seen so far, so the decoder learns the same model from the
+// indices it decodes.
+//
+// n + 1 is split into its bit length, the slot, and the bits below its
+// leading one. The slot is coded with an adaptive binary tree, the top two
+// remaining bits with adaptive trees per slot, which captures the decay of
+// the density within a slot, and the rest with probability 1/2.
+//
+// A batch starts from an IndexModel, by default every probability 1/2. The
+// model learned from one batch is exported with IndexModel::header, at most
+// 128 bytes and empty for the default model, and seeds the next batch of
+// both the encoder and the decoder, e.g. the next checkpoint of the same
+// layer. Both sides start from the parsed header rather than from the
+// learned model itself, whose probabilities the header rounds.
+namespace rcc {
+namespace internal {
+// Binary range coder with 11-bit adaptive probabilities of a 0, in the
+// style of LZMA.
+constexpr int kProbabilityBits = 11;
+constexpr uint16_t kProbabilityOne = 1 << kProbabilityBits;
+constexpr int kAdaptationShift = 5;
+constexpr uint32_t kRangeTop = 1 << 24;
+
+class RangeEncoder {
+ public:
+  void encode(uint16_t *probability, int bit) {
+    uint32_t bound = (range_ >> kProbabilityBits) * *probability;
+    if (bit == 0) {
+      range_ = bound;
+      *probability += (kProbabilityOne - *probability) >> kAdaptationShift;
+    } else {
+      low_ += bound;
+      range_ -= bound;
+      *probability -= *probability >> kAdaptationShift;
+    }
+    normalize();
+  }
+  // The num_bits low bits of value, most significant first, each with
+  // probability 1/2.
+  void encode_direct(uint32_t value, int num_bits) {
+    for (int i = num_bits - 1; i >= 0; i--) {
+      range_ >>= 1;
+      if ((value >> i) & 1) low_ += range_;
+      normalize();
+    }
+  }
+  std::vector<uint8_t> finish() {
+    for (int i = 0; i < 5; i++) shift_low();
+    return std::move(bytes_);
+  }
+
+ private:
+  void normalize() {
+    while (range_ < kRangeTop) {
+      range_ <<= 8;
+      shift_low();
+    }
+  }
+  // Emits the top byte of low_ once a carry into it is no longer possible.
+  void shift_low() {
+    if (static_cast<uint32_t>(low_) < 0xFF000000u || (low_ >> 32) != 0) {
+      uint8_t carry = low_ >> 32;
+      uint8_t byte = cache_;
+      do {
+        bytes_.push_back(byte + carry);
+        byte = 0xFF;
+      } while (--cache_size_ != 0);
+      cache_ = (low_ >> 24) & 0xFF;
+    }
+    cache_size_++;
+    low_ = (low_ & 0x00FFFFFFu) << 8;
+  }
+
+  uint64_t low_ = 0;
+  uint32_t range_ = 0xFFFFFFFFu;
+  uint8_t cache_ = 0;
+  uint64_t cache_size_ = 1;
+  std::vector<uint8_t> bytes_;
+};
+
+// Reads past the end of the input as zeros, so corrupt input decodes to
+// garbage rather than out of bounds.
+class RangeDecoder {
+ public:
+  RangeDecoder(const uint8_t *data, size_t size) : data_(data), size_(size) {
+    for (int i = 0; i < 5; i++) code_ = (code_ << 8) | next();
+  }
+  int decode(uint16_t *probability) {
+    uint32_t bound = (range_ >> kProbabilityBits) * *probability;
+    int bit;
+    if (code_ < bound) {
+      range_ = bound;
+      *probability += (kProbabilityOne - *probability) >> kAdaptationShift;
+      bit = 0;
+    } else {
+      code_ -= bound;
+      range_ -= bound;
+      *probability -= *probability >> kAdaptationShift;
+      bit = 1;
+    }
+    normalize();
+    return bit;
+  }
+  uint32_t decode_direct(int num_bits) {
+    uint32_t value = 0;
+    for (int i = 0; i < num_bits; i++) {
+      range_ >>= 1;
+      int bit = code_ >= range_;
+      if (bit) code_ -= range_;
+      value = (value << 1) | bit;
+      normalize();
+    }
+    return value;
+  }
+
+ private:
+  uint8_t next() { return position_ < size_ ? data_[position_++] : 0; }
+  void normalize() {
+    while (range_ < kRangeTop) {
+      range_ <<= 8;
+      code_ = (code_ << 8) | next();
+    }
+  }
+
+  const uint8_t *data_;
+  size_t size_, position_ = 0;
+  uint32_t code_ = 0, range_ = 0xFFFFFFFFu;
+};
+}  // namespace internal
+
+namespace algorithm {
+class IndexModel {
+ public:
+  static constexpr int kSlotBits = 5;
+  static constexpr int kNumSlots = 1 << kSlotBits;
+  // Bits below the leading one of n + 1 that are coded adaptively.
+  static constexpr int kContextBits = 2;
+
+  IndexModel() {
+    std::fill(slot_, slot_ + kNumSlots, kDefault);
+    std::fill(&mantissa_[0][0], &mantissa_[0][0] + kNumSlots * kContexts,
+              kDefault);
+  }
+
+  // Probabilities are rounded to 8 bits:
+  //   uint8 S, then if S > 0 the 31 slot tree probabilities followed by the
+  //   3 probabilities of each of the slots [0, S),
+  // where S is one more than the last slot whose mantissa probabilities are
+  // not the default. The default model has an empty header.
+  std::vector<uint8_t> header() const {
+    int used = 0;
+    for (int s = 0; s < kNumSlots; s++) {
+      for (int j = 1; j < kContexts; j++)
+        if (quantize(mantissa_[s][j]) != kDefault >> 3) used = s + 1;
+    }
+    bool slots_default = true;
+    for (int j = 1; j < kNumSlots; j++)
+      slots_default &= quantize(slot_[j]) == kDefault >> 3;
+    if (used == 0 && slots_default) return {};
+    // A non-default slot tree with default mantissas still needs S >= 1.
+    used = std::max(used, 1);
+    std::vector<uint8_t> bytes = {static_cast<uint8_t>(used)};
+    for (int j = 1; j < kNumSlots; j++) bytes.push_back(quantize(slot_[j]));
+    for (int s = 0; s < used; s++) {
+      for (int j = 1; j < kContexts; j++)
+        bytes.push_back(quantize(mantissa_[s][j]));
+    }
+    return bytes;
+  }
+
+  // False, leaving model untouched, if bytes is not a header.
+  static bool from_header(const uint8_t *bytes, size_t size,
+                          IndexModel *model) {
+    IndexModel parsed;
+    if (size == 0) {
+      *model = parsed;
+      return true;
+    }
+    int used = bytes[0];
+    if (used < 1 || used > kNumSlots ||
+        size != static_cast<size_t>(kNumSlots + used * (kContexts - 1)) ||
+        std::find(bytes + 1, bytes + size, 0) != bytes + size)
+      return false;
+    const uint8_t *b = bytes + 1;
+    for (int j = 1; j < kNumSlots; j++) parsed.slot_[j] = *b++ << 3;
+    for (int s = 0; s < used; s++) {
+      for (int j = 1; j < kContexts; j++) parsed.mantissa_[s][j] = *b++ << 3;
+    }
+    *model = parsed;
+    return true;
+  }
+
+ private:
+  friend class IndexEncoder;
+  friend class IndexDecoder;
+  static constexpr int kContexts = 1 << kContextBits;
+  static constexpr uint16_t kDefault = internal::kProbabilityOne / 2;
+
+  // Adapted probabilities stay within [31, 2017], so the rounded ones are
+  // never 0.
+  static uint8_t quantize(uint16_t probability) {
+    return std::max(1, probability >> 3);
+  }
+
+  // Binary trees indexed from 1, node 2 m + bit following node m.
+  uint16_t slot_[kNumSlots];
+  uint16_t mantissa_[kNumSlots][kContexts];
+};
+
+class IndexEncoder {
+ public:
+  explicit IndexEncoder(const IndexModel &model = IndexModel())
+      : model_(model) {}
+
+  // n must be below 2^32 - 1.
+  void encode(uint32_t n) {
+    uint64_t v = static_cast<uint64_t>(n) + 1;
+    assert(v < (uint64_t(1) << IndexModel::kNumSlots));
+    int slot = 0;
+    while (v >> (slot + 1)) slot++;
+    int m = 1;
+    for (int i = IndexModel::kSlotBits - 1; i >= 0; i--) {
+      int bit = (slot >> i) & 1;
+      coder_.encode(&model_.slot_[m], bit);
+      m = 2 * m + bit;
+    }
+    int context_bits = std::min(slot, IndexModel::kContextBits);
+    int direct_bits = slot - context_bits;
+    m = 1;
+    for (int i = slot - 1; i >= direct_bits; i--) {
+      int bit = (v >> i) & 1;
+      coder_.encode(&model_.mantissa_[slot][m], bit);
+      m = 2 * m + bit;
+    }
+    coder_.encode_direct(static_cast<uint32_t>(v), direct_bits);
+  }
+
+  // The coded indices; the encoder can not be used afterwards.
+  std::vector<uint8_t> finish() { return coder_.finish(); }
+
+  // The model learned so far.
+  const IndexModel &model() const { return model_; }
+
+ private:
+  IndexModel model_;
+  internal::RangeEncoder coder_;
+};
+
+class IndexDecoder {
+ public:
+  IndexDecoder(const uint8_t *data, size_t size,
+               const IndexModel &model = IndexModel())
+      : model_(model), coder_(data, size) {}
+
+  uint32_t decode() {
+    int m = 1;
+    for (int i = 0; i < IndexModel::kSlotBits; i++)
+      m = 2 * m + coder_.decode(&model_.slot_[m]);
+    int slot = m - IndexModel::kNumSlots;
+    int context_bits = std::min(slot, IndexModel::kContextBits);
+    int direct_bits = slot - context_bits;
+    m = 1;
+    for (int i = 0; i < context_bits; i++)
+      m = 2 * m + coder_.decode(&model_.mantissa_[slot][m]);
+    uint64_t v = m;
+    v = (v << direct_bits) | coder_.decode_direct(direct_bits);
+    return static_cast<uint32_t>(v - 1);
+  }
+
+  const IndexModel &model() const { return model_; }
+
+ private:
+  IndexModel model_;
+  internal::RangeDecoder coder_;
+};
+
+// Cost of the sample indices of one batch of blocks, e.g. one layer.
+struct IndexCodingReport {
+  int num_indices = 0;
+  // Sum of internal::zipf_index_bits, the index part of codingCostHyprid.
+  double zipf_bits = 0;
+  // Size of the adaptive code and of the header of the model it started
+  // from.
+  double adaptive_bits = 0, header_bits = 0;
+
+  double saved_bits() const { return zipf_bits - adaptive_bits - header_bits; }
+};
+
+// Codes indices starting from model and compares the result with the Zipf
+// estimate, given the mutual information mi and log2 prod(M) of each block.
+inline IndexCodingReport report_index_coding(
+    const std::vector<uint32_t> &indices, const std::vector<double> &mi,
+    const std::vector<double> &log2M, const IndexModel &model = IndexModel()) {
+  assert(mi.size() == indices.size() && log2M.size() == indices.size());
+  IndexCodingReport report;
+  report.num_indices = indices.size();
+  IndexEncoder encoder(model);
+  for (size_t b = 0; b < indices.size(); b++) {
+    encoder.encode(indices[b]);
+    report.zipf_bits += internal::zipf_index_bits(mi[b], log2M[b], indices[b]);
+  }
+  report.adaptive_bits = 8.0 * encoder.finish().size();
+  report.header_bits = 8.0 * model.header().size();
+  return report;
+}
+}  // namespace algorithm
+}  // namespace rcc
+#endif  // THIRD_PARTY_HYBRID_RCC_ALGORITHM_INDEX_CODER_H_
@@ -0,0 +1,188 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_ALGORITHM_LAYERED_H_
+#define THIRD_PARTY_HYBRID_RCC_ALGORITHM_LAYERED_H_
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "Eigen/Core"
+#include "algorithm/deadline.h"
+#include "algorithm/options.h"
+#include "algorithm/reverse_channel.h"
+#include "include/pcg_random.hpp"
+#include "stats/distributions/multivariate/continuous/gaussian.h"
+
+// Progressive coding of a Gaussian posterior in layers.
+//
+// Successive refinement through a Gaussian noise chain: with z ~ q the
+// sample to communicate, layer l carries z_l = z + e_l where e_l has
+// variance noise[l] p_std^2 per dimension, noise is strictly decreasing and
+// its last entry is 0, so the last layer carries z itself. Under q and
+// under p alike, z_l is Gaussian given z_{l-1}, so every layer is a plain
+// hybrid code,
+//
+//   layer 0:  q(z_0)            against  p(z_0)
+//   layer l:  q(z_l | z_{l-1})  against  p(z_l | z_{l-1}),
+//
+// with the prior of a layer fixed by the sample the decoder reconstructed
+// from the layer before. By the chain rule the layers add up to
+// KL(q || p): refinement costs nothing beyond the one-shot code apart from
+// the per layer overhead of the sampler. A decoder can stop after any
+// layer with a sample of q blurred by noise[l], and an encoder can emit
+// layer 0 before it runs the refinements. Each layer runs
+// sample_gaussian_hybrid, with its certified w_min, on the stream
+// pcg32(seed, l).
+namespace rcc {
+namespace internal {
+// KL(N(mean_a, var_a) || N(mean_b, var_b)) in bits, summed over dimensions.
+inline double gaussian_kl_bits(const Eigen::ArrayXd &mean_a,
+                               const Eigen::ArrayXd &var_a,
+                               const Eigen::ArrayXd &mean_b,
+                               const Eigen::ArrayXd &var_b) {
+  Eigen::ArrayXd kl = 0.5 * ((var_b / var_a).log() +
+                             (var_a + (mean_a - mean_b).square()) / var_b - 1);
+  return kl.sum() / std::log(2.0);
+}
+
+// Distribution of z_l given z_{l-1} = previous when z ~ N(mean, std^2);
+// previous is ignored for layer 0. Returns the mean and the variance.
+inline std::pair<Eigen::ArrayXd, Eigen::ArrayXd> layer_conditional(
+    const Eigen::ArrayXd &mean, const Eigen::ArrayXd &std,
+    const Eigen::ArrayXd &p_var, const std::vector<double> &noise, int layer,
+    const Eigen::ArrayXd &previous) {
+  Eigen::ArrayXd var = std.square() + noise[layer] * p_var;
+  if (layer == 0) return {mean, var};
+  Eigen::ArrayXd step = (noise[layer - 1] - noise[layer]) * p_var;
+  Eigen::ArrayXd gain = var / (var + step);
+  return {mean + gain * (previous - mean), gain * step};
+}
+
+inline bool valid_noise(const std::vector<double> &noise) {
+  if (noise.empty() || noise.back() != 0) return false;
+  for (size_t l = 1; l < noise.size(); l++)
+    if (!(noise[l] < noise[l - 1])) return false;
+  return true;
+}
+}  // namespace internal
+
+namespace algorithm {
+// One layer of a progressive code: what decode_hybrid needs, how the
+// sampler stopped, and the KL of the layer in bits, which its coding cost
+// approaches.
+struct Layer {
+  Eigen::ArrayXd signal, box_dimensions;
+  int sample_index = 0, total_number_samples = 0;
+  SamplerStatus status;
+  double kl_bits = 0;
+};
+
+class LayeredEncoder {
+ public:
+  // noise is in units of the prior variance, strictly decreasing and ending
+  // with 0; {0} is the one-shot hybrid code.
+  LayeredEncoder(const stats::multivariates::IndependentGaussian &q,
+                 const stats::multivariates::IndependentGaussian &p,
+                 std::vector<double> noise, double eps = 1e-4,
+                 uint64_t seed = 0, uint32_t N_max = 1 << 16, bool pfr = true)
+      : q_mean_(q.mean()), q_std_(q.std()), p_mean_(p.mean()),
+        p_std_(p.std()), noise_(std::move(noise)), eps_(eps), seed_(seed),
+        N_max_(N_max), pfr_(pfr) {
+    assert(internal::valid_noise(noise_));
+  }
+
+  int num_layers() const { return noise_.size(); }
+  int encoded_layers() const { return layer_; }
+  bool done() const { return layer_ == num_layers(); }
+
+  // Encodes the next layer. Afterwards sample() is what a decoder of the
+  // layers so far reconstructs.
+  Layer next(const Deadline &deadline = Deadline()) {
+    assert(!done());
+    Eigen::ArrayXd p_var = p_std_.square();
+    auto [q_mean, q_var] = internal::layer_conditional(
+        q_mean_, q_std_, p_var, noise_, layer_, sample_);
+    auto [p_mean, p_var_l] = internal::layer_conditional(
+        p_mean_, p_std_, p_var, noise_, layer_, sample_);
+    stats::multivariates::IndependentGaussian q(q_mean, q_var.sqrt());
+    stats::multivariates::IndependentGaussian p(p_mean, p_var_l.sqrt());
+    Layer layer;
+    layer.kl_bits = internal::gaussian_kl_bits(q_mean, q_var, p_mean, p_var_l);
+    std::tie(sample_, layer.sample_index, layer.signal,
+             layer.total_number_samples, layer.box_dimensions) =
+        sample_gaussian_hybrid(&q, &p, pfr_, eps_, pcg32(seed_, layer_),
+                               N_max_, false, deadline,
+                               Fallback::kBestCandidate, &layer.status);
+    layer_++;
+    return layer;
+  }
+
+  const Eigen::ArrayXd &sample() const { return sample_; }
+
+ private:
+  Eigen::ArrayXd q_mean_, q_std_, p_mean_, p_std_;
+  std::vector<double> noise_;
+  double eps_;
+  uint64_t seed_;
+  uint32_t N_max_;
+  bool pfr_;
+  int layer_ = 0;
+  Eigen::ArrayXd sample_;
+};
+
+class LayeredDecoder {
+ public:
+  LayeredDecoder(const stats::multivariates::IndependentGaussian &p,
+                 std::vector<double> noise, uint64_t seed = 0)
+      : p_mean_(p.mean()), p_std_(p.std()), noise_(std::move(noise)),
+        seed_(seed) {
+    assert(internal::valid_noise(noise_));
+  }
+
+  int num_layers() const { return noise_.size(); }
+  int decoded_layers() const { return layer_; }
+
+  // Decodes the next layer and returns the refined sample.
+  const Eigen::ArrayXd &add(const Layer &layer) {
+    assert(layer_ < num_layers());
+    Eigen::ArrayXd p_var = p_std_.square();
+    auto [p_mean, p_var_l] = internal::layer_conditional(
+        p_mean_, p_std_, p_var, noise_, layer_, sample_);
+    stats::multivariates::IndependentGaussian p(p_mean, p_var_l.sqrt());
+    sample_ = decode_hybrid(layer.sample_index, layer.signal,
+                            layer.box_dimensions, p, p_mean.size(),
+                            pcg32(seed_, layer_));
+    layer_++;
+    return sample_;
+  }
+
+  const Eigen::ArrayXd &sample() const { return sample_; }
+
+ private:
+  Eigen::ArrayXd p_mean_, p_std_;
+  std::vector<double> noise_;
+  uint64_t seed_;
+  int layer_ = 0;
+  Eigen::ArrayXd sample_;
+};
+}  // namespace algorithm
+}  // namespace rcc
+#endif  // THIRD_PARTY_HYBRID_RCC_ALGORITHM_LAYERED_H_
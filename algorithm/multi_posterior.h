@@ -0,0 +1,194 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_ALGORITHM_MULTI_POSTERIOR_H_
+#define THIRD_PARTY_HYBRID_RCC_ALGORITHM_MULTI_POSTERIOR_H_
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <vector>
+
+#include "Eigen/Core"
+#include "algorithm/bounds.h"
+#include "algorithm/deadline.h"
+#include "algorithm/helper.h"
+#include "algorithm/options.h"
+#include "algorithm/reverse_channel.h"
+#include "include/pcg_random.hpp"
+#include "stats/distributions/multivariate/continuous/gaussian.h"
+#include "stats/distributions/multivariate/continuous/uniform.h"
+
+// Coding of several Gaussian posteriors q_1..q_K against one prior and one
+// seed, as in ensembles.
+//
+// The candidates z = p^-1(u) of sample_pfr and sample_sis and their arrival
+// times are fixed by the seed whatever q is, so K calls with the same prior
+// and seed draw and transform the same candidates K times.
+// sample_multi_posterior draws each candidate once, evaluates its quantile
+// and log p once, and scores it under every posterior as one K x dim array
+// expression, with the log normalizers of the posteriors computed up front.
+// Each posterior keeps its own best score and stopping rule, and leaves the
+// expression once its rule fires; the loop ends when every posterior has.
+// Posterior k gets the sample, index and candidate count that sample_pfr or
+// sample_sis would give it, up to the order in which its log densities are
+// summed, which only matters when two scores tie to rounding.
+namespace rcc {
+namespace algorithm {
+// One (z, n, i) per posterior, as sample_pfr (pfr) or sample_sis return
+// them for the same w_min and urbg. status, if given, receives one entry
+// per posterior.
+template <typename STD_URBG, typename Scalar>
+std::vector<std::tuple<Vector<Scalar>, int, int>> sample_multi_posterior(
+    const std::vector<stats::multivariates::BasicIndependentGaussian<Scalar>>
+        &q,
+    ContinuousDistribution<Scalar> &p, const std::vector<double> &w_min,
+    uint32_t N_max, bool pfr, STD_URBG urbg,
+    const Deadline &deadline = Deadline(),
+    std::vector<SamplerStatus> *status = nullptr) {
+  using Array = Vector<Scalar>;
+  using Matrix = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>;
+  assert(w_min.size() == q.size());
+  const int K = q.size();
+  const int dim = p.mean().size();
+  stats::ExponentialDistribution exponential(1);
+  stats::multivariates::BasicIndependentUniform<Scalar> U(dim);
+  auto rng = U.make_rng(urbg);
+  internal::skip_to_arrival_stream(urbg);
+
+  double arrival = 0;
+  std::vector<double> t(K, 0);
+  std::vector<double> s(K, std::numeric_limits<double>::infinity());
+  std::vector<int> n(K, 0), count(K, 0);
+  std::vector<Array> z(K);
+  std::vector<int> active;
+  for (int k = 0; k < K; k++) active.push_back(k);
+
+  // Parameters of the active posteriors, one row each, rebuilt whenever a
+  // posterior stops. The normalizers are those of BasicGaussian::logpdf.
+  Matrix mu, sigma, log_norm;
+  const Scalar sqrt2pi = std::sqrt(Scalar(2 * M_PI));
+  auto gather = [&]() {
+    int rows = active.size();
+    mu.resize(rows, dim);
+    sigma.resize(rows, dim);
+    for (int j = 0; j < rows; j++) {
+      mu.row(j) = q[active[j]].mean().transpose();
+      sigma.row(j) = q[active[j]].std().transpose();
+    }
+    log_norm =
+        (sigma * sqrt2pi).unaryExpr([](Scalar x) { return std::log(x); });
+  };
+  gather();
+
+  std::vector<int> still;
+  Eigen::ArrayXd log_q;
+  for (int i = 0; !active.empty(); i++) {
+    // sample_sis scores candidate 0 before it checks its stopping rule.
+    if (i > 0 || pfr) {
+      bool expired = deadline.expired(i);
+      still.clear();
+      for (int k : active) {
+        if (static_cast<uint32_t>(i) < N_max && s[k] > t[k] * w_min[k] &&
+            !expired)
+          still.push_back(k);
+        else
+          count[k] = i;
+      }
+      if (still.size() != active.size()) {
+        active.swap(still);
+        if (active.empty()) break;
+        gather();
+      }
+    }
+
+    Array u = U.rvs(rng);
+    Array z_ = p.ppf(u);
+    double log_p = p.logpdf(z_).template cast<double>().sum();
+    double e = exponential(urbg);
+    log_q = (Scalar(-0.5) *
+                 ((mu.rowwise() - z_.transpose()) / sigma).square() -
+             log_norm)
+                .template cast<double>()
+                .rowwise()
+                .sum();
+    double w = pfr ? 1 : N_max / static_cast<double>(N_max - i);
+    arrival += w * e;
+    double log_t = std::log(arrival);
+    for (size_t j = 0; j < active.size(); j++) {
+      int k = active[j];
+      t[k] = arrival;
+      double s_ = log_t + log_p - log_q[j];
+      if (isnan(s_))
+        s_ = std::numeric_limits<double>::infinity();
+      else
+        s_ = std::exp(s_);
+      if (i == 0 || s_ < s[k]) {
+        n[k] = i;
+        s[k] = s_;
+        z[k] = z_;
+      }
+    }
+  }
+
+  std::vector<std::tuple<Array, int, int>> results;
+  if (status) status->assign(K, SamplerStatus());
+  for (int k = 0; k < K; k++) {
+    results.emplace_back(z[k], n[k], count[k]);
+    if (status) {
+      SamplerStatus &st = (*status)[k];
+      st.t = t[k];
+      st.s = s[k];
+      st.w_min_stop = !(s[k] > t[k] * w_min[k]);
+      st.deadline_stop =
+          !st.w_min_stop && static_cast<uint32_t>(count[k]) < N_max;
+    }
+  }
+  return results;
+}
+
+// sample_gaussian for each posterior of q with the same p and rs, sharing
+// the candidates between them.
+template <typename STD_URBG, typename Scalar>
+std::vector<std::tuple<Vector<Scalar>, int, int>> sample_gaussian_multi(
+    const std::vector<stats::multivariates::BasicIndependentGaussian<Scalar>>
+        &q,
+    stats::multivariates::BasicIndependentGaussian<Scalar> *p, bool pfr,
+    STD_URBG rs = pcg32(0), uint32_t N_max = 0,
+    const Deadline &deadline = Deadline(),
+    std::vector<SamplerStatus> *status = nullptr) {
+  stats::multivariates::IndependentGaussian p64(
+      p->mean().template cast<double>(), p->std().template cast<double>());
+  std::vector<double> w_min;
+  for (const auto &q_k : q) {
+    assert(q_k.mean().size() == p->mean().size());
+    w_min.push_back(internal::certified_w_min(
+        stats::multivariates::IndependentGaussian(
+            q_k.mean().template cast<double>(),
+            q_k.std().template cast<double>()),
+        p64));
+  }
+  auto shared = internal::shared_prior(*p);
+  stats::multivariates::BasicIndependentGaussian<Scalar> &prior =
+      shared ? *shared : *p;
+  return sample_multi_posterior(q, prior, w_min, N_max, pfr, rs, deadline,
+                                status);
+}
+}  // namespace algorithm
+}  // namespace rcc
+#endif  // THIRD_PARTY_HYBRID_RCC_ALGORITHM_MULTI_POSTERIOR_H_
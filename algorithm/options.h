@@ -0,0 +1,65 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_ALGORITHM_OPTIONS_H_
+#define THIRD_PARTY_HYBRID_RCC_ALGORITHM_OPTIONS_H_
+
+#include <limits>
+
+namespace rcc {
+namespace algorithm {
+// Optional ways of sample_gaussian_hybrid to score or skip candidates; the
+// defaults score every candidate exactly.
+struct HybridOptions {
+  // Grid cells of the ratio tables of sample_hybrid_table; 0 scores
+  // exactly.
+  int table_cells = 0;
+  // Abandons candidates once their partial score can not win, see
+  // sample_hybrid_early_abort.
+  bool early_abort = false;
+  // Bound in nats on the divergence of samples coded with a single
+  // candidate, see sample_hybrid_single_shot.
+  double single_shot_kl = 1e-6;
+  // Dimensions with KL(q_d || p_d) below this many nats are sampled from
+  // the prior instead of searched.
+  double elide_kl = 0;
+  // Evaluates a prior whose dimensions share one mean and standard deviation
+  // as a BasicHomoscedasticGaussian. The samples are the same either way.
+  bool shared_prior = true;
+};
+
+// Quality of the returned sample. t is the arrival time of the last
+// candidate and s the score of the best one, in the same units as the
+// sampler's stopping rule s > t * w_min.
+struct SamplerStatus {
+  double t = 0;
+  double s = std::numeric_limits<double>::infinity();
+  bool w_min_stop = false;
+  bool deadline_stop = false;
+  bool fallback = false;
+  // Coded by sample_hybrid_single_shot, in which case t and s keep their
+  // defaults.
+  bool single_shot = false;
+  // Dimensions that sample_gaussian_hybrid sampled from the prior because
+  // their KL(q_d || p_d) was below elide_kl, and the sum of those KLs in
+  // nats. The sample is that much further from q than a full search would
+  // leave it, and the block codes about that much less information.
+  int elided = 0;
+  double elided_kl = 0;
+};
+}  // namespace algorithm
+}  // namespace rcc
+#endif  // THIRD_PARTY_HYBRID_RCC_ALGORITHM_OPTIONS_H_
@@ -0,0 +1,297 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_ALGORITHM_RATIO_TABLE_H_
+#define THIRD_PARTY_HYBRID_RCC_ALGORITHM_RATIO_TABLE_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include "Eigen/Core"
+#include "algorithm/deadline.h"
+#include "algorithm/helper.h"
+#include "algorithm/options.h"
+#include "stats/distributions/multivariate/continuous/gaussian.h"
+#include "stats/distributions/multivariate/continuous/truncated_gaussian.h"
+
+// Hybrid sampler that scores candidates from per-encode lookup tables.
+//
+// A hybrid candidate is y = k + u with k = floor(c - u + 1/2), so every
+// coordinate y_d lies in [c_d - 1/2, c_d + 1/2) and its contribution to the
+// score,
+//
+//   g_d(y_d) = log q_d(p_d^-1(y_d / M_d)) - log p_d(p_d^-1(y_d / M_d))
+//              - log M_d,
+//
+// is a smooth function of one variable on that interval, -inf where
+// p_d^-1(y_d / M_d) leaves the support of the truncated q_d. RatioTable
+// samples g_d on a grid of the part of the interval inside the support and
+// scores candidates by linear interpolation, so the loop evaluates neither
+// quantiles nor log densities. Candidates outside the support are rejected,
+// as exact scoring would.
+//
+// The interpolation error of a cell of width h is at most h^2 / 8 max |g''|
+// over the cell. Inside the support, log q_d - log p_d is a quadratic
+// a x^2 + b x + const in x = mu_p + sigma_p z with z = Phi^-1(y / M), and
+//
+//   g''(y) = 2 pi sigma_p / M^2 exp(z^2) (2 a sigma_p z^2
+//            + (2 a mu_p + b) z + 2 a sigma_p),
+//
+// so the table bounds |g''| over a cell by the largest exp(z^2) and the
+// largest |quadratic| over the z range of the cell, both of which are
+// attained at its ends or the vertex. The bound holds however fast g''
+// changes, and grows with exp(z^2) towards the tails of p, where M = 1
+// puts whole cells. A few ulps of the terms of g are added for rounding.
+// Any candidate whose interpolated score comes within the summed bounds of
+// its cells of the best score is rescored exactly, so the sampler returns
+// the candidate the exact scoring would, and its stream usage is that of
+// sample_hybrid_fixed.
+//
+// Building a table costs cells + 1 quantile and log density evaluations and
+// as many standard normal quantiles per dimension, against one quantile and
+// log density per dimension and candidate for exact scoring, so tables pay
+// off once a block needs more than about 2 cells candidates.
+namespace rcc {
+namespace internal {
+template <typename Scalar>
+class RatioTable {
+ public:
+  using Array = Eigen::Array<Scalar, Eigen::Dynamic, 1>;
+
+  RatioTable(
+      const stats::multivariates::BasicIndependentTruncatedGaussian<Scalar> &q,
+      const stats::multivariates::BasicIndependentGaussian<Scalar> &p,
+      const Array &M, const Array &c, int cells)
+      : dim_(M.size()), cells_(cells), lower_(dim_), upper_(dim_),
+        outer_lower_(dim_), outer_upper_(dim_), inverse_step_(dim_),
+        values_(static_cast<size_t>(dim_) * (cells + 1)),
+        errors_(static_cast<size_t>(dim_) * cells) {
+    assert(cells > 0);
+    auto [q_a, q_b] = q.support();
+    Eigen::ArrayXd support_a = (p.cdf(q_a) * M).template cast<double>();
+    Eigen::ArrayXd support_b = (p.cdf(q_b) * M).template cast<double>();
+    const auto &q_uni = q.univariates();
+    const auto &p_uni = p.univariates();
+    const stats::univariates::Gaussian standard(0, 1);
+    const double rounding = 64 * std::numeric_limits<Scalar>::epsilon();
+    for (int d = 0; d < dim_ && usable_; d++) {
+      auto g = [&](double y) {
+        Scalar phi = p_uni[d].ppf(static_cast<Scalar>(y) / M[d]);
+        return static_cast<double>(q_uni[d].logpdf(phi) +
+                                   (-p_uni[d].logpdf(phi) - std::log(M[d])));
+      };
+      // Where g is finite is decided by the same quantile and log density
+      // as exact scoring, so the support edges are found by bisection on g
+      // rather than taken from the cdf. The interval is widened by a few
+      // ulps for the rounding of k + u.
+      double slack = 1e-12 * (1 + std::abs(static_cast<double>(c[d])));
+      double from = std::max(0.0, c[d] - 0.5 - slack);
+      double to = std::min<double>(M[d], c[d] + 0.5 + slack);
+      double inside = (std::max(from, support_a[d]) +
+                       std::min(to, support_b[d])) / 2;
+      if (!std::isfinite(g(inside))) {
+        usable_ = false;
+        break;
+      }
+      // The quantile is only accurate to rounding, so close to an edge g
+      // is finite or not at random. The table stops a sliver inside the
+      // edge and candidates within a sliver of it are scored exactly.
+      double sliver = 1e-6 + 1e-11 * M[d];
+      auto edge = [&](double outside, double *inner, double *outer) {
+        *inner = *outer = outside;
+        if (std::isfinite(g(outside))) return;
+        double in = inside, out = outside;
+        while (true) {
+          double mid = in + (out - in) / 2;
+          if (mid == in || mid == out) break;
+          (std::isfinite(g(mid)) ? in : out) = mid;
+        }
+        double direction = inside > outside ? 1 : -1;
+        *inner = in + direction * std::min(sliver, std::abs(inside - in));
+        *outer = in - direction * std::min(sliver, std::abs(outside - in));
+      };
+      edge(from, &lower_[d], &outer_lower_[d]);
+      edge(to, &upper_[d], &outer_upper_[d]);
+      double h = (upper_[d] - lower_[d]) / cells;
+      inverse_step_[d] = h > 0 ? 1 / h : 0;
+      double *v = &values_[static_cast<size_t>(d) * (cells + 1)];
+      for (int j = 0; j <= cells; j++) v[j] = g(lower_[d] + j * h);
+
+      // The Gaussian parameters behind the truncation of q_d.
+      using Untruncated = stats::univariates::BasicGaussian<Scalar>;
+      double mu_q = q_uni[d].Untruncated::mean();
+      double sigma_q = q_uni[d].Untruncated::std();
+      double mu_p = p_uni[d].mean(), sigma_p = p_uni[d].std();
+      double a = 0.5 / (sigma_p * sigma_p) - 0.5 / (sigma_q * sigma_q);
+      double b = mu_q / (sigma_q * sigma_q) - mu_p / (sigma_p * sigma_p);
+      double A = 2 * a * sigma_p, B = 2 * a * mu_p + b;
+      auto quadratic = [&](double z) { return std::abs((A * z + B) * z + A); };
+      // Magnitude of the terms that g sums and of its sensitivity to the
+      // rounding of x, for the rounding slack.
+      auto terms = [&](double z) {
+        double x = mu_p + sigma_p * z;
+        double r = (x - mu_q) / sigma_q;
+        return z * z / 2 + r * r / 2 + std::abs(std::log(sigma_p)) +
+               std::abs(std::log(sigma_q)) + std::abs(std::log(M[d])) + 2 +
+               std::abs(2 * a * x + b) * sigma_p * (1 + std::abs(z));
+      };
+      double scale = 2 * M_PI * sigma_p / (M[d] * M[d]) * h * h / 8;
+      double *e = &errors_[static_cast<size_t>(d) * cells];
+      double z1 = standard.ppf(lower_[d] / M[d]);
+      for (int j = 0; j < cells; j++) {
+        double z0 = z1;
+        z1 = standard.ppf((lower_[d] + (j + 1) * h) / M[d]);
+        double largest = std::max(quadratic(z0), quadratic(z1));
+        if (A != 0 && (-B / (2 * A) - z0) * (-B / (2 * A) - z1) < 0)
+          largest = std::max(largest, quadratic(-B / (2 * A)));
+        double z_max = std::max(std::abs(z0), std::abs(z1));
+        // An infinite bound only sends the candidates of the cell to exact
+        // scoring.
+        double curvature =
+            largest > 0 ? scale * std::exp(z_max * z_max) * largest : 0;
+        e[j] = curvature + rounding * std::max(terms(z0), terms(z1));
+        if (std::isnan(e[j])) usable_ = false;
+      }
+    }
+  }
+
+  // False if g could not be tabulated, in which case every candidate has
+  // to be scored exactly.
+  bool usable() const { return usable_; }
+
+  // Interpolated sum of g_d(y_d), -inf if some y_d is outside the support
+  // and +inf if some y_d is too close to its edge to tell. error receives
+  // the summed error bounds of the cells of y.
+  template <typename Y>
+  double log_ratio(const Y &y, double *error) const {
+    double sum = 0;
+    bool edge = false;
+    *error = 0;
+    for (int d = 0; d < dim_; d++) {
+      double yd = y[d];
+      if (!(yd >= outer_lower_[d] && yd <= outer_upper_[d]))
+        return -std::numeric_limits<double>::infinity();
+      if (!(yd >= lower_[d] && yd <= upper_[d])) {
+        edge = true;
+        continue;
+      }
+      double position = (yd - lower_[d]) * inverse_step_[d];
+      int j = std::min(static_cast<int>(position), cells_ - 1);
+      const double *v = &values_[static_cast<size_t>(d) * (cells_ + 1) + j];
+      sum += v[0] + (position - j) * (v[1] - v[0]);
+      *error += errors_[static_cast<size_t>(d) * cells_ + j];
+    }
+    return edge ? std::numeric_limits<double>::infinity() : sum;
+  }
+
+ private:
+  int dim_, cells_;
+  bool usable_ = true;
+  // g_d is tabulated on [lower_, upper_] and -inf outside of
+  // [outer_lower_, outer_upper_].
+  Eigen::ArrayXd lower_, upper_, outer_lower_, outer_upper_, inverse_step_;
+  // Dimension d occupies values_[d (cells + 1), (d + 1) (cells + 1)) and
+  // errors_[d cells, (d + 1) cells).
+  std::vector<double> values_, errors_;
+};
+}  // namespace internal
+
+namespace algorithm {
+// Same arguments and results as sample_hybrid_fixed, for any dimension.
+// exact_evaluations, if given, receives the number of candidates that were
+// rescored exactly.
+template <typename STD_URBG, typename Scalar>
+std::tuple<Eigen::Array<Scalar, Eigen::Dynamic, 1>, int,
+           Eigen::Array<Scalar, Eigen::Dynamic, 1>, int>
+sample_hybrid_table(
+    const stats::multivariates::BasicIndependentTruncatedGaussian<Scalar> &q,
+    const stats::multivariates::BasicIndependentGaussian<Scalar> &p,
+    const Eigen::Array<Scalar, Eigen::Dynamic, 1> &M, uint32_t N_max,
+    double w_min, bool pfr, STD_URBG urbg, int cells = 256,
+    const Deadline &deadline = Deadline(), SamplerStatus *status = nullptr,
+    int *exact_evaluations = nullptr) {
+  using Array = Eigen::Array<Scalar, Eigen::Dynamic, 1>;
+  const int dim = M.size();
+  stats::ExponentialDistribution exponential(1);
+  stats::UniformDistribution uniform(0, 1);
+  STD_URBG uniform_urbg = urbg;
+  internal::skip_to_arrival_stream(urbg);
+
+  auto [q_a, q_b] = q.support();
+  Array c = (p.cdf(q_a) * M + p.cdf(q_b) * M) / 2;
+  c = c.max(0.5).min(M - Scalar(0.5));
+  Array logM = M.log();
+  const auto &q_uni = q.univariates();
+  const auto &p_uni = p.univariates();
+  internal::RatioTable<Scalar> table(q, p, M, c, cells);
+
+  double t = 0;
+  double s = std::numeric_limits<double>::infinity();
+  int n = 0;
+  int i = 0;
+  int exact = 0;
+  double exp_s = std::numeric_limits<double>::infinity();
+  double prodM = M.template cast<double>().prod();
+  Array u(dim), k_(dim), y_(dim), log_ratio(dim), k, y;
+
+  while (static_cast<uint32_t>(i) < N_max && exp_s > t * w_min * prodM &&
+         !deadline.expired(i)) {
+    for (int d = 0; d < dim; d++) u[d] = uniform(uniform_urbg);
+    k_ = (c - u + Scalar(0.5)).floor();
+    y_ = k_ + u;
+
+    double w = pfr ? 1 : N_max / static_cast<double>(N_max - n);
+    t += w * exponential(urbg);
+    double log_t = std::log(t);
+    double error;
+    double approximate = table.usable() ? table.log_ratio(y_, &error) : 0;
+    if (i == 0 || !table.usable() || log_t - approximate - error < s) {
+      for (int d = 0; d < dim; d++) {
+        Scalar phi = p_uni[d].ppf(y_[d] / M[d]);
+        log_ratio[d] = q_uni[d].logpdf(phi) + (-p_uni[d].logpdf(phi) - logM[d]);
+      }
+      double s_ = log_t - log_ratio.template cast<double>().sum();
+      exact++;
+      if (i == 0 || s_ < s) {
+        n = i;
+        s = s_;
+        k = k_;
+        y = y_;
+        exp_s = std::exp(s);
+      }
+    }
+    i++;
+  }
+  if (status) {
+    status->t = t;
+    status->s = exp_s / prodM;
+    status->w_min_stop = !(exp_s > t * w_min * prodM);
+    status->deadline_stop =
+        !status->w_min_stop && static_cast<uint32_t>(i) < N_max;
+  }
+  if (exact_evaluations) *exact_evaluations = exact;
+  Array z = p.ppf(Array(y / M));
+  return std::tuple<Array, int, Array, int>(z, n, k, i);
+}
+}  // namespace algorithm
+}  // namespace rcc
+#endif  // THIRD_PARTY_HYBRID_RCC_ALGORITHM_RATIO_TABLE_H_
@@ -19,16 +19,25 @@
 
 #include <math.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <iostream>
+#include <optional>
 #include <ostream>
 #include <random>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include "Eigen/Core"
+#include "algorithm/bounds.h"
+#include "algorithm/deadline.h"
+#include "algorithm/early_abort.h"
+#include "algorithm/fixed_dimension.h"
 #include "algorithm/helper.h"
+#include "algorithm/options.h"
+#include "algorithm/ratio_table.h"
 #include "stats/distributions/multivariate/continuous/gaussian.h"
 #include "stats/distributions/multivariate/continuous/truncated_gaussian.h"
 #include "stats/distributions/multivariate/continuous/uniform.h"
@@ -36,26 +45,160 @@
 #include "stats/distributions/probability_distribution.h"
 #include "include/pcg_random.hpp"
 
+// The samplers are templated on the scalar type of the distributions and
+// are instantiated for double and float.
+//
+// Precision of the float samplers:
+//  - Per dimension work (the quantile and log densities of every candidate)
+//    runs in Scalar. Everything that accumulates across candidates or
+//    dimensions runs in double: the arrival time t, the log-ratio sums, the
+//    score s and prod(M). A float sum of d log-ratios of magnitude L is off
+//    by about d * L * 6e-8, so dimension-wise rounding perturbs the score by
+//    a relative 1e-6 or less for blocks of up to a few hundred dimensions
+//    with L < 20. This only changes which candidate wins when two scores
+//    tie to that precision, which does not bias the sample noticeably.
+//  - Decoding is exact as long as the decoder uses the same Scalar as the
+//    encoder: the uniforms are drawn in double and rounded to Scalar on both
+//    sides, k is transmitted and the sample is recomputed from (k + u) / M
+//    with the same arithmetic. Mixing precisions between the encoder and the
+//    decoder gives samples that differ by float rounding.
+//  - The lattice index k = floor(c - u + 0.5) is exact in float while
+//    |c| < 2^23, i.e. for M below eight million per dimension.
+//  - The normal quantile is evaluated in double from a Scalar probability.
+//    The largest float below 1 is 1 - 2^-24, so the upper tail of the
+//    candidates is cut at about 5.3 standard deviations, which moves a
+//    probability mass of about 6e-8 per dimension. The lower tail is not
+//    affected.
+//  - M and the certified w_min are computed in double by
+//    sample_gaussian_hybrid and sample_gaussian, so the stopping rule is
+//    the same for both precisions.
+// Use double when blocks have thousands of dimensions, when posteriors are
+// more than five prior standard deviations away from the prior mean, or when
+// the decoder may run in a different precision than the encoder.
 namespace rcc {
+namespace internal {
+// p as a BasicHomoscedasticGaussian if its dimensions share their mean and
+// standard deviation, the standard normal prior in particular, so that the
+// samplers evaluate it with scalar parameters. Samples are unchanged.
+template <typename Scalar>
+std::optional<stats::multivariates::BasicHomoscedasticGaussian<Scalar>>
+shared_prior(const stats::multivariates::BasicIndependentGaussian<Scalar> &p) {
+  if (!stats::multivariates::is_homoscedastic(p)) return std::nullopt;
+  return stats::multivariates::BasicHomoscedasticGaussian<Scalar>(
+      p.mean().size(), p.mean()[0], p.std()[0]);
+}
+
+// Double-precision twins of the priors, for the bounds and M.
+template <typename Scalar>
+stats::multivariates::IndependentGaussian in_double(
+    const stats::multivariates::BasicIndependentGaussian<Scalar> &p) {
+  return stats::multivariates::IndependentGaussian(
+      p.mean().template cast<double>(), p.std().template cast<double>());
+}
+
+template <typename Scalar>
+stats::multivariates::IndependentUniform in_double(
+    const stats::multivariates::BasicIndependentUniform<Scalar> &p) {
+  auto [a, b] = p.support();
+  return stats::multivariates::IndependentUniform(a.template cast<double>(),
+                                                  b.template cast<double>());
+}
+
+// The Laplace, logistic and Student's t priors are only used in double.
+inline const stats::multivariates::IndependentLaplace &in_double(
+    const stats::multivariates::IndependentLaplace &p) {
+  return p;
+}
+
+inline const stats::multivariates::IndependentLogistic &in_double(
+    const stats::multivariates::IndependentLogistic &p) {
+  return p;
+}
+
+inline const stats::multivariates::IndependentStudentT &in_double(
+    const stats::multivariates::IndependentStudentT &p) {
+  return p;
+}
+
+// Upper bound in nats of the KL divergence of q from the first hybrid
+// candidate, given the certified w_min of q and p and the lattice M; see
+// sample_hybrid_single_shot. It is 0, up to the margin of the bounds, when
+// q is uniform on a cell of the lattice.
+inline double single_shot_divergence(double w_min, const Eigen::ArrayXd &M) {
+  return std::max(0.0, -std::log(w_min) - M.log().sum());
+}
+
+// Per dimension KL(q_d || p_d) in nats.
+template <typename Scalar>
+Eigen::ArrayXd gaussian_kl(
+    const stats::multivariates::BasicIndependentGaussian<Scalar> &q,
+    const stats::multivariates::BasicIndependentGaussian<Scalar> &p) {
+  Eigen::ArrayXd var_q = q.std().template cast<double>().square();
+  Eigen::ArrayXd var_p = p.std().template cast<double>().square();
+  Eigen::ArrayXd diff = (q.mean() - p.mean()).template cast<double>();
+  return 0.5 * ((var_p / var_q).log() + (var_q + diff.square()) / var_p - 1);
+}
+
+// Probabilities p(z) of candidate n of a block with elided dimensions,
+// marked by M_d = 0 and k_d = 0. The other dimensions form an ordinary
+// hybrid block of their own, whose candidate n starts n * (their number)
+// steps into the uniform stream. Elided dimensions take uniforms from the
+// stream at kElidedStreamOffset, the same for every candidate.
+template <typename AdvanceURBG, typename Scalar>
+Eigen::Array<Scalar, Eigen::Dynamic, 1> elided_probabilities(
+    int n, const Eigen::Array<Scalar, Eigen::Dynamic, 1> &k,
+    const Eigen::Array<Scalar, Eigen::Dynamic, 1> &M, AdvanceURBG urbg) {
+  using Array = Eigen::Array<Scalar, Eigen::Dynamic, 1>;
+  const int dim = M.size();
+  const int kept = (M != 0).count();
+  AdvanceURBG elided_urbg = urbg;
+  elided_urbg.advance(kElidedStreamOffset);
+  urbg.advance(static_cast<uint64_t>(n) * kept);
+  Array u_kept, u_elided;
+  if (kept > 0) {
+    stats::multivariates::BasicIndependentUniform<Scalar> U(kept);
+    auto rng = U.make_rng(urbg);
+    u_kept = U.rvs(rng);
+  }
+  if (kept < dim) {
+    stats::multivariates::BasicIndependentUniform<Scalar> U(dim - kept);
+    auto rng = U.make_rng(elided_urbg);
+    u_elided = U.rvs(rng);
+  }
+  Array P(dim);
+  for (int d = 0, a = 0, e = 0; d < dim; d++)
+    P[d] = M[d] != 0 ? (k[d] + u_kept[a++]) / M[d] : u_elided[e++];
+  return P;
+}
+}  // namespace internal
+
 namespace algorithm {
-template <typename STD_URBG>
-std::tuple<Eigen::ArrayXd, int, Eigen::ArrayXd, int> sample_hybrid_pfr(
-    stats::ProbabilityDistribution<stats::ContinuousMultiVariable> &q,
-    stats::ProbabilityDistribution<stats::ContinuousMultiVariable> &p,
-    const Eigen::ArrayXd &M, uint32_t limit, double w_min, STD_URBG urbg,
-    bool verbose = false) {
-  std::exponential_distribution<> exponential(1);
+template <typename Scalar>
+using Vector = Eigen::Array<Scalar, Eigen::Dynamic, 1>;
+template <typename Scalar>
+using ContinuousDistribution =
+    stats::ProbabilityDistribution<stats::BasicContinuousMultiVariable<Scalar>>;
+
+template <typename STD_URBG, typename Scalar>
+std::tuple<Vector<Scalar>, int, Vector<Scalar>, int> sample_hybrid_pfr(
+    ContinuousDistribution<Scalar> &q, ContinuousDistribution<Scalar> &p,
+    const Vector<Scalar> &M, uint32_t limit, double w_min, STD_URBG urbg,
+    bool verbose = false, const Deadline &deadline = Deadline(),
+    SamplerStatus *status = nullptr) {
+  using Array = Vector<Scalar>;
+  stats::ExponentialDistribution exponential(1);
   int dim = q.mean().size();
-  Eigen::ArrayXd logM = M.log();
+  Array logM = M.log();
 
-  stats::multivariates::IndependentUniform U(dim);
+  stats::multivariates::BasicIndependentUniform<Scalar> U(dim);
   auto rng = U.make_rng(urbg);
+  internal::skip_to_arrival_stream(urbg);
 
   auto [q_a, q_b] = q.support();
-  Eigen::ArrayXd q_support_a = p.cdf(q_a) * M;
-  Eigen::ArrayXd q_support_b = p.cdf(q_b) * M;
-  Eigen::ArrayXd c = (q_support_a + q_support_b) / 2.0;
-  c = c.max(0.5).min(M - 0.5);
+  Array q_support_a = p.cdf(q_a) * M;
+  Array q_support_b = p.cdf(q_b) * M;
+  Array c = (q_support_a + q_support_b) / 2;
+  c = c.max(0.5).min(M - Scalar(0.5));
   if (verbose) {
     std::cerr << "q_a=" << q_a.transpose().format(eigen_format()) << "\t q_b="
               << q_b.transpose().format(eigen_format()) << "\t c="
@@ -68,20 +211,22 @@ std::tuple<Eigen::ArrayXd, int, Eigen::ArrayXd, int> sample_hybrid_pfr(
   int n = 0;  // index of last accepted proposal
   int i = 0;  // index of current proposal
   double exp_s = std::numeric_limits<double>::infinity();
-  typename stats::ContinuousMultiVariable::pointProbabilityType y, k;
-  double prodM = M.prod();
+  Array y, k;
+  double prodM = M.template cast<double>().prod();
 
-  while (i < limit && exp_s > t * w_min * prodM) {
+  while (static_cast<uint32_t>(i) < limit && exp_s > t * w_min * prodM &&
+         !deadline.expired(i)) {
     // generate candidate using universal quantization
-    Eigen::ArrayXd u = U.rvs(rng);
-    Eigen::ArrayXd k_ = (c - u + 0.5).floor();
-    Eigen::ArrayXd y_ = k_ + u;
+    Array u = U.rvs(rng);
+    Array k_ = (c - u + Scalar(0.5)).floor();
+    Array y_ = k_ + u;
 
     // evaluate candidate
     t += exponential(urbg);
-    Eigen::ArrayXd phi = p.ppf(y_ / M);
-    Eigen::ArrayXd q_phi_logpdf = q.logpdf(phi) + (-p.logpdf(phi) - logM);
-    double s_ = std::log(t) - q_phi_logpdf.sum();
+    Array phi = p.ppf(y_ / M);
+    Array q_phi_logpdf = q.logpdf(phi) + (-p.logpdf(phi) - logM);
+    double s_ =
+        std::log(t) - q_phi_logpdf.template cast<double>().sum();
     if (verbose) {
       std::cerr << "u " << u.transpose().format(eigen_format()) << " k_ "
                 << k_.transpose().format(eigen_format()) << " y_ "
@@ -103,29 +248,38 @@ std::tuple<Eigen::ArrayXd, int, Eigen::ArrayXd, int> sample_hybrid_pfr(
     }
     i++;
   }
+  if (status) {
+    status->t = t;
+    status->s = exp_s / prodM;
+    status->w_min_stop = !(exp_s > t * w_min * prodM);
+    status->deadline_stop =
+        !status->w_min_stop && static_cast<uint32_t>(i) < limit;
+  }
   // transform sample back
   auto z = p.ppf(y / M);
-  return std::tuple<Eigen::ArrayXd, int, Eigen::ArrayXd, int>(z, n, k, i);
+  return std::tuple<Array, int, Array, int>(z, n, k, i);
 }
 
-template <typename STD_URBG>
-std::tuple<Eigen::ArrayXd, int, Eigen::ArrayXd, int> sample_hybrid_sis(
-    stats::ProbabilityDistribution<stats::ContinuousMultiVariable> &q,
-    stats::ProbabilityDistribution<stats::ContinuousMultiVariable> &p,
-    const Eigen::ArrayXd &M, uint32_t N_max, double w_min, STD_URBG urbg,
-    bool verbose = false) {
-  std::exponential_distribution<> exponential(1);
+template <typename STD_URBG, typename Scalar>
+std::tuple<Vector<Scalar>, int, Vector<Scalar>, int> sample_hybrid_sis(
+    ContinuousDistribution<Scalar> &q, ContinuousDistribution<Scalar> &p,
+    const Vector<Scalar> &M, uint32_t N_max, double w_min, STD_URBG urbg,
+    bool verbose = false, const Deadline &deadline = Deadline(),
+    SamplerStatus *status = nullptr) {
+  using Array = Vector<Scalar>;
+  stats::ExponentialDistribution exponential(1);
   int dim = q.mean().size();
-  Eigen::ArrayXd logM = M.log();
+  Array logM = M.log();
 
-  stats::multivariates::IndependentUniform U(dim);
+  stats::multivariates::BasicIndependentUniform<Scalar> U(dim);
   auto rng = U.make_rng(urbg);
+  internal::skip_to_arrival_stream(urbg);
 
   auto [q_a, q_b] = q.support();
-  Eigen::ArrayXd q_support_a = p.cdf(q_a) * M;
-  Eigen::ArrayXd q_support_b = p.cdf(q_b) * M;
-  Eigen::ArrayXd c = (q_support_a + q_support_b) / 2.0;
-  c = c.max(0.5).min(M - 0.5);
+  Array q_support_a = p.cdf(q_a) * M;
+  Array q_support_b = p.cdf(q_b) * M;
+  Array c = (q_support_a + q_support_b) / 2;
+  c = c.max(0.5).min(M - Scalar(0.5));
   if (verbose) {
     std::cerr << "q_a=" << q_a.transpose().format(eigen_format()) << "\tq_b="
               << q_b.transpose().format(eigen_format()) << "\tc="
@@ -138,21 +292,23 @@ std::tuple<Eigen::ArrayXd, int, Eigen::ArrayXd, int> sample_hybrid_sis(
   int n = 0;  // index of last accepted proposal
   int i = 0;  // index of current proposal
   double exp_s = std::numeric_limits<double>::infinity();
-  typename stats::ContinuousMultiVariable::pointProbabilityType y, k;
-  double prodM = M.prod();
+  Array y, k;
+  double prodM = M.template cast<double>().prod();
 
-  while (i < N_max && exp_s > t * w_min * prodM) {
+  while (static_cast<uint32_t>(i) < N_max && exp_s > t * w_min * prodM &&
+         !deadline.expired(i)) {
     // generate candidate using universal quantization
-    Eigen::ArrayXd u = U.rvs(rng);
-    Eigen::ArrayXd k_ = (c - u + 0.5).floor();
-    Eigen::ArrayXd y_ = k_ + u;
+    Array u = U.rvs(rng);
+    Array k_ = (c - u + Scalar(0.5)).floor();
+    Array y_ = k_ + u;
 
     // evaluate candidate
     double w = N_max / static_cast<double>(N_max - n);
     t += w * exponential(urbg);
-    Eigen::ArrayXd phi = p.ppf(y_ / M);
-    Eigen::ArrayXd q_phi_logpdf = q.logpdf(phi) + (-p.logpdf(phi) - logM);
-    double s_ = std::log(t) - q_phi_logpdf.sum();
+    Array phi = p.ppf(y_ / M);
+    Array q_phi_logpdf = q.logpdf(phi) + (-p.logpdf(phi) - logM);
+    double s_ =
+        std::log(t) - q_phi_logpdf.template cast<double>().sum();
     if (verbose) {
       std::cerr << i << "/" << N_max << ": u "
                 << u.transpose().format(eigen_format()) << " k_ "
@@ -175,42 +331,57 @@ std::tuple<Eigen::ArrayXd, int, Eigen::ArrayXd, int> sample_hybrid_sis(
     }
     i++;
   }
+  if (status) {
+    status->t = t;
+    status->s = exp_s / prodM;
+    status->w_min_stop = !(exp_s > t * w_min * prodM);
+    status->deadline_stop =
+        !status->w_min_stop && static_cast<uint32_t>(i) < N_max;
+  }
   // transform sample back
   auto z = p.ppf(y / M);
-  return std::tuple<Eigen::ArrayXd, int, Eigen::ArrayXd, int>(z, n, k, i);
+  return std::tuple<Array, int, Array, int>(z, n, k, i);
 }
 
-template <typename AdvanceURBG>
-inline Eigen::ArrayXd decode_hybrid(
-    int n, const Eigen::ArrayXd &k, const Eigen::ArrayXd &M,
-    stats::ProbabilityDistribution<stats::ContinuousMultiVariable> &p, int dim,
-    AdvanceURBG urbg) {
-  urbg.advance(n * dim);
-  stats::multivariates::IndependentUniform U(dim);
+// Each uniform takes exactly one engine step, so candidate n starts n * dim
+// steps into the uniform stream. Blocks with elided dimensions, M_d = 0,
+// follow the layout of internal::elided_probabilities.
+template <typename AdvanceURBG, typename Scalar>
+inline Vector<Scalar> decode_hybrid(int n, const Vector<Scalar> &k,
+                                    const Vector<Scalar> &M,
+                                    ContinuousDistribution<Scalar> &p, int dim,
+                                    AdvanceURBG urbg) {
+  using Array = Vector<Scalar>;
+  if ((M == 0).any())
+    return p.ppf(internal::elided_probabilities(n, k, M, urbg));
+  urbg.advance(static_cast<uint64_t>(n) * dim);
+  stats::multivariates::BasicIndependentUniform<Scalar> U(dim);
   auto rng = U.make_rng(urbg);
-  Eigen::ArrayXd u = U.rvs(rng);
+  Array u = U.rvs(rng);
   return p.ppf((k + u) / M);
 }
 
-template <typename STD_URBG>
-std::tuple<Eigen::ArrayXd, int, int> sample_sis(
-    stats::ProbabilityDistribution<stats::ContinuousMultiVariable> &q,
-    stats::ProbabilityDistribution<stats::ContinuousMultiVariable> &p,
-    double w_min, int N_max, STD_URBG &urbg, bool verbose = false) {
-  std::exponential_distribution<> exponential(1);
+template <typename STD_URBG, typename Scalar>
+std::tuple<Vector<Scalar>, int, int> sample_sis(
+    ContinuousDistribution<Scalar> &q, ContinuousDistribution<Scalar> &p,
+    double w_min, int N_max, STD_URBG &urbg, bool verbose = false,
+    const Deadline &deadline = Deadline(), SamplerStatus *status = nullptr) {
+  using Array = Vector<Scalar>;
+  stats::ExponentialDistribution exponential(1);
   int dim = q.mean().size();
-  stats::multivariates::IndependentUniform U(dim);
+  stats::multivariates::BasicIndependentUniform<Scalar> U(dim);
   auto rng = U.make_rng(urbg);
+  internal::skip_to_arrival_stream(urbg);
 
   double t = 0;
   int n = 0;
   double s_star = std::numeric_limits<double>::infinity();
   int n_star = 1;
-  Eigen::ArrayXd z_star;
+  Array z_star;
 
   do {
-    Eigen::ArrayXd u = U.rvs(rng);
-    Eigen::ArrayXd z = p.ppf(u);
+    Array u = U.rvs(rng);
+    Array z = p.ppf(u);
     if (verbose) {
       std::cerr << n << "/" << N_max << ": "
                 << u.transpose().format(eigen_format()) << "\t"
@@ -219,7 +390,8 @@ std::tuple<Eigen::ArrayXd, int, int> sample_sis(
 
     double w = N_max / static_cast<double>(N_max - n);
     t += w * exponential(urbg);
-    double s = std::log(t) + p.logpdf(z).sum() - q.logpdf(z).sum();
+    double s = std::log(t) + p.logpdf(z).template cast<double>().sum() -
+               q.logpdf(z).template cast<double>().sum();
     if (isnan(s))
       s = std::numeric_limits<double>::infinity();
     else
@@ -231,36 +403,46 @@ std::tuple<Eigen::ArrayXd, int, int> sample_sis(
       z_star = z;
     }
     n++;
-  } while (s_star > t * w_min && n < N_max);
-  return std::tuple<Eigen::ArrayXd, int, int>(z_star, n_star, n);
+  } while (s_star > t * w_min && n < N_max && !deadline.expired(n));
+  if (status) {
+    status->t = t;
+    status->s = s_star;
+    status->w_min_stop = !(s_star > t * w_min);
+    status->deadline_stop = !status->w_min_stop && n < N_max;
+  }
+  return std::tuple<Array, int, int>(z_star, n_star, n);
 }
 
-template <typename STD_URBG>
-std::tuple<Eigen::ArrayXd, int, int> sample_pfr(
-    stats::ProbabilityDistribution<stats::ContinuousMultiVariable> &q,
-    stats::ProbabilityDistribution<stats::ContinuousMultiVariable> &p,
-    double w_min, uint32_t N_max, STD_URBG &urbg, bool verbose = false) {
-  std::exponential_distribution<> exponential(1);
+template <typename STD_URBG, typename Scalar>
+std::tuple<Vector<Scalar>, int, int> sample_pfr(
+    ContinuousDistribution<Scalar> &q, ContinuousDistribution<Scalar> &p,
+    double w_min, uint32_t N_max, STD_URBG &urbg, bool verbose = false,
+    const Deadline &deadline = Deadline(), SamplerStatus *status = nullptr) {
+  using Array = Vector<Scalar>;
+  stats::ExponentialDistribution exponential(1);
   int dim = q.mean().size();
-  stats::multivariates::IndependentUniform U(dim);
+  stats::multivariates::BasicIndependentUniform<Scalar> U(dim);
   auto rng = U.make_rng(urbg);
+  internal::skip_to_arrival_stream(urbg);
 
   double t = 0;
   double s = std::numeric_limits<double>::infinity();
   int n = 0;
   int i = 0;
-  Eigen::ArrayXd z;
+  Array z;
 
-  while (i < N_max && s > t * w_min) {
-    Eigen::ArrayXd u = U.rvs(rng);
-    Eigen::ArrayXd z_ = p.ppf(u);
+  while (static_cast<uint32_t>(i) < N_max && s > t * w_min &&
+         !deadline.expired(i)) {
+    Array u = U.rvs(rng);
+    Array z_ = p.ppf(u);
 
     if (verbose) {
       std::cerr << i << ": " << u.transpose().format(eigen_format()) << "\t"
                 << z_.transpose().format(eigen_format()) << std::endl;
     }
     t += exponential(urbg);
-    double s_ = std::log(t) + p.logpdf(z_).sum() - q.logpdf(z_).sum();
+    double s_ = std::log(t) + p.logpdf(z_).template cast<double>().sum() -
+                q.logpdf(z_).template cast<double>().sum();
     if (isnan(s_))
       s_ = std::numeric_limits<double>::infinity();
     else
@@ -273,60 +455,272 @@ std::tuple<Eigen::ArrayXd, int, int> sample_pfr(
     }
     i++;
   }
-  return std::tuple<Eigen::ArrayXd, int, int>(z, n, i);
+  if (status) {
+    status->t = t;
+    status->s = s;
+    status->w_min_stop = !(s > t * w_min);
+    status->deadline_stop =
+        !status->w_min_stop && static_cast<uint32_t>(i) < N_max;
+  }
+  return std::tuple<Array, int, int>(z, n, i);
 }
 
-template <typename STD_URBG>
-std::tuple<Eigen::ArrayXd, int, Eigen::ArrayXd, int, Eigen::ArrayXd>
-sample_gaussian_hybrid(stats::multivariates::IndependentGaussian *q,
-                       stats::multivariates::IndependentGaussian *p, bool pfr,
-                       double eps = 1e-4, STD_URBG rs = pcg32(0),
-                       uint32_t N_max = 0, bool verbose = false) {
+// Dithered quantization of c, in the coordinates y = M p.cdf(x) of the
+// lattice of the hybrid samplers, using the dither of their first
+// candidate. c is clamped to the centres of the outermost cells. The result
+// decodes with decode_hybrid as sample index 0.
+template <typename STD_URBG, typename Scalar>
+std::tuple<Vector<Scalar>, Vector<Scalar>> dithered_quantization(
+    const Vector<Scalar> &c, ContinuousDistribution<Scalar> &p,
+    const Vector<Scalar> &M, STD_URBG urbg) {
+  using Array = Vector<Scalar>;
+  int dim = M.size();
+  stats::multivariates::BasicIndependentUniform<Scalar> U(dim);
+  auto rng = U.make_rng(urbg);
+  Array u = U.rvs(rng);
+  Array k = (c.max(0.5).min(M - Scalar(0.5)) - u + Scalar(0.5)).floor();
+  return std::tuple<Array, Array>(p.ppf((k + u) / M), k);
+}
+
+// Single-shot hybrid coding. The first candidate of the hybrid samplers is
+// uniform on the unit cell of the lattice around c, which contains the
+// support of the pushforward of q through y = M p.cdf(x). If that
+// pushforward has density r(y) <= R, then KL(q || candidate) = E_q log r
+// <= log R, and by the ratio bounds log R = -log(w_min prod(M)), which is
+// internal::single_shot_divergence. When q is uniform on the cell, e.g. an
+// IndependentUniform whose support lines up with the lattice, R = 1: every
+// candidate then has the same log-ratio and the samplers return the first
+// one, but only stop after the second. Near-uniform posteriors, such as
+// Gaussians truncated close to their mean, have R close to 1 and spend a
+// few candidates for a sample that one candidate approximates within
+// log R. Either way this returns (z, k) in O(dim): the dithered
+// quantization of the samplers' c, which is exactly the candidate they
+// would start with and decodes with decode_hybrid as sample index 0.
+template <typename STD_URBG, typename Scalar>
+std::tuple<Vector<Scalar>, Vector<Scalar>> sample_hybrid_single_shot(
+    ContinuousDistribution<Scalar> &q, ContinuousDistribution<Scalar> &p,
+    const Vector<Scalar> &M, STD_URBG urbg) {
+  auto [q_a, q_b] = q.support();
+  return dithered_quantization(
+      Vector<Scalar>((p.cdf(q_a) * M + p.cdf(q_b) * M) / 2), p, M, urbg);
+}
+
+// Hybrid coding of a uniform posterior q, such as a quantization bin, against
+// a Gaussian, uniform, Laplace, logistic or Student's t prior p. M is the
+// finest lattice whose cells can hold the support of q after
+// y = M p.cdf(x). Blocks whose internal::single_shot_divergence is at most
+// single_shot_kl nats, among them every q that is uniform on exactly one
+// cell, are coded with sample_hybrid_single_shot and the others with
+// sample_hybrid_pfr or sample_hybrid_sis. Returns (z, n, k, i, M) like
+// sample_gaussian_hybrid.
+template <typename STD_URBG, typename Scalar, typename Prior>
+std::tuple<Vector<Scalar>, int, Vector<Scalar>, int, Vector<Scalar>>
+sample_uniform_hybrid(stats::multivariates::BasicIndependentUniform<Scalar> *q,
+                      Prior *p, bool pfr, STD_URBG rs = pcg32(0),
+                      uint32_t N_max = 0, bool verbose = false,
+                      const Deadline &deadline = Deadline(),
+                      SamplerStatus *status = nullptr,
+                      double single_shot_kl = 1e-6) {
+  using Array = Vector<Scalar>;
+  auto q64 = internal::in_double(*q);
+  auto p64 = internal::in_double(*p);
+  auto [a, b] = q64.support();
+  Eigen::ArrayXd c = p64.cdf(a);
+  Eigen::ArrayXd d = p64.cdf(b);
+  // A support of 1/M cells maps to a width that rounds either way of 1/M;
+  // keep M rather than dropping to M - 1 and losing the single shot.
+  Array M = (1.0 / (d - c) * (1 + 1e-12)).floor().template cast<Scalar>();
+  double w_min = internal::certified_w_min(q64, p64);
+  SamplerStatus local_status;
+  if (!status) status = &local_status;
+  Array z, k;
+  int n, i;
+  if (!verbose && internal::single_shot_divergence(
+                      w_min, M.template cast<double>()) <= single_shot_kl) {
+    std::tie(z, k) = sample_hybrid_single_shot(*q, *p, M, rs);
+    status->single_shot = true;
+    return std::tuple<Array, int, Array, int, Array>(z, 0, k, 1, M);
+  }
+  if (pfr)
+    std::tie(z, n, k, i) = sample_hybrid_pfr(*q, *p, M, N_max, w_min, rs,
+                                             verbose, deadline, status);
+  else
+    std::tie(z, n, k, i) = sample_hybrid_sis(*q, *p, M, N_max, w_min, rs,
+                                             verbose, deadline, status);
+  return std::tuple<Array, int, Array, int, Array>(z, n, k, i, M);
+}
+
+// The O(dim) setup of M and the certified w_min runs in double whatever
+// Scalar is; only the candidate loop runs in Scalar. Blocks of up to
+// internal::kMaxFixedDimension dimensions use sample_hybrid_fixed unless
+// verbose output is requested. A positive options.table_cells scores
+// candidates with sample_hybrid_table instead, which rescores exactly every
+// candidate its certified interpolation bounds can not rule out, so it
+// returns the same sample, and is faster for blocks that need many more
+// than 2 table_cells candidates. Otherwise options.early_abort selects
+// sample_hybrid_early_abort, which also returns the same sample and skips
+// most of the work of losing candidates in long runs. Blocks whose
+// internal::single_shot_divergence is at most options.single_shot_kl nats
+// are coded with sample_hybrid_single_shot. The default only catches
+// posteriors that are uniform on a lattice cell up to rounding, for which
+// the samplers would return the same candidate.
+//
+// A positive options.elide_kl samples the dimensions whose KL(q_d || p_d)
+// is below it, in nats, from p instead: they are dropped from q and p, the
+// remaining dimensions are coded as a block of their own, and the elided
+// ones take uniforms from a stream that does not depend on the candidate.
+// They are returned with M_d = 0 and k_d = 0, which decode_hybrid
+// recognizes. Posterior collapse leaves many such dimensions in large
+// latents, and every candidate would otherwise evaluate their quantiles and
+// densities for next to no information. status receives their number and
+// summed KL.
+template <typename STD_URBG, typename Scalar>
+std::tuple<Vector<Scalar>, int, Vector<Scalar>, int, Vector<Scalar>>
+sample_gaussian_hybrid(
+    stats::multivariates::BasicIndependentGaussian<Scalar> *q,
+    stats::multivariates::BasicIndependentGaussian<Scalar> *p, bool pfr,
+    double eps = 1e-4, STD_URBG rs = pcg32(0), uint32_t N_max = 0,
+    bool verbose = false, const Deadline &deadline = Deadline(),
+    Fallback fallback = Fallback::kBestCandidate,
+    SamplerStatus *status = nullptr,
+    const HybridOptions &options = HybridOptions()) {
+  using Array = Vector<Scalar>;
   int dim = q->mean().size();
+  if (options.elide_kl > 0) {
+    Eigen::ArrayXd kl = internal::gaussian_kl(*q, *p);
+    std::vector<int> kept;
+    double elided_kl = 0;
+    for (int d = 0; d < dim; d++) {
+      if (kl[d] < options.elide_kl)
+        elided_kl += kl[d];
+      else
+        kept.push_back(d);
+    }
+    if (static_cast<int>(kept.size()) < dim) {
+      SamplerStatus local_status;
+      if (!status) status = &local_status;
+      Array M = Array::Zero(dim), k = Array::Zero(dim);
+      int n = 0, i = 0;
+      if (!kept.empty()) {
+        int size = kept.size();
+        Array q_mean(size), q_std(size), p_mean(size), p_std(size);
+        for (int j = 0; j < size; j++) {
+          q_mean[j] = q->mean()[kept[j]];
+          q_std[j] = q->std()[kept[j]];
+          p_mean[j] = p->mean()[kept[j]];
+          p_std[j] = p->std()[kept[j]];
+        }
+        stats::multivariates::BasicIndependentGaussian<Scalar> q_kept(q_mean,
+                                                                      q_std);
+        stats::multivariates::BasicIndependentGaussian<Scalar> p_kept(p_mean,
+                                                                      p_std);
+        HybridOptions kept_options = options;
+        kept_options.elide_kl = 0;
+        Array z_kept, k_kept, M_kept;
+        std::tie(z_kept, n, k_kept, i, M_kept) = sample_gaussian_hybrid(
+            &q_kept, &p_kept, pfr, eps, rs, N_max, verbose, deadline, fallback,
+            status, kept_options);
+        for (int j = 0; j < size; j++) {
+          k[kept[j]] = k_kept[j];
+          M[kept[j]] = M_kept[j];
+        }
+      }
+      status->elided = dim - kept.size();
+      status->elided_kl = elided_kl;
+      Array z = decode_hybrid(n, k, M, *p, dim, rs);
+      return std::tuple<Array, int, Array, int, Array>(z, n, k, i, M);
+    }
+  }
   Eigen::ArrayXd D(dim);
   D = eps;
   D = 1 - (1 - D).pow(1.0 / dim);
-  stats::multivariates::IndependentGaussian standardNormal(dim);
+  stats::multivariates::HomoscedasticGaussian standardNormal(dim);
 
   auto a = standardNormal.ppf(D / 2.0);
   auto b = standardNormal.ppf(1 - D / 2.0);
 
-  auto mu = q->mean();
-  auto std = q->std();
-  stats::multivariates::IndependentTruncatedGaussian q_tr(mu, std, a * std + mu,
-                                                          b * std + mu);
-  std::tie(a, b) = q_tr.support();
-
-  Eigen::ArrayXd c = p->mean() - q_tr.mean() + a;
-  Eigen::ArrayXd d = p->mean() - q_tr.mean() + b;
-  c = p->cdf(c);
-  d = p->cdf(d);
-  Eigen::ArrayXd M = (1.0 / (d - c)).floor();
-
-  double w_min = (internal::minimum_weight(*q, *p) * (1 - D)).prod();
-
-  Eigen::ArrayXd z, k;
+  Eigen::ArrayXd mu = q->mean().template cast<double>();
+  Eigen::ArrayXd std = q->std().template cast<double>();
+  stats::multivariates::IndependentGaussian p64(
+      p->mean().template cast<double>(), p->std().template cast<double>());
+  stats::multivariates::IndependentTruncatedGaussian q_tr64(
+      mu, std, a * std + mu, b * std + mu);
+  std::tie(a, b) = q_tr64.support();
+
+  Eigen::ArrayXd c = p64.mean() - q_tr64.mean() + a;
+  Eigen::ArrayXd d = p64.mean() - q_tr64.mean() + b;
+  c = p64.cdf(c);
+  d = p64.cdf(d);
+  Array M = (1.0 / (d - c)).floor().template cast<Scalar>();
+
+  double w_min = internal::certified_w_min(q_tr64, p64);
+
+  stats::multivariates::BasicIndependentTruncatedGaussian<Scalar> q_tr(
+      q->mean(), q->std(), a.template cast<Scalar>(),
+      b.template cast<Scalar>());
+  std::optional<stats::multivariates::BasicHomoscedasticGaussian<Scalar>>
+      shared;
+  if (options.shared_prior) shared = internal::shared_prior(*p);
+  stats::multivariates::BasicIndependentGaussian<Scalar> &prior =
+      shared ? *shared : *p;
+  SamplerStatus local_status;
+  if (!status) status = &local_status;
+  Array z, k;
   int n, i;
-  if (pfr)
+  if (!verbose && internal::single_shot_divergence(
+                      w_min, M.template cast<double>()) <=
+                      options.single_shot_kl) {
+    std::tie(z, k) = sample_hybrid_single_shot(q_tr, prior, M, rs);
+    status->single_shot = true;
+    return std::tuple<Array, int, Array, int, Array>(z, 0, k, 1, M);
+  }
+  if (!verbose && options.table_cells > 0)
     std::tie(z, n, k, i) =
-        sample_hybrid_pfr(q_tr, *p, M, N_max, w_min, rs, verbose);
-  else
+        sample_hybrid_table(q_tr, prior, M, N_max, w_min, pfr, rs,
+                            options.table_cells, deadline, status);
+  else if (!verbose && options.early_abort)
+    std::tie(z, n, k, i) = sample_hybrid_early_abort(
+        q_tr, prior, M, N_max, w_min, pfr, rs,
+        internal::maximum_log_ratio(q_tr64, p64), deadline, status);
+  else if (!verbose && dim <= internal::kMaxFixedDimension)
     std::tie(z, n, k, i) =
-        sample_hybrid_sis(q_tr, *p, M, N_max, w_min, rs, verbose);
-  return std::tuple<Eigen::ArrayXd, int, Eigen::ArrayXd, int, Eigen::ArrayXd>(
-      z, n, k, i, M);
+        internal::with_fixed_dimension(dim, [&](auto fixed_dim) {
+          return sample_hybrid_fixed<decltype(fixed_dim)::value>(
+              q_tr, prior, M, N_max, w_min, pfr, rs, deadline, status);
+        });
+  else if (pfr)
+    std::tie(z, n, k, i) = sample_hybrid_pfr(q_tr, prior, M, N_max, w_min, rs,
+                                             verbose, deadline, status);
+  else
+    std::tie(z, n, k, i) = sample_hybrid_sis(q_tr, prior, M, N_max, w_min, rs,
+                                             verbose, deadline, status);
+  if (status->deadline_stop && fallback == Fallback::kDitheredQuantization) {
+    std::tie(z, k) =
+        dithered_quantization(Array(prior.cdf(q_tr.mean()) * M), prior, M, rs);
+    n = 0;
+    status->fallback = true;
+  }
+  return std::tuple<Array, int, Array, int, Array>(z, n, k, i, M);
 }
 
-template <typename STD_URBG>
-std::tuple<Eigen::ArrayXd, int, int> sample_gaussian(
-    stats::multivariates::IndependentGaussian *q,
-    stats::multivariates::IndependentGaussian *p, bool pfr,
-    STD_URBG rs = pcg32(0), uint32_t N_max = 0, bool verbose = false) {
-  double w_min = internal::minimum_weight(*q, *p).prod();
+template <typename STD_URBG, typename Scalar>
+std::tuple<Vector<Scalar>, int, int> sample_gaussian(
+    stats::multivariates::BasicIndependentGaussian<Scalar> *q,
+    stats::multivariates::BasicIndependentGaussian<Scalar> *p, bool pfr,
+    STD_URBG rs = pcg32(0), uint32_t N_max = 0, bool verbose = false,
+    const Deadline &deadline = Deadline(), SamplerStatus *status = nullptr) {
+  double w_min = internal::certified_w_min(
+      stats::multivariates::IndependentGaussian(
+          q->mean().template cast<double>(), q->std().template cast<double>()),
+      stats::multivariates::IndependentGaussian(
+          p->mean().template cast<double>(), p->std().template cast<double>()));
+  auto shared = internal::shared_prior(*p);
+  stats::multivariates::BasicIndependentGaussian<Scalar> &prior =
+      shared ? *shared : *p;
   if (pfr)
-    return sample_pfr(*q, *p, w_min, N_max, rs, verbose);
+    return sample_pfr(*q, prior, w_min, N_max, rs, verbose, deadline, status);
   else
-    return sample_sis(*q, *p, w_min, N_max, rs, verbose);
+    return sample_sis(*q, prior, w_min, N_max, rs, verbose, deadline, status);
 }
 }  // namespace algorithm
 }  // namespace rcc
@@ -0,0 +1,240 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_ALGORITHM_TUNER_H_
+#define THIRD_PARTY_HYBRID_RCC_ALGORITHM_TUNER_H_
+
+#include <math.h>
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "Eigen/Core"
+#include "algorithm/bounds.h"
+#include "algorithm/helper.h"
+#include "algorithm/reverse_channel.h"
+#include "stats/distributions/univariate/continuous/gaussian.h"
+
+// Predicts the cost of sample_gaussian_hybrid before running it and picks
+// eps and N_max for a batch of blocks.
+//
+// Blocks are the columns of dim x num_blocks arrays of means and standard
+// deviations. Everything except the final per block reductions is
+// elementwise over all dimensions of all blocks at once:
+//  - M is the box size the sampler derives from eps,
+//  - R = 1 / (w_min prod(M)) bounds q / (M p) over the box and is the
+//    expected number of candidates of the w_min stopping rule,
+//  - the index is about 2^(KL - log2 M) and its Zipf code length is
+//    estimated as in internal::codingCostHyprid, with the KL divergence of
+//    the Gaussians in place of the difference of entropies,
+//  - latency is a TimingModel applied to min(R, N_max) candidates.
+// The probability that a block is cut off by N_max is estimated as
+// exp(-N_max / R), the tail of the geometric number of candidates of a
+// rejection sampler with acceptance rate 1 / R.
+namespace rcc {
+namespace algorithm {
+// seconds = seconds_per_block + candidates * dim * seconds_per_candidate_dim.
+// The defaults were fitted by calibrate_timing_model on one x86-64 core,
+// where the normal quantile and the log densities dominate the per
+// candidate cost. Calibrate for the machine at hand.
+struct TimingModel {
+  double seconds_per_block = 3e-5;
+  double seconds_per_candidate_dim = 7e-8;
+
+  Eigen::ArrayXd predict(const Eigen::ArrayXd &candidates, int dim) const {
+    return seconds_per_block + candidates * dim * seconds_per_candidate_dim;
+  }
+};
+
+// Per block predictions, one entry per column of the inputs.
+struct HybridPrediction {
+  Eigen::ArrayXd log2M, kl_bits, expected_candidates, coding_cost_bits,
+      cutoff_probability, seconds;
+};
+
+inline HybridPrediction predict_gaussian_hybrid(
+    const Eigen::ArrayXXd &q_mean, const Eigen::ArrayXXd &q_std,
+    const Eigen::ArrayXXd &p_mean, const Eigen::ArrayXXd &p_std, double eps,
+    uint32_t N_max, const TimingModel &timing = TimingModel()) {
+  const int dim = q_mean.rows();
+  const Eigen::Index size = q_mean.size();
+  assert(q_std.rows() == dim && p_mean.rows() == dim && p_std.rows() == dim);
+  static const double log2 = std::log(2), e = std::exp(1);
+
+  // Truncation of q to [mu + a std, mu + b std], as in the sampler.
+  double D = 1 - std::pow(1 - eps, 1.0 / dim);
+  stats::univariates::Gaussian standard_normal(0, 1);
+  double a = standard_normal.ppf(D / 2), b = standard_normal.ppf(1 - D / 2);
+  Eigen::ArrayXXd M = (1 / (q_std / p_std * (b / M_SQRT2)).unaryExpr([](
+                                double x) { return std::erf(x); }))
+                          .floor()
+                          .max(1);
+
+  // Flatten so that the bounds of all dimensions of all blocks are found in
+  // one pass.
+  auto flat = [size](const Eigen::ArrayXXd &x) {
+    return Eigen::Map<const Eigen::ArrayXd>(x.data(), size);
+  };
+  Eigen::ArrayXd mu_q = flat(q_mean), var_q = flat(q_std).square();
+  Eigen::ArrayXd mu_p = flat(p_mean), var_p = flat(p_std).square();
+  const double inf = std::numeric_limits<double>::infinity();
+  double log_z = std::log(standard_normal.cdf(b) - standard_normal.cdf(a));
+  internal::LogQuadratic q_tr{
+      -0.5 / var_q, mu_q / var_q,
+      -0.5 * mu_q * mu_q / var_q - 0.5 * (2 * M_PI * var_q).log() - log_z,
+      mu_q + a * flat(q_std), mu_q + b * flat(q_std)};
+  internal::LogQuadratic p{
+      -0.5 / var_p, mu_p / var_p,
+      -0.5 * mu_p * mu_p / var_p - 0.5 * (2 * M_PI * var_p).log(),
+      Eigen::ArrayXd::Constant(size, -inf),
+      Eigen::ArrayXd::Constant(size, inf)};
+  Eigen::ArrayXd log_weight = internal::minimum_log_weight(q_tr, p);
+  Eigen::ArrayXd kl = (var_p / var_q).log() / 2 +
+                      (var_q + (mu_q - mu_p).square()) / (2 * var_p) - 0.5;
+
+  HybridPrediction prediction;
+  auto per_block = [dim](const Eigen::ArrayXd &x) -> Eigen::ArrayXd {
+    return Eigen::Map<const Eigen::ArrayXXd>(x.data(), dim, x.size() / dim)
+        .colwise()
+        .sum()
+        .transpose();
+  };
+  Eigen::ArrayXd log_M = flat(M).log();
+  prediction.log2M = per_block(log_M) / log2;
+  prediction.kl_bits = per_block(kl) / log2;
+  Eigen::ArrayXd log_R = -per_block(log_weight + log_M);
+  Eigen::ArrayXd R = log_R.exp().max(1);
+  prediction.expected_candidates = R.min(N_max);
+  prediction.cutoff_probability = (-static_cast<double>(N_max) / R).exp();
+
+  Eigen::ArrayXd index_bits = (prediction.kl_bits - prediction.log2M).max(0);
+  prediction.coding_cost_bits.resize(index_bits.size());
+  for (Eigen::Index i = 0; i < index_bits.size(); i++) {
+    double exponent = 1.0 + 1.0 / (1.0 + std::log2(e) / e + index_bits[i]);
+    prediction.coding_cost_bits[i] = prediction.log2M[i] +
+                                     exponent * index_bits[i] +
+                                     std::log2(riemann_zeta(exponent));
+  }
+  prediction.seconds = timing.predict(prediction.expected_candidates, dim);
+  return prediction;
+}
+
+struct TuningOptions {
+  // Upper bound on the summed coding cost of all blocks, in bits.
+  double rate_target = std::numeric_limits<double>::infinity();
+  // Candidate settings. Larger eps is faster but truncates more of q.
+  std::vector<double> eps = {1e-4, 1e-3, 1e-2};
+  std::vector<uint32_t> N_max = {1 << 10, 1 << 12, 1 << 14, 1 << 16,
+                                 1 << 18, 1 << 20};
+  // Largest acceptable cutoff_probability of any block.
+  double max_cutoff_probability = 1e-3;
+};
+
+struct TunedSetting {
+  double eps = 0;
+  uint32_t N_max = 0;
+  // False if no setting met the rate target and the cutoff probability; the
+  // setting is then the one with the lowest rate.
+  bool feasible = false;
+  double coding_cost_bits = 0, seconds = 0;
+  HybridPrediction prediction;
+};
+
+// For every eps, takes the smallest N_max that keeps every block below
+// max_cutoff_probability and returns the fastest setting within
+// rate_target, preferring the smaller eps on ties.
+inline TunedSetting tune_gaussian_hybrid(
+    const Eigen::ArrayXXd &q_mean, const Eigen::ArrayXXd &q_std,
+    const Eigen::ArrayXXd &p_mean, const Eigen::ArrayXXd &p_std,
+    const TuningOptions &options, const TimingModel &timing = TimingModel()) {
+  assert(!options.eps.empty() && !options.N_max.empty());
+  std::vector<uint32_t> N_max = options.N_max;
+  std::sort(N_max.begin(), N_max.end());
+  TunedSetting best, lowest_rate;
+  lowest_rate.coding_cost_bits = std::numeric_limits<double>::infinity();
+  for (double eps : options.eps) {
+    TunedSetting setting;
+    setting.eps = eps;
+    for (uint32_t n : N_max) {
+      setting.N_max = n;
+      setting.prediction =
+          predict_gaussian_hybrid(q_mean, q_std, p_mean, p_std, eps, n, timing);
+      if (setting.prediction.cutoff_probability.maxCoeff() <=
+          options.max_cutoff_probability)
+        break;
+    }
+    setting.coding_cost_bits = setting.prediction.coding_cost_bits.sum();
+    setting.seconds = setting.prediction.seconds.sum();
+    setting.feasible = setting.coding_cost_bits <= options.rate_target &&
+                       setting.prediction.cutoff_probability.maxCoeff() <=
+                           options.max_cutoff_probability;
+    if (setting.feasible &&
+        (!best.feasible || setting.seconds < best.seconds ||
+         (setting.seconds == best.seconds && setting.eps < best.eps)))
+      best = setting;
+    if (setting.coding_cost_bits < lowest_rate.coding_cost_bits)
+      lowest_rate = setting;
+  }
+  return best.feasible ? best : lowest_rate;
+}
+
+// Fits a TimingModel by timing sample_gaussian_hybrid on random blocks of
+// dimension dim whose posteriors range from close to far from the prior.
+template <typename STD_URBG>
+TimingModel calibrate_timing_model(int dim, int num_blocks, STD_URBG urbg,
+                                   double eps = 1e-4) {
+  using Clock = std::chrono::steady_clock;
+  stats::NormalDistribution normal;
+  stats::UniformDistribution scale(0.05, 0.8);
+  // Least squares fit of seconds = a + b * work.
+  double sum_w = 0, sum_t = 0, sum_ww = 0, sum_wt = 0;
+  for (int block = 0; block < num_blocks; block++) {
+    Eigen::ArrayXd mu(dim), std(dim);
+    for (int d = 0; d < dim; d++) {
+      std[d] = scale(urbg);
+      mu[d] = normal(urbg) * (1 - std[d]);
+    }
+    stats::multivariates::IndependentGaussian q(mu, std);
+    stats::multivariates::IndependentGaussian p(dim);
+    auto start = Clock::now();
+    auto result = sample_gaussian_hybrid(&q, &p, true, eps, pcg32(block),
+                                         1 << 20, false);
+    double seconds =
+        std::chrono::duration<double>(Clock::now() - start).count();
+    double work = static_cast<double>(std::get<3>(result)) * dim;
+    sum_w += work;
+    sum_t += seconds;
+    sum_ww += work * work;
+    sum_wt += work * seconds;
+  }
+  TimingModel model;
+  double n = num_blocks, det = n * sum_ww - sum_w * sum_w;
+  if (det <= 0) return model;
+  model.seconds_per_candidate_dim =
+      std::max(0.0, (n * sum_wt - sum_w * sum_t) / det);
+  model.seconds_per_block =
+      std::max(0.0, (sum_t - model.seconds_per_candidate_dim * sum_w) / n);
+  return model;
+}
+}  // namespace algorithm
+}  // namespace rcc
+#endif  // THIRD_PARTY_HYBRID_RCC_ALGORITHM_TUNER_H_
@@ -0,0 +1,123 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the number of candidates the samplers run with the previous w_min
+// estimates against the certified bounds of algorithm/bounds.h.
+//
+// A bound is reported as invalid when it exceeds the certified infimum of
+// p/q, in which case the sampler stops too early and the sample is biased.
+
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+
+#include "Eigen/Core"
+#include "algorithm/bounds.h"
+#include "algorithm/helper.h"
+#include "algorithm/reverse_channel.h"
+#include "include/pcg_random.hpp"
+#include "stats/distributions/multivariate/continuous/gaussian.h"
+#include "stats/distributions/multivariate/continuous/truncated_gaussian.h"
+#include "stats/distributions/multivariate/continuous/uniform.h"
+
+namespace {
+using stats::multivariates::IndependentGaussian;
+using stats::multivariates::IndependentTruncatedGaussian;
+using stats::multivariates::IndependentUniform;
+
+constexpr int kDim = 4;
+constexpr int kTrials = 100;
+constexpr uint32_t kNMax = 1 << 14;
+constexpr double kEps = 1e-4;
+
+struct Summary {
+  double candidates = 0, invalid = 0;
+  void Add(int i, bool is_invalid) {
+    candidates += i / static_cast<double>(kTrials);
+    invalid += is_invalid / static_cast<double>(kTrials);
+  }
+};
+
+void Print(const std::string &pair, const std::string &bound,
+           const Summary &s) {
+  std::cout << std::left << std::setw(28) << pair << std::setw(16) << bound
+            << std::right << std::setw(12) << std::fixed
+            << std::setprecision(1) << s.candidates << std::setw(10)
+            << std::setprecision(3) << s.invalid << std::endl;
+}
+}  // namespace
+
+int main() {
+  pcg32 params(2022);
+  std::uniform_real_distribution<> mean(-1, 1), scale(0.2, 1.2);
+  Summary hybrid_old, hybrid_new, uniform_mc, uniform_new, uniform_none;
+
+  for (int trial = 0; trial < kTrials; trial++) {
+    Eigen::ArrayXd mu_q(kDim), std_q(kDim), mu_p(kDim), std_p(kDim);
+    for (int d = 0; d < kDim; d++) {
+      mu_q[d] = mean(params), std_q[d] = scale(params);
+      mu_p[d] = mean(params), std_p[d] = 1;
+    }
+    IndependentGaussian q(mu_q, std_q), p(mu_p, std_p);
+
+    // Truncated posterior of sample_gaussian_hybrid.
+    Eigen::ArrayXd D = Eigen::ArrayXd::Constant(kDim, kEps);
+    D = 1 - (1 - D).pow(1.0 / kDim);
+    IndependentGaussian standard_normal(kDim);
+    Eigen::ArrayXd a = standard_normal.ppf(D / 2.0) * std_q + mu_q;
+    Eigen::ArrayXd b = standard_normal.ppf(1 - D / 2.0) * std_q + mu_q;
+    IndependentTruncatedGaussian q_tr(mu_q, std_q, a, b);
+    Eigen::ArrayXd M = (1.0 / (p.cdf(b) - p.cdf(a))).floor();
+
+    double w_certified = rcc::internal::certified_w_min(q_tr, p);
+    double w_old = (rcc::internal::minimum_weight(q, p) * (1 - D)).prod();
+    auto [z_old, n_old, k_old, i_old] = rcc::algorithm::sample_hybrid_pfr(
+        q_tr, p, M, kNMax, w_old, pcg32(trial));
+    auto [z_new, n_new, k_new, i_new] = rcc::algorithm::sample_hybrid_pfr(
+        q_tr, p, M, kNMax, w_certified, pcg32(trial));
+    hybrid_old.Add(i_old, w_old > w_certified * (1 + 1e-9));
+    hybrid_new.Add(i_new, false);
+
+    // Uniform posterior, which previously had to use estimate_w.
+    IndependentUniform q_u(mu_q - std_q, mu_q + std_q);
+    pcg32 mc_urbg(trial);
+    auto mc_rng = p.make_rng(mc_urbg);
+    double w_mc = rcc::internal::estimate_w(p, q_u, mc_rng, 1000);
+    double w_u = rcc::internal::certified_w_min(q_u, p);
+    pcg32 rs_mc(trial), rs_new(trial), rs_none(trial);
+    uniform_mc.Add(
+        std::get<2>(rcc::algorithm::sample_pfr(q_u, p, w_mc, kNMax, rs_mc)),
+        w_mc > w_u * (1 + 1e-9));
+    uniform_new.Add(
+        std::get<2>(rcc::algorithm::sample_pfr(q_u, p, w_u, kNMax, rs_new)),
+        false);
+    uniform_none.Add(
+        std::get<2>(rcc::algorithm::sample_pfr(q_u, p, 0.0, kNMax, rs_none)),
+        false);
+  }
+
+  std::cout << std::left << std::setw(28) << "pair" << std::setw(16)
+            << "w_min" << std::right << std::setw(12) << "candidates"
+            << std::setw(10) << "invalid" << std::endl;
+  Print("truncated gaussian/gaussian", "closed form", hybrid_old);
+  Print("truncated gaussian/gaussian", "certified", hybrid_new);
+  Print("uniform/gaussian", "monte carlo", uniform_mc);
+  Print("uniform/gaussian", "certified", uniform_new);
+  Print("uniform/gaussian", "none", uniform_none);
+  return 0;
+}
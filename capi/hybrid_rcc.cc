@@ -0,0 +1,422 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "capi/hybrid_rcc.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "Eigen/Core"
+#include "pipeline/batch_scheduler.h"
+#include "pipeline/encoder.h"
+
+struct rcc_prior {
+  Eigen::ArrayXd mean, std;
+};
+
+struct rcc_workspace {
+  rcc::pipeline::SchedulerOptions options;
+  // Kept across calls so that batches of the same shape reuse the arrays.
+  std::vector<rcc::pipeline::EncodeRequest> requests;
+};
+
+namespace {
+using rcc::pipeline::EncodeRequest;
+using rcc::pipeline::EncodeResult;
+using rcc::pipeline::valid_boxes;
+using rcc::pipeline::valid_scale;
+using ConstMap = Eigen::Map<const Eigen::ArrayXd>;
+
+// Runs body, turning exceptions into status codes: nothing may unwind
+// through a C caller.
+template <typename Body>
+rcc_status guarded(Body body) {
+  try {
+    return body();
+  } catch (const std::bad_alloc &) {
+    return RCC_OUT_OF_MEMORY;
+  } catch (...) {
+    return RCC_FAILED;
+  }
+}
+
+// Size of rcc_encode_options in ABI version 1, which ended at early_abort.
+constexpr size_t kEncodeOptionsV1Size =
+    offsetof(rcc_encode_options, early_abort) + sizeof(int32_t);
+
+// Copies the settings of options into request, which keeps its arrays,
+// seed and deadline.
+void apply_options(const rcc_encode_options &options, bool hybrid,
+                   EncodeRequest *request) {
+  request->hybrid = hybrid;
+  request->pfr = options.pfr;
+  request->eps = options.eps;
+  request->N_max = options.N_max;
+  request->fallback = options.fallback
+                          ? rcc::algorithm::Fallback::kDitheredQuantization
+                          : rcc::algorithm::Fallback::kBestCandidate;
+  request->hybrid_options.table_cells = options.table_cells;
+  request->hybrid_options.early_abort = options.early_abort;
+  request->hybrid_options.elide_kl = options.elide_kl;
+  request->hybrid_options.single_shot_kl = options.single_shot_kl;
+}
+
+// Copies the fields the caller's struct has into *read and defaults the
+// rest, so that callers built against a smaller struct keep working.
+bool read_options(const rcc_encode_options *options,
+                  rcc_encode_options *read) {
+  if (!options || options->struct_size < kEncodeOptionsV1Size) return false;
+  rcc_encode_options_init(read);
+  std::memcpy(read, options,
+              std::min<size_t>(options->struct_size, sizeof(*read)));
+  read->struct_size = sizeof(*read);
+  EncodeRequest settings;
+  apply_options(*read, true, &settings);
+  return read->timeout >= 0 && rcc::pipeline::valid_settings(settings);
+}
+
+// Fills request for one block, or returns false if its q is invalid.
+bool make_request(const rcc_prior &prior, const double *q_mean,
+                  const double *q_std, uint64_t seed,
+                  const rcc_encode_options &options, bool hybrid,
+                  const rcc::algorithm::Deadline &deadline,
+                  EncodeRequest *request) {
+  const int dim = prior.mean.size();
+  request->q_mean = ConstMap(q_mean, dim);
+  request->q_std = ConstMap(q_std, dim);
+  request->p_mean = prior.mean;
+  request->p_std = prior.std;
+  request->seed = seed;
+  request->deadline = deadline;
+  apply_options(options, hybrid, request);
+  return rcc::pipeline::valid_request(*request);
+}
+
+rcc::algorithm::Deadline deadline_of(const rcc_encode_options &options) {
+  if (options.timeout == 0) return rcc::algorithm::Deadline();
+  return rcc::algorithm::Deadline::after(
+      std::chrono::duration_cast<rcc::algorithm::Deadline::Clock::duration>(
+          std::chrono::duration<double>(options.timeout)));
+}
+
+void copy_out(const Eigen::ArrayXd &values, double *target) {
+  if (target)
+    std::memcpy(target, values.data(), values.size() * sizeof(double));
+}
+
+// Smallest rcc_encode_info accepted: the fields up to fallback.
+constexpr size_t kEncodeInfoV1Size =
+    offsetof(rcc_encode_info, fallback) + sizeof(int32_t);
+
+bool valid_info(const rcc_encode_info *info) {
+  return !info || info->struct_size >= kEncodeInfoV1Size;
+}
+
+// Writes the fields of result that fit in the caller's struct_size bytes;
+// the caller's struct may be smaller or larger than ours.
+void fill_info(const EncodeResult &result, uint32_t struct_size,
+               rcc_encode_info *info) {
+  if (!info) return;
+  rcc_encode_info filled;
+  rcc_encode_info_init(&filled);
+  filled.sample_index = result.sample_index;
+  filled.total_number_samples = result.total_number_samples;
+  filled.t = result.status.t;
+  filled.s = result.status.s;
+  filled.w_min_stop = result.status.w_min_stop;
+  filled.deadline_stop = result.status.deadline_stop;
+  filled.fallback = result.status.fallback;
+  filled.single_shot = result.status.single_shot;
+  filled.elided = result.status.elided;
+  filled.elided_kl = result.status.elided_kl;
+  const size_t begin = offsetof(rcc_encode_info, sample_index);
+  std::memcpy(reinterpret_cast<char *>(info) + begin,
+              reinterpret_cast<const char *>(&filled) + begin,
+              std::min<size_t>(struct_size, sizeof(filled)) - begin);
+}
+
+// Element b of an array of infos of struct_size bytes each.
+rcc_encode_info *info_at(rcc_encode_info *infos, uint32_t struct_size,
+                         size_t b) {
+  return infos ? reinterpret_cast<rcc_encode_info *>(
+                     reinterpret_cast<char *>(infos) + b * struct_size)
+               : nullptr;
+}
+
+rcc_status encode_batch(rcc_workspace *workspace, const rcc_prior *prior,
+                        size_t count, const double *q_mean,
+                        const double *q_std, const uint64_t *seeds,
+                        const rcc_encode_options *options, bool hybrid,
+                        double *samples, double *signals,
+                        double *box_dimensions, rcc_encode_info *infos) {
+  rcc_encode_options read;
+  if (!workspace || !prior || !read_options(options, &read))
+    return RCC_INVALID_ARGUMENT;
+  if (count == 0) return RCC_OK;
+  if (!q_mean || !q_std || !seeds || !samples ||
+      (hybrid && (!signals || !box_dimensions)) || !valid_info(infos))
+    return RCC_INVALID_ARGUMENT;
+  return guarded([&] {
+    const size_t dim = prior->mean.size();
+    const uint32_t info_size = infos ? infos->struct_size : 0;
+    auto deadline = deadline_of(read);
+    auto &requests = workspace->requests;
+    requests.resize(count);
+    for (size_t b = 0; b < count; b++) {
+      if (!make_request(*prior, q_mean + b * dim, q_std + b * dim, seeds[b],
+                        read, hybrid, deadline, &requests[b]))
+        return RCC_INVALID_ARGUMENT;
+    }
+    // Rethrows the first exception of its workers once they have joined.
+    std::vector<EncodeResult> results =
+        rcc::pipeline::encode_batch(requests, workspace->options);
+    for (size_t b = 0; b < count; b++) {
+      copy_out(results[b].sample, samples + b * dim);
+      if (hybrid) {
+        copy_out(results[b].signal, signals + b * dim);
+        copy_out(results[b].box_dimensions, box_dimensions + b * dim);
+      }
+      fill_info(results[b], info_size, info_at(infos, info_size, b));
+    }
+    return RCC_OK;
+  });
+}
+
+bool valid_decode(const rcc_prior &prior, int32_t sample_index,
+                  const double *signal, const double *box_dimensions) {
+  const int dim = prior.mean.size();
+  return sample_index >= 0 && ConstMap(signal, dim).isFinite().all() &&
+         valid_boxes(ConstMap(box_dimensions, dim));
+}
+
+Eigen::ArrayXd decode_block(const rcc_prior &prior, uint64_t seed,
+                            int32_t sample_index, const double *signal,
+                            const double *box_dimensions) {
+  const int dim = prior.mean.size();
+  EncodeResult result;
+  result.seed = seed;
+  result.sample_index = sample_index;
+  result.signal = ConstMap(signal, dim);
+  result.box_dimensions = ConstMap(box_dimensions, dim);
+  return rcc::pipeline::decode(result, prior.mean, prior.std);
+}
+}  // namespace
+
+extern "C" {
+uint32_t rcc_abi_version(void) { return RCC_ABI_VERSION; }
+
+const char *rcc_status_string(rcc_status status) {
+  switch (status) {
+    case RCC_OK:
+      return "ok";
+    case RCC_INVALID_ARGUMENT:
+      return "invalid argument";
+    case RCC_OUT_OF_MEMORY:
+      return "out of memory";
+    case RCC_FAILED:
+      return "failed";
+  }
+  return "unknown status";
+}
+
+void rcc_encode_options_init(rcc_encode_options *options) {
+  if (!options) return;
+  std::memset(options, 0, sizeof(*options));
+  options->struct_size = sizeof(*options);
+  options->pfr = 1;
+  options->eps = 1e-4;
+  options->N_max = 1 << 16;
+  options->single_shot_kl = 1e-6;
+}
+
+void rcc_encode_info_init(rcc_encode_info *info) {
+  if (!info) return;
+  std::memset(info, 0, sizeof(*info));
+  info->struct_size = sizeof(*info);
+}
+
+rcc_status rcc_prior_create(const double *mean, const double *std, size_t dim,
+                            rcc_prior **prior) {
+  if (!mean || !std || !prior || dim == 0 ||
+      dim > static_cast<size_t>(std::numeric_limits<int>::max()))
+    return RCC_INVALID_ARGUMENT;
+  return guarded([&] {
+    auto created = std::make_unique<rcc_prior>();
+    created->mean = ConstMap(mean, dim);
+    created->std = ConstMap(std, dim);
+    if (!created->mean.isFinite().all() || !valid_scale(created->std))
+      return RCC_INVALID_ARGUMENT;
+    *prior = created.release();
+    return RCC_OK;
+  });
+}
+
+void rcc_prior_destroy(rcc_prior *prior) { delete prior; }
+
+size_t rcc_prior_dim(const rcc_prior *prior) {
+  return prior ? prior->mean.size() : 0;
+}
+
+rcc_status rcc_workspace_create(int num_workers, rcc_workspace **workspace) {
+  if (!workspace) return RCC_INVALID_ARGUMENT;
+  return guarded([&] {
+    auto created = std::make_unique<rcc_workspace>();
+    if (num_workers > 0) created->options.num_workers = num_workers;
+    *workspace = created.release();
+    return RCC_OK;
+  });
+}
+
+void rcc_workspace_destroy(rcc_workspace *workspace) { delete workspace; }
+
+rcc_status rcc_sample_gaussian_hybrid(const rcc_prior *prior,
+                                      const double *q_mean,
+                                      const double *q_std, uint64_t seed,
+                                      const rcc_encode_options *options,
+                                      double *sample, double *signal,
+                                      double *box_dimensions,
+                                      rcc_encode_info *info) {
+  rcc_encode_options read;
+  if (!prior || !q_mean || !q_std || !read_options(options, &read) ||
+      !sample || !signal || !box_dimensions || !valid_info(info))
+    return RCC_INVALID_ARGUMENT;
+  return guarded([&] {
+    EncodeRequest request;
+    if (!make_request(*prior, q_mean, q_std, seed, read, true,
+                      deadline_of(read), &request))
+      return RCC_INVALID_ARGUMENT;
+    EncodeResult result = rcc::pipeline::encode(request);
+    copy_out(result.sample, sample);
+    copy_out(result.signal, signal);
+    copy_out(result.box_dimensions, box_dimensions);
+    fill_info(result, info ? info->struct_size : 0, info);
+    return RCC_OK;
+  });
+}
+
+rcc_status rcc_sample_gaussian(const rcc_prior *prior, const double *q_mean,
+                               const double *q_std, uint64_t seed,
+                               const rcc_encode_options *options,
+                               double *sample, rcc_encode_info *info) {
+  rcc_encode_options read;
+  if (!prior || !q_mean || !q_std || !read_options(options, &read) ||
+      !sample || !valid_info(info))
+    return RCC_INVALID_ARGUMENT;
+  return guarded([&] {
+    EncodeRequest request;
+    if (!make_request(*prior, q_mean, q_std, seed, read, false,
+                      deadline_of(read), &request))
+      return RCC_INVALID_ARGUMENT;
+    EncodeResult result = rcc::pipeline::encode(request);
+    copy_out(result.sample, sample);
+    fill_info(result, info ? info->struct_size : 0, info);
+    return RCC_OK;
+  });
+}
+
+rcc_status rcc_decode_hybrid(const rcc_prior *prior, uint64_t seed,
+                             int32_t sample_index, const double *signal,
+                             const double *box_dimensions, double *sample) {
+  if (!prior || !signal || !box_dimensions || !sample ||
+      !valid_decode(*prior, sample_index, signal, box_dimensions))
+    return RCC_INVALID_ARGUMENT;
+  return guarded([&] {
+    copy_out(decode_block(*prior, seed, sample_index, signal, box_dimensions),
+             sample);
+    return RCC_OK;
+  });
+}
+
+rcc_status rcc_sample_gaussian_hybrid_batch(
+    rcc_workspace *workspace, const rcc_prior *prior, size_t count,
+    const double *q_mean, const double *q_std, const uint64_t *seeds,
+    const rcc_encode_options *options, double *samples, double *signals,
+    double *box_dimensions, rcc_encode_info *infos) {
+  return encode_batch(workspace, prior, count, q_mean, q_std, seeds, options,
+                      true, samples, signals, box_dimensions, infos);
+}
+
+rcc_status rcc_sample_gaussian_batch(rcc_workspace *workspace,
+                                     const rcc_prior *prior, size_t count,
+                                     const double *q_mean, const double *q_std,
+                                     const uint64_t *seeds,
+                                     const rcc_encode_options *options,
+                                     double *samples, rcc_encode_info *infos) {
+  return encode_batch(workspace, prior, count, q_mean, q_std, seeds, options,
+                      false, samples, nullptr, nullptr, infos);
+}
+
+rcc_status rcc_decode_hybrid_batch(rcc_workspace *workspace,
+                                   const rcc_prior *prior, size_t count,
+                                   const uint64_t *seeds,
+                                   const int32_t *sample_indices,
+                                   const double *signals,
+                                   const double *box_dimensions,
+                                   double *samples) {
+  if (!workspace || !prior) return RCC_INVALID_ARGUMENT;
+  if (count == 0) return RCC_OK;
+  if (!seeds || !sample_indices || !signals || !box_dimensions || !samples)
+    return RCC_INVALID_ARGUMENT;
+  const size_t dim = prior->mean.size();
+  for (size_t b = 0; b < count; b++) {
+    if (!valid_decode(*prior, sample_indices[b], signals + b * dim,
+                      box_dimensions + b * dim))
+      return RCC_INVALID_ARGUMENT;
+  }
+  return guarded([&] {
+    // Decodes cost the same for every block, so a static split balances.
+    std::vector<Eigen::ArrayXd> decoded(count);
+    size_t num_workers =
+        std::min<size_t>(workspace->options.num_workers, count);
+    std::vector<std::exception_ptr> errors(num_workers);
+    auto work = [&](size_t self) {
+      try {
+        for (size_t b = self; b < count; b += num_workers)
+          decoded[b] =
+              decode_block(*prior, seeds[b], sample_indices[b],
+                           signals + b * dim, box_dimensions + b * dim);
+      } catch (...) {
+        errors[self] = std::current_exception();
+      }
+    };
+    std::vector<std::thread> threads;
+    size_t started = 1;
+    for (; started < num_workers; started++) {
+      try {
+        threads.emplace_back(work, started);
+      } catch (...) {
+        break;
+      }
+    }
+    // The shares of workers that failed to start run here.
+    work(0);
+    for (size_t w = started; w < num_workers; w++) work(w);
+    for (auto &thread : threads) thread.join();
+    for (const auto &error : errors)
+      if (error) std::rethrow_exception(error);
+    for (size_t b = 0; b < count; b++)
+      copy_out(decoded[b], samples + b * dim);
+    return RCC_OK;
+  });
+}
+}  // extern "C"
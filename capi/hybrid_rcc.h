@@ -0,0 +1,174 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_CAPI_HYBRID_RCC_H_
+#define THIRD_PARTY_HYBRID_RCC_CAPI_HYBRID_RCC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Stable C interface of libhybrid_rcc.so for services that embed the
+// samplers without Python or C++ templates.
+//
+// The library never hands memory to the caller: every array is a buffer
+// the caller owns, of the prior's dimension dim per block, and batches lay
+// blocks out one after the other, block b at offset b * dim. The only
+// objects the library allocates are the opaque handles, which the caller
+// releases with the matching destroy function.
+//
+// A prior is immutable once created and can be used by any number of
+// threads at once. A workspace holds the worker count and the buffers of
+// the batch functions, which start that many threads for every call, and
+// must not be used by two calls at the same time.
+//
+// Functions return RCC_OK or an error without touching the outputs, and
+// never throw or abort on bad arguments. Structs may only grow at the end;
+// callers set struct_size so that older libraries can tell which fields
+// they know, and newer libraries default the fields a smaller struct
+// lacks.
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32)
+#define RCC_EXPORT __declspec(dllexport)
+#else
+#define RCC_EXPORT __attribute__((visibility("default")))
+#endif
+
+// Bumped on incompatible changes, together with the soname.
+#define RCC_ABI_VERSION 1
+
+typedef enum rcc_status {
+  RCC_OK = 0,
+  RCC_INVALID_ARGUMENT = 1,
+  RCC_OUT_OF_MEMORY = 2,
+  RCC_FAILED = 3,
+} rcc_status;
+
+typedef struct rcc_prior rcc_prior;
+typedef struct rcc_workspace rcc_workspace;
+
+// Set with rcc_encode_options_init before changing individual fields.
+typedef struct rcc_encode_options {
+  uint32_t struct_size;
+  // 1 for PFR, 0 for SIS.
+  int32_t pfr;
+  // Probability mass of q outside the hybrid coding region.
+  double eps;
+  // Candidate budget, at least 1.
+  uint32_t N_max;
+  // Seconds from the call, 0 for no deadline.
+  double timeout;
+  // When the deadline fires: 0 returns the best candidate, 1 the dithered
+  // quantization of the mean of q.
+  int32_t fallback;
+  // Hybrid only: grid cells of the ratio tables, 0 to score exactly.
+  int32_t table_cells;
+  // Hybrid only: abandon candidates once their partial score can not win.
+  int32_t early_abort;
+  // Hybrid only: sample the dimensions whose KL(q_d || p_d) is below this
+  // many nats from the prior and return them with box dimension 0. 0 keeps
+  // every dimension. Added after ABI version 1; older callers get 0.
+  double elide_kl;
+  // Hybrid only: code blocks within this many nats of a single candidate
+  // with that candidate. Added after ABI version 1; older callers get 1e-6.
+  double single_shot_kl;
+} rcc_encode_options;
+
+// What a decoder needs besides the signal and the box dimensions, and how
+// the sampler stopped. Set with rcc_encode_info_init; the library fills
+// the fields that fit in struct_size and leaves the rest alone. In a batch,
+// every element has the struct_size of the first.
+typedef struct rcc_encode_info {
+  uint32_t struct_size;
+  int32_t sample_index;
+  int32_t total_number_samples;
+  double t, s;
+  int32_t w_min_stop, deadline_stop, fallback;
+  // Coded with a single candidate, see HybridOptions::single_shot_kl.
+  int32_t single_shot;
+  // Dimensions sampled from the prior under elide_kl, and the sum of their
+  // KL divergences in nats.
+  int32_t elided;
+  double elided_kl;
+} rcc_encode_info;
+
+RCC_EXPORT uint32_t rcc_abi_version(void);
+RCC_EXPORT const char *rcc_status_string(rcc_status status);
+RCC_EXPORT void rcc_encode_options_init(rcc_encode_options *options);
+RCC_EXPORT void rcc_encode_info_init(rcc_encode_info *info);
+
+// An independent Gaussian prior of dim dimensions. mean and std are copied.
+RCC_EXPORT rcc_status rcc_prior_create(const double *mean, const double *std,
+                                       size_t dim, rcc_prior **prior);
+RCC_EXPORT void rcc_prior_destroy(rcc_prior *prior);
+RCC_EXPORT size_t rcc_prior_dim(const rcc_prior *prior);
+
+// num_workers <= 0 uses every core.
+RCC_EXPORT rcc_status rcc_workspace_create(int num_workers,
+                                           rcc_workspace **workspace);
+RCC_EXPORT void rcc_workspace_destroy(rcc_workspace *workspace);
+
+// Hybrid coding of one block of q = N(q_mean, q_std) against the prior.
+// sample, signal and box_dimensions receive dim values each; info may be
+// NULL, and is otherwise rejected if its struct_size is smaller than the
+// fields up to fallback.
+RCC_EXPORT rcc_status rcc_sample_gaussian_hybrid(
+    const rcc_prior *prior, const double *q_mean, const double *q_std,
+    uint64_t seed, const rcc_encode_options *options, double *sample,
+    double *signal, double *box_dimensions, rcc_encode_info *info);
+
+// Plain PFR or SIS; the hybrid only options are ignored.
+RCC_EXPORT rcc_status rcc_sample_gaussian(const rcc_prior *prior,
+                                          const double *q_mean,
+                                          const double *q_std, uint64_t seed,
+                                          const rcc_encode_options *options,
+                                          double *sample,
+                                          rcc_encode_info *info);
+
+// Reconstructs the sample of a hybrid encode from its seed, sample index,
+// signal and box dimensions.
+RCC_EXPORT rcc_status rcc_decode_hybrid(const rcc_prior *prior, uint64_t seed,
+                                        int32_t sample_index,
+                                        const double *signal,
+                                        const double *box_dimensions,
+                                        double *sample);
+
+// Batches of count blocks sharing the prior and the options, with one seed
+// per block. Encodes are spread over the workspace's workers longest
+// first; infos may be NULL. The outputs are written only if every block
+// succeeds.
+RCC_EXPORT rcc_status rcc_sample_gaussian_hybrid_batch(
+    rcc_workspace *workspace, const rcc_prior *prior, size_t count,
+    const double *q_mean, const double *q_std, const uint64_t *seeds,
+    const rcc_encode_options *options, double *samples, double *signals,
+    double *box_dimensions, rcc_encode_info *infos);
+RCC_EXPORT rcc_status rcc_sample_gaussian_batch(
+    rcc_workspace *workspace, const rcc_prior *prior, size_t count,
+    const double *q_mean, const double *q_std, const uint64_t *seeds,
+    const rcc_encode_options *options, double *samples,
+    rcc_encode_info *infos);
+RCC_EXPORT rcc_status rcc_decode_hybrid_batch(
+    rcc_workspace *workspace, const rcc_prior *prior, size_t count,
+    const uint64_t *seeds, const int32_t *sample_indices,
+    const double *signals, const double *box_dimensions, double *samples);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // THIRD_PARTY_HYBRID_RCC_CAPI_HYBRID_RCC_H_
@@ -0,0 +1,401 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "daemon/encode_server.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <future>
+#include <iostream>
+#include <utility>
+
+#include "pipeline/local_socket.h"
+
+namespace rcc::daemon {
+namespace {
+using pipeline::DaemonOp;
+using pipeline::DaemonRequest;
+using pipeline::DaemonResponse;
+using pipeline::DaemonStatus;
+using pipeline::MappedFile;
+using pipeline::update_max;
+using pipeline::valid_boxes;
+using pipeline::valid_scale;
+
+// The i-th array of the request in the region; EncodeServer::fits() has
+// checked that it is there.
+double *array(const DaemonRequest &request, int i, MappedFile &region) {
+  return reinterpret_cast<double *>(region.mutable_data() + request.offset) +
+         static_cast<size_t>(i) * request.dim;
+}
+
+Eigen::ArrayXd get(const DaemonRequest &request, int i, MappedFile &region) {
+  return Eigen::Map<const Eigen::ArrayXd>(array(request, i, region),
+                                          request.dim);
+}
+
+void put(const DaemonRequest &request, int i, MappedFile &region,
+         const Eigen::ArrayXd &values) {
+  std::memcpy(array(request, i, region), values.data(),
+              values.size() * sizeof(double));
+}
+
+DaemonResponse reply(const DaemonRequest &request, DaemonStatus status) {
+  DaemonResponse response;
+  response.id = request.id;
+  response.status = status;
+  return response;
+}
+}  // namespace
+
+void EncodeServer::LatencyCounter::record(Clock::duration latency) {
+  uint64_t ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count();
+  count_.fetch_add(1, std::memory_order_relaxed);
+  total_ns_.fetch_add(ns, std::memory_order_relaxed);
+  update_max(max_ns_, ns);
+  uint64_t us = ns / 1000;
+  int bucket = 0;
+  while (us && bucket < pipeline::DaemonLatency::kBuckets - 1) {
+    us >>= 1;
+    bucket++;
+  }
+  histogram_[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+pipeline::DaemonLatency EncodeServer::LatencyCounter::snapshot() const {
+  pipeline::DaemonLatency latency;
+  latency.count = count_.load(std::memory_order_relaxed);
+  latency.mean = latency.count ? total_ns_.load(std::memory_order_relaxed) *
+                                     1e-6 / latency.count
+                               : 0;
+  latency.max = max_ns_.load(std::memory_order_relaxed) * 1e-6;
+  for (int b = 0; b < pipeline::DaemonLatency::kBuckets; b++)
+    latency.histogram[b] = histogram_[b].load(std::memory_order_relaxed);
+  return latency;
+}
+
+EncodeServer::EncodeServer(const ServerOptions &options)
+    : options_(options), pipeline_([&] {
+        pipeline::PipelineOptions pipeline = options.pipeline;
+        pipeline.order = pipeline::ResultOrder::kCompletion;
+        return pipeline;
+      }()) {}
+
+bool EncodeServer::start() {
+  listen_fd_ = pipeline::listen_local(options_.socket_path);
+  if (listen_fd_ < 0) return false;
+  acceptor_ = std::thread(&EncodeServer::accept_connections, this);
+  return true;
+}
+
+void EncodeServer::stop() {
+  if (stopping_.exchange(true)) return;
+  if (listen_fd_ >= 0) {
+    // Wakes the acceptor up from accept().
+    shutdown(listen_fd_, SHUT_RDWR);
+    if (acceptor_.joinable()) acceptor_.join();
+    ::close(listen_fd_);
+    unlink(options_.socket_path.c_str());
+    listen_fd_ = -1;
+  }
+  std::list<std::unique_ptr<Connection>> connections;
+  {
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    connections.swap(connections_);
+  }
+  // Connections waiting for a request see end of file; those in the middle
+  // of one finish it first.
+  for (auto &connection : connections) shutdown(connection->fd, SHUT_RDWR);
+  for (auto &connection : connections) {
+    connection->thread.join();
+    ::close(connection->fd);
+  }
+  pipeline_.close();
+}
+
+void EncodeServer::accept_connections() {
+  while (!stopping_) {
+    int fd = accept(listen_fd_, nullptr, nullptr);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) continue;
+      if (!stopping_)
+        std::cerr << "accept failed: " << std::strerror(errno) << std::endl;
+      break;
+    }
+    reap();
+    connections_accepted_.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    auto connection = std::make_unique<Connection>();
+    connection->fd = fd;
+    connection->thread =
+        std::thread(&EncodeServer::serve, this, connection.get());
+    connections_.push_back(std::move(connection));
+  }
+}
+
+void EncodeServer::reap() {
+  std::list<std::unique_ptr<Connection>> done;
+  {
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    for (auto it = connections_.begin(); it != connections_.end();) {
+      auto next = std::next(it);
+      if ((*it)->done) done.splice(done.end(), connections_, it);
+      it = next;
+    }
+  }
+  for (auto &connection : done) {
+    connection->thread.join();
+    ::close(connection->fd);
+  }
+}
+
+void EncodeServer::serve(Connection *connection) {
+  int fd = connection->fd;
+  DaemonRequest request;
+  int region_fd = -1;
+  if (!pipeline::receive_with_fd(fd, &request, sizeof(request), &region_fd)) {
+    if (region_fd >= 0) ::close(region_fd);
+    connection->done = true;
+    return;
+  }
+  DaemonStatus status = DaemonStatus::kBadRequest;
+  if (request.magic == pipeline::kDaemonMagic &&
+      request.version == pipeline::kDaemonVersion &&
+      request.op == DaemonOp::kAttach && region_fd >= 0 &&
+      request.offset > 0) {
+    // The region takes the descriptor over, even when mapping it fails.
+    if (connection->region.adopt_shared(region_fd, request.offset))
+      status = DaemonStatus::kOk;
+  } else if (region_fd >= 0) {
+    ::close(region_fd);
+  }
+  DaemonResponse response = reply(request, status);
+  if (!pipeline::send_all(fd, &response, sizeof(response)) ||
+      status != DaemonStatus::kOk) {
+    connection->done = true;
+    return;
+  }
+
+  MappedFile &region = connection->region;
+  while (pipeline::receive_all(fd, &request, sizeof(request))) {
+    Clock::time_point received = Clock::now();
+    // A request out of step with the protocol leaves nothing to resync on.
+    if (request.magic != pipeline::kDaemonMagic ||
+        request.version != pipeline::kDaemonVersion)
+      break;
+    switch (request.op) {
+      case DaemonOp::kRegisterPrior:
+        response = register_prior(request, region);
+        break;
+      case DaemonOp::kEncode:
+        response = encode(request, region, received);
+        break;
+      case DaemonOp::kDecode:
+        response = decode(request, region);
+        break;
+      case DaemonOp::kMetrics: {
+        pipeline::DaemonMetrics current = metrics();
+        if (request.offset <= region.size() &&
+            region.size() - request.offset >= sizeof(current)) {
+          std::memcpy(region.mutable_data() + request.offset, &current,
+                      sizeof(current));
+          response = reply(request, DaemonStatus::kOk);
+        } else {
+          response = reply(request, DaemonStatus::kBadRequest);
+        }
+        break;
+      }
+      default:
+        response = reply(request, DaemonStatus::kBadRequest);
+    }
+    Clock::duration latency = Clock::now() - received;
+    response.latency =
+        std::chrono::duration<double, std::milli>(latency).count();
+    if (response.status == DaemonStatus::kOk) {
+      if (request.op == DaemonOp::kEncode) encode_latency_.record(latency);
+      if (request.op == DaemonOp::kDecode) decode_latency_.record(latency);
+    }
+    if (!pipeline::send_all(fd, &response, sizeof(response))) break;
+  }
+  region.close();
+  connection->done = true;
+}
+
+bool EncodeServer::fits(const DaemonRequest &request, int arrays,
+                        const MappedFile &region) const {
+  if (request.dim == 0 || request.dim > options_.max_dim ||
+      request.offset % alignof(double) != 0 || request.offset > region.size())
+    return false;
+  return (region.size() - request.offset) / sizeof(double) /
+             request.dim >=
+         static_cast<size_t>(arrays);
+}
+
+std::shared_ptr<const EncodeServer::Prior> EncodeServer::prior(
+    uint64_t id) const {
+  std::lock_guard<std::mutex> lock(priors_mutex_);
+  if (id == 0 || id > priors_.size()) return nullptr;
+  return priors_[id - 1];
+}
+
+DaemonResponse EncodeServer::register_prior(const DaemonRequest &request,
+                                            MappedFile &region) {
+  if (!fits(request, 2, region))
+    return reply(request, DaemonStatus::kBadRequest);
+  auto registered = std::make_shared<Prior>();
+  registered->mean = get(request, 0, region);
+  registered->std = get(request, 1, region);
+  if (!valid_scale(registered->std) || !registered->mean.isFinite().all())
+    return reply(request, DaemonStatus::kBadRequest);
+
+  std::lock_guard<std::mutex> lock(priors_mutex_);
+  auto it = prior_ids_.find(request.prior);
+  if (it == prior_ids_.end()) {
+    priors_.push_back(std::move(registered));
+    it = prior_ids_.emplace(request.prior, priors_.size()).first;
+  } else {
+    // A key names one prior; reusing it for another would silently run
+    // later requests against the first.
+    const Prior &existing = *priors_[it->second - 1];
+    if (existing.mean.size() != request.dim ||
+        (existing.mean != registered->mean).any() ||
+        (existing.std != registered->std).any())
+      return reply(request, DaemonStatus::kBadRequest);
+  }
+  DaemonResponse response = reply(request, DaemonStatus::kOk);
+  response.prior = it->second;
+  return response;
+}
+
+DaemonResponse EncodeServer::encode(const DaemonRequest &request,
+                                    MappedFile &region,
+                                    Clock::time_point received) {
+  // The samplers need at least one candidate to return.
+  if (!fits(request, request.prior ? 3 : 4, region) || !(request.timeout >= 0))
+    return reply(request, DaemonStatus::kBadRequest);
+  pipeline::EncodeRequest job;
+  job.q_mean = get(request, 0, region);
+  job.q_std = get(request, 1, region);
+  if (request.prior) {
+    auto registered = prior(request.prior);
+    if (!registered) return reply(request, DaemonStatus::kUnknownPrior);
+    if (registered->mean.size() != request.dim)
+      return reply(request, DaemonStatus::kBadRequest);
+    job.p_mean = registered->mean;
+    job.p_std = registered->std;
+  } else {
+    job.p_mean = get(request, 2, region);
+    job.p_std = get(request, 3, region);
+  }
+  job.hybrid = request.hybrid;
+  job.pfr = request.pfr;
+  job.eps = request.eps;
+  job.seed = request.seed;
+  job.N_max = request.N_max;
+  job.hybrid_options.table_cells = request.table_cells;
+  job.hybrid_options.early_abort = request.early_abort;
+  job.hybrid_options.single_shot_kl = request.single_shot_kl;
+  job.hybrid_options.elide_kl = request.elide_kl;
+  job.fallback = request.fallback ? algorithm::Fallback::kDitheredQuantization
+                                  : algorithm::Fallback::kBestCandidate;
+  if (!pipeline::valid_request(job))
+    return reply(request, DaemonStatus::kBadRequest);
+  if (request.timeout > 0) {
+    job.deadline = algorithm::Deadline(
+        received + std::chrono::duration_cast<Clock::duration>(
+                       std::chrono::duration<double>(request.timeout)));
+  }
+
+  // Admission control: a full queue means the workers are saturated, and
+  // queueing further would only add latency the client can not see.
+  std::future<pipeline::EncodeResult> future;
+  if (!pipeline_.try_submit(job, &future)) {
+    busy_.fetch_add(1, std::memory_order_relaxed);
+    return reply(request, DaemonStatus::kBusy);
+  }
+  pipeline::EncodeResult result;
+  try {
+    result = future.get();
+  } catch (const std::exception &e) {
+    std::cerr << "encode failed: " << e.what() << std::endl;
+    failed_.fetch_add(1, std::memory_order_relaxed);
+    return reply(request, DaemonStatus::kFailed);
+  }
+  put(request, 0, region, result.sample);
+  if (request.hybrid) {
+    put(request, 1, region, result.signal);
+    put(request, 2, region, result.box_dimensions);
+  }
+  DaemonResponse response = reply(request, DaemonStatus::kOk);
+  response.sample_index = result.sample_index;
+  response.total_number_samples = result.total_number_samples;
+  response.t = result.status.t;
+  response.s = result.status.s;
+  response.w_min_stop = result.status.w_min_stop;
+  response.deadline_stop = result.status.deadline_stop;
+  response.fallback = result.status.fallback;
+  response.single_shot = result.status.single_shot;
+  response.elided = result.status.elided;
+  response.elided_kl = result.status.elided_kl;
+  return response;
+}
+
+DaemonResponse EncodeServer::decode(const DaemonRequest &request,
+                                    MappedFile &region) {
+  if (!fits(request, request.prior ? 2 : 4, region))
+    return reply(request, DaemonStatus::kBadRequest);
+  pipeline::EncodeResult result;
+  result.seed = request.seed;
+  result.sample_index = request.sample_index;
+  result.signal = get(request, 0, region);
+  result.box_dimensions = get(request, 1, region);
+  if (!valid_boxes(result.box_dimensions) || request.sample_index < 0)
+    return reply(request, DaemonStatus::kBadRequest);
+  Eigen::ArrayXd sample;
+  if (request.prior) {
+    auto registered = prior(request.prior);
+    if (!registered) return reply(request, DaemonStatus::kUnknownPrior);
+    if (registered->mean.size() != request.dim)
+      return reply(request, DaemonStatus::kBadRequest);
+    sample = pipeline::decode(result, registered->mean, registered->std);
+  } else {
+    Eigen::ArrayXd p_std = get(request, 3, region);
+    if (!valid_scale(p_std)) return reply(request, DaemonStatus::kBadRequest);
+    sample = pipeline::decode(result, get(request, 2, region), p_std);
+  }
+  put(request, 0, region, sample);
+  return reply(request, DaemonStatus::kOk);
+}
+
+pipeline::DaemonMetrics EncodeServer::metrics() const {
+  pipeline::DaemonMetrics metrics;
+  metrics.connections = connections_accepted_.load(std::memory_order_relaxed);
+  {
+    std::lock_guard<std::mutex> lock(priors_mutex_);
+    metrics.priors = priors_.size();
+  }
+  metrics.busy = busy_.load(std::memory_order_relaxed);
+  metrics.failed = failed_.load(std::memory_order_relaxed);
+  metrics.encode = encode_latency_.snapshot();
+  metrics.decode = decode_latency_.snapshot();
+  metrics.pipeline = pipeline_.metrics();
+  return metrics;
+}
+}  // namespace rcc::daemon
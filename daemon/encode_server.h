@@ -0,0 +1,128 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_DAEMON_ENCODE_SERVER_H_
+#define THIRD_PARTY_HYBRID_RCC_DAEMON_ENCODE_SERVER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Eigen/Core"
+#include "pipeline/daemon_protocol.h"
+#include "pipeline/encoder_pipeline.h"
+#include "pipeline/mapped_file.h"
+
+// Server side of the local encoding daemon, see pipeline/daemon_protocol.h.
+//
+// An acceptor thread hands every connection to a thread of its own, which
+// maps the client's shared region and serves its requests in order. Encode
+// requests go through one EncoderPipeline whose workers stay up for the
+// lifetime of the server; a full input queue answers kBusy rather than
+// queueing without bound. Decodes are cheap and run on the connection
+// thread. Registered priors are kept for the lifetime of the server and
+// shared by every connection.
+namespace rcc::daemon {
+struct ServerOptions {
+  std::string socket_path;
+  // Workers and admission queue of the encoder. Every connection waits for
+  // its own result, so order is ignored.
+  pipeline::PipelineOptions pipeline;
+  // Largest dimension of a request.
+  uint32_t max_dim = 1 << 24;
+};
+
+class EncodeServer {
+ public:
+  explicit EncodeServer(const ServerOptions &options);
+  EncodeServer(const EncodeServer &) = delete;
+  EncodeServer &operator=(const EncodeServer &) = delete;
+  ~EncodeServer() { stop(); }
+
+  // Listens on the socket and starts accepting connections.
+  bool start();
+  // Closes the socket and every connection, then waits for the requests in
+  // flight. Called by the destructor.
+  void stop();
+
+  pipeline::DaemonMetrics metrics() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Prior {
+    Eigen::ArrayXd mean, std;
+  };
+  struct Connection {
+    int fd = -1;
+    pipeline::MappedFile region;
+    std::thread thread;
+    std::atomic<bool> done{false};
+  };
+  class LatencyCounter {
+   public:
+    void record(Clock::duration latency);
+    pipeline::DaemonLatency snapshot() const;
+
+   private:
+    std::atomic<uint64_t> count_{0}, total_ns_{0}, max_ns_{0};
+    std::atomic<uint64_t> histogram_[pipeline::DaemonLatency::kBuckets] = {};
+  };
+
+  void accept_connections();
+  void serve(Connection *connection);
+  // Reaps the threads of closed connections.
+  void reap();
+  // Checks that request's arrays fit into region.
+  bool fits(const pipeline::DaemonRequest &request, int arrays,
+            const pipeline::MappedFile &region) const;
+  std::shared_ptr<const Prior> prior(uint64_t id) const;
+
+  pipeline::DaemonResponse register_prior(
+      const pipeline::DaemonRequest &request, pipeline::MappedFile &region);
+  pipeline::DaemonResponse encode(const pipeline::DaemonRequest &request,
+                                  pipeline::MappedFile &region,
+                                  Clock::time_point received);
+  pipeline::DaemonResponse decode(const pipeline::DaemonRequest &request,
+                                  pipeline::MappedFile &region);
+
+  ServerOptions options_;
+  pipeline::EncoderPipeline pipeline_;
+  int listen_fd_ = -1;
+  std::thread acceptor_;
+  std::atomic<bool> stopping_{false};
+
+  std::mutex connections_mutex_;
+  std::list<std::unique_ptr<Connection>> connections_;
+
+  // priors_[id - 1] is the prior registered as id.
+  mutable std::mutex priors_mutex_;
+  std::unordered_map<uint64_t, uint64_t> prior_ids_;
+  std::vector<std::shared_ptr<const Prior>> priors_;
+
+  LatencyCounter encode_latency_, decode_latency_;
+  std::atomic<uint64_t> connections_accepted_{0}, busy_{0}, failed_{0};
+};
+}  // namespace rcc::daemon
+
+#endif  // THIRD_PARTY_HYBRID_RCC_DAEMON_ENCODE_SERVER_H_
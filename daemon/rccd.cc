@@ -0,0 +1,131 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Local encoding daemon.
+//
+//   rccd --socket=/tmp/rccd.sock --workers=8 --queue_capacity=64
+//        --metrics_interval=10 --max_dim=65536
+//
+// Serves pipeline::DaemonClient until SIGINT or SIGTERM. queue_capacity is
+// the number of encodes admitted beyond the ones running; more are refused
+// with kBusy. Every metrics_interval seconds, and on exit, the latency
+// metrics are printed to stdout as one line of key=value pairs.
+
+#include <signal.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "daemon/encode_server.h"
+
+namespace {
+bool parse_flag(const std::string &arg, const std::string &name,
+                std::string *value) {
+  std::string prefix = "--" + name + "=";
+  if (arg.compare(0, prefix.size(), prefix) != 0) return false;
+  *value = arg.substr(prefix.size());
+  return true;
+}
+
+void print_latency(const char *name, const rcc::pipeline::DaemonLatency &l) {
+  std::cout << ' ' << name << "_count=" << l.count << ' ' << name
+            << "_mean_ms=" << l.mean << ' ' << name << "_max_ms=" << l.max;
+  // Median and tail from the log2 microsecond histogram, as bucket bounds.
+  for (double quantile : {0.5, 0.99}) {
+    uint64_t seen = 0;
+    int b = 0;
+    while (b < rcc::pipeline::DaemonLatency::kBuckets - 1 &&
+           (seen += l.histogram[b]) < quantile * l.count)
+      b++;
+    std::cout << ' ' << name << "_p" << static_cast<int>(quantile * 100)
+              << "_us<" << (uint64_t(1) << b);
+  }
+}
+
+void print_metrics(const rcc::pipeline::DaemonMetrics &m) {
+  std::cout << "connections=" << m.connections << " priors=" << m.priors
+            << " busy=" << m.busy << " failed=" << m.failed;
+  print_latency("encode", m.encode);
+  print_latency("decode", m.decode);
+  std::cout << " queue_mean_ms=" << m.pipeline.queue.mean_latency
+            << " queue_max_depth=" << m.pipeline.queue.max_depth
+            << " sampler_mean_ms=" << m.pipeline.encode.mean_latency
+            << std::endl;
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+  rcc::daemon::ServerOptions options;
+  options.socket_path = "/tmp/rccd.sock";
+  options.pipeline.queue_capacity = 64;
+  double metrics_interval = 0;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i], value;
+    if (parse_flag(arg, "socket", &value)) {
+      options.socket_path = value;
+    } else if (parse_flag(arg, "workers", &value)) {
+      options.pipeline.num_workers = std::atoi(value.c_str());
+    } else if (parse_flag(arg, "queue_capacity", &value)) {
+      options.pipeline.queue_capacity = std::atol(value.c_str());
+    } else if (parse_flag(arg, "max_dim", &value)) {
+      options.max_dim = std::atol(value.c_str());
+    } else if (parse_flag(arg, "metrics_interval", &value)) {
+      metrics_interval = std::atof(value.c_str());
+    } else {
+      std::cerr << "unknown flag " << arg << std::endl;
+      return 2;
+    }
+  }
+  if (options.pipeline.num_workers < 1 || options.pipeline.queue_capacity < 1) {
+    std::cerr << "--workers and --queue_capacity must be positive" << std::endl;
+    return 2;
+  }
+
+  // Blocked before any thread starts so that only sigtimedwait sees them.
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+  rcc::daemon::EncodeServer server(options);
+  if (!server.start()) return 1;
+  std::cerr << "listening on " << options.socket_path << std::endl;
+
+  std::cout << std::setprecision(4);
+  while (true) {
+    int signal;
+    if (metrics_interval > 0) {
+      timespec timeout;
+      timeout.tv_sec = static_cast<time_t>(metrics_interval);
+      timeout.tv_nsec =
+          static_cast<long>((metrics_interval - timeout.tv_sec) * 1e9);
+      signal = sigtimedwait(&signals, nullptr, &timeout);
+      if (signal < 0 && errno == EAGAIN) {
+        print_metrics(server.metrics());
+        continue;
+      }
+    } else {
+      signal = sigwaitinfo(&signals, nullptr);
+    }
+    if (signal == SIGINT || signal == SIGTERM) break;
+  }
+  server.stop();
+  print_metrics(server.metrics());
+  return 0;
+}
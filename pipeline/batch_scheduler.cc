@@ -0,0 +1,199 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pipeline/batch_scheduler.h"
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <numeric>
+
+#include "algorithm/bounds.h"
+#include "pipeline/mpmc_queue.h"
+#include "stats/distributions/multivariate/continuous/gaussian.h"
+
+namespace rcc::pipeline {
+namespace {
+using Clock = std::chrono::steady_clock;
+
+struct WorkerDeque {
+  std::mutex mutex;
+  std::deque<size_t> items;
+  // Written under mutex, read without it to pick a victim.
+  std::atomic<size_t> size{0};
+  std::atomic<double> remaining{0};
+
+  void push_back(size_t item, double seconds) {
+    items.push_back(item);
+    size.store(items.size(), std::memory_order_relaxed);
+    remaining.store(remaining.load(std::memory_order_relaxed) + seconds,
+                    std::memory_order_relaxed);
+  }
+  bool pop_front(size_t *item, const std::vector<double> &seconds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (items.empty()) return false;
+    *item = items.front();
+    items.pop_front();
+    size.store(items.size(), std::memory_order_relaxed);
+    remaining.store(items.empty() ? 0
+                                  : remaining.load(std::memory_order_relaxed) -
+                                        seconds[*item],
+                    std::memory_order_relaxed);
+    return true;
+  }
+};
+}  // namespace
+
+double SchedulerStats::utilization() const {
+  if (workers.empty() || wall_seconds <= 0) return 0;
+  double busy = 0;
+  for (const auto &worker : workers) busy += worker.busy_seconds;
+  return busy / (workers.size() * wall_seconds);
+}
+
+uint64_t SchedulerStats::steals() const {
+  uint64_t steals = 0;
+  for (const auto &worker : workers) steals += worker.stolen;
+  return steals;
+}
+
+double SchedulerStats::imbalance() const {
+  double busy = 0, longest = 0;
+  for (const auto &worker : workers) {
+    busy += worker.busy_seconds;
+    longest = std::max(longest, worker.busy_seconds);
+  }
+  return busy > 0 ? longest * workers.size() / busy : 1;
+}
+
+double predict_encode_seconds(const EncodeRequest &request,
+                              const algorithm::TimingModel &timing) {
+  const int dim = request.q_mean.size();
+  if (request.hybrid) {
+    return algorithm::predict_gaussian_hybrid(
+               request.q_mean, request.q_std, request.p_mean, request.p_std,
+               request.eps, request.N_max, timing)
+        .seconds[0];
+  }
+  stats::multivariates::IndependentGaussian q(request.q_mean, request.q_std);
+  stats::multivariates::IndependentGaussian p(request.p_mean, request.p_std);
+  double log_candidates = -internal::minimum_log_weight(q, p).sum();
+  double candidates = std::min<double>(
+      request.N_max, std::exp(std::max(0.0, log_candidates)));
+  return timing.predict(Eigen::ArrayXd::Constant(1, candidates), dim)[0];
+}
+
+std::vector<EncodeResult> encode_batch(
+    const std::vector<EncodeRequest> &requests,
+    const SchedulerOptions &options, SchedulerStats *stats) {
+  assert(options.num_workers > 0);
+  const size_t num_workers = options.num_workers;
+  std::vector<double> seconds(requests.size());
+  for (size_t i = 0; i < requests.size(); i++)
+    seconds[i] = predict_encode_seconds(requests[i], options.timing);
+  std::vector<size_t> order(requests.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return seconds[a] > seconds[b];
+  });
+
+  std::vector<std::unique_ptr<WorkerDeque>> deques(num_workers);
+  for (auto &deque : deques) deque = std::make_unique<WorkerDeque>();
+  for (size_t j = 0; j < order.size(); j++)
+    deques[j % num_workers]->push_back(order[j], seconds[order[j]]);
+  std::atomic<size_t> queued{requests.size()};
+  auto start = Clock::now();
+
+  std::vector<EncodeResult> results(requests.size());
+  std::vector<WorkerStats> worker_stats(num_workers);
+  // The first exception of each worker, rethrown after all have joined.
+  std::vector<std::exception_ptr> errors(num_workers);
+  std::atomic<bool> failed{false};
+  auto run = [&](size_t self) {
+    WorkerStats &stat = worker_stats[self];
+    Backoff backoff;
+    size_t item;
+    while (queued.load(std::memory_order_acquire) > 0 &&
+           !failed.load(std::memory_order_relaxed)) {
+      bool stolen = false;
+      if (!deques[self]->pop_front(&item, seconds)) {
+        // Steal from the deque with the most predicted work left.
+        size_t victim = self;
+        double most = -1;
+        for (size_t w = 0; w < num_workers; w++) {
+          if (w == self || deques[w]->size.load(std::memory_order_relaxed) == 0)
+            continue;
+          double remaining =
+              deques[w]->remaining.load(std::memory_order_relaxed);
+          if (remaining > most) {
+            most = remaining;
+            victim = w;
+          }
+        }
+        // Everything left is running on other workers.
+        if (victim == self) break;
+        if (!deques[victim]->pop_front(&item, seconds)) {
+          stat.failed_steals++;
+          backoff.wait();
+          continue;
+        }
+        stolen = true;
+      }
+      backoff.reset();
+      queued.fetch_sub(1, std::memory_order_acq_rel);
+      auto begin = Clock::now();
+      results[item] = encode(requests[item]);
+      stat.busy_seconds +=
+          std::chrono::duration<double>(Clock::now() - begin).count();
+      stat.predicted_seconds += seconds[item];
+      stat.executed++;
+      stat.stolen += stolen;
+    }
+  };
+  auto work = [&](size_t self) {
+    try {
+      run(self);
+    } catch (...) {
+      errors[self] = std::current_exception();
+      failed.store(true, std::memory_order_relaxed);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t w = 1; w < num_workers; w++) {
+    // Workers that fail to start leave their deques to be stolen from.
+    try {
+      threads.emplace_back(work, w);
+    } catch (...) {
+      break;
+    }
+  }
+  work(0);
+  for (auto &thread : threads) thread.join();
+  for (const auto &error : errors)
+    if (error) std::rethrow_exception(error);
+
+  if (stats) {
+    stats->workers = std::move(worker_stats);
+    stats->wall_seconds =
+        std::chrono::duration<double>(Clock::now() - start).count();
+  }
+  return results;
+}
+}  // namespace rcc::pipeline
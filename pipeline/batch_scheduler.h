@@ -0,0 +1,80 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_PIPELINE_BATCH_SCHEDULER_H_
+#define THIRD_PARTY_HYBRID_RCC_PIPELINE_BATCH_SCHEDULER_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "algorithm/tuner.h"
+#include "pipeline/encoder.h"
+
+// Work-stealing encoder for a batch of requests known up front.
+//
+// The number of candidates of a block grows like exp(KL), so encode times
+// within one batch span orders of magnitude and a static split leaves most
+// workers idle behind the few that drew the expensive blocks. encode_batch
+// predicts the cost of every request, sorts the batch longest first and
+// deals it round robin into per-worker deques, so every deque is itself
+// sorted longest first. Workers take from the front of their own deque and,
+// once it is empty, steal single blocks from the front of the deque with
+// the most predicted work left. Both ends being the expensive one keeps the
+// execution order close to longest processing time first, which is what
+// bounds the makespan; a deque operation is a short critical section next
+// to an encode, so the shared end does not contend in practice.
+namespace rcc::pipeline {
+struct SchedulerOptions {
+  int num_workers = std::max(1u, std::thread::hardware_concurrency());
+  algorithm::TimingModel timing;
+};
+
+// Times are in seconds.
+struct WorkerStats {
+  uint64_t executed = 0, stolen = 0, failed_steals = 0;
+  double busy_seconds = 0, predicted_seconds = 0;
+};
+
+struct SchedulerStats {
+  std::vector<WorkerStats> workers;
+  // From the first to the last worker running, prediction excluded.
+  double wall_seconds = 0;
+
+  // Fraction of worker time spent in encode().
+  double utilization() const;
+  uint64_t steals() const;
+  // Longest busy time over the mean busy time, 1 when perfectly balanced.
+  double imbalance() const;
+};
+
+// Predicted encode() time of request: the expected number of candidates,
+// from the w_min stopping rule and capped at N_max, through timing.
+double predict_encode_seconds(const EncodeRequest &request,
+                              const algorithm::TimingModel &timing =
+                                  algorithm::TimingModel());
+
+// Encodes all requests and returns their results in the order of requests.
+// If an encode throws, the workers stop taking requests and the exception
+// is rethrown once they have all returned.
+std::vector<EncodeResult> encode_batch(
+    const std::vector<EncodeRequest> &requests,
+    const SchedulerOptions &options = SchedulerOptions(),
+    SchedulerStats *stats = nullptr);
+}  // namespace rcc::pipeline
+
+#endif  // THIRD_PARTY_HYBRID_RCC_PIPELINE_BATCH_SCHEDULER_H_
@@ -0,0 +1,310 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pipeline/block_container.h"
+
+#include <array>
+#include <cassert>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace rcc::pipeline {
+namespace {
+constexpr char kMagic[4] = {'R', 'C', 'C', 'B'};
+// Magic, version, num_parameters, block_size, chunk_blocks, seed, eps,
+// prior kind, prior mean, prior std, length of the prior source.
+constexpr size_t kHeaderSize = 4 + 4 + 8 + 4 + 4 + 8 + 8 + 4 + 8 + 8 + 4;
+// Offset of the index, magic.
+constexpr size_t kFooterSize = 8 + 4;
+// Offset, size and checksum of a chunk.
+constexpr size_t kChunkEntrySize = 8 + 4 + 4;
+
+template <typename T>
+void put(std::vector<uint8_t> &buffer, T value) {
+  uint8_t bytes[sizeof(T)];
+  std::memcpy(bytes, &value, sizeof(T));
+  buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+T get(const char *data) {
+  T value;
+  std::memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+void put_varint(std::vector<uint8_t> &buffer, uint64_t value) {
+  while (value >= 0x80) {
+    buffer.push_back(static_cast<uint8_t>(value) | 0x80);
+    value >>= 7;
+  }
+  buffer.push_back(static_cast<uint8_t>(value));
+}
+
+bool get_varint(const char *&data, const char *end, uint64_t *value) {
+  *value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (data >= end) return false;
+    uint8_t byte = *data++;
+    *value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) return true;
+  }
+  return false;
+}
+
+// CRC-32 with the reflected IEEE polynomial, as used by zlib.
+uint32_t crc32(const void *data, size_t size) {
+  static const std::array<uint32_t, 256> table = [] {
+    std::array<uint32_t, 256> table;
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; k++) c = c & 1 ? 0xedb88320 ^ (c >> 1) : c >> 1;
+      table[i] = c;
+    }
+    return table;
+  }();
+  const uint8_t *bytes = static_cast<const uint8_t *>(data);
+  uint32_t crc = 0xffffffff;
+  for (size_t i = 0; i < size; i++)
+    crc = table[(crc ^ bytes[i]) & 0xff] ^ (crc >> 8);
+  return ~crc;
+}
+}  // namespace
+
+bool ContainerWriter::open(const std::string &path,
+                           const ContainerHeader &header) {
+  assert(header.block_size > 0 && header.chunk_blocks > 0);
+  close();
+  file_ = std::fopen(path.c_str(), "wb");
+  if (!file_) {
+    std::cerr << "cannot create " << path << ": " << std::strerror(errno)
+              << std::endl;
+    return false;
+  }
+  header_ = header;
+  ok_ = true;
+  next_block_ = 0;
+  chunk_.clear();
+  chunk_index_.clear();
+  block_offsets_.clear();
+  block_offsets_.reserve(header.num_blocks());
+
+  std::vector<uint8_t> buffer(kMagic, kMagic + 4);
+  put<uint32_t>(buffer, ContainerHeader::kVersion);
+  put<uint64_t>(buffer, header.num_parameters);
+  put<uint32_t>(buffer, header.block_size);
+  put<uint32_t>(buffer, header.chunk_blocks);
+  put<uint64_t>(buffer, header.seed);
+  put<double>(buffer, header.eps);
+  put<uint32_t>(buffer, static_cast<uint32_t>(header.prior.kind));
+  put<double>(buffer, header.prior.mean);
+  put<double>(buffer, header.prior.std);
+  put<uint32_t>(buffer, header.prior.source.size());
+  buffer.insert(buffer.end(), header.prior.source.begin(),
+                header.prior.source.end());
+  if (std::fwrite(buffer.data(), 1, buffer.size(), file_) != buffer.size())
+    ok_ = false;
+  bytes_written_ = buffer.size();
+  return ok_;
+}
+
+bool ContainerWriter::write_block(const EncodeResult &result) {
+  assert(file_);
+  if (next_block_ >= header_.num_blocks() ||
+      result.seed != header_.seed + next_block_ ||
+      result.signal.size() != header_.block_dim(next_block_) ||
+      result.box_dimensions.size() != result.signal.size()) {
+    std::cerr << "block " << next_block_
+              << " does not match the container layout" << std::endl;
+    ok_ = false;
+    return false;
+  }
+  block_offsets_.push_back(chunk_.size());
+  put_varint(chunk_, result.sample_index);
+  for (double m : result.box_dimensions) put_varint(chunk_, std::lround(m));
+  for (double k : result.signal) put_varint(chunk_, std::lround(k));
+  if (++next_block_ % header_.chunk_blocks == 0) return flush_chunk();
+  return ok_;
+}
+
+bool ContainerWriter::flush_chunk() {
+  if (chunk_.empty()) return ok_;
+  put<uint64_t>(chunk_index_, bytes_written_);
+  put<uint32_t>(chunk_index_, chunk_.size());
+  put<uint32_t>(chunk_index_, crc32(chunk_.data(), chunk_.size()));
+  if (std::fwrite(chunk_.data(), 1, chunk_.size(), file_) != chunk_.size())
+    ok_ = false;
+  bytes_written_ += chunk_.size();
+  chunk_.clear();
+  return ok_;
+}
+
+bool ContainerWriter::close() {
+  if (!file_) return ok_;
+  flush_chunk();
+  if (next_block_ != header_.num_blocks()) {
+    std::cerr << "container closed after " << next_block_ << " of "
+              << header_.num_blocks() << " blocks" << std::endl;
+    ok_ = false;
+  }
+  std::vector<uint8_t> index = std::move(chunk_index_);
+  for (uint32_t offset : block_offsets_) put<uint32_t>(index, offset);
+  put<uint64_t>(index, bytes_written_);
+  index.insert(index.end(), kMagic, kMagic + 4);
+  if (std::fwrite(index.data(), 1, index.size(), file_) != index.size())
+    ok_ = false;
+  bytes_written_ += index.size();
+  if (std::fclose(file_) != 0) ok_ = false;
+  file_ = nullptr;
+  chunk_index_.clear();
+  block_offsets_.clear();
+  return ok_;
+}
+
+bool ContainerReader::open(const std::string &path) {
+  if (!file_.open(path)) return false;
+  const char *data = file_.data();
+  const size_t size = file_.size();
+  auto fail = [&]() {
+    std::cerr << path << " is not a block container" << std::endl;
+    file_.close();
+    return false;
+  };
+  if (size < kHeaderSize + kFooterSize || std::memcmp(data, kMagic, 4) != 0 ||
+      get<uint32_t>(data + 4) != ContainerHeader::kVersion ||
+      std::memcmp(data + size - 4, kMagic, 4) != 0)
+    return fail();
+  header_.num_parameters = get<uint64_t>(data + 8);
+  header_.block_size = get<uint32_t>(data + 16);
+  header_.chunk_blocks = get<uint32_t>(data + 20);
+  header_.seed = get<uint64_t>(data + 24);
+  header_.eps = get<double>(data + 32);
+  header_.prior.kind =
+      static_cast<PriorDescription::Kind>(get<uint32_t>(data + 40));
+  header_.prior.mean = get<double>(data + 44);
+  header_.prior.std = get<double>(data + 52);
+  uint32_t source_size = get<uint32_t>(data + 60);
+  if (header_.block_size == 0 || header_.chunk_blocks == 0 ||
+      kHeaderSize + source_size + kFooterSize > size)
+    return fail();
+  header_.prior.source.assign(data + kHeaderSize, source_size);
+
+  uint64_t index_offset = get<uint64_t>(data + size - kFooterSize);
+  uint64_t index_size =
+      header_.num_chunks() * kChunkEntrySize + header_.num_blocks() * 4;
+  if (index_offset < kHeaderSize + source_size ||
+      index_offset + index_size + kFooterSize != size)
+    return fail();
+  chunk_index_ = data + index_offset;
+  block_offsets_ = chunk_index_ + header_.num_chunks() * kChunkEntrySize;
+  verified_ = std::make_unique<std::atomic<bool>[]>(header_.num_chunks());
+  for (uint64_t c = 0; c < header_.num_chunks(); c++) verified_[c] = false;
+  file_.advise_random();
+  return true;
+}
+
+bool ContainerReader::verify_chunk(uint64_t chunk) const {
+  if (verified_[chunk].load(std::memory_order_acquire)) return true;
+  const char *entry = chunk_index_ + chunk * kChunkEntrySize;
+  uint64_t offset = get<uint64_t>(entry);
+  uint32_t size = get<uint32_t>(entry + 8);
+  if (offset + size > static_cast<uint64_t>(chunk_index_ - file_.data()) ||
+      crc32(file_.data() + offset, size) != get<uint32_t>(entry + 12)) {
+    std::cerr << "chunk " << chunk << " is corrupt" << std::endl;
+    return false;
+  }
+  verified_[chunk].store(true, std::memory_order_release);
+  return true;
+}
+
+bool ContainerReader::read_block(uint64_t block, EncodeResult *result) const {
+  if (block >= header_.num_blocks()) {
+    std::cerr << "block " << block << " is out of range" << std::endl;
+    return false;
+  }
+  uint64_t chunk = block / header_.chunk_blocks;
+  if (!verify_chunk(chunk)) return false;
+  const char *entry = chunk_index_ + chunk * kChunkEntrySize;
+  const char *begin = file_.data() + get<uint64_t>(entry);
+  const char *end = begin + get<uint32_t>(entry + 8);
+  const char *data = begin + get<uint32_t>(block_offsets_ + block * 4);
+
+  int dim = header_.block_dim(block);
+  uint64_t value;
+  bool ok = get_varint(data, end, &value);
+  result->sample_index = value;
+  result->box_dimensions.resize(dim);
+  result->signal.resize(dim);
+  for (int d = 0; d < dim && ok; d++) {
+    ok = get_varint(data, end, &value);
+    result->box_dimensions[d] = value;
+  }
+  for (int d = 0; d < dim && ok; d++) {
+    ok = get_varint(data, end, &value);
+    result->signal[d] = value;
+  }
+  if (!ok) {
+    std::cerr << "block " << block << " is truncated" << std::endl;
+    return false;
+  }
+  result->seed = header_.seed + block;
+  return true;
+}
+
+bool ContainerReader::decode(uint64_t first, uint64_t last,
+                             const Eigen::ArrayXd &p_mean,
+                             const Eigen::ArrayXd &p_std,
+                             Eigen::ArrayXd *weights) const {
+  if (first > last || last > header_.num_blocks()) {
+    std::cerr << "blocks [" << first << ", " << last << ") are out of range"
+              << std::endl;
+    return false;
+  }
+  uint64_t begin = parameter_offset(first);
+  uint64_t end = std::min(header_.num_parameters, parameter_offset(last));
+  if (p_mean.size() != static_cast<Eigen::Index>(end - begin) ||
+      p_std.size() != p_mean.size()) {
+    std::cerr << "the prior covers " << p_mean.size() << " parameters, "
+              << "expected " << end - begin << std::endl;
+    return false;
+  }
+  weights->resize(end - begin);
+  EncodeResult result;
+  for (uint64_t block = first; block < last; block++) {
+    if (!read_block(block, &result)) return false;
+    uint64_t offset = parameter_offset(block) - begin;
+    int dim = header_.block_dim(block);
+    weights->segment(offset, dim) = pipeline::decode(
+        result, p_mean.segment(offset, dim), p_std.segment(offset, dim));
+  }
+  return true;
+}
+
+bool ContainerReader::decode(uint64_t first, uint64_t last,
+                             Eigen::ArrayXd *weights) const {
+  if (header_.prior.kind != PriorDescription::Kind::kIsotropic) {
+    std::cerr << "the prior of the container is not stored in it"
+              << std::endl;
+    return false;
+  }
+  uint64_t begin = parameter_offset(std::min(first, header_.num_blocks()));
+  uint64_t end = std::min(header_.num_parameters, parameter_offset(last));
+  Eigen::Index size = end > begin ? end - begin : 0;
+  return decode(first, last,
+                Eigen::ArrayXd::Constant(size, header_.prior.mean),
+                Eigen::ArrayXd::Constant(size, header_.prior.std), weights);
+}
+}  // namespace rcc::pipeline
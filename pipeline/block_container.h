@@ -0,0 +1,144 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_PIPELINE_BLOCK_CONTAINER_H_
+#define THIRD_PARTY_HYBRID_RCC_PIPELINE_BLOCK_CONTAINER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Eigen/Core"
+#include "pipeline/encoder.h"
+#include "pipeline/mapped_file.h"
+
+// Seekable container of hybrid encode results.
+//
+//   header: "RCCB", version, num_parameters, block_size, chunk_blocks, seed,
+//           eps, prior kind, prior mean, prior std, prior source
+//   chunks: block records of chunk_blocks consecutive blocks, each
+//           varint n, varint M[0..dim), varint k[0..dim) as in the encoded
+//           stream
+//   index:  per chunk (uint64 offset, uint32 size, uint32 crc32), then per
+//           block the uint32 offset of its record within its chunk
+//   footer: uint64 offset of the index, "RCCB"
+//
+// Blocks are laid out and seeded as in the encoded stream: block b covers
+// parameters [b block_size, (b + 1) block_size) and was encoded with
+// seed + b. The index sits at the end so the writer can stream; the reader
+// maps the file, loads the index and decodes any range of blocks, touching
+// only the pages of the chunks it covers. A chunk's checksum is verified
+// the first time one of its blocks is read.
+namespace rcc::pipeline {
+// What the blocks were encoded against. An isotropic prior N(mean, std^2)
+// makes the container self contained; otherwise source names the files the
+// per parameter prior came from, and the caller passes the prior to decode.
+struct PriorDescription {
+  enum class Kind : uint32_t { kExternal = 0, kIsotropic = 1 };
+  Kind kind = Kind::kExternal;
+  double mean = 0, std = 1;
+  std::string source;
+};
+
+struct ContainerHeader {
+  static constexpr uint32_t kVersion = 1;
+  uint64_t num_parameters = 0;
+  uint32_t block_size = 0;
+  uint32_t chunk_blocks = 1024;
+  uint64_t seed = 0;
+  double eps = 0;
+  PriorDescription prior;
+
+  uint64_t num_blocks() const {
+    return (num_parameters + block_size - 1) / block_size;
+  }
+  uint64_t num_chunks() const {
+    return (num_blocks() + chunk_blocks - 1) / chunk_blocks;
+  }
+  int block_dim(uint64_t block) const {
+    return std::min<uint64_t>(block_size, num_parameters - block * block_size);
+  }
+};
+
+// Appends blocks in order, writing a chunk once it is complete. Failures
+// are logged; close() returns false if any happened.
+class ContainerWriter {
+ public:
+  ContainerWriter() = default;
+  ContainerWriter(const ContainerWriter &) = delete;
+  ContainerWriter &operator=(const ContainerWriter &) = delete;
+  ~ContainerWriter() { close(); }
+
+  bool open(const std::string &path, const ContainerHeader &header);
+  // result.seed must be header.seed plus the index of the block.
+  bool write_block(const EncodeResult &result);
+  // Writes the last chunk, the index and the footer. All blocks must have
+  // been written.
+  bool close();
+
+  uint64_t bytes_written() const { return bytes_written_ + chunk_.size(); }
+
+ private:
+  bool flush_chunk();
+
+  FILE *file_ = nullptr;
+  ContainerHeader header_;
+  std::vector<uint8_t> chunk_;
+  std::vector<uint8_t> chunk_index_;
+  std::vector<uint32_t> block_offsets_;
+  uint64_t bytes_written_ = 0, next_block_ = 0;
+  bool ok_ = true;
+};
+
+// Random access reader over a read-only mapping. Reading is thread safe.
+class ContainerReader {
+ public:
+  bool open(const std::string &path);
+  const ContainerHeader &header() const { return header_; }
+  uint64_t num_blocks() const { return header_.num_blocks(); }
+
+  // Fills sample_index, signal, box_dimensions and seed of block. Fails,
+  // after logging why, if the block is out of range or its chunk is corrupt.
+  bool read_block(uint64_t block, EncodeResult *result) const;
+
+  // Decodes blocks [first, last) into weights, which is resized to the
+  // parameters they cover. p_mean and p_std are the prior of exactly those
+  // parameters; the overload without them requires an isotropic prior.
+  bool decode(uint64_t first, uint64_t last, const Eigen::ArrayXd &p_mean,
+              const Eigen::ArrayXd &p_std, Eigen::ArrayXd *weights) const;
+  bool decode(uint64_t first, uint64_t last, Eigen::ArrayXd *weights) const;
+
+  // Index of the first parameter of block.
+  uint64_t parameter_offset(uint64_t block) const {
+    return block * header_.block_size;
+  }
+
+ private:
+  bool verify_chunk(uint64_t chunk) const;
+
+  MappedFile file_;
+  ContainerHeader header_;
+  const char *chunk_index_ = nullptr;
+  const char *block_offsets_ = nullptr;
+  std::unique_ptr<std::atomic<bool>[]> verified_;
+};
+}  // namespace rcc::pipeline
+
+#endif  // THIRD_PARTY_HYBRID_RCC_PIPELINE_BLOCK_CONTAINER_H_
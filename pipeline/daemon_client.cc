@@ -0,0 +1,199 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pipeline/daemon_client.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include "pipeline/local_socket.h"
+
+namespace rcc::pipeline {
+namespace {
+void put(double *target, const Eigen::ArrayXd &values) {
+  std::memcpy(target, values.data(), values.size() * sizeof(double));
+}
+
+Eigen::ArrayXd get(const double *source, int dim) {
+  return Eigen::Map<const Eigen::ArrayXd>(source, dim);
+}
+}  // namespace
+
+bool DaemonClient::connect(const std::string &socket_path,
+                           size_t region_bytes) {
+  close();
+  if (!region_.create_shared(region_bytes)) return false;
+  fd_ = connect_local(socket_path);
+  if (fd_ < 0) {
+    region_.close();
+    return false;
+  }
+  DaemonRequest request;
+  request.op = DaemonOp::kAttach;
+  request.id = next_id_++;
+  request.offset = region_bytes;
+  DaemonResponse response;
+  if (!send_with_fd(fd_, &request, sizeof(request), region_.fd()) ||
+      !receive_all(fd_, &response, sizeof(response)) ||
+      response.status != DaemonStatus::kOk) {
+    std::cerr << "daemon at " << socket_path << " refused the connection"
+              << std::endl;
+    close();
+    return false;
+  }
+  return true;
+}
+
+void DaemonClient::close() {
+  if (fd_ >= 0) ::close(fd_);
+  fd_ = -1;
+  region_.close();
+}
+
+DaemonStatus DaemonClient::call(DaemonRequest *request,
+                                DaemonResponse *response) {
+  if (fd_ < 0) return DaemonStatus::kFailed;
+  request->id = next_id_++;
+  if (!send_all(fd_, request, sizeof(*request)) ||
+      !receive_all(fd_, response, sizeof(*response)) ||
+      response->magic != kDaemonMagic || response->id != request->id) {
+    std::cerr << "lost the connection to the daemon" << std::endl;
+    close();
+    return DaemonStatus::kFailed;
+  }
+  return response->status;
+}
+
+uint64_t DaemonClient::register_prior(uint64_t key, const Eigen::ArrayXd &mean,
+                                      const Eigen::ArrayXd &std) {
+  int dim = mean.size();
+  if (fd_ < 0 || dim != std.size() || dim > max_dim()) return 0;
+  put(array(0, dim), mean);
+  put(array(1, dim), std);
+  DaemonRequest request;
+  request.op = DaemonOp::kRegisterPrior;
+  request.dim = dim;
+  request.prior = key;
+  DaemonResponse response;
+  if (call(&request, &response) != DaemonStatus::kOk) return 0;
+  return response.prior;
+}
+
+DaemonStatus DaemonClient::encode(const EncodeRequest &request,
+                                  EncodeResult *result, uint64_t prior,
+                                  DaemonResponse *response) {
+  int dim = request.q_mean.size();
+  if (fd_ < 0 || dim > max_dim() || request.q_std.size() != dim ||
+      (!prior && (request.p_mean.size() != dim || request.p_std.size() != dim)))
+    return DaemonStatus::kBadRequest;
+  put(array(0, dim), request.q_mean);
+  put(array(1, dim), request.q_std);
+  if (!prior) {
+    put(array(2, dim), request.p_mean);
+    put(array(3, dim), request.p_std);
+  }
+  DaemonRequest message;
+  message.op = DaemonOp::kEncode;
+  message.dim = dim;
+  message.prior = prior;
+  message.seed = request.seed;
+  message.eps = request.eps;
+  message.N_max = request.N_max;
+  message.table_cells = request.hybrid_options.table_cells;
+  message.hybrid = request.hybrid;
+  message.pfr = request.pfr;
+  message.early_abort = request.hybrid_options.early_abort;
+  message.single_shot_kl = request.hybrid_options.single_shot_kl;
+  message.elide_kl = request.hybrid_options.elide_kl;
+  message.fallback =
+      request.fallback == algorithm::Fallback::kDitheredQuantization;
+  if (request.deadline.is_set()) {
+    auto remaining = request.deadline.at() - algorithm::Deadline::Clock::now();
+    message.timeout =
+        std::max(1e-9, std::chrono::duration<double>(remaining).count());
+  }
+  DaemonResponse local_response;
+  if (!response) response = &local_response;
+  DaemonStatus status = call(&message, response);
+  if (status != DaemonStatus::kOk) return status;
+  result->seed = request.seed;
+  result->sample = get(array(0, dim), dim);
+  result->signal = request.hybrid ? get(array(1, dim), dim) : Eigen::ArrayXd();
+  result->box_dimensions =
+      request.hybrid ? get(array(2, dim), dim) : Eigen::ArrayXd();
+  result->sample_index = response->sample_index;
+  result->total_number_samples = response->total_number_samples;
+  result->status.t = response->t;
+  result->status.s = response->s;
+  result->status.w_min_stop = response->w_min_stop;
+  result->status.deadline_stop = response->deadline_stop;
+  result->status.fallback = response->fallback;
+  result->status.single_shot = response->single_shot;
+  result->status.elided = response->elided;
+  result->status.elided_kl = response->elided_kl;
+  return status;
+}
+
+DaemonStatus DaemonClient::decode(const EncodeResult &result,
+                                  const Eigen::ArrayXd &p_mean,
+                                  const Eigen::ArrayXd &p_std,
+                                  Eigen::ArrayXd *sample) {
+  return decode(result, 0, &p_mean, &p_std, sample);
+}
+
+DaemonStatus DaemonClient::decode(const EncodeResult &result, uint64_t prior,
+                                  Eigen::ArrayXd *sample) {
+  return decode(result, prior, nullptr, nullptr, sample);
+}
+
+DaemonStatus DaemonClient::decode(const EncodeResult &result, uint64_t prior,
+                                  const Eigen::ArrayXd *p_mean,
+                                  const Eigen::ArrayXd *p_std,
+                                  Eigen::ArrayXd *sample) {
+  int dim = result.signal.size();
+  if (fd_ < 0 || dim > max_dim() || result.box_dimensions.size() != dim ||
+      (!prior && (p_mean->size() != dim || p_std->size() != dim)))
+    return DaemonStatus::kBadRequest;
+  put(array(0, dim), result.signal);
+  put(array(1, dim), result.box_dimensions);
+  if (!prior) {
+    put(array(2, dim), *p_mean);
+    put(array(3, dim), *p_std);
+  }
+  DaemonRequest request;
+  request.op = DaemonOp::kDecode;
+  request.dim = dim;
+  request.prior = prior;
+  request.seed = result.seed;
+  request.sample_index = result.sample_index;
+  DaemonResponse response;
+  DaemonStatus status = call(&request, &response);
+  if (status == DaemonStatus::kOk) *sample = get(array(0, dim), dim);
+  return status;
+}
+
+bool DaemonClient::metrics(DaemonMetrics *metrics) {
+  if (fd_ < 0 || region_.size() < sizeof(DaemonMetrics)) return false;
+  DaemonRequest request;
+  request.op = DaemonOp::kMetrics;
+  DaemonResponse response;
+  if (call(&request, &response) != DaemonStatus::kOk) return false;
+  std::memcpy(metrics, region_.data(), sizeof(*metrics));
+  return true;
+}
+}  // namespace rcc::pipeline
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_PIPELINE_DAEMON_CLIENT_H_
+#define THIRD_PARTY_HYBRID_RCC_PIPELINE_DAEMON_CLIENT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "Eigen/Core"
+#include "pipeline/daemon_protocol.h"
+#include "pipeline/encoder.h"
+#include "pipeline/mapped_file.h"
+
+// Client of the local encoding daemon (daemon/rccd).
+//
+// Drop-in replacement for calling encode() and decode() in process: the
+// daemon keeps registered priors and its encode workers warm across every
+// process on the host and applies admission control. Arrays travel through
+// a shared memory region created at connect(), which bounds the dimension
+// of a request to max_dim(). A client holds one connection and runs one
+// request at a time, so it is not thread safe; use one per thread.
+namespace rcc::pipeline {
+class DaemonClient {
+ public:
+  DaemonClient() = default;
+  DaemonClient(const DaemonClient &) = delete;
+  DaemonClient &operator=(const DaemonClient &) = delete;
+  ~DaemonClient() { close(); }
+
+  bool connect(const std::string &socket_path,
+               size_t region_bytes = size_t(1) << 24);
+  void close();
+  bool is_connected() const { return fd_ >= 0; }
+  int max_dim() const {
+    return static_cast<int>(region_.size() / (4 * sizeof(double)));
+  }
+
+  // Registers a prior under a key of the caller's choosing, e.g. a hash of
+  // the files it came from, and returns the id to pass to encode() and
+  // decode(), or 0 on failure. Clients registering the same key share the
+  // daemon's copy; registering a key again with a different mean or std
+  // fails.
+  uint64_t register_prior(uint64_t key, const Eigen::ArrayXd &mean,
+                          const Eigen::ArrayXd &std);
+
+  // Runs encode(request) in the daemon. With a prior id, request.p_mean and
+  // request.p_std are ignored. kBusy means the daemon is saturated and the
+  // request can be retried; on a transport failure the connection is
+  // closed. response, if given, receives the daemon's latencies.
+  DaemonStatus encode(const EncodeRequest &request, EncodeResult *result,
+                      uint64_t prior = 0, DaemonResponse *response = nullptr);
+
+  // Runs decode(result, p_mean, p_std) in the daemon.
+  DaemonStatus decode(const EncodeResult &result, const Eigen::ArrayXd &p_mean,
+                      const Eigen::ArrayXd &p_std, Eigen::ArrayXd *sample);
+  DaemonStatus decode(const EncodeResult &result, uint64_t prior,
+                      Eigen::ArrayXd *sample);
+
+  bool metrics(DaemonMetrics *metrics);
+
+ private:
+  DaemonStatus call(DaemonRequest *request, DaemonResponse *response);
+  DaemonStatus decode(const EncodeResult &result, uint64_t prior,
+                      const Eigen::ArrayXd *p_mean,
+                      const Eigen::ArrayXd *p_std, Eigen::ArrayXd *sample);
+  // The i-th array of dim entries of the region.
+  double *array(int i, int dim) {
+    return reinterpret_cast<double *>(region_.mutable_data()) + i * dim;
+  }
+
+  int fd_ = -1;
+  MappedFile region_;
+  uint64_t next_id_ = 1;
+};
+}  // namespace rcc::pipeline
+
+#endif  // THIRD_PARTY_HYBRID_RCC_PIPELINE_DAEMON_CLIENT_H_
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_PIPELINE_DAEMON_PROTOCOL_H_
+#define THIRD_PARTY_HYBRID_RCC_PIPELINE_DAEMON_PROTOCOL_H_
+
+#include <cstdint>
+
+#include "pipeline/encoder_pipeline.h"
+
+// Wire format between the encoding daemon and its clients.
+//
+// A client connects to the daemon's Unix domain socket and first sends a
+// kAttach request carrying the descriptor of a shared memory region it
+// created. Every later request is one fixed size DaemonRequest answered by
+// one DaemonResponse, in order. Arrays never go through the socket: they
+// are float64 arrays of dim entries at request.offset in the region,
+//
+//   kRegisterPrior  in:  mean, std
+//   kEncode         in:  q_mean, q_std, then p_mean, p_std if prior == 0
+//                   out: sample, signal, box_dimensions
+//   kDecode         in:  signal, box_dimensions, then p_mean, p_std if
+//                        prior == 0
+//                   out: sample
+//   kMetrics        out: DaemonMetrics
+//
+// and outputs overwrite the inputs. Both sides run on the same host, so the
+// structs are sent in native layout.
+namespace rcc::pipeline {
+constexpr uint32_t kDaemonMagic = 0x52434344;  // "RCCD"
+constexpr uint32_t kDaemonVersion = 2;
+
+enum class DaemonOp : uint32_t {
+  kAttach = 1,
+  kRegisterPrior = 2,
+  kEncode = 3,
+  kDecode = 4,
+  kMetrics = 5,
+};
+
+enum class DaemonStatus : uint32_t {
+  kOk = 0,
+  // The encode queue is full; the request was not run.
+  kBusy = 1,
+  kBadRequest = 2,
+  kUnknownPrior = 3,
+  kFailed = 4,
+};
+
+struct DaemonRequest {
+  uint32_t magic = kDaemonMagic;
+  uint32_t version = kDaemonVersion;
+  DaemonOp op = DaemonOp::kEncode;
+  uint32_t dim = 0;
+  // Echoed in the response.
+  uint64_t id = 0;
+  // kAttach: size of the region. Otherwise the byte offset of the arrays.
+  uint64_t offset = 0;
+  // kRegisterPrior: client chosen key under which every client shares the
+  // prior. kEncode and kDecode: the id it was registered as, or 0 to pass
+  // the prior in the region.
+  uint64_t prior = 0;
+  // Encode parameters, as in EncodeRequest, and the seed of kDecode.
+  uint64_t seed = 0;
+  double eps = 1e-4;
+  uint32_t N_max = 0;
+  int32_t table_cells = 0;
+  // Seconds from the moment the daemon reads the request; 0 means none.
+  double timeout = 0;
+  uint8_t hybrid = 1, pfr = 1, fallback = 0, early_abort = 0;
+  // Nats; see HybridOptions.
+  double single_shot_kl = 1e-6, elide_kl = 0;
+  // kDecode.
+  int32_t sample_index = 0;
+};
+
+struct DaemonResponse {
+  uint32_t magic = kDaemonMagic;
+  DaemonStatus status = DaemonStatus::kOk;
+  uint64_t id = 0;
+  // kRegisterPrior: the id to pass in later requests.
+  uint64_t prior = 0;
+  int32_t sample_index = 0, total_number_samples = 0;
+  double t = 0, s = 0;
+  uint8_t w_min_stop = 0, deadline_stop = 0, fallback = 0, single_shot = 0;
+  int32_t elided = 0;
+  double elided_kl = 0;
+  // Milliseconds from the daemon reading the request to it having the
+  // result.
+  double latency = 0;
+};
+
+// Latencies are in milliseconds and cover reading a request to writing its
+// response. histogram[b] counts requests that took [2^(b-1), 2^b)
+// microseconds, the last bucket everything slower.
+struct DaemonLatency {
+  static constexpr int kBuckets = 32;
+  uint64_t count = 0;
+  double mean = 0, max = 0;
+  uint64_t histogram[kBuckets] = {};
+};
+
+// connections counts every connection accepted, priors the registered
+// ones, busy the encodes refused by admission control. pipeline breaks
+// encode latency down into time queued and encoding.
+struct DaemonMetrics {
+  uint64_t connections = 0, priors = 0;
+  uint64_t busy = 0, failed = 0;
+  DaemonLatency encode, decode;
+  PipelineMetrics pipeline;
+};
+}  // namespace rcc::pipeline
+
+#endif  // THIRD_PARTY_HYBRID_RCC_PIPELINE_DAEMON_PROTOCOL_H_
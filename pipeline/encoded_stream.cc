@@ -0,0 +1,153 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pipeline/encoded_stream.h"
+
+#include <cassert>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace rcc::pipeline {
+namespace {
+constexpr char kMagic[4] = {'R', 'C', 'C', 'W'};
+// Magic, version, num_parameters, block_size, seed, eps.
+constexpr size_t kHeaderSize = 4 + 4 + 8 + 4 + 8 + 8;
+// Release the input in steps of this many bytes.
+constexpr size_t kReleaseStep = 1 << 20;
+
+template <typename T>
+void put(std::vector<uint8_t> &buffer, T value) {
+  uint8_t bytes[sizeof(T)];
+  std::memcpy(bytes, &value, sizeof(T));
+  buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+T get(const char *data) {
+  T value;
+  std::memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+void put_varint(std::vector<uint8_t> &buffer, uint64_t value) {
+  while (value >= 0x80) {
+    buffer.push_back(static_cast<uint8_t>(value) | 0x80);
+    value >>= 7;
+  }
+  buffer.push_back(static_cast<uint8_t>(value));
+}
+}  // namespace
+
+bool EncodedStreamWriter::open(const std::string &path,
+                               const StreamHeader &header) {
+  close();
+  file_ = std::fopen(path.c_str(), "wb");
+  if (!file_) {
+    std::cerr << "cannot create " << path << ": " << std::strerror(errno)
+              << std::endl;
+    return false;
+  }
+  ok_ = true;
+  bytes_written_ = 0;
+  buffer_.clear();
+  buffer_.reserve(buffer_size_ + 1024);
+  buffer_.insert(buffer_.end(), kMagic, kMagic + 4);
+  put<uint32_t>(buffer_, StreamHeader::kVersion);
+  put<uint64_t>(buffer_, header.num_parameters);
+  put<uint32_t>(buffer_, header.block_size);
+  put<uint64_t>(buffer_, header.seed);
+  put<double>(buffer_, header.eps);
+  return true;
+}
+
+bool EncodedStreamWriter::write_block(const EncodeResult &result) {
+  assert(file_);
+  put_varint(buffer_, result.sample_index);
+  for (double m : result.box_dimensions) put_varint(buffer_, std::lround(m));
+  for (double k : result.signal) put_varint(buffer_, std::lround(k));
+  if (buffer_.size() >= buffer_size_) return flush();
+  return ok_;
+}
+
+bool EncodedStreamWriter::flush() {
+  if (!buffer_.empty() &&
+      std::fwrite(buffer_.data(), 1, buffer_.size(), file_) != buffer_.size())
+    ok_ = false;
+  bytes_written_ += buffer_.size();
+  buffer_.clear();
+  return ok_;
+}
+
+bool EncodedStreamWriter::close() {
+  if (!file_) return ok_;
+  flush();
+  if (std::fclose(file_) != 0) ok_ = false;
+  file_ = nullptr;
+  return ok_;
+}
+
+bool EncodedStreamReader::open(const std::string &path) {
+  if (!file_.open(path)) return false;
+  const char *data = file_.data();
+  if (file_.size() < kHeaderSize || std::memcmp(data, kMagic, 4) != 0 ||
+      get<uint32_t>(data + 4) != StreamHeader::kVersion) {
+    std::cerr << path << " is not an encoded stream" << std::endl;
+    file_.close();
+    return false;
+  }
+  header_.num_parameters = get<uint64_t>(data + 8);
+  header_.block_size = get<uint32_t>(data + 16);
+  header_.seed = get<uint64_t>(data + 20);
+  header_.eps = get<double>(data + 28);
+  position_ = released_ = kHeaderSize;
+  next_block_ = 0;
+  return header_.block_size > 0;
+}
+
+bool EncodedStreamReader::read_varint(uint64_t *value) {
+  *value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (position_ >= file_.size()) return false;
+    uint8_t byte = file_.data()[position_++];
+    *value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) return true;
+  }
+  return false;
+}
+
+bool EncodedStreamReader::read_block(EncodeResult *result) {
+  if (next_block_ >= header_.num_blocks()) return false;
+  int dim = header_.block_dim(next_block_);
+  uint64_t value;
+  if (!read_varint(&value)) return false;
+  result->sample_index = value;
+  result->box_dimensions.resize(dim);
+  result->signal.resize(dim);
+  for (int d = 0; d < dim; d++) {
+    if (!read_varint(&value)) return false;
+    result->box_dimensions[d] = value;
+  }
+  for (int d = 0; d < dim; d++) {
+    if (!read_varint(&value)) return false;
+    result->signal[d] = value;
+  }
+  result->seed = header_.seed + next_block_;
+  next_block_++;
+  if (position_ - released_ >= kReleaseStep)
+    released_ = file_.release(released_, position_ - released_);
+  return true;
+}
+}  // namespace rcc::pipeline
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_PIPELINE_ENCODED_STREAM_H_
+#define THIRD_PARTY_HYBRID_RCC_PIPELINE_ENCODED_STREAM_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "pipeline/encoder.h"
+#include "pipeline/mapped_file.h"
+
+// Sequential stream of hybrid encode results.
+//
+//   header: "RCCW", version, num_parameters, block_size, seed, eps
+//   block:  varint n, varint M[0..dim), varint k[0..dim)
+//
+// Parameters are split into consecutive blocks of block_size, the last one
+// possibly shorter, and block b is encoded with seed + b. Everything the
+// decoder needs besides the prior is in the stream.
+namespace rcc::pipeline {
+struct StreamHeader {
+  static constexpr uint32_t kVersion = 1;
+  uint64_t num_parameters = 0;
+  uint32_t block_size = 0;
+  uint64_t seed = 0;
+  double eps = 0;
+
+  uint64_t num_blocks() const {
+    return (num_parameters + block_size - 1) / block_size;
+  }
+  int block_dim(uint64_t block) const {
+    return std::min<uint64_t>(block_size, num_parameters - block * block_size);
+  }
+};
+
+// Buffers blocks and appends them to the file in large writes.
+class EncodedStreamWriter {
+ public:
+  explicit EncodedStreamWriter(size_t buffer_size = 1 << 20)
+      : buffer_size_(buffer_size) {}
+  EncodedStreamWriter(const EncodedStreamWriter &) = delete;
+  EncodedStreamWriter &operator=(const EncodedStreamWriter &) = delete;
+  ~EncodedStreamWriter() { close(); }
+
+  bool open(const std::string &path, const StreamHeader &header);
+  bool write_block(const EncodeResult &result);
+  // Flushes the buffer; false if any write failed.
+  bool close();
+
+  uint64_t bytes_written() const { return bytes_written_ + buffer_.size(); }
+
+ private:
+  bool flush();
+
+  FILE *file_ = nullptr;
+  size_t buffer_size_;
+  std::vector<uint8_t> buffer_;
+  uint64_t bytes_written_ = 0;
+  bool ok_ = true;
+};
+
+// Reads a stream back from a read-only mapping, releasing what it has read.
+class EncodedStreamReader {
+ public:
+  bool open(const std::string &path);
+  const StreamHeader &header() const { return header_; }
+  size_t bytes_read() const { return position_; }
+
+  // Fills sample_index, signal, box_dimensions and seed of the next block.
+  bool read_block(EncodeResult *result);
+
+ private:
+  bool read_varint(uint64_t *value);
+
+  MappedFile file_;
+  StreamHeader header_;
+  size_t position_ = 0, released_ = 0;
+  uint64_t next_block_ = 0;
+};
+}  // namespace rcc::pipeline
+
+#endif  // THIRD_PARTY_HYBRID_RCC_PIPELINE_ENCODED_STREAM_H_
@@ -0,0 +1,80 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pipeline/encoder.h"
+
+#include <cmath>
+#include <tuple>
+
+#include "algorithm/reverse_channel.h"
+#include "include/pcg_random.hpp"
+#include "stats/distributions/multivariate/continuous/gaussian.h"
+
+namespace rcc::pipeline {
+using stats::multivariates::IndependentGaussian;
+
+EncodeResult encode(const EncodeRequest &request) {
+  IndependentGaussian p(request.p_mean, request.p_std);
+  IndependentGaussian q(request.q_mean, request.q_std);
+  pcg32 rs(request.seed);
+  EncodeResult result;
+  result.seed = request.seed;
+  if (request.hybrid) {
+    std::tie(result.sample, result.sample_index, result.signal,
+             result.total_number_samples, result.box_dimensions) =
+        rcc::algorithm::sample_gaussian_hybrid(
+            &q, &p, request.pfr, request.eps, rs, request.N_max, false,
+            request.deadline, request.fallback, &result.status,
+            request.hybrid_options);
+  } else {
+    std::tie(result.sample, result.sample_index, result.total_number_samples) =
+        rcc::algorithm::sample_gaussian(&q, &p, request.pfr, rs, request.N_max,
+                                        false, request.deadline,
+                                        &result.status);
+  }
+  return result;
+}
+
+Eigen::ArrayXd decode(const EncodeResult &result, const Eigen::ArrayXd &p_mean,
+                      const Eigen::ArrayXd &p_std) {
+  IndependentGaussian p(p_mean, p_std);
+  pcg32 rs(result.seed);
+  return rcc::algorithm::decode_hybrid(result.sample_index, result.signal,
+                                       result.box_dimensions, p, p_mean.size(),
+                                       rs);
+}
+
+bool valid_scale(const Eigen::ArrayXd &std) {
+  return (std > 0).all() && std.isFinite().all();
+}
+
+bool valid_boxes(const Eigen::ArrayXd &M) {
+  return (M >= 0).all() && M.isFinite().all();
+}
+
+bool valid_settings(const EncodeRequest &request) {
+  const algorithm::HybridOptions &options = request.hybrid_options;
+  return request.N_max > 0 && request.eps > 0 && request.eps < 1 &&
+         options.table_cells >= 0 && options.table_cells <= kMaxTableCells &&
+         !std::isnan(options.single_shot_kl) && options.elide_kl >= 0;
+}
+
+bool valid_request(const EncodeRequest &request) {
+  const Eigen::Index dim = request.q_mean.size();
+  return dim > 0 && valid_settings(request) && request.q_std.size() == dim &&
+         request.p_mean.size() == dim && request.p_std.size() == dim &&
+         request.q_mean.isFinite().all() && valid_scale(request.q_std) &&
+         request.p_mean.isFinite().all() && valid_scale(request.p_std);
+}
+}  // namespace rcc::pipeline
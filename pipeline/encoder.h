@@ -0,0 +1,88 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_PIPELINE_ENCODER_H_
+#define THIRD_PARTY_HYBRID_RCC_PIPELINE_ENCODER_H_
+
+#include <atomic>
+#include <cstdint>
+
+#include "Eigen/Core"
+#include "algorithm/deadline.h"
+#include "algorithm/options.h"
+
+namespace rcc::pipeline {
+// A self contained encode job for a pair of independent Gaussians.
+struct EncodeRequest {
+  Eigen::ArrayXd q_mean, q_std, p_mean, p_std;
+  bool hybrid = true;
+  bool pfr = true;
+  double eps = 1e-4;
+  uint64_t seed = 0;
+  uint32_t N_max = 1 << 16;
+  // Absolute, so that time spent queueing counts against the budget.
+  algorithm::Deadline deadline;
+  algorithm::Fallback fallback = algorithm::Fallback::kBestCandidate;
+  // Ignored by non-hybrid requests.
+  algorithm::HybridOptions hybrid_options;
+};
+
+// Mirrors the fields of interface::SamplingOutput. signal and box_dimensions
+// are empty for non-hybrid requests.
+struct EncodeResult {
+  Eigen::ArrayXd sample, signal, box_dimensions;
+  int sample_index = 0, total_number_samples = 0;
+  uint64_t seed = 0;
+  algorithm::SamplerStatus status;
+};
+
+// Runs sample_gaussian_hybrid or sample_gaussian on the request.
+EncodeResult encode(const EncodeRequest &request);
+
+// Reconstructs the sample of a hybrid encode result under the prior.
+Eigen::ArrayXd decode(const EncodeResult &result, const Eigen::ArrayXd &p_mean,
+                      const Eigen::ArrayXd &p_std);
+
+// Validation of requests from outside the process, shared by rccd and the
+// C API so that both accept the same requests.
+//
+// Larger tables cost more to build than any block could save.
+constexpr int kMaxTableCells = 1 << 16;
+// Positive and finite.
+bool valid_scale(const Eigen::ArrayXd &std);
+// Nonnegative and finite; box dimensions of 0 mark dimensions elided by the
+// encoder.
+bool valid_boxes(const Eigen::ArrayXd &M);
+// Whether encode() accepts the settings of request, whatever its arrays:
+// at least one candidate, eps in (0, 1), table_cells in
+// [0, kMaxTableCells], single_shot_kl not NaN and elide_kl nonnegative.
+bool valid_settings(const EncodeRequest &request);
+// valid_settings, and q and p of one size with finite means and valid
+// scales.
+bool valid_request(const EncodeRequest &request);
+
+// Raises target to value, for the maxima of latency metrics.
+template <typename T>
+void update_max(std::atomic<T> &target, T value) {
+  T current = target.load(std::memory_order_relaxed);
+  while (current < value &&
+         !target.compare_exchange_weak(current, value,
+                                       std::memory_order_relaxed)) {
+  }
+}
+}  // namespace rcc::pipeline
+
+#endif  // THIRD_PARTY_HYBRID_RCC_PIPELINE_ENCODER_H_
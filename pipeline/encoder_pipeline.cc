@@ -0,0 +1,193 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pipeline/encoder_pipeline.h"
+
+#include <algorithm>
+#include <cassert>
+#include <map>
+#include <utility>
+
+namespace rcc::pipeline {
+void EncoderPipeline::StageCounter::record(Clock::duration latency) {
+  uint64_t ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count();
+  count_.fetch_add(1, std::memory_order_relaxed);
+  total_ns_.fetch_add(ns, std::memory_order_relaxed);
+  update_max(max_ns_, ns);
+}
+
+void EncoderPipeline::StageCounter::track_depth(size_t depth) {
+  update_max(max_depth_, depth);
+}
+
+StageMetrics EncoderPipeline::StageCounter::snapshot(size_t depth) const {
+  StageMetrics metrics;
+  metrics.count = count_.load(std::memory_order_relaxed);
+  metrics.mean_latency =
+      metrics.count ? total_ns_.load(std::memory_order_relaxed) * 1e-6 /
+                          metrics.count
+                    : 0;
+  metrics.max_latency = max_ns_.load(std::memory_order_relaxed) * 1e-6;
+  metrics.depth = depth;
+  metrics.max_depth = max_depth_.load(std::memory_order_relaxed);
+  return metrics;
+}
+
+EncoderPipeline::EncoderPipeline(const PipelineOptions &options)
+    : options_(options),
+      input_(options.queue_capacity),
+      completions_(options.queue_capacity) {
+  assert(options_.num_workers > 0);
+  for (int i = 0; i < options_.num_workers; i++)
+    workers_.emplace_back(&EncoderPipeline::work, this);
+  if (options_.order == ResultOrder::kSubmission)
+    sequencer_ = std::thread(&EncoderPipeline::sequence, this);
+}
+
+EncoderPipeline::~EncoderPipeline() { close(); }
+
+bool EncoderPipeline::push(Job &job, bool *closed) {
+  std::lock_guard<std::mutex> lock(submit_mutex_);
+  *closed = !accepting_;
+  if (*closed) return false;
+  job.id = next_id_;
+  job.submitted = Clock::now();
+  if (!input_.try_push(std::move(job))) return false;
+  next_id_++;
+  submitted_.fetch_add(1, std::memory_order_release);
+  queue_stage_.track_depth(input_.size());
+  return true;
+}
+
+std::future<EncodeResult> EncoderPipeline::submit(EncodeRequest request) {
+  Job job;
+  job.request = std::move(request);
+  auto result = job.promise.get_future();
+  Backoff backoff;
+  bool closed;
+  while (!push(job, &closed) && !closed) {
+    rejected_.fetch_add(1, std::memory_order_relaxed);
+    backoff.wait();
+  }
+  return result;
+}
+
+bool EncoderPipeline::try_submit(EncodeRequest &request,
+                                 std::future<EncodeResult> *result) {
+  Job job;
+  job.request = std::move(request);
+  auto future = job.promise.get_future();
+  bool closed;
+  if (!push(job, &closed)) {
+    request = std::move(job.request);
+    rejected_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  *result = std::move(future);
+  return true;
+}
+
+void EncoderPipeline::close() {
+  {
+    std::lock_guard<std::mutex> lock(submit_mutex_);
+    if (!accepting_) return;
+    accepting_ = false;
+  }
+  Backoff backoff;
+  while (encoded_.load(std::memory_order_acquire) !=
+         submitted_.load(std::memory_order_acquire))
+    backoff.wait();
+  stop_.store(true, std::memory_order_release);
+  for (auto &worker : workers_) worker.join();
+  if (sequencer_.joinable()) sequencer_.join();
+}
+
+void EncoderPipeline::work() {
+  Backoff backoff;
+  Job job;
+  while (!stop_.load(std::memory_order_acquire)) {
+    if (!input_.try_pop(job)) {
+      backoff.wait();
+      continue;
+    }
+    backoff.reset();
+    auto start = Clock::now();
+    queue_stage_.record(start - job.submitted);
+    // An exception escaping the thread would terminate the process.
+    EncodeResult result;
+    std::exception_ptr error;
+    try {
+      result = encode(job.request);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    auto finished = Clock::now();
+    encode_stage_.record(finished - start);
+
+    if (options_.order == ResultOrder::kCompletion) {
+      if (error)
+        job.promise.set_exception(error);
+      else
+        job.promise.set_value(std::move(result));
+      reorder_stage_.record(Clock::now() - finished);
+    } else {
+      Completion completion{job.id, std::move(result), error,
+                            std::move(job.promise), finished};
+      while (!completions_.try_push(std::move(completion))) backoff.wait();
+      backoff.reset();
+      size_t held = reorder_depth_.load(std::memory_order_relaxed);
+      reorder_stage_.track_depth(completions_.size() + held);
+    }
+    encoded_.fetch_add(1, std::memory_order_release);
+  }
+}
+
+void EncoderPipeline::sequence() {
+  Backoff backoff;
+  std::map<uint64_t, Completion> pending;
+  uint64_t next = 0;
+  Completion completion;
+  while (!stop_.load(std::memory_order_acquire) ||
+         next != submitted_.load(std::memory_order_acquire)) {
+    if (!completions_.try_pop(completion)) {
+      backoff.wait();
+      continue;
+    }
+    backoff.reset();
+    uint64_t id = completion.id;
+    pending.emplace(id, std::move(completion));
+    for (auto it = pending.begin(); it != pending.end() && it->first == next;
+         it = pending.erase(it), next++) {
+      if (it->second.error)
+        it->second.promise.set_exception(it->second.error);
+      else
+        it->second.promise.set_value(std::move(it->second.result));
+      reorder_stage_.record(Clock::now() - it->second.finished);
+    }
+    reorder_depth_.store(pending.size(), std::memory_order_relaxed);
+  }
+}
+
+PipelineMetrics EncoderPipeline::metrics() const {
+  PipelineMetrics metrics;
+  metrics.queue = queue_stage_.snapshot(input_.size());
+  metrics.encode = encode_stage_.snapshot(0);
+  metrics.encode.depth = metrics.queue.count - metrics.encode.count;
+  metrics.reorder = reorder_stage_.snapshot(
+      completions_.size() + reorder_depth_.load(std::memory_order_relaxed));
+  metrics.rejected = rejected_.load(std::memory_order_relaxed);
+  return metrics;
+}
+}  // namespace rcc::pipeline
@@ -0,0 +1,138 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_PIPELINE_ENCODER_PIPELINE_H_
+#define THIRD_PARTY_HYBRID_RCC_PIPELINE_ENCODER_PIPELINE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "pipeline/encoder.h"
+#include "pipeline/mpmc_queue.h"
+
+// Asynchronous encoder for a stream of (q, p) requests.
+//
+//   submit() --> [input queue] --> workers --> [completion queue] --> sequencer
+//
+// Workers run encode() on requests they pop from the input queue. With
+// ResultOrder::kSubmission a sequencer thread holds finished requests back
+// until all earlier ones are done, so futures become ready in submission
+// order; with ResultOrder::kCompletion workers fulfil the futures directly.
+// An exception thrown by encode() is stored in the request's future, in the
+// same order, and the pipeline keeps running.
+// submit() blocks while the input queue is full and try_submit() fails
+// instead, which is how backpressure reaches the caller.
+namespace rcc::pipeline {
+enum class ResultOrder { kSubmission, kCompletion };
+
+struct PipelineOptions {
+  int num_workers = std::max(1u, std::thread::hardware_concurrency());
+  size_t queue_capacity = 1024;
+  ResultOrder order = ResultOrder::kSubmission;
+};
+
+// Latencies are in milliseconds, depths in number of requests.
+struct StageMetrics {
+  uint64_t count = 0;
+  double mean_latency = 0, max_latency = 0;
+  size_t depth = 0, max_depth = 0;
+};
+
+// queue: submit() until a worker picks the request up.
+// encode: time spent in encode().
+// reorder: end of encode() until the future is fulfilled.
+// rejected: submission attempts that found the input queue full.
+struct PipelineMetrics {
+  StageMetrics queue, encode, reorder;
+  uint64_t rejected = 0;
+};
+
+class EncoderPipeline {
+ public:
+  explicit EncoderPipeline(const PipelineOptions &options = PipelineOptions());
+  EncoderPipeline(const EncoderPipeline &) = delete;
+  EncoderPipeline &operator=(const EncoderPipeline &) = delete;
+  ~EncoderPipeline();
+
+  // Submitting to a closed pipeline returns a future with a broken promise.
+  std::future<EncodeResult> submit(EncodeRequest request);
+  // Returns false, leaving request untouched, when the input queue is full.
+  bool try_submit(EncodeRequest &request, std::future<EncodeResult> *result);
+  // Stops accepting requests, waits for the submitted ones and joins the
+  // threads. Called by the destructor.
+  void close();
+
+  PipelineMetrics metrics() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Job {
+    uint64_t id = 0;
+    EncodeRequest request;
+    std::promise<EncodeResult> promise;
+    Clock::time_point submitted;
+  };
+  struct Completion {
+    uint64_t id = 0;
+    EncodeResult result;
+    // Set instead of result when encode() threw.
+    std::exception_ptr error;
+    std::promise<EncodeResult> promise;
+    Clock::time_point finished;
+  };
+
+  class StageCounter {
+   public:
+    void record(Clock::duration latency);
+    void track_depth(size_t depth);
+    StageMetrics snapshot(size_t depth) const;
+
+   private:
+    std::atomic<uint64_t> count_{0}, total_ns_{0}, max_ns_{0};
+    std::atomic<size_t> max_depth_{0};
+  };
+
+  // Fails when the input queue is full or the pipeline is closed.
+  bool push(Job &job, bool *closed);
+  void work();
+  void sequence();
+
+  PipelineOptions options_;
+  MpmcQueue<Job> input_;
+  MpmcQueue<Completion> completions_;
+  std::vector<std::thread> workers_;
+  std::thread sequencer_;
+
+  // Serializes producers so that ids are handed out in queue order.
+  std::mutex submit_mutex_;
+  bool accepting_ = true;
+  uint64_t next_id_ = 0;
+  std::atomic<uint64_t> submitted_{0}, encoded_{0}, rejected_{0};
+  std::atomic<bool> stop_{false};
+  std::atomic<size_t> reorder_depth_{0};
+  StageCounter queue_stage_, encode_stage_, reorder_stage_;
+};
+}  // namespace rcc::pipeline
+
+#endif  // THIRD_PARTY_HYBRID_RCC_PIPELINE_ENCODER_PIPELINE_H_
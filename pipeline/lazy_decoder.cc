@@ -0,0 +1,204 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pipeline/lazy_decoder.h"
+
+#include <exception>
+#include <iostream>
+
+#include "pipeline/encoder.h"
+
+namespace rcc::pipeline {
+namespace {
+bool open_prior(MappedFile *file, const std::string &path,
+                uint64_t num_parameters) {
+  if (!file->open(path)) return false;
+  if (file->size() != num_parameters * sizeof(float)) {
+    std::cerr << path << " holds " << file->size() / sizeof(float)
+              << " parameters, expected " << num_parameters << std::endl;
+    file->close();
+    return false;
+  }
+  file->advise_random();
+  return true;
+}
+}  // namespace
+
+bool LazyDecoder::open(const std::string &container, const std::string &p_mean,
+                       const std::string &p_std) {
+  clear();
+  p_mean_.close();
+  p_std_.close();
+  if (!reader_.open(container)) return false;
+  const ContainerHeader &header = reader_.header();
+  if (header.prior.kind == PriorDescription::Kind::kIsotropic) return true;
+  std::string mean_path = p_mean, std_path = p_std;
+  if (mean_path.empty() || std_path.empty()) {
+    size_t split = header.prior.source.find('\n');
+    if (split == std::string::npos) {
+      std::cerr << container << " does not name its prior" << std::endl;
+      return false;
+    }
+    mean_path = header.prior.source.substr(0, split);
+    std_path = header.prior.source.substr(split + 1);
+  }
+  return open_prior(&p_mean_, mean_path, header.num_parameters) &&
+         open_prior(&p_std_, std_path, header.num_parameters);
+}
+
+LazyDecoder::Block LazyDecoder::lookup(uint64_t block) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = index_.find(block);
+  if (it == index_.end()) return nullptr;
+  lru_.splice(lru_.begin(), lru_, it->second);
+  return it->second->second;
+}
+
+LazyDecoder::Block LazyDecoder::decode(uint64_t block) {
+  auto start = Clock::now();
+  EncodeResult result;
+  if (!reader_.read_block(block, &result)) {
+    failures_.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  const ContainerHeader &header = reader_.header();
+  uint64_t offset = reader_.parameter_offset(block);
+  int dim = header.block_dim(block);
+  Eigen::ArrayXd p_mean, p_std;
+  if (header.prior.kind == PriorDescription::Kind::kIsotropic) {
+    p_mean = Eigen::ArrayXd::Constant(dim, header.prior.mean);
+    p_std = Eigen::ArrayXd::Constant(dim, header.prior.std);
+  } else {
+    auto read = [&](const MappedFile &file) -> Eigen::ArrayXd {
+      return Eigen::Map<const Eigen::ArrayXf>(
+                 reinterpret_cast<const float *>(file.data()) + offset, dim)
+          .cast<double>();
+    };
+    p_mean = read(p_mean_);
+    p_std = read(p_std_);
+  }
+  auto values = std::make_shared<const Eigen::ArrayXd>(
+      pipeline::decode(result, p_mean, p_std));
+  uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    Clock::now() - start)
+                    .count();
+  decoded_.fetch_add(1, std::memory_order_relaxed);
+  total_ns_.fetch_add(ns, std::memory_order_relaxed);
+  update_max(max_ns_, ns);
+  return values;
+}
+
+void LazyDecoder::insert(uint64_t block, const Block &values) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (index_.count(block)) return;
+  lru_.emplace_front(block, values);
+  index_[block] = lru_.begin();
+  cached_bytes_ += values->size() * sizeof(double);
+  while (cached_bytes_ > options_.cache_bytes && !lru_.empty()) {
+    cached_bytes_ -= lru_.back().second->size() * sizeof(double);
+    index_.erase(lru_.back().first);
+    lru_.pop_back();
+    evictions_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+LazyDecoder::Block LazyDecoder::get(uint64_t block) {
+  if (Block values = lookup(block)) {
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return values;
+  }
+  misses_.fetch_add(1, std::memory_order_relaxed);
+  Block values = decode(block);
+  if (values) insert(block, values);
+  return values;
+}
+
+std::vector<LazyDecoder::Block> LazyDecoder::get(
+    const std::vector<uint64_t> &blocks) {
+  std::vector<Block> values(blocks.size());
+  // Positions of every missing block, so that repeats decode once.
+  std::unordered_map<uint64_t, std::vector<size_t>> missing;
+  std::vector<uint64_t> cold;
+  for (size_t i = 0; i < blocks.size(); i++) {
+    values[i] = lookup(blocks[i]);
+    if (values[i]) {
+      hits_.fetch_add(1, std::memory_order_relaxed);
+      continue;
+    }
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    auto &positions = missing[blocks[i]];
+    if (positions.empty()) cold.push_back(blocks[i]);
+    positions.push_back(i);
+  }
+
+  std::vector<Block> decoded(cold.size());
+  std::atomic<size_t> next{0};
+  size_t num_threads =
+      std::min<size_t>(std::max(1, options_.num_workers), cold.size());
+  std::vector<std::exception_ptr> errors(num_threads);
+  auto work = [&](size_t self) {
+    try {
+      for (size_t j; (j = next.fetch_add(1)) < cold.size();)
+        decoded[j] = decode(cold[j]);
+    } catch (...) {
+      errors[self] = std::current_exception();
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < num_threads; t++) {
+    try {
+      threads.emplace_back(work, t);
+    } catch (...) {
+      // The blocks are shared out dynamically, so this thread takes the
+      // share of the workers that failed to start.
+      break;
+    }
+  }
+  work(0);
+  for (auto &thread : threads) thread.join();
+
+  for (size_t j = 0; j < cold.size(); j++) {
+    if (decoded[j]) insert(cold[j], decoded[j]);
+    for (size_t i : missing[cold[j]]) values[i] = decoded[j];
+  }
+  // The blocks decoded before the failure stay cached.
+  for (const auto &error : errors)
+    if (error) std::rethrow_exception(error);
+  return values;
+}
+
+void LazyDecoder::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  lru_.clear();
+  index_.clear();
+  cached_bytes_ = 0;
+}
+
+LazyDecoderMetrics LazyDecoder::metrics() const {
+  LazyDecoderMetrics metrics;
+  metrics.hits = hits_.load(std::memory_order_relaxed);
+  metrics.misses = misses_.load(std::memory_order_relaxed);
+  metrics.evictions = evictions_.load(std::memory_order_relaxed);
+  metrics.failures = failures_.load(std::memory_order_relaxed);
+  uint64_t decoded = decoded_.load(std::memory_order_relaxed);
+  metrics.mean_decode_latency =
+      decoded ? total_ns_.load(std::memory_order_relaxed) * 1e-6 / decoded
+              : 0;
+  metrics.max_decode_latency = max_ns_.load(std::memory_order_relaxed) * 1e-6;
+  std::lock_guard<std::mutex> lock(mutex_);
+  metrics.cached_blocks = lru_.size();
+  metrics.cached_bytes = cached_bytes_;
+  return metrics;
+}
+}  // namespace rcc::pipeline
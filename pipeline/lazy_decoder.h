@@ -0,0 +1,111 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_PIPELINE_LAZY_DECODER_H_
+#define THIRD_PARTY_HYBRID_RCC_PIPELINE_LAZY_DECODER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Eigen/Core"
+#include "pipeline/block_container.h"
+#include "pipeline/mapped_file.h"
+
+// On-demand decoding of a block container.
+//
+// Opening maps the container and the prior and decodes nothing. A block is
+// decoded the first time it is asked for and its reconstruction is kept in
+// an LRU cache bounded by the bytes of the cached arrays. Batched lookups
+// decode their cold misses on up to num_workers threads. Blocks are handed
+// out as shared pointers, so evicting a block never invalidates an array a
+// caller still holds.
+//
+// Concurrent misses on the same block may both decode it; the results are
+// identical and the second one to finish is dropped.
+namespace rcc::pipeline {
+struct LazyDecoderOptions {
+  size_t cache_bytes = size_t(1) << 28;
+  int num_workers = std::max(1u, std::thread::hardware_concurrency());
+};
+
+// Latencies are in milliseconds and cover decoding one block.
+struct LazyDecoderMetrics {
+  uint64_t hits = 0, misses = 0, evictions = 0, failures = 0;
+  double mean_decode_latency = 0, max_decode_latency = 0;
+  size_t cached_blocks = 0, cached_bytes = 0;
+};
+
+class LazyDecoder {
+ public:
+  using Block = std::shared_ptr<const Eigen::ArrayXd>;
+
+  explicit LazyDecoder(const LazyDecoderOptions &options = LazyDecoderOptions())
+      : options_(options) {}
+  LazyDecoder(const LazyDecoder &) = delete;
+  LazyDecoder &operator=(const LazyDecoder &) = delete;
+
+  // Maps the container and, for an external prior, the float32 prior files.
+  // Empty paths fall back to the prior source recorded in the container.
+  bool open(const std::string &container, const std::string &p_mean = "",
+            const std::string &p_std = "");
+  const ContainerHeader &header() const { return reader_.header(); }
+  uint64_t num_blocks() const { return reader_.num_blocks(); }
+
+  // The reconstruction of block, or null after logging why it failed.
+  Block get(uint64_t block);
+  // The reconstructions of blocks, in order, with the misses decoded in
+  // parallel. An exception thrown by a decode is rethrown here once every
+  // worker has finished.
+  std::vector<Block> get(const std::vector<uint64_t> &blocks);
+
+  // Drops every cached block.
+  void clear();
+  LazyDecoderMetrics metrics() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+  using Entry = std::pair<uint64_t, Block>;
+
+  Block lookup(uint64_t block);
+  Block decode(uint64_t block);
+  void insert(uint64_t block, const Block &values);
+
+  LazyDecoderOptions options_;
+  ContainerReader reader_;
+  MappedFile p_mean_, p_std_;
+
+  // Most recently used first.
+  mutable std::mutex mutex_;
+  std::list<Entry> lru_;
+  std::unordered_map<uint64_t, std::list<Entry>::iterator> index_;
+  size_t cached_bytes_ = 0;
+
+  std::atomic<uint64_t> hits_{0}, misses_{0}, evictions_{0}, failures_{0};
+  std::atomic<uint64_t> decoded_{0}, total_ns_{0}, max_ns_{0};
+};
+}  // namespace rcc::pipeline
+
+#endif  // THIRD_PARTY_HYBRID_RCC_PIPELINE_LAZY_DECODER_H_
@@ -0,0 +1,167 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pipeline/local_socket.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+namespace rcc::pipeline {
+namespace {
+bool make_address(const std::string &path, sockaddr_un *address) {
+  std::memset(address, 0, sizeof(*address));
+  address->sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address->sun_path)) {
+    std::cerr << "socket path too long: " << path << std::endl;
+    return false;
+  }
+  std::memcpy(address->sun_path, path.c_str(), path.size());
+  return true;
+}
+
+int local_socket() {
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0)
+    std::cerr << "cannot create socket: " << std::strerror(errno) << std::endl;
+  return fd;
+}
+
+#ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+}  // namespace
+
+int listen_local(const std::string &path, int backlog) {
+  sockaddr_un address;
+  if (!make_address(path, &address)) return -1;
+  int fd = local_socket();
+  if (fd < 0) return -1;
+  unlink(path.c_str());
+  if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+      listen(fd, backlog) != 0) {
+    std::cerr << "cannot listen on " << path << ": " << std::strerror(errno)
+              << std::endl;
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+int connect_local(const std::string &path) {
+  sockaddr_un address;
+  if (!make_address(path, &address)) return -1;
+  int fd = local_socket();
+  if (fd < 0) return -1;
+  if (connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) !=
+      0) {
+    std::cerr << "cannot connect to " << path << ": " << std::strerror(errno)
+              << std::endl;
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+bool send_all(int fd, const void *data, size_t size) {
+  const char *p = static_cast<const char *>(data);
+  while (size > 0) {
+    ssize_t sent = send(fd, p, size, kSendFlags);
+    if (sent < 0 && errno == EINTR) continue;
+    if (sent <= 0) {
+      if (errno != EPIPE && errno != ECONNRESET)
+        std::cerr << "send failed: " << std::strerror(errno) << std::endl;
+      return false;
+    }
+    p += sent;
+    size -= sent;
+  }
+  return true;
+}
+
+bool receive_all(int fd, void *data, size_t size) {
+  char *p = static_cast<char *>(data);
+  while (size > 0) {
+    ssize_t received = recv(fd, p, size, 0);
+    if (received < 0 && errno == EINTR) continue;
+    if (received == 0) return false;
+    if (received < 0) {
+      if (errno != ECONNRESET)
+        std::cerr << "recv failed: " << std::strerror(errno) << std::endl;
+      return false;
+    }
+    p += received;
+    size -= received;
+  }
+  return true;
+}
+
+bool send_with_fd(int fd, const void *data, size_t size, int passed_fd) {
+  iovec io{const_cast<void *>(data), size};
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+  msghdr message{};
+  message.msg_iov = &io;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+  cmsghdr *header = CMSG_FIRSTHDR(&message);
+  header->cmsg_level = SOL_SOCKET;
+  header->cmsg_type = SCM_RIGHTS;
+  header->cmsg_len = CMSG_LEN(sizeof(int));
+  std::memcpy(CMSG_DATA(header), &passed_fd, sizeof(int));
+  ssize_t sent;
+  do {
+    sent = sendmsg(fd, &message, kSendFlags);
+  } while (sent < 0 && errno == EINTR);
+  if (sent <= 0) {
+    std::cerr << "sendmsg failed: " << std::strerror(errno) << std::endl;
+    return false;
+  }
+  // The descriptor went with the first byte; the rest is plain data.
+  return send_all(fd, static_cast<const char *>(data) + sent, size - sent);
+}
+
+bool receive_with_fd(int fd, void *data, size_t size, int *passed_fd) {
+  *passed_fd = -1;
+  iovec io{data, size};
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+  msghdr message{};
+  message.msg_iov = &io;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+  ssize_t received;
+  do {
+    received = recvmsg(fd, &message, 0);
+  } while (received < 0 && errno == EINTR);
+  if (received <= 0) {
+    if (received < 0)
+      std::cerr << "recvmsg failed: " << std::strerror(errno) << std::endl;
+    return false;
+  }
+  for (cmsghdr *header = CMSG_FIRSTHDR(&message); header;
+       header = CMSG_NXTHDR(&message, header)) {
+    if (header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS)
+      std::memcpy(passed_fd, CMSG_DATA(header), sizeof(int));
+  }
+  return receive_all(fd, static_cast<char *>(data) + received,
+                     size - received);
+}
+}  // namespace rcc::pipeline
@@ -0,0 +1,39 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_PIPELINE_LOCAL_SOCKET_H_
+#define THIRD_PARTY_HYBRID_RCC_PIPELINE_LOCAL_SOCKET_H_
+
+#include <cstddef>
+#include <string>
+
+// Blocking helpers over Unix domain stream sockets. Failures are logged and
+// reported as false or -1; a peer closing the connection is not logged.
+namespace rcc::pipeline {
+// Binds path, replacing a stale socket file, and listens on it.
+int listen_local(const std::string &path, int backlog = 64);
+int connect_local(const std::string &path);
+
+bool send_all(int fd, const void *data, size_t size);
+bool receive_all(int fd, void *data, size_t size);
+
+// Like send_all and receive_all, passing the descriptor passed_fd along
+// with the data. The received descriptor is -1 if none came with it.
+bool send_with_fd(int fd, const void *data, size_t size, int passed_fd);
+bool receive_with_fd(int fd, void *data, size_t size, int *passed_fd);
+}  // namespace rcc::pipeline
+
+#endif  // THIRD_PARTY_HYBRID_RCC_PIPELINE_LOCAL_SOCKET_H_
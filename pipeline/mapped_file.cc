@@ -0,0 +1,210 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pipeline/mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <utility>
+
+namespace rcc::pipeline {
+namespace {
+#ifdef __linux__
+constexpr int kSizeSeals = F_SEAL_SHRINK | F_SEAL_GROW;
+#endif
+
+size_t page_size() {
+  static const size_t size = sysconf(_SC_PAGESIZE);
+  return size;
+}
+
+// Largest page aligned range inside [offset, offset + length), or with
+// round_out the smallest one containing it. The last page of the file counts
+// as full.
+std::pair<size_t, size_t> page_range(size_t offset, size_t length,
+                                     size_t size, bool round_out) {
+  size_t page = page_size();
+  size_t end = std::min(offset + length, size);
+  if (round_out) {
+    offset = offset / page * page;
+    end = (end + page - 1) / page * page;
+  } else {
+    offset = (offset + page - 1) / page * page;
+    if (end != size) end = end / page * page;
+  }
+  return {offset, end > offset ? end - offset : 0};
+}
+}  // namespace
+
+MappedFile::MappedFile(MappedFile &&other) noexcept {
+  *this = std::move(other);
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    close();
+    std::swap(fd_, other.fd_);
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    std::swap(writable_, other.writable_);
+  }
+  return *this;
+}
+
+MappedFile::~MappedFile() { close(); }
+
+bool MappedFile::open(const std::string &path) {
+  close();
+  fd_ = ::open(path.c_str(), O_RDONLY);
+  if (fd_ < 0) {
+    std::cerr << "cannot open " << path << ": " << std::strerror(errno)
+              << std::endl;
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd_, &st) != 0) {
+    std::cerr << "cannot stat " << path << ": " << std::strerror(errno)
+              << std::endl;
+    close();
+    return false;
+  }
+  size_ = st.st_size;
+  writable_ = false;
+  return map(PROT_READ);
+}
+
+bool MappedFile::create(const std::string &path, size_t size) {
+  close();
+  fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd_ < 0 || ftruncate(fd_, size) != 0) {
+    std::cerr << "cannot create " << path << ": " << std::strerror(errno)
+              << std::endl;
+    close();
+    return false;
+  }
+  size_ = size;
+  writable_ = true;
+  return map(PROT_READ | PROT_WRITE);
+}
+
+bool MappedFile::create_shared(size_t size) {
+  close();
+#ifdef __linux__
+  fd_ = memfd_create("rcc", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+#else
+  // Unlinked right away, so the segment lives exactly as long as its
+  // descriptors and mappings.
+  std::string name = "/rcc-" + std::to_string(getpid()) + "-" +
+                     std::to_string(reinterpret_cast<uintptr_t>(this));
+  fd_ = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd_ >= 0) shm_unlink(name.c_str());
+#endif
+  bool created = fd_ >= 0 && ftruncate(fd_, size) == 0;
+#ifdef __linux__
+  // Fixes the size for good, so that the receiving process can map it
+  // without being exposed to SIGBUS, see adopt_shared.
+  created = created &&
+            fcntl(fd_, F_ADD_SEALS, kSizeSeals | F_SEAL_SEAL) == 0;
+#endif
+  if (!created) {
+    std::cerr << "cannot create shared memory: " << std::strerror(errno)
+              << std::endl;
+    close();
+    return false;
+  }
+  size_ = size;
+  writable_ = true;
+  return map(PROT_READ | PROT_WRITE);
+}
+
+bool MappedFile::adopt_shared(int fd, size_t size) {
+  close();
+  fd_ = fd;
+#ifdef __linux__
+  // The sender could otherwise truncate the memory under the mapping, and
+  // the next access beyond the new end would raise SIGBUS here.
+  int seals = fcntl(fd_, F_GET_SEALS);
+  if (seals < 0 || (seals & kSizeSeals) != kSizeSeals) {
+    std::cerr << "shared memory is not sealed against resizing" << std::endl;
+    close();
+    return false;
+  }
+#endif
+  // Elsewhere this is the only check. macOS, which the shm_open path of
+  // create_shared is for, does not resize a shared memory object again
+  // once it has a size.
+  struct stat st;
+  if (fstat(fd_, &st) != 0 || static_cast<size_t>(st.st_size) < size) {
+    std::cerr << "shared memory is smaller than " << size << " bytes"
+              << std::endl;
+    close();
+    return false;
+  }
+  size_ = size;
+  writable_ = true;
+  return map(PROT_READ | PROT_WRITE);
+}
+
+bool MappedFile::map(int prot) {
+  if (size_ == 0) return true;
+  void *data = mmap(nullptr, size_, prot, MAP_SHARED, fd_, 0);
+  if (data == MAP_FAILED) {
+    std::cerr << "mmap failed: " << std::strerror(errno) << std::endl;
+    close();
+    return false;
+  }
+  data_ = static_cast<char *>(data);
+  madvise(data_, size_, MADV_SEQUENTIAL);
+  return true;
+}
+
+void MappedFile::close() {
+  if (data_) munmap(data_, size_);
+  if (fd_ >= 0) ::close(fd_);
+  fd_ = -1;
+  data_ = nullptr;
+  size_ = 0;
+  writable_ = false;
+}
+
+void MappedFile::prefetch(size_t offset, size_t length) const {
+  auto [start, bytes] = page_range(offset, length, size_, true);
+  if (data_ && bytes) madvise(data_ + start, bytes, MADV_WILLNEED);
+}
+
+size_t MappedFile::release(size_t offset, size_t length) const {
+  auto [start, bytes] = page_range(offset, length, size_, false);
+  if (!bytes) return offset;
+  if (data_) madvise(data_ + start, bytes, MADV_DONTNEED);
+  return start + bytes;
+}
+
+void MappedFile::flush(size_t offset, size_t length) const {
+  auto [start, bytes] = page_range(offset, length, size_, true);
+  if (data_ && writable_ && bytes) msync(data_ + start, bytes, MS_ASYNC);
+}
+
+void MappedFile::advise_random() const {
+  if (data_) madvise(data_, size_, MADV_RANDOM);
+}
+}  // namespace rcc::pipeline
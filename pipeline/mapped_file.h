@@ -0,0 +1,84 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_PIPELINE_MAPPED_FILE_H_
+#define THIRD_PARTY_HYBRID_RCC_PIPELINE_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <string>
+
+namespace rcc::pipeline {
+// A file mapped into memory with mmap.
+//
+// Streaming readers and writers keep their resident set bounded by
+// prefetching the range they will touch next and releasing the range they
+// are done with. Released pages of a read-only mapping are simply dropped;
+// released pages of a writable mapping stay in the page cache and reach the
+// file on flush() or unmap.
+class MappedFile {
+ public:
+  MappedFile() = default;
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  ~MappedFile();
+
+  // Maps an existing file read-only.
+  bool open(const std::string &path);
+  // Creates or truncates path to size bytes and maps it writable.
+  bool create(const std::string &path, size_t size);
+  // Creates size bytes of anonymous shared memory and maps them writable.
+  // Its descriptor, fd(), can be passed to another process. On Linux it is
+  // a memfd sealed against shrinking and growing.
+  bool create_shared(size_t size);
+  // Takes ownership of a shared memory descriptor received from another
+  // process and maps its first size bytes writable. On Linux the
+  // descriptor must carry the seals of create_shared, so that the sender
+  // can not shrink the memory while it is mapped here.
+  bool adopt_shared(int fd, size_t size);
+  void close();
+
+  bool is_open() const { return fd_ >= 0; }
+  int fd() const { return fd_; }
+  const char *data() const { return data_; }
+  char *mutable_data() { return writable_ ? data_ : nullptr; }
+  size_t size() const { return size_; }
+
+  // Hints that [offset, offset + length) will be read soon, so the kernel
+  // reads it ahead while the caller keeps computing.
+  void prefetch(size_t offset, size_t length) const;
+  // Drops the pages fully inside [offset, offset + length) from the
+  // resident set and returns the end of the dropped range, from where the
+  // next call should continue.
+  size_t release(size_t offset, size_t length) const;
+  // Starts writing back the dirty pages of [offset, offset + length).
+  void flush(size_t offset, size_t length) const;
+  // Turns off the sequential read ahead of new mappings for readers that
+  // seek around the file.
+  void advise_random() const;
+
+ private:
+  bool map(int prot);
+
+  int fd_ = -1;
+  char *data_ = nullptr;
+  size_t size_ = 0;
+  bool writable_ = false;
+};
+}  // namespace rcc::pipeline
+
+#endif  // THIRD_PARTY_HYBRID_RCC_PIPELINE_MAPPED_FILE_H_
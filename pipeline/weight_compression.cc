@@ -0,0 +1,220 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pipeline/weight_compression.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <deque>
+#include <future>
+#include <iostream>
+#include <utility>
+
+#include "Eigen/Core"
+#include "pipeline/block_container.h"
+#include "pipeline/encoded_stream.h"
+#include "pipeline/mapped_file.h"
+
+namespace rcc::pipeline {
+namespace {
+using Clock = std::chrono::steady_clock;
+
+// A float32 parameter file that is read front to back.
+class ParameterStream {
+ public:
+  bool open(const std::string &path) {
+    if (!file_.open(path)) return false;
+    if (file_.size() % sizeof(float) != 0) {
+      std::cerr << path << " is not a float32 file" << std::endl;
+      return false;
+    }
+    return true;
+  }
+  uint64_t size() const { return file_.size() / sizeof(float); }
+
+  Eigen::ArrayXd read(uint64_t offset, int n) const {
+    return Eigen::Map<const Eigen::ArrayXf>(
+               reinterpret_cast<const float *>(file_.data()) + offset, n)
+        .cast<double>();
+  }
+  void prefetch(uint64_t offset, uint64_t n) const {
+    file_.prefetch(offset * sizeof(float), n * sizeof(float));
+  }
+  // Drops everything before parameter end.
+  void release(uint64_t end) {
+    released_ = file_.release(released_, end * sizeof(float) - released_);
+  }
+
+ private:
+  MappedFile file_;
+  size_t released_ = 0;
+};
+
+bool open_all(ParameterStream *streams, const std::string *paths, int n,
+              uint64_t size) {
+  for (int i = 0; i < n; i++) {
+    if (!streams[i].open(paths[i])) return false;
+    if (streams[i].size() != size) {
+      std::cerr << paths[i] << " holds " << streams[i].size()
+                << " parameters, expected " << size << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+bool compress_weights(const WeightFiles &input, const std::string &output,
+                      const CompressionOptions &options,
+                      CompressionStats *stats) {
+  assert(options.block_size > 0 && options.chunk_blocks > 0);
+  auto start = Clock::now();
+  const std::string paths[4] = {input.q_mean, input.q_std, input.p_mean,
+                                input.p_std};
+  ParameterStream streams[4];
+  if (!streams[0].open(paths[0])) return false;
+  if (!open_all(streams, paths, 4, streams[0].size())) return false;
+
+  StreamHeader header;
+  header.num_parameters = streams[0].size();
+  header.block_size = options.block_size;
+  header.seed = options.seed;
+  header.eps = options.eps;
+  EncodedStreamWriter writer;
+  ContainerWriter container;
+  if (options.seekable) {
+    ContainerHeader container_header;
+    container_header.num_parameters = header.num_parameters;
+    container_header.block_size = header.block_size;
+    container_header.seed = header.seed;
+    container_header.eps = header.eps;
+    container_header.prior.source = input.p_mean + "\n" + input.p_std;
+    if (!container.open(output, container_header)) return false;
+  } else if (!writer.open(output, header)) {
+    return false;
+  }
+
+  PipelineOptions pipeline_options = options.pipeline;
+  pipeline_options.order = ResultOrder::kSubmission;
+  EncoderPipeline pipeline(pipeline_options);
+  // Futures of submitted blocks, oldest first. Bounding them bounds the
+  // number of finished results waiting for the writer.
+  std::deque<std::future<EncodeResult>> pending;
+  const size_t max_pending = 2 * pipeline_options.queue_capacity;
+  bool ok = true;
+  auto write_oldest = [&]() {
+    EncodeResult result = pending.front().get();
+    ok = (options.seekable ? container.write_block(result)
+                           : writer.write_block(result)) &&
+         ok;
+    pending.pop_front();
+  };
+
+  const uint64_t num_blocks = header.num_blocks();
+  const uint64_t chunk = options.chunk_blocks * options.block_size;
+  for (auto &stream : streams) stream.prefetch(0, chunk);
+  for (uint64_t first = 0; first < num_blocks; first += options.chunk_blocks) {
+    uint64_t last = std::min(num_blocks, first + options.chunk_blocks);
+    uint64_t end = std::min(header.num_parameters, last * options.block_size);
+    for (auto &stream : streams) stream.prefetch(end, chunk);
+
+    for (uint64_t block = first; block < last; block++) {
+      uint64_t offset = block * options.block_size;
+      int dim = header.block_dim(block);
+      EncodeRequest request;
+      request.q_mean = streams[0].read(offset, dim);
+      request.q_std = streams[1].read(offset, dim);
+      request.p_mean = streams[2].read(offset, dim);
+      request.p_std = streams[3].read(offset, dim);
+      request.hybrid = true;
+      request.pfr = options.pfr;
+      request.eps = options.eps;
+      request.seed = options.seed + block;
+      request.N_max = options.N_max;
+      pending.push_back(pipeline.submit(std::move(request)));
+      while (pending.size() > max_pending) write_oldest();
+    }
+    // Requests own copies of their parameters.
+    for (auto &stream : streams) stream.release(end);
+  }
+  while (!pending.empty()) write_oldest();
+  pipeline.close();
+  ok = (options.seekable ? container.close() : writer.close()) && ok;
+
+  if (stats) {
+    stats->num_parameters = header.num_parameters;
+    stats->num_blocks = num_blocks;
+    stats->encoded_bytes = options.seekable ? container.bytes_written()
+                                            : writer.bytes_written();
+    stats->seconds =
+        std::chrono::duration<double>(Clock::now() - start).count();
+  }
+  if (!ok) std::cerr << "writing " << output << " failed" << std::endl;
+  return ok;
+}
+
+bool decompress_weights(const std::string &input, const std::string &p_mean,
+                        const std::string &p_std, const std::string &output,
+                        size_t chunk_blocks, CompressionStats *stats) {
+  assert(chunk_blocks > 0);
+  auto start = Clock::now();
+  EncodedStreamReader reader;
+  if (!reader.open(input)) return false;
+  const StreamHeader &header = reader.header();
+
+  const std::string paths[2] = {p_mean, p_std};
+  ParameterStream prior[2];
+  if (!open_all(prior, paths, 2, header.num_parameters)) return false;
+  MappedFile out;
+  if (!out.create(output, header.num_parameters * sizeof(float))) return false;
+  float *weights = reinterpret_cast<float *>(out.mutable_data());
+
+  const uint64_t num_blocks = header.num_blocks();
+  const uint64_t chunk = chunk_blocks * header.block_size;
+  size_t released = 0;
+  EncodeResult result;
+  for (auto &stream : prior) stream.prefetch(0, chunk);
+  for (uint64_t first = 0; first < num_blocks; first += chunk_blocks) {
+    uint64_t last = std::min<uint64_t>(num_blocks, first + chunk_blocks);
+    uint64_t begin = first * header.block_size;
+    uint64_t end = std::min(header.num_parameters, last * header.block_size);
+    for (auto &stream : prior) stream.prefetch(end, chunk);
+
+    for (uint64_t block = first; block < last; block++) {
+      if (!reader.read_block(&result)) {
+        std::cerr << input << " is truncated at block " << block << std::endl;
+        return false;
+      }
+      uint64_t offset = block * header.block_size;
+      int dim = header.block_dim(block);
+      Eigen::Map<Eigen::ArrayXf>(weights + offset, dim) =
+          decode(result, prior[0].read(offset, dim), prior[1].read(offset, dim))
+              .cast<float>();
+    }
+    for (auto &stream : prior) stream.release(end);
+    out.flush(begin * sizeof(float), (end - begin) * sizeof(float));
+    released = out.release(released, end * sizeof(float) - released);
+  }
+
+  if (stats) {
+    stats->num_parameters = header.num_parameters;
+    stats->num_blocks = num_blocks;
+    stats->encoded_bytes = reader.bytes_read();
+    stats->seconds =
+        std::chrono::duration<double>(Clock::now() - start).count();
+  }
+  return true;
+}
+}  // namespace rcc::pipeline
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_PIPELINE_WEIGHT_COMPRESSION_H_
+#define THIRD_PARTY_HYBRID_RCC_PIPELINE_WEIGHT_COMPRESSION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "pipeline/encoder_pipeline.h"
+
+// Streaming compression of model weights stored as raw little endian
+// float32 files.
+//
+// compress_weights maps the four parameter files, cuts them into chunks of
+// chunk_blocks blocks, prefetches chunk c + 1 while the blocks of chunk c are
+// encoded by an EncoderPipeline, and appends the results to an encoded
+// stream as they complete. Input pages are released once their blocks are
+// submitted, so the resident set is bounded by a few chunks plus the
+// in-flight requests, whatever the size of the model.
+//
+// With seekable set the blocks go to a block container, whose ranges can
+// later be decoded independently with a ContainerReader.
+//
+// decompress_weights is the mirror path: it streams the encoded blocks and
+// the prior files and writes the reconstructed weights into a mapped
+// float32 output file.
+namespace rcc::pipeline {
+struct WeightFiles {
+  std::string q_mean, q_std, p_mean, p_std;
+};
+
+struct CompressionOptions {
+  uint32_t block_size = 16;
+  size_t chunk_blocks = 1 << 14;
+  double eps = 1e-4;
+  bool pfr = true;
+  uint64_t seed = 0;
+  uint32_t N_max = 1 << 16;
+  // Write a seekable block container instead of an encoded stream. Its
+  // prior source is the p_mean and p_std paths separated by a newline.
+  bool seekable = false;
+  PipelineOptions pipeline;
+};
+
+struct CompressionStats {
+  uint64_t num_parameters = 0, num_blocks = 0, encoded_bytes = 0;
+  double seconds = 0;
+};
+
+// Returns false, after logging why, when a file can not be read or written
+// or the parameter files differ in size.
+bool compress_weights(const WeightFiles &input, const std::string &output,
+                      const CompressionOptions &options,
+                      CompressionStats *stats = nullptr);
+
+bool decompress_weights(const std::string &input, const std::string &p_mean,
+                        const std::string &p_std, const std::string &output,
+                        size_t chunk_blocks = 1 << 14,
+                        CompressionStats *stats = nullptr);
+}  // namespace rcc::pipeline
+
+#endif  // THIRD_PARTY_HYBRID_RCC_PIPELINE_WEIGHT_COMPRESSION_H_
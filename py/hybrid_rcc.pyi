@@ -4,6 +4,25 @@ class SamplingAlgorithm:
   PFR = 0
   SIS = 1
 
+# What sample_gaussian_hybrid returns when its timeout fires first.
+class Fallback:
+  BEST_CANDIDATE = 0
+  # Dithered quantization of the mean of q, decoded as sample index 0.
+  DITHERED_QUANTIZATION = 1
+
+# How a sampler stopped, see algorithm/deadline.h.
+class SamplerStatus:
+  t: float
+  s: float
+  w_min_stop: bool
+  deadline_stop: bool
+  fallback: bool
+  single_shot: bool
+  # Dimensions sampled from the prior under HybridOptions.elide_kl, and the
+  # sum of their KLs in nats.
+  elided: int
+  elided_kl: float
+
 class SamplingOutput:
   sample_opt: np.array
   sample_index: int = 0
@@ -11,23 +30,319 @@ class SamplingOutput:
   seed: int = 0
   signal: np.array
   box_dimensions: np.array
+  status: SamplerStatus
 
   def __init__(self, np.array, int, int, int, np.array, np.array): ...
   def __str__(self) -> str:
 
 
+class IndependentGaussian:
+  def __init__(self, mean: np.array, std: np.array): ...
+  # Point-wise methods take arrays of shape (n, dim) and return the same shape.
+  def pdf(self, x: np.array) -> np.array: ...
+  def logpdf(self, x: np.array) -> np.array: ...
+  def cdf(self, x: np.array) -> np.array: ...
+  def ppf(self, p: np.array) -> np.array: ...
+  def dim(self) -> int: ...
+  def mean(self) -> np.array: ...
+  def std(self) -> np.array: ...
+  def var(self) -> np.array: ...
+  def entropy(self) -> np.array: ...
+  def support(self) -> tuple[np.array, np.array]: ...
+
+# True if the dimensions of p share one mean and std, in which case
+# sample_gaussian_hybrid and sample_gaussian evaluate it with scalar parameters.
+def is_homoscedastic(p: IndependentGaussian) -> bool: ...
+
+class IndependentTruncatedGaussian(IndependentGaussian):
+  def __init__(self, mean: np.array, std: np.array, lower: np.array,
+               upper: np.array): ...
+
+class IndependentUniform(IndependentGaussian):
+  def __init__(self, lower: np.array, upper: np.array): ...
+
+class IndependentLaplace(IndependentGaussian):
+  def __init__(self, mean: np.array, scale: np.array): ...
+
+class IndependentLogistic(IndependentGaussian):
+  def __init__(self, mean: np.array, scale: np.array): ...
+
+class IndependentStudentT(IndependentGaussian):
+  def __init__(self, mean: np.array, scale: np.array, df: np.array): ...
+
+# Per dimension certified lower bound of log p(x)/q(x) over the support of q,
+# -inf where the ratio is not bounded away from 0. The samplers stop at
+# w_min = exp(sum of the bounds). q is a Gaussian, truncated Gaussian or
+# uniform, and p a Gaussian or, for a uniform q, a uniform.
+def minimum_log_weight(
+    q: IndependentGaussian | IndependentTruncatedGaussian | IndependentUniform,
+    p: IndependentGaussian | IndependentUniform) -> np.array: ...
+
+
+# sample_gaussian, sample_gaussian_hybrid and decode_gaussian_hybrid run in
+# float when every array argument is a float32 array, and in double
+# otherwise. decode_gaussian_hybrid returns a float32 array in that case and
+# reproduces the float encoder's sample exactly.
 def sample_gaussian(q_mean: np.array, q_std: np.array, p_mean: np.array,
                                p_std: np.array,
                                sampling_algorithm: SamplingAlgorithm,
                                seed: int, N_max: int,
                                verbose: bool) -> SamplingOutput: ...
 
+# The first N candidates of PFR sampling against N(p_mean, p_std) with seed,
+# in a k-d tree. search returns (sample, sample_index, evaluated), where the
+# first two are those of sample_gaussian(q_mean, q_std, p_mean, p_std,
+# SamplingAlgorithm.PFR, seed, N, False) and evaluated counts the candidates
+# whose score was computed.
+class CandidateCodebook:
+  def __init__(self, p_mean: np.array, p_std: np.array, N: int, seed: int,
+               leaf_size: int = 16): ...
+  def size(self) -> int: ...
+  def dim(self) -> int: ...
+  def search(self, q_mean: np.array,
+             q_std: np.array) -> tuple[np.array, int, int]: ...
+
+# Faster or approximate ways of sample_gaussian_hybrid to score candidates;
+# the defaults score every candidate exactly.
+class HybridOptions:
+  # Grid cells of the per-encode density ratio tables, 0 to score exactly.
+  table_cells: int = 0
+  # Abandon candidates once their partial score can not win.
+  early_abort: bool = False
+  # Code blocks within this many nats of a single candidate with one.
+  single_shot_kl: float = 1e-6
+  # Sample dimensions with KL(q_d || p_d) below this many nats from the
+  # prior; they come back with box dimension 0.
+  elide_kl: float = 0.0
+  # Evaluate a prior whose dimensions share one mean and std with scalar
+  # parameters; the samples are the same either way.
+  shared_prior: bool = True
+  def __init__(self): ...
+
 def sample_gaussian_hybrid(q_mean: np.array, q_std: np.array, p_mean: np.array,
                                p_std: np.array,
                                sampling_algorithm: SamplingAlgorithm, eps: float,
                                seed: int, N_max: int,
-                               verbose: bool) -> SamplingOutput: ...
+                               verbose: bool,
+                               options: HybridOptions = ...,
+                               timeout: float = 0.0,
+                               fallback: Fallback = ...) -> SamplingOutput: ...
+
+
+
+def decode_gaussian_hybrid(h: SamplingOutput, p_mean: np.array, p_std: np.array) -> np.array: ...
+
+# Hybrid coding of a uniform posterior, e.g. a quantization bin, against a
+# Gaussian, uniform, Laplace, logistic or Student's t prior. Blocks within
+# single_shot_kl nats of one candidate are coded with it; pass a negative
+# value to always search.
+def sample_uniform_hybrid(q: IndependentUniform,
+                          p: IndependentGaussian | IndependentUniform |
+                          IndependentLaplace | IndependentLogistic |
+                          IndependentStudentT,
+                          sampling_algorithm: SamplingAlgorithm, seed: int,
+                          N_max: int, verbose: bool = False,
+                          single_shot_kl: float = 1e-6) -> SamplingOutput: ...
+
+def decode_uniform_hybrid(
+    h: SamplingOutput,
+    p: IndependentGaussian | IndependentUniform | IndependentLaplace |
+    IndependentLogistic | IndependentStudentT
+) -> np.array: ...
+
+# sample_gaussian for each row of q_mean and q_std with the same prior and
+# seed, drawing the shared candidates once.
+# sample_gaussian_hybrid of every row of q_mean and q_std with the seed of
+# the same index, on num_workers threads or one per core.
+def sample_gaussian_hybrid_batch(
+    q_mean: np.array, q_std: np.array, p_mean: np.array, p_std: np.array,
+    sampling_algorithm: SamplingAlgorithm, eps: float, seeds: list[int],
+    N_max: int, options: HybridOptions = ...,
+    num_workers: int = 0) -> list[SamplingOutput]: ...
+
+# Per block predictions of sample_gaussian_hybrid for blocks given as the
+# columns of dim x num_blocks arrays, and the choice of eps and N_max for
+# them. log2M is the predicted sum of log2(box_dimensions).
+class TimingModel:
+  seconds_per_block: float = 3e-5
+  seconds_per_candidate_dim: float = 7e-8
+  def __init__(self): ...
+
+class HybridPrediction:
+  log2M: np.array
+  kl_bits: np.array
+  expected_candidates: np.array
+  coding_cost_bits: np.array
+  cutoff_probability: np.array
+  seconds: np.array
+
+class TuningOptions:
+  rate_target: float = float('inf')
+  eps: list[float] = [1e-4, 1e-3, 1e-2]
+  N_max: list[int] = [1 << 10, 1 << 12, 1 << 14, 1 << 16, 1 << 18, 1 << 20]
+  max_cutoff_probability: float = 1e-3
+  def __init__(self): ...
+
+class TunedSetting:
+  eps: float
+  N_max: int
+  feasible: bool
+  coding_cost_bits: float
+  seconds: float
+  prediction: HybridPrediction
+
+def predict_gaussian_hybrid(q_mean: np.array, q_std: np.array,
+                            p_mean: np.array, p_std: np.array, eps: float,
+                            N_max: int,
+                            timing: TimingModel = ...) -> HybridPrediction: ...
+
+def tune_gaussian_hybrid(q_mean: np.array, q_std: np.array, p_mean: np.array,
+                         p_std: np.array, options: TuningOptions = ...,
+                         timing: TimingModel = ...) -> TunedSetting: ...
+
+def sample_gaussian_multi(q_mean: np.array, q_std: np.array,
+                          p_mean: np.array, p_std: np.array,
+                          sampling_algorithm: SamplingAlgorithm, seed: int,
+                          N_max: int) -> list[SamplingOutput]: ...
+
+def sample_categorical(q_probs: np.array, p_probs: np.array,
+                       sampling_algorithm: SamplingAlgorithm, seed: int,
+                       N_max: int, verbose: bool) -> SamplingOutput: ...
+
+def decode_categorical(h: SamplingOutput, p_probs: np.array) -> np.array: ...
+
+# Progressive coding: one output per entry of noise, the variance of the
+# blur left after that layer in units of the prior variance. noise must be
+# strictly decreasing and end with 0.
+def sample_gaussian_layered(q_mean: np.array, q_std: np.array,
+                            p_mean: np.array, p_std: np.array,
+                            noise: list[float],
+                            sampling_algorithm: SamplingAlgorithm, eps: float,
+                            seed: int, N_max: int) -> list[SamplingOutput]: ...
+
+# The sample after each of the given leading layers.
+def decode_gaussian_layered(h: list[SamplingOutput], p_mean: np.array,
+                            p_std: np.array,
+                            noise: list[float]) -> list[np.array]: ...
+
+# Adaptive coding of sample indices. header is that of the model to start
+# from, b"" for the default one; both return the header of the learned
+# model, from which the next batch can start.
+def encode_sample_indices(indices: list[int],
+                          header: bytes = b"") -> tuple[bytes, bytes]: ...
+
+def decode_sample_indices(code: bytes, count: int,
+                          header: bytes = b"") -> tuple[list[int], bytes]: ...
+
+class IndexCodingReport:
+  num_indices: int
+  # Index bits assumed by the Zipf estimate of the coding cost.
+  zipf_bits: float
+  adaptive_bits: float
+  header_bits: float
+  saved_bits: float
+
+# Row b of q_std and p_std holds the standard deviations of block b.
+def report_index_coding(h: list[SamplingOutput], q_std: np.array,
+                        p_std: np.array,
+                        header: bytes = b"") -> IndexCodingReport: ...
+
+def compress_weights(q_mean: str, q_std: str, p_mean: str, p_std: str,
+                     output: str, block_size: int, eps: float, seed: int,
+                     N_max: int, num_workers: int,
+                     seekable: bool = False) -> int: ...
+
+def decompress_weights(input: str, p_mean: str, p_std: str,
+                       output: str) -> int: ...
+
+def decode_blocks(input: str, first: int, last: int, p_mean: np.array,
+                  p_std: np.array) -> np.array: ...
+
+# The first n draws from pcg32(seed) of the portable uniform, exponential and
+# normal samplers that every encode and decode depends on.
+def uniform_draws(seed: int, n: int) -> np.array: ...
+def exponential_draws(seed: int, n: int) -> np.array: ...
+def normal_draws(seed: int, n: int) -> np.array: ...
+
+class LazyDecoderMetrics:
+  hits: int
+  misses: int
+  evictions: int
+  failures: int
+  # Milliseconds per decoded block.
+  mean_decode_latency: float
+  max_decode_latency: float
+  cached_blocks: int
+  cached_bytes: int
+
+class LazyDecoder:
+  # Empty prior paths fall back to the ones recorded in the container.
+  def __init__(self, input: str, p_mean: str = '', p_std: str = '',
+               cache_bytes: int = 1 << 28, num_workers: int = 0): ...
+  def num_blocks(self) -> int: ...
+  def block(self, block: int) -> np.array: ...
+  def blocks(self, blocks: list[int]) -> list[np.array]: ...
+  def clear(self) -> None: ...
+  def metrics(self) -> LazyDecoderMetrics: ...
+
+# Asynchronous encoder of sample_gaussian_hybrid requests on num_workers
+# threads, or one per core. With SUBMISSION order the requests become ready
+# in the order they were submitted, with COMPLETION as soon as they are
+# encoded. try_submit returns None when queue_capacity requests are waiting.
+class ResultOrder:
+  SUBMISSION: ResultOrder
+  COMPLETION: ResultOrder
+
+# Latencies in milliseconds, depths in requests.
+class StageMetrics:
+  count: int
+  mean_latency: float
+  max_latency: float
+  depth: int
+  max_depth: int
+
+class PipelineMetrics:
+  queue: StageMetrics
+  encode: StageMetrics
+  reorder: StageMetrics
+  rejected: int
 
+class PendingEncode:
+  def ready(self) -> bool: ...
+  # Waits for the encode and raises its exception, if any.
+  def result(self) -> SamplingOutput: ...
 
+class EncoderPipeline:
+  def __init__(self, num_workers: int = 0, queue_capacity: int = 1024,
+               order: ResultOrder = ResultOrder.SUBMISSION): ...
+  def submit(self, q_mean: np.array, q_std: np.array, p_mean: np.array,
+             p_std: np.array, sampling_algorithm: SamplingAlgorithm = ...,
+             eps: float = 1e-4, seed: int = 0, N_max: int = 1 << 16,
+             options: HybridOptions = ...) -> PendingEncode: ...
+  def try_submit(self, q_mean: np.array, q_std: np.array, p_mean: np.array,
+                 p_std: np.array, sampling_algorithm: SamplingAlgorithm = ...,
+                 eps: float = 1e-4, seed: int = 0, N_max: int = 1 << 16,
+                 options: HybridOptions = ...) -> PendingEncode | None: ...
+  # Waits for the submitted requests; later submissions fail.
+  def close(self) -> None: ...
+  def metrics(self) -> PipelineMetrics: ...
 
-def decode_gaussian_hybrid(h: SamplingOutput, p_mean: np.array, p_std: np.array) -> np.array: ...
\ No newline at end of file
+class DaemonClient:
+  # Client of a local rccd. The prior is passed either as p_mean and p_std
+  # or as the id register_prior returned. Raises RuntimeError when the
+  # daemon is busy or rejects the request. register_prior returns 0 if the
+  # daemon rejects the prior, e.g. for a key registered with another one.
+  def __init__(self, socket_path: str, region_bytes: int = 1 << 24): ...
+  def max_dim(self) -> int: ...
+  def register_prior(self, key: int, mean: np.array, std: np.array) -> int: ...
+  def sample_gaussian_hybrid(self, q_mean: np.array, q_std: np.array,
+                             p_mean: np.array = ..., p_std: np.array = ...,
+                             prior: int = 0,
+                             sampling_algorithm: SamplingAlgorithm = ...,
+                             eps: float = 1e-4, seed: int = 0,
+                             N_max: int = 1 << 16,
+                             options: HybridOptions = ...
+                             ) -> SamplingOutput: ...
+  def decode_gaussian_hybrid(self, h: SamplingOutput, p_mean: np.array = ...,
+                             p_std: np.array = ...,
+                             prior: int = 0) -> np.array: ...
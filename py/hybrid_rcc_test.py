@@ -1,4 +1,12 @@
+import ctypes
+import ctypes.util
+import os
+import shutil
+import subprocess
+import time
+
 import numpy as np
+import pytest
 from scipy import stats
 import hybrid_rcc
 
@@ -32,7 +40,7 @@ def test_sample_pfr():
       50,
       False,
   )
-  want = hybrid_rcc.SamplingOutput([-0.206789, -0.624549], 0, 3, 42)
+  want = hybrid_rcc.SamplingOutput([0.711324, -0.206789], 0, 4, 42)
   compare_sampling_outputs(output, want, 1e-6)
 
 
@@ -49,7 +57,7 @@ def test_sample_sis():
       50,
       False,
   )
-  want = hybrid_rcc.SamplingOutput([-0.206789, -0.624549], 0, 3, 42)
+  want = hybrid_rcc.SamplingOutput([0.711324, -0.206789], 0, 3, 42)
   compare_sampling_outputs(output, want, 1e-6)
 
 
@@ -68,7 +76,7 @@ def test_sample_hybrid_pfr():
       False,
   )
   want = hybrid_rcc.SamplingOutput(
-      [-0.229706, 1.465346], 1, 4, 42, np.zeros((2,)), np.ones((2,))
+      [2.567020, 1.505592], 37, 1000, 42, np.zeros((2,)), np.ones((2,))
   )
   compare_sampling_outputs(output, want, 1e-6)
 
@@ -88,7 +96,7 @@ def test_sample_hybrid_sis():
       False,
   )
   want = hybrid_rcc.SamplingOutput(
-      [0.074926, 0.047668], 0, 2, 42, np.ones((2,)) * 7, np.ones((2,)) * 14
+      [-0.042705, 0.074926], 0, 2, 42, np.array([6, 7]), np.ones((2,)) * 14
   )
   compare_sampling_outputs(output, want, 1e-6)
 
@@ -108,7 +116,7 @@ def test_decode_hybrid_pfr():
       False,
   )
   got = hybrid_rcc.decode_gaussian_hybrid(output, p.mean(), p.std())
-  np.testing.assert_allclose(got, output.sample_opt, atol=0.5)
+  np.testing.assert_array_equal(got, output.sample_opt)
 
 
 def test_decode_hybrid_sis():
@@ -126,4 +134,1176 @@ def test_decode_hybrid_sis():
       False,
   )
   got = hybrid_rcc.decode_gaussian_hybrid(output, p.mean(), p.std())
-  np.testing.assert_allclose(got, output.sample_opt, atol=0.5)
+  np.testing.assert_array_equal(got, output.sample_opt)
+
+
+def hybrid_blocks(count, scale=3.0):
+  """Yields (seed, q_mean, q_std) of 1 to 4 dimensions against N(0, 1).
+
+  With the default scale many posteriors sit in the tails of the prior and
+  get M = 1, where one lattice cell spans a whole tail.
+  """
+  rng = np.random.default_rng(0)
+  for seed in range(count):
+    dim = 1 + seed % 4
+    yield seed, scale * rng.normal(size=dim), rng.uniform(0.02, 0.92, dim)
+
+
+@pytest.mark.parametrize("table_cells", [1, 4, 16, 256])
+@pytest.mark.parametrize(
+    "algorithm",
+    [hybrid_rcc.SamplingAlgorithm.PFR, hybrid_rcc.SamplingAlgorithm.SIS],
+)
+def test_table_scoring_matches_exact(table_cells, algorithm):
+  options = hybrid_rcc.HybridOptions()
+  options.table_cells = table_cells
+  boxes = []
+  for seed, q_mean, q_std in hybrid_blocks(200):
+    args = (
+        q_mean,
+        q_std,
+        np.zeros(len(q_mean)),
+        np.ones(len(q_mean)),
+        algorithm,
+        1e-3,
+        seed,
+        4096,
+        False,
+    )
+    want = hybrid_rcc.sample_gaussian_hybrid(*args)
+    got = hybrid_rcc.sample_gaussian_hybrid(*args, options=options)
+    compare_sampling_outputs(got, want, 0)
+    boxes.extend(want.box_dimensions)
+  assert min(boxes) == 1
+
+
+@pytest.mark.parametrize(
+    "algorithm",
+    [hybrid_rcc.SamplingAlgorithm.PFR, hybrid_rcc.SamplingAlgorithm.SIS],
+)
+def test_early_abort_matches_exact(algorithm):
+  options = hybrid_rcc.HybridOptions()
+  options.early_abort = True
+  for seed, q_mean, q_std in hybrid_blocks(200):
+    args = (
+        q_mean,
+        q_std,
+        np.zeros(len(q_mean)),
+        np.ones(len(q_mean)),
+        algorithm,
+        1e-3,
+        seed,
+        4096,
+        False,
+    )
+    want = hybrid_rcc.sample_gaussian_hybrid(*args)
+    got = hybrid_rcc.sample_gaussian_hybrid(*args, options=options)
+    compare_sampling_outputs(got, want, 0)
+
+
+@pytest.mark.parametrize(
+    "algorithm",
+    [hybrid_rcc.SamplingAlgorithm.PFR, hybrid_rcc.SamplingAlgorithm.SIS],
+)
+def test_fixed_dimension_matches_generic(algorithm):
+  # Blocks of up to 16 dimensions take the fixed-dimension sampler unless
+  # verbose output is requested, which forces the generic one.
+  rng = np.random.default_rng(0)
+  for dim in range(1, 17):
+    args = (
+        0.5 * rng.normal(size=dim),
+        rng.uniform(0.2, 0.9, dim),
+        np.zeros(dim),
+        np.ones(dim),
+        algorithm,
+        1e-3,
+        dim,
+        256,
+    )
+    want = hybrid_rcc.sample_gaussian_hybrid(*args, True)
+    got = hybrid_rcc.sample_gaussian_hybrid(*args, False)
+    compare_sampling_outputs(got, want, 0)
+
+
+@pytest.mark.parametrize("dtype", [np.float64, np.float32])
+@pytest.mark.parametrize(
+    "algorithm",
+    [hybrid_rcc.SamplingAlgorithm.PFR, hybrid_rcc.SamplingAlgorithm.SIS],
+)
+def test_shared_prior_matches_generic(dtype, algorithm):
+  # Blocks of 8 dimensions take the fixed-dimension sampler, those of 32
+  # sample_hybrid_pfr or sample_hybrid_sis.
+  generic = hybrid_rcc.HybridOptions()
+  generic.shared_prior = False
+  mismatches = 0
+  for dim in [8, 32]:
+    for p_mean, p_std in [(0.0, 1.0), (0.3, 2.0)]:
+      for seed in range(50):
+        rng = np.random.default_rng(seed)
+        args = (
+            (p_mean + 0.5 * p_std * rng.normal(size=dim)).astype(dtype),
+            (p_std * rng.uniform(0.2, 0.9, dim)).astype(dtype),
+            np.full(dim, p_mean, dtype),
+            np.full(dim, p_std, dtype),
+            algorithm,
+            1e-3,
+            seed,
+            4096,
+            False,
+        )
+        want = hybrid_rcc.sample_gaussian_hybrid(*args, options=generic)
+        got = hybrid_rcc.sample_gaussian_hybrid(*args)
+        mismatches += not (
+            got.sample_index == want.sample_index
+            and got.total_number_samples == want.total_number_samples
+            and np.array_equal(got.sample_opt, want.sample_opt)
+            and np.array_equal(got.signal, want.signal)
+        )
+  assert mismatches == 0
+
+
+def test_shared_prior_detection():
+  assert hybrid_rcc.is_homoscedastic(
+      hybrid_rcc.IndependentGaussian(np.zeros(4), np.ones(4))
+  )
+  assert hybrid_rcc.is_homoscedastic(
+      hybrid_rcc.IndependentGaussian(np.full(4, 0.3), np.full(4, 2.0))
+  )
+  # One dimension's std or mean differs.
+  std = np.ones(4)
+  std[2] = np.nextafter(1.0, 2.0)
+  assert not hybrid_rcc.is_homoscedastic(
+      hybrid_rcc.IndependentGaussian(np.zeros(4), std)
+  )
+  mean = np.zeros(4)
+  mean[3] = 1e-12
+  assert not hybrid_rcc.is_homoscedastic(
+      hybrid_rcc.IndependentGaussian(mean, np.ones(4))
+  )
+
+
+@pytest.mark.parametrize(
+    "fallback",
+    [hybrid_rcc.Fallback.BEST_CANDIDATE,
+     hybrid_rcc.Fallback.DITHERED_QUANTIZATION],
+)
+@pytest.mark.parametrize(
+    "algorithm",
+    [hybrid_rcc.SamplingAlgorithm.PFR, hybrid_rcc.SamplingAlgorithm.SIS],
+)
+def test_deadline_fallback(fallback, algorithm):
+  # Thousands of candidates without a deadline. The deadline has passed by
+  # the first clock check, after 16 candidates.
+  args = (
+      np.array([2.0, -2.0, 1.5, -1.0]),
+      np.full(4, 0.05),
+      np.zeros(4),
+      np.ones(4),
+      algorithm,
+      1e-3,
+      42,
+      1 << 20,
+      False,
+  )
+  full = hybrid_rcc.sample_gaussian_hybrid(*args)
+  assert full.status.w_min_stop
+  assert full.total_number_samples > 16
+  output = hybrid_rcc.sample_gaussian_hybrid(
+      *args, timeout=1e-9, fallback=fallback
+  )
+  assert output.total_number_samples == 16
+  assert output.status.deadline_stop
+  assert not output.status.w_min_stop
+  dithered = fallback == hybrid_rcc.Fallback.DITHERED_QUANTIZATION
+  assert output.status.fallback == dithered
+  if dithered:
+    assert output.sample_index == 0
+  got = hybrid_rcc.decode_gaussian_hybrid(output, args[2], args[3])
+  np.testing.assert_array_equal(got, output.sample_opt)
+  with pytest.raises(ValueError):
+    hybrid_rcc.sample_gaussian_hybrid(*args, timeout=-1)
+
+
+def test_float32_hybrid_round_trip():
+  want_indices = []
+  got_indices = []
+  for seed, q_mean, q_std in hybrid_blocks(50, scale=0.5):
+    args = (
+        q_mean.astype(np.float32),
+        q_std.astype(np.float32),
+        np.zeros(len(q_mean), np.float32),
+        np.ones(len(q_mean), np.float32),
+        hybrid_rcc.SamplingAlgorithm.PFR,
+        1e-3,
+        seed,
+        1 << 16,
+        False,
+    )
+    output = hybrid_rcc.sample_gaussian_hybrid(*args)
+    got = hybrid_rcc.decode_gaussian_hybrid(output, args[2], args[3])
+    assert got.dtype == np.float32
+    np.testing.assert_array_equal(got, output.sample_opt)
+    want = hybrid_rcc.sample_gaussian_hybrid(
+        *(np.asarray(a, np.float64) for a in args[:4]), *args[4:]
+    )
+    np.testing.assert_allclose(output.sample_opt, want.sample_opt, atol=1e-4)
+    got_indices.append(output.sample_index)
+    want_indices.append(want.sample_index)
+  assert got_indices == want_indices
+
+
+@pytest.mark.parametrize(
+    "algorithm",
+    [hybrid_rcc.SamplingAlgorithm.PFR, hybrid_rcc.SamplingAlgorithm.SIS],
+)
+def test_single_shot_matches_search(algorithm):
+  # Posteriors uniform on one lattice cell of a U(0, 1) prior, which the
+  # single shot codes with the candidate the search would also return.
+  rng = np.random.default_rng(0)
+  for seed in range(200):
+    dim = 1 + seed % 4
+    M = rng.integers(2, 32, dim).astype(float)
+    cell = np.floor(rng.uniform(0, M))
+    q = hybrid_rcc.IndependentUniform(cell / M, (cell + 1) / M)
+    p = hybrid_rcc.IndependentUniform(np.zeros(dim), np.ones(dim))
+    got = hybrid_rcc.sample_uniform_hybrid(q, p, algorithm, seed, 4096)
+    want = hybrid_rcc.sample_uniform_hybrid(
+        q, p, algorithm, seed, 4096, single_shot_kl=-1
+    )
+    assert got.total_number_samples == 1
+    assert got.sample_index == want.sample_index == 0
+    np.testing.assert_array_equal(got.box_dimensions, M)
+    np.testing.assert_array_equal(got.signal, want.signal)
+    np.testing.assert_array_equal(got.sample_opt, want.sample_opt)
+    np.testing.assert_array_equal(
+        hybrid_rcc.decode_uniform_hybrid(got, p), got.sample_opt
+    )
+
+
+@pytest.mark.parametrize(
+    "p, algorithm",
+    [
+        (
+            hybrid_rcc.IndependentLaplace(np.zeros(6), np.ones(6)),
+            hybrid_rcc.SamplingAlgorithm.PFR,
+        ),
+        (
+            hybrid_rcc.IndependentStudentT(
+                np.zeros(6), np.ones(6), np.full(6, 3.0)
+            ),
+            hybrid_rcc.SamplingAlgorithm.SIS,
+        ),
+    ],
+)
+def test_uniform_hybrid_round_trip_heavy_tailed_prior(p, algorithm):
+  for seed in range(50):
+    rng = np.random.default_rng(seed)
+    lower = rng.normal(size=6)
+    upper = lower + rng.uniform(0.05, 0.5, 6)
+    q = hybrid_rcc.IndependentUniform(lower, upper)
+    got = hybrid_rcc.sample_uniform_hybrid(q, p, algorithm, seed, 1 << 16)
+    assert got.status.w_min_stop
+    assert np.all(got.sample_opt >= lower) and np.all(got.sample_opt <= upper)
+    np.testing.assert_array_equal(
+        hybrid_rcc.decode_uniform_hybrid(got, p), got.sample_opt
+    )
+
+
+@pytest.mark.parametrize(
+    "algorithm",
+    [hybrid_rcc.SamplingAlgorithm.PFR, hybrid_rcc.SamplingAlgorithm.SIS],
+)
+def test_elided_dimensions_round_trip(algorithm):
+  # Every other dimension is within 1e-5 nats of the prior.
+  q_mean = np.array([0.8, 0.001, -0.6, -0.002, 0.3, 0.0])
+  q_std = np.array([0.3, 0.999, 0.4, 1.002, 0.5, 1.0])
+  p_mean = np.zeros(6)
+  p_std = np.ones(6)
+  kl = np.log(p_std / q_std) + (q_std**2 + q_mean**2) / 2 - 0.5
+  options = hybrid_rcc.HybridOptions()
+  options.elide_kl = 1e-3
+  output = hybrid_rcc.sample_gaussian_hybrid(
+      q_mean,
+      q_std,
+      p_mean,
+      p_std,
+      algorithm,
+      1e-3,
+      42,
+      1 << 16,
+      False,
+      options=options,
+  )
+  assert output.status.elided == 3
+  assert output.status.elided_kl == pytest.approx(kl[1::2].sum())
+  np.testing.assert_array_equal(output.box_dimensions[1::2], 0)
+  assert (output.box_dimensions[::2] > 0).all()
+  got = hybrid_rcc.decode_gaussian_hybrid(output, p_mean, p_std)
+  np.testing.assert_array_equal(got, output.sample_opt)
+
+  full = hybrid_rcc.sample_gaussian_hybrid(
+      q_mean,
+      q_std,
+      p_mean,
+      p_std,
+      algorithm,
+      1e-3,
+      42,
+      1 << 16,
+      False,
+  )
+  assert full.status.elided == 0
+  assert (full.box_dimensions > 0).all()
+
+
+@pytest.mark.parametrize(
+    "algorithm",
+    [hybrid_rcc.SamplingAlgorithm.PFR, hybrid_rcc.SamplingAlgorithm.SIS],
+)
+def test_sample_gaussian_multi_matches_single(algorithm):
+  q_mean = np.array([[0.5, -0.3, 1.0], [0.1, 0.2, -0.4], [0.0, 0.0, 0.0]])
+  q_std = np.array([[0.2, 0.3, 0.25], [0.5, 0.4, 0.6], [0.3, 0.3, 0.3]])
+  p_mean = np.full(3, 0.2)
+  p_std = np.full(3, 1.5)
+  outputs = hybrid_rcc.sample_gaussian_multi(
+      q_mean,
+      q_std,
+      p_mean,
+      p_std,
+      algorithm,
+      42,
+      1 << 16,
+  )
+  assert len(outputs) == len(q_mean)
+  for k, output in enumerate(outputs):
+    want = hybrid_rcc.sample_gaussian(
+        q_mean[k],
+        q_std[k],
+        p_mean,
+        p_std,
+        algorithm,
+        42,
+        1 << 16,
+        False,
+    )
+    compare_sampling_outputs(output, want, 0)
+
+
+def test_codebook_matches_sample_pfr():
+  p_mean = np.full(3, 0.2)
+  p_std = np.full(3, 1.5)
+  codebook = hybrid_rcc.CandidateCodebook(p_mean, p_std, 4096, 42)
+  assert codebook.size() == 4096
+  rng = np.random.default_rng(0)
+  evaluated = 0
+  for _ in range(50):
+    q_mean = p_mean + rng.normal(size=3)
+    q_std = rng.uniform(0.2, 1.0, 3)
+    sample, index, count = codebook.search(q_mean, q_std)
+    want = hybrid_rcc.sample_gaussian(
+        q_mean,
+        q_std,
+        p_mean,
+        p_std,
+        hybrid_rcc.SamplingAlgorithm.PFR,
+        42,
+        4096,
+        False,
+    )
+    assert index == want.sample_index
+    np.testing.assert_array_equal(sample, want.sample_opt)
+    evaluated += count
+  # The branch and bound scores a fraction of the codebook.
+  assert evaluated < 50 * 4096 / 2
+  with pytest.raises(ValueError):
+    codebook.search(np.zeros(2), np.ones(2))
+
+
+@pytest.mark.parametrize(
+    "algorithm",
+    [hybrid_rcc.SamplingAlgorithm.PFR, hybrid_rcc.SamplingAlgorithm.SIS],
+)
+@pytest.mark.parametrize("num_workers", [1, 4])
+def test_batch_matches_single(algorithm, num_workers):
+  rng = np.random.default_rng(3)
+  blocks = 24
+  q_mean = rng.normal(size=(blocks, 3))
+  # Spread the KLs so that the scheduler reorders the batch.
+  q_std = rng.uniform(0.02, 1.0, (blocks, 3))
+  p_mean = np.zeros(3)
+  p_std = np.ones(3)
+  seeds = [int(s) for s in rng.integers(0, 2**31, blocks)]
+  outputs = hybrid_rcc.sample_gaussian_hybrid_batch(
+      q_mean,
+      q_std,
+      p_mean,
+      p_std,
+      algorithm,
+      1e-4,
+      seeds,
+      1 << 16,
+      num_workers=num_workers,
+  )
+  assert len(outputs) == blocks
+  for k in range(blocks):
+    want = hybrid_rcc.sample_gaussian_hybrid(
+        q_mean[k],
+        q_std[k],
+        p_mean,
+        p_std,
+        algorithm,
+        1e-4,
+        seeds[k],
+        1 << 16,
+        False,
+    )
+    compare_sampling_outputs(outputs[k], want, 0.0)
+  with pytest.raises(ValueError):
+    hybrid_rcc.sample_gaussian_hybrid_batch(
+        q_mean,
+        q_std,
+        p_mean,
+        p_std,
+        hybrid_rcc.SamplingAlgorithm.PFR,
+        1e-4,
+        seeds[1:],
+        1 << 16,
+    )
+
+
+# About a second of candidates, next to milliseconds for the others.
+SLOW_BLOCK = (np.full(16, 0.5), np.full(16, 0.05), np.zeros(16), np.ones(16))
+
+
+def cheap_block(seed):
+  rng = np.random.default_rng(seed)
+  return (rng.normal(size=3), rng.uniform(0.3, 0.6, 3), np.zeros(3), np.ones(3))
+
+
+@pytest.mark.parametrize(
+    "order",
+    [hybrid_rcc.ResultOrder.SUBMISSION, hybrid_rcc.ResultOrder.COMPLETION],
+)
+def test_encoder_pipeline_order_and_errors(order):
+  pipeline = hybrid_rcc.EncoderPipeline(num_workers=2, order=order)
+  slow = pipeline.submit(*SLOW_BLOCK, N_max=1 << 20)
+  # The ratio tables of this request do not fit in memory.
+  options = hybrid_rcc.HybridOptions()
+  options.table_cells = 1 << 30
+  dim = 1 << 16
+  failing = pipeline.submit(
+      np.full(dim, 0.5),
+      np.full(dim, 0.5),
+      np.zeros(dim),
+      np.ones(dim),
+      options=options,
+  )
+  cheap = [pipeline.submit(*cheap_block(seed), seed=seed) for seed in range(4)]
+  last = cheap[-1].result()
+  if order == hybrid_rcc.ResultOrder.SUBMISSION:
+    assert slow.ready() and failing.ready()
+    assert all(pending.ready() for pending in cheap)
+  else:
+    assert not slow.ready()
+  with pytest.raises(MemoryError):
+    failing.result()
+  for seed, pending in enumerate(cheap):
+    want = hybrid_rcc.sample_gaussian_hybrid(
+        *cheap_block(seed),
+        hybrid_rcc.SamplingAlgorithm.PFR,
+        1e-4,
+        seed,
+        1 << 16,
+        False,
+    )
+    compare_sampling_outputs(pending.result(), want, 0.0)
+  compare_sampling_outputs(last, cheap[-1].result(), 0.0)
+  assert slow.result().total_number_samples > 0
+
+  pipeline.close()
+  metrics = pipeline.metrics()
+  assert metrics.queue.count == metrics.encode.count == 6
+  assert metrics.reorder.count == 6
+  assert metrics.encode.max_latency >= metrics.encode.mean_latency > 0
+  assert metrics.rejected == 0
+  with pytest.raises(RuntimeError):
+    pipeline.submit(*cheap_block(0)).result()
+
+
+def test_encoder_pipeline_backpressure():
+  pipeline = hybrid_rcc.EncoderPipeline(
+      num_workers=1,
+      queue_capacity=2,
+      order=hybrid_rcc.ResultOrder.COMPLETION,
+  )
+  slow = pipeline.submit(*SLOW_BLOCK, N_max=1 << 20)
+  # Wait for the worker to take the slow request off the queue.
+  while pipeline.metrics().queue.count == 0:
+    time.sleep(0.001)
+  accepted = [pipeline.try_submit(*cheap_block(seed)) for seed in range(2)]
+  assert all(pending is not None for pending in accepted)
+  assert pipeline.try_submit(*cheap_block(2)) is None
+  metrics = pipeline.metrics()
+  assert metrics.rejected == 1
+  assert metrics.queue.depth == 2 and metrics.queue.max_depth == 2
+  assert metrics.encode.depth == 1
+  for pending in [slow] + accepted:
+    pending.result()
+  pipeline.close()
+  assert pipeline.metrics().encode.count == 3
+
+
+@pytest.mark.parametrize("eps", [1e-4, 1e-2])
+def test_predicted_box_matches_sampler(eps):
+  rng = np.random.default_rng(1)
+  dim, blocks = 3, 40
+  q_mean = rng.normal(size=(dim, blocks))
+  # Includes posteriors wider than the prior, whose boxes have M = 1.
+  q_std = rng.uniform(0.05, 2.0, (dim, blocks))
+  p_mean = np.zeros((dim, blocks))
+  p_std = np.ones((dim, blocks))
+  prediction = hybrid_rcc.predict_gaussian_hybrid(
+      q_mean, q_std, p_mean, p_std, eps, 1 << 14
+  )
+  for j in range(blocks):
+    h = hybrid_rcc.sample_gaussian_hybrid(
+        q_mean[:, j],
+        q_std[:, j],
+        p_mean[:, j],
+        p_std[:, j],
+        hybrid_rcc.SamplingAlgorithm.PFR,
+        eps,
+        j,
+        1 << 14,
+        False,
+    )
+    assert prediction.log2M[j] == pytest.approx(
+        np.log2(h.box_dimensions).sum(), abs=1e-9
+    )
+  assert (prediction.expected_candidates <= 1 << 14).all()
+
+
+def test_tuned_setting_meets_cutoff():
+  rng = np.random.default_rng(2)
+  q_mean = rng.normal(size=(2, 20))
+  q_std = rng.uniform(0.05, 0.5, (2, 20))
+  p_mean = np.zeros((2, 20))
+  p_std = np.ones((2, 20))
+  options = hybrid_rcc.TuningOptions()
+  setting = hybrid_rcc.tune_gaussian_hybrid(
+      q_mean, q_std, p_mean, p_std, options
+  )
+  assert setting.feasible
+  assert setting.eps in options.eps
+  assert setting.N_max in options.N_max
+  cutoff = setting.prediction.cutoff_probability
+  assert cutoff.max() <= options.max_cutoff_probability
+  assert setting.coding_cost_bits == pytest.approx(
+      setting.prediction.coding_cost_bits.sum()
+  )
+  with pytest.raises(ValueError):
+    hybrid_rcc.predict_gaussian_hybrid(
+        q_mean, q_std, p_mean[:1], p_std, 1e-4, 1 << 10
+    )
+
+
+def test_layered_decode_matches_encoder():
+  q = stats.norm([0.5, -0.3, 1.0], [0.2, 0.3, 0.25])
+  p = stats.norm([0.2, 0.2, 0.2], [1.5, 1.5, 1.5])
+  noise = [0.1, 0.01, 0]
+  layers = hybrid_rcc.sample_gaussian_layered(
+      q.mean(),
+      q.std(),
+      p.mean(),
+      p.std(),
+      noise,
+      hybrid_rcc.SamplingAlgorithm.PFR,
+      1e-3,
+      42,
+      1 << 16,
+  )
+  assert len(layers) == len(noise)
+  for depth in range(1, len(layers) + 1):
+    got = hybrid_rcc.decode_gaussian_layered(
+        layers[:depth], p.mean(), p.std(), noise
+    )
+    for sample, layer in zip(got, layers):
+      np.testing.assert_array_equal(sample, layer.sample_opt)
+
+
+def test_layered_rejects_bad_noise():
+  with pytest.raises(ValueError):
+    hybrid_rcc.sample_gaussian_layered(
+        [0.0],
+        [0.5],
+        [0.0],
+        [1.0],
+        [0.1, 0.2, 0],
+        hybrid_rcc.SamplingAlgorithm.PFR,
+        1e-3,
+        0,
+        100,
+    )
+
+
+def test_sample_indices_round_trip():
+  rng = np.random.default_rng(0)
+  header = b""
+  for _ in range(3):
+    indices = [int(n) for n in rng.geometric(0.02, size=200) - 1]
+    code, learned = hybrid_rcc.encode_sample_indices(indices, header)
+    got, decoded = hybrid_rcc.decode_sample_indices(
+        code, len(indices), header
+    )
+    assert got == indices
+    assert decoded == learned
+    header = learned
+  assert 0 < len(header) <= 128
+  with pytest.raises(ValueError):
+    hybrid_rcc.decode_sample_indices(b"", 1, b"\x01")
+
+
+def test_report_index_coding():
+  rng = np.random.default_rng(1)
+  blocks = 100
+  q_std = np.full((blocks, 4), 0.1)
+  p_std = np.ones((blocks, 4))
+  h = [
+      hybrid_rcc.SamplingOutput(
+          np.zeros(4),
+          int(n),
+          int(n) + 1,
+          0,
+          np.zeros(4),
+          np.full(4, 2.0),
+      )
+      for n in rng.geometric(0.01, size=blocks) - 1
+  ]
+  report = hybrid_rcc.report_index_coding(h, q_std, p_std)
+  assert report.num_indices == blocks
+  assert report.header_bits == 0
+  assert report.adaptive_bits > 0
+  np.testing.assert_allclose(
+      report.saved_bits,
+      report.zipf_bits - report.adaptive_bits - report.header_bits,
+  )
+
+
+def test_sample_categorical_pfr():
+  q = np.array([[0.7, 0.2, 0.1], [0.1, 0.1, 0.8]])
+  p = np.ones((2, 3)) / 3
+  output = hybrid_rcc.sample_categorical(
+      q, p, hybrid_rcc.SamplingAlgorithm.PFR, 42, 50, False
+  )
+  want = hybrid_rcc.SamplingOutput([0, 2], 6, 7, 42)
+  compare_sampling_outputs(output, want, 0)
+
+
+def test_sample_categorical_sis():
+  q = np.array([[0.7, 0.2, 0.1], [0.1, 0.1, 0.8]])
+  p = np.ones((2, 3)) / 3
+  output = hybrid_rcc.sample_categorical(
+      q, p, hybrid_rcc.SamplingAlgorithm.SIS, 42, 50, False
+  )
+  want = hybrid_rcc.SamplingOutput([0, 2], 6, 7, 42)
+  compare_sampling_outputs(output, want, 0)
+
+
+def test_decode_categorical():
+  q = np.array([[0.7, 0.2, 0.1], [0.1, 0.1, 0.8]])
+  p = np.ones((2, 3)) / 3
+  output = hybrid_rcc.sample_categorical(
+      q, p, hybrid_rcc.SamplingAlgorithm.PFR, 42, 50, False
+  )
+  got = hybrid_rcc.decode_categorical(output, p)
+  np.testing.assert_array_equal(got, output.sample_opt)
+
+
+# Draws that encodes and decodes must reproduce on every platform, as exact
+# doubles. Draw 13 of seed 0 takes the wedge of both ziggurats, and draws
+# 3181 and 3212 the tails of the exponential and the normal.
+ZIGGURAT_DRAWS = {
+    (0, "uniform"): {
+        0: "0x1.d047449dp-1",
+        1: "0x1.e9fb2f66p-2",
+        2: "0x1.13fad80dp-1",
+        3: "0x1.5cc8d551p-1",
+    },
+    (42, "uniform"): {
+        0: "0x1.85eaf7adp-1",
+        1: "0x1.ac1f12a6p-2",
+        2: "0x1.cadeca6ep-2",
+        3: "0x1.10854e0ep-2",
+    },
+    (0, "exponential"): {
+        0: "0x1.3a2dc8b0d4a57p-1",
+        1: "0x1.4d4ae5ae2215p-1",
+        2: "0x1.4c67141b32521p+2",
+        3: "0x1.c2338442660fep-2",
+        13: "0x1.58bf822e12449p+0",
+        3181: "0x1.fa0f3bde99729p+2",
+    },
+    (42, "exponential"): {
+        0: "0x1.d2a613c2208ep-1",
+        1: "0x1.76af276f4f8bcp-1",
+        2: "0x1.73769370d95a4p+1",
+        3: "0x1.1d078dc4db553p-1",
+    },
+    (0, "normal"): {
+        0: "-0x1.9e11ac6854438p-1",
+        1: "0x1.5d7d481f2f606p-1",
+        2: "-0x1.54b87215b89a3p+1",
+        3: "0x1.11efdaf63b0b7p-2",
+        13: "0x1.48fadb93a893cp+0",
+        3212: "0x1.ede507730c174p+1",
+    },
+    (42, "normal"): {
+        0: "0x1.eb1bacd2d0c9dp-1",
+        1: "-0x1.5b9aef1d3cbe1p-1",
+        2: "0x1.0a298c1ea24fp+1",
+        3: "-0x1.72df0861a6251p-1",
+    },
+}
+
+
+@pytest.mark.parametrize("seed, sampler", list(ZIGGURAT_DRAWS))
+def test_ziggurat_draws_are_pinned(seed, sampler):
+  want = ZIGGURAT_DRAWS[(seed, sampler)]
+  draws = getattr(hybrid_rcc, sampler + "_draws")(seed, max(want) + 1)
+  for j, value in want.items():
+    if sampler == "normal" and j == 3212:
+      # The normal tail goes through log, which libm may round either way.
+      np.testing.assert_allclose(draws[j], float.fromhex(value), rtol=1e-15)
+    else:
+      assert draws[j] == float.fromhex(value), j
+
+
+def test_minimum_log_weight_is_certified():
+  # Even dimensions have std(q) < std(p), where log p/q is convex with an
+  # interior minimum, and odd ones std(q) > std(p), where it is unbounded
+  # below unless q is truncated.
+  for seed in range(20):
+    rng = np.random.default_rng(seed)
+    dim = 6
+    p_mean, p_std = rng.normal(size=dim), rng.uniform(0.5, 2.0, dim)
+    q_std = p_std * np.where(np.arange(dim) % 2 == 0, 0.6, 1.7)
+    q_mean = p_mean + p_std * rng.normal(size=dim)
+    lower, upper = q_mean - 3 * q_std, q_mean + 3 * q_std
+    x = np.linspace(lower, upper, 20001)
+    p = hybrid_rcc.IndependentGaussian(p_mean, p_std)
+
+    q = hybrid_rcc.IndependentGaussian(q_mean, q_std)
+    bound = hybrid_rcc.minimum_log_weight(q, p)
+    assert np.all(bound <= (p.logpdf(x) - q.logpdf(x)).min(axis=0))
+    assert np.all(bound[1::2] == -np.inf)
+
+    # Over a bounded support the bound is attained, up to the grid spacing
+    # and the relative margin of 1e-12.
+    for q in [
+        hybrid_rcc.IndependentTruncatedGaussian(q_mean, q_std, lower, upper),
+        hybrid_rcc.IndependentUniform(lower, upper),
+    ]:
+      bound = hybrid_rcc.minimum_log_weight(q, p)
+      empirical = (p.logpdf(x) - q.logpdf(x)).min(axis=0)
+      assert np.all(bound <= empirical)
+      np.testing.assert_allclose(bound, empirical, rtol=0, atol=1e-7)
+
+
+def test_independent_gaussian():
+  mean, std = np.array([0.0, 1.0, -2.0]), np.array([1.0, 2.0, 0.5])
+  dist = hybrid_rcc.IndependentGaussian(mean, std)
+  x = np.random.default_rng(0).normal(size=(100, 3))
+  want = stats.norm(mean, std)
+  np.testing.assert_allclose(dist.pdf(x), want.pdf(x), rtol=1e-12)
+  np.testing.assert_allclose(dist.logpdf(x), want.logpdf(x), rtol=1e-12)
+  np.testing.assert_allclose(dist.cdf(x), want.cdf(x), rtol=1e-12)
+  np.testing.assert_allclose(dist.ppf(dist.cdf(x)), x, atol=1e-9)
+  p = np.array([[1e-300, 1e-10, 0.3], [0.5, 0.99, 1 - 1e-12]])
+  np.testing.assert_allclose(dist.ppf(p), want.ppf(p), rtol=1e-13)
+  np.testing.assert_allclose(dist.entropy(), want.entropy(), rtol=1e-12)
+  assert dist.dim() == 3
+
+
+def test_independent_truncated_gaussian():
+  mean, std = np.array([0.0, 1.0]), np.array([1.0, 2.0])
+  lower, upper = np.array([-1.0, 0.0]), np.array([2.0, 1.5])
+  dist = hybrid_rcc.IndependentTruncatedGaussian(mean, std, lower, upper)
+  x = np.random.default_rng(0).uniform(lower, upper, size=(100, 2))
+  want = stats.truncnorm((lower - mean) / std, (upper - mean) / std, mean, std)
+  np.testing.assert_allclose(dist.pdf(x), want.pdf(x), rtol=1e-9)
+  np.testing.assert_allclose(dist.cdf(x), want.cdf(x), rtol=1e-9, atol=1e-12)
+  np.testing.assert_allclose(dist.ppf(dist.cdf(x)), x, atol=1e-9)
+
+
+def test_independent_uniform():
+  dist = hybrid_rcc.IndependentUniform(np.array([0.0, -1.0]), np.ones(2))
+  x = np.array([[0.5, 0.0], [2.0, -0.5]])
+  np.testing.assert_allclose(dist.pdf(x), [[1.0, 0.5], [0.0, 0.5]])
+  np.testing.assert_allclose(dist.ppf(np.full((1, 2), 0.25)), [[0.25, -0.5]])
+
+
+@pytest.mark.parametrize(
+    'make, want',
+    [
+        (
+            lambda m, s: hybrid_rcc.IndependentLaplace(m, s),
+            lambda m, s: stats.laplace(m, s),
+        ),
+        (
+            lambda m, s: hybrid_rcc.IndependentLogistic(m, s),
+            lambda m, s: stats.logistic(m, s),
+        ),
+        (
+            lambda m, s: hybrid_rcc.IndependentStudentT(
+                m, s, np.array([0.7, 3.0, 30.0])
+            ),
+            lambda m, s: stats.t(np.array([0.7, 3.0, 30.0]), m, s),
+        ),
+    ],
+)
+def test_heavy_tailed_distributions(make, want):
+  mean, scale = np.array([0.0, 1.0, -2.0]), np.array([1.0, 2.0, 0.5])
+  dist, want = make(mean, scale), want(mean, scale)
+  x = np.random.default_rng(0).standard_cauchy(size=(100, 3))
+  np.testing.assert_allclose(dist.pdf(x), want.pdf(x), rtol=1e-12)
+  np.testing.assert_allclose(dist.logpdf(x), want.logpdf(x), rtol=1e-12)
+  np.testing.assert_allclose(dist.cdf(x), want.cdf(x), rtol=1e-11)
+  p = np.random.default_rng(1).uniform(size=(100, 3))
+  np.testing.assert_allclose(dist.ppf(p), want.ppf(p), rtol=1e-12)
+  np.testing.assert_allclose(dist.entropy(), want.entropy(), rtol=1e-12)
+
+
+def test_distribution_shape_mismatch():
+  dist = hybrid_rcc.IndependentGaussian(np.zeros(3), np.ones(3))
+  with pytest.raises(ValueError):
+    dist.pdf(np.zeros((4, 2)))
+
+
+def test_compress_weights(tmp_path):
+  rng = np.random.default_rng(0)
+  n = 1001
+  files = {
+      'q_mean': rng.normal(0, 0.5, n),
+      'q_std': rng.uniform(0.5, 0.7, n),
+      'p_mean': np.zeros(n),
+      'p_std': np.ones(n),
+  }
+  paths = {}
+  for name, values in files.items():
+    paths[name] = str(tmp_path / (name + '.bin'))
+    values.astype(np.float32).tofile(paths[name])
+
+  encoded = [str(tmp_path / 'a.rcc'), str(tmp_path / 'b.rcc')]
+  for path, workers in zip(encoded, [1, 4]):
+    size = hybrid_rcc.compress_weights(
+        paths['q_mean'], paths['q_std'], paths['p_mean'], paths['p_std'],
+        path, 8, 0.5, 42, 64, workers
+    )
+    assert size > 0
+  with open(encoded[0], 'rb') as a, open(encoded[1], 'rb') as b:
+    assert a.read() == b.read()
+
+  output = str(tmp_path / 'weights.bin')
+  assert (
+      hybrid_rcc.decompress_weights(
+          encoded[0], paths['p_mean'], paths['p_std'], output
+      )
+      == n
+  )
+  weights = np.fromfile(output, dtype=np.float32)
+  assert weights.shape == (n,)
+  assert np.all(np.isfinite(weights))
+
+  container = str(tmp_path / 'c.rcc')
+  assert hybrid_rcc.compress_weights(
+      paths['q_mean'], paths['q_std'], paths['p_mean'], paths['p_std'],
+      container, 8, 0.5, 42, 64, 4, seekable=True
+  ) > 0
+  for first, last in [(0, 126), (5, 9), (125, 126), (7, 7)]:
+    begin, end = 8 * first, min(n, 8 * last)
+    decoded = hybrid_rcc.decode_blocks(
+        container, first, last, files['p_mean'][begin:end],
+        files['p_std'][begin:end]
+    )
+    np.testing.assert_array_equal(decoded.astype(np.float32),
+                                  weights[begin:end])
+  with pytest.raises(RuntimeError):
+    hybrid_rcc.decode_blocks(container, 0, 127, np.zeros(0), np.zeros(0))
+
+  # One block of 8 doubles fits the cache.
+  decoder = hybrid_rcc.LazyDecoder(container, cache_bytes=64)
+  assert decoder.num_blocks() == 126
+  np.testing.assert_array_equal(decoder.block(5).astype(np.float32),
+                                weights[40:48])
+  blocks = decoder.blocks([125, 5, 125])
+  np.testing.assert_array_equal(blocks[0].astype(np.float32), weights[1000:])
+  np.testing.assert_array_equal(blocks[0], blocks[2])
+  # Block 5 hits; caching block 125 evicts it.
+  metrics = decoder.metrics()
+  assert (metrics.hits, metrics.misses) == (1, 3)
+  assert metrics.cached_blocks == 1 and metrics.evictions == 1
+  decoder.block(125)
+  assert decoder.metrics().hits == 2
+
+
+@pytest.fixture
+def rccd_client(tmp_path):
+  # The daemon is a separate binary; RCCD overrides the one on the PATH.
+  binary = os.environ.get('RCCD') or shutil.which('rccd')
+  if not binary:
+    pytest.skip('rccd not found')
+  socket_path = str(tmp_path / 'rccd.sock')
+  daemon = subprocess.Popen(
+      [binary, '--socket=' + socket_path, '--workers=2'],
+      stdout=subprocess.DEVNULL,
+  )
+  try:
+    # The socket file appears before the daemon listens on it.
+    deadline = time.monotonic() + 10
+    while True:
+      try:
+        client = hybrid_rcc.DaemonClient(socket_path)
+        break
+      except RuntimeError:
+        assert daemon.poll() is None and time.monotonic() < deadline
+        time.sleep(0.01)
+    yield client
+  finally:
+    daemon.terminate()
+    daemon.wait()
+
+
+def test_daemon_round_trip(rccd_client):
+  client = rccd_client
+  rng = np.random.default_rng(4)
+  p_mean = rng.normal(0, 0.1, 4)
+  p_std = rng.uniform(0.8, 1.2, 4)
+  prior = client.register_prior(7, p_mean, p_std)
+  assert prior != 0
+  assert client.register_prior(7, p_mean.copy(), p_std.copy()) == prior
+  # A key can not be reused for another prior.
+  assert client.register_prior(7, p_mean + 1e-9, p_std) == 0
+  assert client.register_prior(7, p_mean, p_std[:3]) == 0
+  options = hybrid_rcc.HybridOptions()
+  options.elide_kl = 1e-3
+  for seed in range(10):
+    q_mean = p_mean + rng.normal(0, 0.5, 4)
+    q_std = rng.uniform(0.2, 0.6, 4)
+    # The last dimension is next to the prior and gets elided.
+    q_mean[3], q_std[3] = p_mean[3], p_std[3]
+    want = hybrid_rcc.sample_gaussian_hybrid(
+        q_mean,
+        q_std,
+        p_mean,
+        p_std,
+        hybrid_rcc.SamplingAlgorithm.PFR,
+        1e-4,
+        seed,
+        1 << 16,
+        False,
+        options=options,
+    )
+    by_id = client.sample_gaussian_hybrid(
+        q_mean, q_std, prior=prior, seed=seed, options=options
+    )
+    inline = client.sample_gaussian_hybrid(
+        q_mean, q_std, p_mean, p_std, seed=seed, options=options
+    )
+    for output in (by_id, inline):
+      compare_sampling_outputs(output, want, 0.0)
+      assert output.status.elided == want.status.elided == 1
+    np.testing.assert_array_equal(
+        client.decode_gaussian_hybrid(by_id, prior=prior), want.sample_opt
+    )
+    np.testing.assert_array_equal(
+        client.decode_gaussian_hybrid(inline, p_mean, p_std),
+        hybrid_rcc.decode_gaussian_hybrid(want, p_mean, p_std),
+    )
+  with pytest.raises(RuntimeError):
+    client.sample_gaussian_hybrid(q_mean, q_std, prior=prior + 1)
+
+
+class RccEncodeOptions(ctypes.Structure):
+  # rcc_encode_options of capi/hybrid_rcc.h.
+  _fields_ = [
+      ('struct_size', ctypes.c_uint32),
+      ('pfr', ctypes.c_int32),
+      ('eps', ctypes.c_double),
+      ('N_max', ctypes.c_uint32),
+      ('timeout', ctypes.c_double),
+      ('fallback', ctypes.c_int32),
+      ('table_cells', ctypes.c_int32),
+      ('early_abort', ctypes.c_int32),
+      ('elide_kl', ctypes.c_double),
+      ('single_shot_kl', ctypes.c_double),
+  ]
+
+
+class RccEncodeInfo(ctypes.Structure):
+  _fields_ = [
+      ('struct_size', ctypes.c_uint32),
+      ('sample_index', ctypes.c_int32),
+      ('total_number_samples', ctypes.c_int32),
+      ('t', ctypes.c_double),
+      ('s', ctypes.c_double),
+      ('w_min_stop', ctypes.c_int32),
+      ('deadline_stop', ctypes.c_int32),
+      ('fallback', ctypes.c_int32),
+      ('single_shot', ctypes.c_int32),
+      ('elided', ctypes.c_int32),
+      ('elided_kl', ctypes.c_double),
+  ]
+
+
+@pytest.fixture
+def capi():
+  # libhybrid_rcc is built separately; RCC_LIBRARY overrides the search.
+  path = os.environ.get('RCC_LIBRARY') or ctypes.util.find_library(
+      'hybrid_rcc'
+  )
+  if not path:
+    pytest.skip('libhybrid_rcc not found')
+  return ctypes.CDLL(path)
+
+
+def as_doubles(x):
+  return x.ctypes.data_as(ctypes.POINTER(ctypes.c_double))
+
+
+def test_capi_round_trip(capi):
+  assert capi.rcc_abi_version() == 1
+  dim, count = 3, 12
+  p_mean = np.array([0.1, -0.2, 0.0])
+  p_std = np.array([1.0, 1.5, 0.8])
+  prior = ctypes.c_void_p()
+  assert capi.rcc_prior_create(
+      as_doubles(p_mean), as_doubles(p_std), ctypes.c_size_t(dim),
+      ctypes.byref(prior)
+  ) == 0
+  workspace = ctypes.c_void_p()
+  assert capi.rcc_workspace_create(2, ctypes.byref(workspace)) == 0
+  try:
+    options = RccEncodeOptions()
+    capi.rcc_encode_options_init(ctypes.byref(options))
+    assert options.struct_size == ctypes.sizeof(RccEncodeOptions)
+    assert options.single_shot_kl == 1e-6
+    options.pfr = 1
+    options.eps = 1e-4
+    options.N_max = 1 << 16
+
+    rng = np.random.default_rng(5)
+    q_mean = p_mean + rng.normal(0, 0.5, (count, dim))
+    q_std = rng.uniform(0.1, 0.6, (count, dim))
+    seeds = np.arange(count, dtype=np.uint64) + 100
+    samples = np.zeros((count, dim))
+    signals = np.zeros((count, dim))
+    boxes = np.zeros((count, dim))
+    infos = (RccEncodeInfo * count)()
+    for info in infos:
+      capi.rcc_encode_info_init(ctypes.byref(info))
+    assert infos[0].struct_size == ctypes.sizeof(RccEncodeInfo)
+    assert capi.rcc_sample_gaussian_hybrid_batch(
+        workspace, prior, ctypes.c_size_t(count), as_doubles(q_mean),
+        as_doubles(q_std),
+        seeds.ctypes.data_as(ctypes.POINTER(ctypes.c_uint64)),
+        ctypes.byref(options), as_doubles(samples), as_doubles(signals),
+        as_doubles(boxes), infos
+    ) == 0
+    for b in range(count):
+      want = hybrid_rcc.sample_gaussian_hybrid(
+          q_mean[b],
+          q_std[b],
+          p_mean,
+          p_std,
+          hybrid_rcc.SamplingAlgorithm.PFR,
+          1e-4,
+          int(seeds[b]),
+          1 << 16,
+          False,
+      )
+      assert infos[b].sample_index == want.sample_index
+      assert infos[b].total_number_samples == want.total_number_samples
+      assert infos[b].single_shot == want.status.single_shot
+      assert infos[b].elided == 0
+      np.testing.assert_array_equal(samples[b], want.sample_opt)
+      np.testing.assert_array_equal(signals[b], want.signal)
+      np.testing.assert_array_equal(boxes[b], want.box_dimensions)
+
+      sample = np.zeros(dim)
+      assert capi.rcc_decode_hybrid(
+          prior, ctypes.c_uint64(int(seeds[b])),
+          ctypes.c_int32(infos[b].sample_index), as_doubles(signals[b]),
+          as_doubles(boxes[b]), as_doubles(sample)
+      ) == 0
+      np.testing.assert_array_equal(sample, want.sample_opt)
+
+    # Callers built against ABI version 1 lack elide_kl.
+    options.struct_size = RccEncodeOptions.elide_kl.offset
+    options.elide_kl = 1.0
+    sample = np.zeros(dim)
+    signal = np.zeros(dim)
+    box = np.zeros(dim)
+    assert capi.rcc_sample_gaussian_hybrid(
+        prior, as_doubles(q_mean[0]), as_doubles(q_std[0]),
+        ctypes.c_uint64(int(seeds[0])), ctypes.byref(options),
+        as_doubles(sample), as_doubles(signal), as_doubles(box), None
+    ) == 0
+    np.testing.assert_array_equal(box, boxes[0])
+
+    # The elision status reaches the caller's info, but only the fields
+    # that fit in its struct_size.
+    options.struct_size = ctypes.sizeof(RccEncodeOptions)
+    hybrid_options = hybrid_rcc.HybridOptions()
+    hybrid_options.elide_kl = 1.0
+    want = hybrid_rcc.sample_gaussian_hybrid(
+        q_mean[0],
+        q_std[0],
+        p_mean,
+        p_std,
+        hybrid_rcc.SamplingAlgorithm.PFR,
+        1e-4,
+        int(seeds[0]),
+        1 << 16,
+        False,
+        options=hybrid_options,
+    )
+    assert want.status.elided > 0
+    full_size = ctypes.sizeof(RccEncodeInfo)
+    for size in (full_size, RccEncodeInfo.single_shot.offset):
+      info = RccEncodeInfo()
+      capi.rcc_encode_info_init(ctypes.byref(info))
+      info.struct_size = size
+      info.elided = -1
+      assert capi.rcc_sample_gaussian_hybrid(
+          prior, as_doubles(q_mean[0]), as_doubles(q_std[0]),
+          ctypes.c_uint64(int(seeds[0])), ctypes.byref(options),
+          as_doubles(sample), as_doubles(signal), as_doubles(box),
+          ctypes.byref(info)
+      ) == 0
+      np.testing.assert_array_equal(box, want.box_dimensions)
+      assert info.sample_index == want.sample_index
+      if size == full_size:
+        assert info.elided == want.status.elided
+        assert info.elided_kl == pytest.approx(want.status.elided_kl)
+      else:
+        assert info.elided == -1
+    info.struct_size = RccEncodeInfo.fallback.offset
+    assert capi.rcc_sample_gaussian_hybrid(
+        prior, as_doubles(q_mean[0]), as_doubles(q_std[0]),
+        ctypes.c_uint64(0), ctypes.byref(options), as_doubles(sample),
+        as_doubles(signal), as_doubles(box), ctypes.byref(info)
+    ) == 1
+
+    # Bad arguments leave the outputs alone.
+    options.struct_size = ctypes.sizeof(RccEncodeOptions)
+    options.eps = 0
+    sample[:] = 7
+    assert capi.rcc_sample_gaussian_hybrid(
+        prior, as_doubles(q_mean[0]), as_doubles(q_std[0]),
+        ctypes.c_uint64(0), ctypes.byref(options), as_doubles(sample),
+        as_doubles(signal), as_doubles(box), None
+    ) == 1
+    np.testing.assert_array_equal(sample, 7)
+  finally:
+    capi.rcc_workspace_destroy(workspace)
+    capi.rcc_prior_destroy(prior)
@@ -1,51 +1,639 @@
 #include "py/interface.h"
 
+#include <chrono>
+#include <future>
+#include <optional>
+#include <utility>
+
+#include "algorithm/categorical.h"
+#include "algorithm/codebook.h"
+#include "algorithm/layered.h"
+#include "algorithm/multi_posterior.h"
 #include "algorithm/reverse_channel.h"
+#include "algorithm/tuner.h"
+#include "pipeline/batch_scheduler.h"
+#include "pipeline/block_container.h"
+#include "pipeline/daemon_client.h"
+#include "pipeline/encoder_pipeline.h"
+#include "pipeline/lazy_decoder.h"
+#include "pipeline/weight_compression.h"
 #include "stats/distributions/multivariate/continuous/gaussian.h"
+#include "stats/distributions/multivariate/continuous/laplace.h"
+#include "stats/distributions/multivariate/continuous/logistic.h"
+#include "stats/distributions/multivariate/continuous/student_t.h"
+#include "stats/distributions/multivariate/continuous/truncated_gaussian.h"
+#include "stats/distributions/multivariate/continuous/uniform.h"
+#include "stats/distributions/multivariate/discrete/categorical.h"
+#include "stats/random_number_generator/ziggurat.h"
 #include "include/pcg_random.hpp"
 #include "pybind11/cast.h"
 #include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
 
 namespace rcc::interface {
+using stats::multivariates::IndependentCategorical;
 using stats::multivariates::IndependentGaussian;
 
-SamplingOutput sample_gaussian_hybrid(VecType q_mean, VecType q_std,
-                                      VecType p_mean, VecType p_std,
-                                      SamplingAlgorithm sampling_algorithm,
-                                      double eps, uint64_t seed, uint32_t N_max,
-                                      bool verbose) {
-  IndependentGaussian p(p_mean, p_std);
-  IndependentGaussian q(q_mean, q_std);
+namespace {
+// The samplers and the decoder in Scalar. Float outputs are widened to
+// double exactly, so a float SamplingOutput decodes in float bit for bit.
+template <typename Scalar>
+SamplingOutput sample_gaussian_hybrid_in(
+    const rcc::algorithm::Vector<Scalar> &q_mean,
+    const rcc::algorithm::Vector<Scalar> &q_std,
+    const rcc::algorithm::Vector<Scalar> &p_mean,
+    const rcc::algorithm::Vector<Scalar> &p_std,
+    SamplingAlgorithm sampling_algorithm, double eps, uint64_t seed,
+    uint32_t N_max, bool verbose,
+    const rcc::algorithm::HybridOptions &options, double timeout,
+    rcc::algorithm::Fallback fallback) {
+  if (!(timeout >= 0))
+    throw std::invalid_argument("timeout must be non-negative");
+  rcc::algorithm::Deadline deadline;
+  if (timeout > 0)
+    deadline = rcc::algorithm::Deadline::after(
+        std::chrono::duration_cast<rcc::algorithm::Deadline::Clock::duration>(
+            std::chrono::duration<double>(timeout)));
+  stats::multivariates::BasicIndependentGaussian<Scalar> p(p_mean, p_std);
+  stats::multivariates::BasicIndependentGaussian<Scalar> q(q_mean, q_std);
   pcg32 rs(seed);
+  rcc::algorithm::SamplerStatus status;
   auto [z, n, k, i, M] = rcc::algorithm::sample_gaussian_hybrid(
       &q, &p, sampling_algorithm == SamplingAlgorithm::PFR, eps, rs, N_max,
-      verbose);
-  return SamplingOutput(z, n, i, seed, k, M);
+      verbose, deadline, fallback, &status, options);
+  SamplingOutput output(z.template cast<double>(), n, i, seed,
+                        k.template cast<double>(), M.template cast<double>());
+  output.status_ = status;
+  return output;
+}
+
+template <typename Scalar>
+SamplingOutput sample_gaussian_in(const rcc::algorithm::Vector<Scalar> &q_mean,
+                                  const rcc::algorithm::Vector<Scalar> &q_std,
+                                  const rcc::algorithm::Vector<Scalar> &p_mean,
+                                  const rcc::algorithm::Vector<Scalar> &p_std,
+                                  SamplingAlgorithm sampling_algorithm,
+                                  uint64_t seed, uint32_t N_max,
+                                  bool verbose) {
+  stats::multivariates::BasicIndependentGaussian<Scalar> p(p_mean, p_std);
+  stats::multivariates::BasicIndependentGaussian<Scalar> q(q_mean, q_std);
+  pcg32 rs(seed);
+  auto [z, n, i] = rcc::algorithm::sample_gaussian(
+      &q, &p, sampling_algorithm == SamplingAlgorithm::PFR, rs, N_max, verbose);
+  return SamplingOutput(z.template cast<double>(), n, i, seed);
+}
+
+template <typename Scalar>
+rcc::algorithm::Vector<Scalar> decode_gaussian_hybrid_in(
+    const SamplingOutput &h, const rcc::algorithm::Vector<Scalar> &p_mean,
+    const rcc::algorithm::Vector<Scalar> &p_std) {
+  stats::multivariates::BasicIndependentGaussian<Scalar> p(p_mean, p_std);
+  pcg32 rs(h.seed_);
+  return rcc::algorithm::decode_hybrid(
+      h.sample_index_, rcc::algorithm::Vector<Scalar>(h.signal_.cast<Scalar>()),
+      rcc::algorithm::Vector<Scalar>(h.box_dimensions_.cast<Scalar>()), p,
+      p_mean.size(), rs);
+}
+}  // namespace
+
+namespace {
+// The request of sample_gaussian_hybrid(q_mean, ..., options) for the
+// batch encoder, the pipeline and the daemon.
+rcc::pipeline::EncodeRequest make_encode_request(
+    VecType q_mean, VecType q_std, VecType p_mean, VecType p_std,
+    SamplingAlgorithm sampling_algorithm, double eps, uint64_t seed,
+    uint32_t N_max, const rcc::algorithm::HybridOptions &options) {
+  rcc::pipeline::EncodeRequest request;
+  request.q_mean = std::move(q_mean);
+  request.q_std = std::move(q_std);
+  request.p_mean = std::move(p_mean);
+  request.p_std = std::move(p_std);
+  request.pfr = sampling_algorithm == SamplingAlgorithm::PFR;
+  request.eps = eps;
+  request.seed = seed;
+  request.N_max = N_max;
+  request.hybrid_options = options;
+  return request;
+}
+
+SamplingOutput to_sampling_output(const rcc::pipeline::EncodeResult &result) {
+  SamplingOutput output(result.sample, result.sample_index,
+                        result.total_number_samples, result.seed,
+                        result.signal, result.box_dimensions);
+  output.status_ = result.status;
+  return output;
+}
+}  // namespace
+
+SamplingOutput sample_gaussian_hybrid(
+    VecType q_mean, VecType q_std, VecType p_mean, VecType p_std,
+    SamplingAlgorithm sampling_algorithm, double eps, uint64_t seed,
+    uint32_t N_max, bool verbose,
+    const rcc::algorithm::HybridOptions &options, double timeout,
+    rcc::algorithm::Fallback fallback) {
+  return sample_gaussian_hybrid_in(q_mean, q_std, p_mean, p_std,
+                                   sampling_algorithm, eps, seed, N_max,
+                                   verbose, options, timeout, fallback);
+}
+
+SamplingOutput sample_gaussian_hybrid(
+    VecTypeF q_mean, VecTypeF q_std, VecTypeF p_mean, VecTypeF p_std,
+    SamplingAlgorithm sampling_algorithm, double eps, uint64_t seed,
+    uint32_t N_max, bool verbose,
+    const rcc::algorithm::HybridOptions &options, double timeout,
+    rcc::algorithm::Fallback fallback) {
+  return sample_gaussian_hybrid_in(q_mean, q_std, p_mean, p_std,
+                                   sampling_algorithm, eps, seed, N_max,
+                                   verbose, options, timeout, fallback);
 }
 
 SamplingOutput sample_gaussian(VecType q_mean, VecType q_std, VecType p_mean,
                                VecType p_std,
                                SamplingAlgorithm sampling_algorithm,
                                uint64_t seed, uint32_t N_max, bool verbose) {
+  return sample_gaussian_in(q_mean, q_std, p_mean, p_std, sampling_algorithm,
+                            seed, N_max, verbose);
+}
+
+SamplingOutput sample_gaussian(VecTypeF q_mean, VecTypeF q_std,
+                               VecTypeF p_mean, VecTypeF p_std,
+                               SamplingAlgorithm sampling_algorithm,
+                               uint64_t seed, uint32_t N_max, bool verbose) {
+  return sample_gaussian_in(q_mean, q_std, p_mean, p_std, sampling_algorithm,
+                            seed, N_max, verbose);
+}
+
+std::vector<SamplingOutput> sample_gaussian_multi(
+    MatType q_mean, MatType q_std, VecType p_mean, VecType p_std,
+    SamplingAlgorithm sampling_algorithm, uint64_t seed, uint32_t N_max) {
+  if (q_std.rows() != q_mean.rows() || q_std.cols() != q_mean.cols() ||
+      q_mean.cols() != p_mean.size() || p_std.size() != p_mean.size())
+    throw std::invalid_argument(
+        "q_mean and q_std must have one column per prior dimension");
   IndependentGaussian p(p_mean, p_std);
-  IndependentGaussian q(q_mean, q_std);
-  pcg32 rs(seed);
-  auto [z, n, i] = rcc::algorithm::sample_gaussian(
-      &q, &p, sampling_algorithm == SamplingAlgorithm::PFR, rs, N_max, verbose);
-  return SamplingOutput(z, n, i, seed);
+  std::vector<IndependentGaussian> q;
+  for (Eigen::Index k = 0; k < q_mean.rows(); k++)
+    q.emplace_back(q_mean.row(k).transpose(), q_std.row(k).transpose());
+  auto samples = rcc::algorithm::sample_gaussian_multi(
+      q, &p, sampling_algorithm == SamplingAlgorithm::PFR, pcg32(seed),
+      N_max);
+  std::vector<SamplingOutput> outputs;
+  for (const auto &[z, n, i] : samples)
+    outputs.emplace_back(z, n, i, seed);
+  return outputs;
+}
+
+std::vector<SamplingOutput> sample_gaussian_hybrid_batch(
+    MatType q_mean, MatType q_std, VecType p_mean, VecType p_std,
+    SamplingAlgorithm sampling_algorithm, double eps,
+    std::vector<uint64_t> seeds, uint32_t N_max,
+    const rcc::algorithm::HybridOptions &options, int num_workers) {
+  if (q_std.rows() != q_mean.rows() || q_std.cols() != q_mean.cols() ||
+      q_mean.cols() != p_mean.size() || p_std.size() != p_mean.size())
+    throw std::invalid_argument(
+        "q_mean and q_std must have one column per prior dimension");
+  if (seeds.size() != static_cast<size_t>(q_mean.rows()))
+    throw std::invalid_argument("seeds must have one entry per row of q_mean");
+  if (num_workers < 0)
+    throw std::invalid_argument("num_workers must not be negative");
+  std::vector<rcc::pipeline::EncodeRequest> requests;
+  for (Eigen::Index k = 0; k < q_mean.rows(); k++)
+    requests.push_back(make_encode_request(
+        q_mean.row(k).transpose(), q_std.row(k).transpose(), p_mean, p_std,
+        sampling_algorithm, eps, seeds[k], N_max, options));
+  rcc::pipeline::SchedulerOptions scheduler;
+  if (num_workers > 0) scheduler.num_workers = num_workers;
+  std::vector<SamplingOutput> outputs;
+  for (const auto &result : rcc::pipeline::encode_batch(requests, scheduler))
+    outputs.push_back(to_sampling_output(result));
+  return outputs;
 }
 
 VecType decode_gaussian_hybrid(SamplingOutput h, VecType p_mean,
                                VecType p_std) {
-  IndependentGaussian p(p_mean, p_std);
-  pcg32 rs(h.seed_);
+  return decode_gaussian_hybrid_in(h, p_mean, p_std);
+}
+
+VecTypeF decode_gaussian_hybrid(SamplingOutput h, VecTypeF p_mean,
+                                VecTypeF p_std) {
+  return decode_gaussian_hybrid_in(h, p_mean, p_std);
+}
+
+namespace {
+template <typename Prior>
+SamplingOutput sample_uniform_hybrid_with(
+    stats::multivariates::IndependentUniform q, Prior p,
+    SamplingAlgorithm sampling_algorithm, uint64_t seed, uint32_t N_max,
+    bool verbose, double single_shot_kl) {
+  if (q.mean().size() != p.mean().size())
+    throw std::invalid_argument("q and p must have the same dimension");
+  rcc::algorithm::SamplerStatus status;
+  auto [z, n, k, i, M] = rcc::algorithm::sample_uniform_hybrid(
+      &q, &p, sampling_algorithm == SamplingAlgorithm::PFR, pcg32(seed), N_max,
+      verbose, rcc::algorithm::Deadline(), &status, single_shot_kl);
+  SamplingOutput output(z, n, i, seed, k, M);
+  output.status_ = status;
+  return output;
+}
+
+template <typename Prior>
+VecType decode_uniform_hybrid_with(const SamplingOutput &h, Prior p) {
   return rcc::algorithm::decode_hybrid(h.sample_index_, h.signal_,
-                                       h.box_dimensions_, p, p_mean.size(), rs);
+                                       h.box_dimensions_, p, p.mean().size(),
+                                       pcg32(h.seed_));
+}
+}  // namespace
+
+SamplingOutput sample_uniform_hybrid(
+    stats::multivariates::IndependentUniform q, IndependentGaussian p,
+    SamplingAlgorithm sampling_algorithm, uint64_t seed, uint32_t N_max,
+    bool verbose, double single_shot_kl) {
+  return sample_uniform_hybrid_with(q, p, sampling_algorithm, seed, N_max,
+                                    verbose, single_shot_kl);
+}
+
+SamplingOutput sample_uniform_hybrid(
+    stats::multivariates::IndependentUniform q,
+    stats::multivariates::IndependentUniform p,
+    SamplingAlgorithm sampling_algorithm, uint64_t seed, uint32_t N_max,
+    bool verbose, double single_shot_kl) {
+  return sample_uniform_hybrid_with(q, p, sampling_algorithm, seed, N_max,
+                                    verbose, single_shot_kl);
+}
+
+VecType decode_uniform_hybrid(SamplingOutput h, IndependentGaussian p) {
+  return decode_uniform_hybrid_with(h, p);
+}
+
+VecType decode_uniform_hybrid(SamplingOutput h,
+                              stats::multivariates::IndependentUniform p) {
+  return decode_uniform_hybrid_with(h, p);
+}
+
+SamplingOutput sample_uniform_hybrid(
+    stats::multivariates::IndependentUniform q,
+    stats::multivariates::IndependentLaplace p,
+    SamplingAlgorithm sampling_algorithm, uint64_t seed, uint32_t N_max,
+    bool verbose, double single_shot_kl) {
+  return sample_uniform_hybrid_with(q, p, sampling_algorithm, seed, N_max,
+                                    verbose, single_shot_kl);
+}
+
+SamplingOutput sample_uniform_hybrid(
+    stats::multivariates::IndependentUniform q,
+    stats::multivariates::IndependentLogistic p,
+    SamplingAlgorithm sampling_algorithm, uint64_t seed, uint32_t N_max,
+    bool verbose, double single_shot_kl) {
+  return sample_uniform_hybrid_with(q, p, sampling_algorithm, seed, N_max,
+                                    verbose, single_shot_kl);
+}
+
+SamplingOutput sample_uniform_hybrid(
+    stats::multivariates::IndependentUniform q,
+    stats::multivariates::IndependentStudentT p,
+    SamplingAlgorithm sampling_algorithm, uint64_t seed, uint32_t N_max,
+    bool verbose, double single_shot_kl) {
+  return sample_uniform_hybrid_with(q, p, sampling_algorithm, seed, N_max,
+                                    verbose, single_shot_kl);
+}
+
+VecType decode_uniform_hybrid(SamplingOutput h,
+                              stats::multivariates::IndependentLaplace p) {
+  return decode_uniform_hybrid_with(h, p);
+}
+
+VecType decode_uniform_hybrid(SamplingOutput h,
+                              stats::multivariates::IndependentLogistic p) {
+  return decode_uniform_hybrid_with(h, p);
+}
+
+VecType decode_uniform_hybrid(SamplingOutput h,
+                              stats::multivariates::IndependentStudentT p) {
+  return decode_uniform_hybrid_with(h, p);
+}
+
+SamplingOutput sample_categorical(MatType q_probs, MatType p_probs,
+                                  SamplingAlgorithm sampling_algorithm,
+                                  uint64_t seed, uint32_t N_max, bool verbose) {
+  IndependentCategorical p(p_probs);
+  IndependentCategorical q(q_probs);
+  pcg32 rs(seed);
+  auto [z, n, i] = rcc::algorithm::sample_categorical(
+      q, p, sampling_algorithm == SamplingAlgorithm::PFR, rs, N_max, verbose);
+  return SamplingOutput(z.cast<double>(), n, i, seed);
+}
+
+VecType decode_categorical(SamplingOutput h, MatType p_probs) {
+  IndependentCategorical p(p_probs);
+  pcg32 rs(h.seed_);
+  return rcc::algorithm::decode_categorical(h.sample_index_, p, rs)
+      .cast<double>();
+}
+
+std::vector<SamplingOutput> sample_gaussian_layered(
+    VecType q_mean, VecType q_std, VecType p_mean, VecType p_std,
+    std::vector<double> noise, SamplingAlgorithm sampling_algorithm,
+    double eps, uint64_t seed, uint32_t N_max) {
+  if (!rcc::internal::valid_noise(noise))
+    throw std::invalid_argument(
+        "noise must be strictly decreasing and end with 0");
+  IndependentGaussian p(p_mean, p_std);
+  IndependentGaussian q(q_mean, q_std);
+  rcc::algorithm::LayeredEncoder encoder(
+      q, p, noise, eps, seed, N_max,
+      sampling_algorithm == SamplingAlgorithm::PFR);
+  std::vector<SamplingOutput> outputs;
+  while (!encoder.done()) {
+    rcc::algorithm::Layer layer = encoder.next();
+    outputs.emplace_back(encoder.sample(), layer.sample_index,
+                         layer.total_number_samples, seed, layer.signal,
+                         layer.box_dimensions);
+  }
+  return outputs;
+}
+
+std::vector<VecType> decode_gaussian_layered(std::vector<SamplingOutput> h,
+                                             VecType p_mean, VecType p_std,
+                                             std::vector<double> noise) {
+  if (!rcc::internal::valid_noise(noise))
+    throw std::invalid_argument(
+        "noise must be strictly decreasing and end with 0");
+  if (h.size() > noise.size())
+    throw std::invalid_argument("more layers than noise levels");
+  IndependentGaussian p(p_mean, p_std);
+  rcc::algorithm::LayeredDecoder decoder(p, noise,
+                                         h.empty() ? 0 : h.front().seed_);
+  std::vector<VecType> samples;
+  for (const SamplingOutput &output : h) {
+    rcc::algorithm::Layer layer;
+    layer.sample_index = output.sample_index_;
+    layer.signal = output.signal_;
+    layer.box_dimensions = output.box_dimensions_;
+    samples.push_back(decoder.add(layer));
+  }
+  return samples;
+}
+
+namespace {
+rcc::algorithm::IndexModel parse_index_model(const std::string &header) {
+  rcc::algorithm::IndexModel model;
+  if (!rcc::algorithm::IndexModel::from_header(
+          reinterpret_cast<const uint8_t *>(header.data()), header.size(),
+          &model))
+    throw std::invalid_argument("header is not an index model header");
+  return model;
+}
+
+std::string to_string(const std::vector<uint8_t> &bytes) {
+  return std::string(bytes.begin(), bytes.end());
+}
+}  // namespace
+
+std::tuple<std::string, std::string> encode_sample_indices(
+    std::vector<uint32_t> indices, std::string header) {
+  rcc::algorithm::IndexEncoder encoder(parse_index_model(header));
+  for (uint32_t n : indices) {
+    if (n == UINT32_MAX) throw std::invalid_argument("index out of range");
+    encoder.encode(n);
+  }
+  std::string code = to_string(encoder.finish());
+  return {code, to_string(encoder.model().header())};
+}
+
+std::tuple<std::vector<uint32_t>, std::string> decode_sample_indices(
+    std::string code, int count, std::string header) {
+  if (count < 0) throw std::invalid_argument("count must be non-negative");
+  rcc::algorithm::IndexDecoder decoder(
+      reinterpret_cast<const uint8_t *>(code.data()), code.size(),
+      parse_index_model(header));
+  std::vector<uint32_t> indices(count);
+  for (uint32_t &n : indices) n = decoder.decode();
+  return {indices, to_string(decoder.model().header())};
+}
+
+rcc::algorithm::IndexCodingReport report_index_coding(
+    std::vector<SamplingOutput> h, MatType q_std, MatType p_std,
+    std::string header) {
+  if (q_std.rows() != static_cast<Eigen::Index>(h.size()) ||
+      p_std.rows() != q_std.rows() || p_std.cols() != q_std.cols())
+    throw std::invalid_argument(
+        "q_std and p_std must have one row per block");
+  std::vector<uint32_t> indices;
+  std::vector<double> mi, log2M;
+  for (size_t b = 0; b < h.size(); b++) {
+    if (h[b].box_dimensions_.size() == 0)
+      throw std::invalid_argument("blocks must come from the hybrid sampler");
+    indices.push_back(h[b].sample_index_);
+    mi.push_back((p_std.row(b) / q_std.row(b)).log2().sum());
+    log2M.push_back(h[b].box_dimensions_.log2().sum());
+  }
+  return rcc::algorithm::report_index_coding(indices, mi, log2M,
+                                             parse_index_model(header));
+}
+
+int64_t compress_weights(std::string q_mean, std::string q_std,
+                         std::string p_mean, std::string p_std,
+                         std::string output, uint32_t block_size, double eps,
+                         uint64_t seed, uint32_t N_max, int num_workers,
+                         bool seekable) {
+  rcc::pipeline::CompressionOptions options;
+  options.block_size = block_size;
+  options.eps = eps;
+  options.seed = seed;
+  options.N_max = N_max;
+  if (num_workers > 0) options.pipeline.num_workers = num_workers;
+  options.seekable = seekable;
+  rcc::pipeline::CompressionStats stats;
+  if (!rcc::pipeline::compress_weights({q_mean, q_std, p_mean, p_std}, output,
+                                       options, &stats))
+    return -1;
+  return stats.encoded_bytes;
+}
+
+int64_t decompress_weights(std::string input, std::string p_mean,
+                           std::string p_std, std::string output) {
+  rcc::pipeline::CompressionStats stats;
+  if (!rcc::pipeline::decompress_weights(input, p_mean, p_std, output,
+                                         1 << 14, &stats))
+    return -1;
+  return stats.num_parameters;
+}
+
+VecType decode_blocks(std::string input, uint64_t first, uint64_t last,
+                      VecType p_mean, VecType p_std) {
+  rcc::pipeline::ContainerReader reader;
+  VecType weights;
+  if (!reader.open(input) || !reader.decode(first, last, p_mean, p_std,
+                                            &weights))
+    throw std::runtime_error("cannot decode blocks of " + input);
+  return weights;
+}
+
+namespace {
+template <typename Sampler>
+VecType draws(uint64_t seed, int n, Sampler sampler) {
+  if (n < 0) throw std::invalid_argument("n must not be negative");
+  pcg32 engine(seed);
+  VecType values(n);
+  for (int j = 0; j < n; j++) values[j] = sampler(engine);
+  return values;
+}
+}  // namespace
+
+VecType uniform_draws(uint64_t seed, int n) {
+  return draws(seed, n, stats::uniform01<pcg32>);
+}
+
+VecType exponential_draws(uint64_t seed, int n) {
+  return draws(seed, n, stats::exponential_ziggurat<pcg32>);
+}
+
+VecType normal_draws(uint64_t seed, int n) {
+  return draws(seed, n, stats::normal_ziggurat<pcg32>);
 }
 }  // namespace rcc::interface
 
 namespace py = ::pybind11;
+namespace {
+using rcc::interface::VecType;
+
+// A request submitted to an EncoderPipeline. The future is shared so that
+// result() can be called again.
+class PendingEncode {
+ public:
+  explicit PendingEncode(std::future<rcc::pipeline::EncodeResult> future)
+      : future_(future.share()) {}
+
+  bool ready() const {
+    return future_.wait_for(std::chrono::seconds(0)) ==
+           std::future_status::ready;
+  }
+  // Waits for the encode and rethrows its exception, if any.
+  rcc::interface::SamplingOutput result() const {
+    return rcc::interface::to_sampling_output(future_.get());
+  }
+
+ private:
+  std::shared_future<rcc::pipeline::EncodeResult> future_;
+};
+
+void check_request(const rcc::pipeline::EncodeRequest &request) {
+  const Eigen::Index dim = request.q_mean.size();
+  if (dim == 0 || request.q_std.size() != dim ||
+      request.p_mean.size() != dim || request.p_std.size() != dim)
+    throw std::invalid_argument(
+        "q_mean, q_std, p_mean and p_std must have the same positive size");
+}
+
+std::string daemon_error(rcc::pipeline::DaemonStatus status) {
+  switch (status) {
+    case rcc::pipeline::DaemonStatus::kBusy:
+      return "daemon busy";
+    case rcc::pipeline::DaemonStatus::kBadRequest:
+      return "daemon rejected the request";
+    case rcc::pipeline::DaemonStatus::kUnknownPrior:
+      return "unknown prior";
+    default:
+      return "daemon request failed";
+  }
+}
+
+// The tuner takes blocks as the columns of dim x num_blocks arrays.
+void check_blocks(const Eigen::ArrayXXd &q_mean, const Eigen::ArrayXXd &q_std,
+                  const Eigen::ArrayXXd &p_mean, const Eigen::ArrayXXd &p_std) {
+  if (q_mean.size() == 0)
+    throw std::invalid_argument("no blocks to predict");
+  for (const Eigen::ArrayXXd *x : {&q_std, &p_mean, &p_std})
+    if (x->rows() != q_mean.rows() || x->cols() != q_mean.cols())
+      throw std::invalid_argument(
+          "q_mean, q_std, p_mean and p_std must have the same shape");
+}
+
+// Array methods shared by the independent distributions. The point-wise
+// methods take (n, dim) arrays and run without the GIL.
+template <typename Distribution>
+void add_distribution_methods(py::class_<Distribution> &c) {
+  using rcc::interface::map_points;
+  using rcc::interface::RowMatRef;
+  c.def(
+       "pdf",
+       [](const Distribution &d, RowMatRef X) {
+         return map_points(d, X, [](const auto &u, double x) {
+           return u.pdf(x);
+         });
+       },
+       py::call_guard<py::gil_scoped_release>())
+      .def(
+          "logpdf",
+          [](const Distribution &d, RowMatRef X) {
+            return map_points(d, X, [](const auto &u, double x) {
+              return u.logpdf(x);
+            });
+          },
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "cdf",
+          [](const Distribution &d, RowMatRef X) {
+            return map_points(d, X, [](const auto &u, double x) {
+              return u.cdf(x);
+            });
+          },
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "ppf",
+          [](const Distribution &d, RowMatRef P) {
+            return map_points(d, P, [](const auto &u, double p) {
+              return u.ppf(p);
+            });
+          },
+          py::call_guard<py::gil_scoped_release>())
+      .def("dim", [](const Distribution &d) { return d.univariates().size(); })
+      .def("mean", &Distribution::mean)
+      .def("std", &Distribution::std)
+      .def("var", &Distribution::var)
+      .def("entropy", &Distribution::entropy)
+      .def("support", &Distribution::support);
+}
+
+// The certified per dimension bound on log p(x)/q(x) behind w_min.
+template <typename Q, typename P>
+void add_minimum_log_weight(py::module &m) {
+  m.def(
+      "minimum_log_weight",
+      [](const Q &q, const P &p) {
+        return rcc::internal::minimum_log_weight(q, p);
+      },
+      py::arg("q"), py::arg("p"));
+}
+
+// sample_uniform_hybrid and decode_uniform_hybrid against a Prior.
+template <typename Prior>
+void add_uniform_hybrid(py::module &m) {
+  m.def("sample_uniform_hybrid",
+        py::overload_cast<stats::multivariates::IndependentUniform, Prior,
+                          rcc::interface::SamplingAlgorithm, uint64_t,
+                          uint32_t, bool, double>(
+            &rcc::interface::sample_uniform_hybrid),
+        py::arg("q"), py::arg("p"), py::arg("sampling_algorithm"),
+        py::arg("seed"), py::arg("N_max"), py::arg("verbose") = false,
+        py::arg("single_shot_kl") = 1e-6);
+  m.def("decode_uniform_hybrid",
+        py::overload_cast<rcc::interface::SamplingOutput, Prior>(
+            &rcc::interface::decode_uniform_hybrid));
+}
+}  // namespace
+
 void AddModules(pybind11::module& m) {
+  py::class_<rcc::algorithm::SamplerStatus>(m, "SamplerStatus")
+      .def_readonly("t", &rcc::algorithm::SamplerStatus::t)
+      .def_readonly("s", &rcc::algorithm::SamplerStatus::s)
+      .def_readonly("w_min_stop", &rcc::algorithm::SamplerStatus::w_min_stop)
+      .def_readonly("deadline_stop",
+                    &rcc::algorithm::SamplerStatus::deadline_stop)
+      .def_readonly("fallback", &rcc::algorithm::SamplerStatus::fallback)
+      .def_readonly("single_shot", &rcc::algorithm::SamplerStatus::single_shot)
+      .def_readonly("elided", &rcc::algorithm::SamplerStatus::elided)
+      .def_readonly("elided_kl", &rcc::algorithm::SamplerStatus::elided_kl);
   py::class_<rcc::interface::SamplingOutput>(m, "SamplingOutput")
       // Class properties.
       .def_readonly("sample_opt", &rcc::interface::SamplingOutput::sample_opt_)
@@ -57,6 +645,7 @@ void AddModules(pybind11::module& m) {
                     &rcc::interface::SamplingOutput::box_dimensions_)
       .def_readonly("total_number_samples",
                     &rcc::interface::SamplingOutput::total_number_samples_)
+      .def_readonly("status", &rcc::interface::SamplingOutput::status_)
       // Constructors.
       .def(py::init([](rcc::interface::VecType optimal_sampe, int sample_index,
                        int total_number_sambles, int seed) {
@@ -77,7 +666,466 @@ void AddModules(pybind11::module& m) {
   py::enum_<rcc::interface::SamplingAlgorithm>(m, "SamplingAlgorithm")
       .value("SIS", rcc::interface::SamplingAlgorithm::SIS)
       .value("PFR", rcc::interface::SamplingAlgorithm::PFR);
-  m.def("decode_gaussian_hybrid", &rcc::interface::decode_gaussian_hybrid);
-  m.def("sample_gaussian_hybrid", &rcc::interface::sample_gaussian_hybrid);
-  m.def("sample_gaussian", &rcc::interface::sample_gaussian);
+  // The float32 overloads come second: pybind11 first tries every overload
+  // without converting, so float64 arrays take the double ones and only
+  // float32 arrays the float ones.
+  m.def("decode_gaussian_hybrid",
+        py::overload_cast<rcc::interface::SamplingOutput,
+                          rcc::interface::VecType, rcc::interface::VecType>(
+            &rcc::interface::decode_gaussian_hybrid));
+  m.def("decode_gaussian_hybrid",
+        py::overload_cast<rcc::interface::SamplingOutput,
+                          rcc::interface::VecTypeF, rcc::interface::VecTypeF>(
+            &rcc::interface::decode_gaussian_hybrid));
+  py::enum_<rcc::algorithm::Fallback>(m, "Fallback")
+      .value("BEST_CANDIDATE", rcc::algorithm::Fallback::kBestCandidate)
+      .value("DITHERED_QUANTIZATION",
+             rcc::algorithm::Fallback::kDitheredQuantization);
+  py::class_<rcc::algorithm::HybridOptions>(m, "HybridOptions")
+      .def(py::init<>())
+      .def_readwrite("table_cells",
+                     &rcc::algorithm::HybridOptions::table_cells)
+      .def_readwrite("early_abort",
+                     &rcc::algorithm::HybridOptions::early_abort)
+      .def_readwrite("single_shot_kl",
+                     &rcc::algorithm::HybridOptions::single_shot_kl)
+      .def_readwrite("elide_kl", &rcc::algorithm::HybridOptions::elide_kl)
+      .def_readwrite("shared_prior",
+                     &rcc::algorithm::HybridOptions::shared_prior);
+  m.def("sample_gaussian_hybrid",
+        py::overload_cast<rcc::interface::VecType, rcc::interface::VecType,
+                          rcc::interface::VecType, rcc::interface::VecType,
+                          rcc::interface::SamplingAlgorithm, double, uint64_t,
+                          uint32_t, bool,
+                          const rcc::algorithm::HybridOptions &, double,
+                          rcc::algorithm::Fallback>(
+            &rcc::interface::sample_gaussian_hybrid),
+        py::arg("q_mean"), py::arg("q_std"), py::arg("p_mean"),
+        py::arg("p_std"), py::arg("sampling_algorithm"), py::arg("eps"),
+        py::arg("seed"), py::arg("N_max"), py::arg("verbose"),
+        py::arg("options") = rcc::algorithm::HybridOptions(),
+        py::arg("timeout") = 0.0,
+        py::arg("fallback") = rcc::algorithm::Fallback::kBestCandidate);
+  m.def("sample_gaussian_hybrid",
+        py::overload_cast<rcc::interface::VecTypeF, rcc::interface::VecTypeF,
+                          rcc::interface::VecTypeF, rcc::interface::VecTypeF,
+                          rcc::interface::SamplingAlgorithm, double, uint64_t,
+                          uint32_t, bool,
+                          const rcc::algorithm::HybridOptions &, double,
+                          rcc::algorithm::Fallback>(
+            &rcc::interface::sample_gaussian_hybrid),
+        py::arg("q_mean"), py::arg("q_std"), py::arg("p_mean"),
+        py::arg("p_std"), py::arg("sampling_algorithm"), py::arg("eps"),
+        py::arg("seed"), py::arg("N_max"), py::arg("verbose"),
+        py::arg("options") = rcc::algorithm::HybridOptions(),
+        py::arg("timeout") = 0.0,
+        py::arg("fallback") = rcc::algorithm::Fallback::kBestCandidate);
+  add_uniform_hybrid<stats::multivariates::IndependentGaussian>(m);
+  add_uniform_hybrid<stats::multivariates::IndependentUniform>(m);
+  add_uniform_hybrid<stats::multivariates::IndependentLaplace>(m);
+  add_uniform_hybrid<stats::multivariates::IndependentLogistic>(m);
+  add_uniform_hybrid<stats::multivariates::IndependentStudentT>(m);
+  m.def("sample_gaussian_hybrid_batch",
+        &rcc::interface::sample_gaussian_hybrid_batch, py::arg("q_mean"),
+        py::arg("q_std"), py::arg("p_mean"), py::arg("p_std"),
+        py::arg("sampling_algorithm"), py::arg("eps"), py::arg("seeds"),
+        py::arg("N_max"),
+        py::arg("options") = rcc::algorithm::HybridOptions(),
+        py::arg("num_workers") = 0, py::call_guard<py::gil_scoped_release>());
+  py::class_<rcc::algorithm::TimingModel>(m, "TimingModel")
+      .def(py::init<>())
+      .def_readwrite("seconds_per_block",
+                     &rcc::algorithm::TimingModel::seconds_per_block)
+      .def_readwrite("seconds_per_candidate_dim",
+                     &rcc::algorithm::TimingModel::seconds_per_candidate_dim);
+  py::class_<rcc::algorithm::HybridPrediction>(m, "HybridPrediction")
+      .def_readonly("log2M", &rcc::algorithm::HybridPrediction::log2M)
+      .def_readonly("kl_bits", &rcc::algorithm::HybridPrediction::kl_bits)
+      .def_readonly("expected_candidates",
+                    &rcc::algorithm::HybridPrediction::expected_candidates)
+      .def_readonly("coding_cost_bits",
+                    &rcc::algorithm::HybridPrediction::coding_cost_bits)
+      .def_readonly("cutoff_probability",
+                    &rcc::algorithm::HybridPrediction::cutoff_probability)
+      .def_readonly("seconds", &rcc::algorithm::HybridPrediction::seconds);
+  py::class_<rcc::algorithm::TuningOptions>(m, "TuningOptions")
+      .def(py::init<>())
+      .def_readwrite("rate_target",
+                     &rcc::algorithm::TuningOptions::rate_target)
+      .def_readwrite("eps", &rcc::algorithm::TuningOptions::eps)
+      .def_readwrite("N_max", &rcc::algorithm::TuningOptions::N_max)
+      .def_readwrite("max_cutoff_probability",
+                     &rcc::algorithm::TuningOptions::max_cutoff_probability);
+  py::class_<rcc::algorithm::TunedSetting>(m, "TunedSetting")
+      .def_readonly("eps", &rcc::algorithm::TunedSetting::eps)
+      .def_readonly("N_max", &rcc::algorithm::TunedSetting::N_max)
+      .def_readonly("feasible", &rcc::algorithm::TunedSetting::feasible)
+      .def_readonly("coding_cost_bits",
+                    &rcc::algorithm::TunedSetting::coding_cost_bits)
+      .def_readonly("seconds", &rcc::algorithm::TunedSetting::seconds)
+      .def_readonly("prediction", &rcc::algorithm::TunedSetting::prediction);
+  m.def(
+      "predict_gaussian_hybrid",
+      [](const Eigen::ArrayXXd &q_mean, const Eigen::ArrayXXd &q_std,
+         const Eigen::ArrayXXd &p_mean, const Eigen::ArrayXXd &p_std,
+         double eps, uint32_t N_max,
+         const rcc::algorithm::TimingModel &timing) {
+        check_blocks(q_mean, q_std, p_mean, p_std);
+        return rcc::algorithm::predict_gaussian_hybrid(q_mean, q_std, p_mean,
+                                                       p_std, eps, N_max,
+                                                       timing);
+      },
+      py::arg("q_mean"), py::arg("q_std"), py::arg("p_mean"),
+      py::arg("p_std"), py::arg("eps"), py::arg("N_max"),
+      py::arg("timing") = rcc::algorithm::TimingModel());
+  m.def(
+      "tune_gaussian_hybrid",
+      [](const Eigen::ArrayXXd &q_mean, const Eigen::ArrayXXd &q_std,
+         const Eigen::ArrayXXd &p_mean, const Eigen::ArrayXXd &p_std,
+         const rcc::algorithm::TuningOptions &options,
+         const rcc::algorithm::TimingModel &timing) {
+        check_blocks(q_mean, q_std, p_mean, p_std);
+        if (options.eps.empty() || options.N_max.empty())
+          throw std::invalid_argument("no eps or N_max to choose from");
+        return rcc::algorithm::tune_gaussian_hybrid(q_mean, q_std, p_mean,
+                                                    p_std, options, timing);
+      },
+      py::arg("q_mean"), py::arg("q_std"), py::arg("p_mean"),
+      py::arg("p_std"), py::arg("options") = rcc::algorithm::TuningOptions(),
+      py::arg("timing") = rcc::algorithm::TimingModel());
+  m.def("sample_gaussian",
+        py::overload_cast<rcc::interface::VecType, rcc::interface::VecType,
+                          rcc::interface::VecType, rcc::interface::VecType,
+                          rcc::interface::SamplingAlgorithm, uint64_t,
+                          uint32_t, bool>(&rcc::interface::sample_gaussian));
+  m.def("sample_gaussian",
+        py::overload_cast<rcc::interface::VecTypeF, rcc::interface::VecTypeF,
+                          rcc::interface::VecTypeF, rcc::interface::VecTypeF,
+                          rcc::interface::SamplingAlgorithm, uint64_t,
+                          uint32_t, bool>(&rcc::interface::sample_gaussian));
+  m.def("sample_categorical", &rcc::interface::sample_categorical);
+  m.def("decode_categorical", &rcc::interface::decode_categorical);
+  m.def("sample_gaussian_multi", &rcc::interface::sample_gaussian_multi,
+        py::call_guard<py::gil_scoped_release>());
+  py::class_<rcc::algorithm::CandidateCodebook>(m, "CandidateCodebook")
+      .def(py::init([](VecType p_mean, VecType p_std, int N, uint64_t seed,
+                       int leaf_size) {
+             if (p_mean.size() == 0 || p_std.size() != p_mean.size())
+               throw std::invalid_argument(
+                   "p_mean and p_std must have the same positive size");
+             if (N <= 0 || leaf_size <= 0)
+               throw std::invalid_argument("N and leaf_size must be positive");
+             stats::multivariates::IndependentGaussian p(p_mean, p_std);
+             pcg32 rs(seed);
+             return std::make_unique<rcc::algorithm::CandidateCodebook>(
+                 p, N, rs, leaf_size);
+           }),
+           py::arg("p_mean"), py::arg("p_std"), py::arg("N"), py::arg("seed"),
+           py::arg("leaf_size") = 16,
+           py::call_guard<py::gil_scoped_release>())
+      .def("size", &rcc::algorithm::CandidateCodebook::size)
+      .def("dim", &rcc::algorithm::CandidateCodebook::dim)
+      .def(
+          "search",
+          [](const rcc::algorithm::CandidateCodebook &codebook,
+             VecType q_mean, VecType q_std) {
+            if (q_mean.size() != codebook.dim() ||
+                q_std.size() != codebook.dim())
+              throw std::invalid_argument(
+                  "q_mean and q_std must match the codebook dimension");
+            return codebook.search(
+                stats::multivariates::IndependentGaussian(q_mean, q_std));
+          },
+          py::arg("q_mean"), py::arg("q_std"),
+          py::call_guard<py::gil_scoped_release>());
+  m.def("sample_gaussian_layered", &rcc::interface::sample_gaussian_layered,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("decode_gaussian_layered", &rcc::interface::decode_gaussian_layered,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("encode_sample_indices",
+        [](std::vector<uint32_t> indices, std::string header) {
+          auto [code, learned] =
+              rcc::interface::encode_sample_indices(indices, header);
+          return std::tuple<py::bytes, py::bytes>(code, learned);
+        },
+        py::arg("indices"), py::arg("header") = py::bytes());
+  m.def("decode_sample_indices",
+        [](std::string code, int count, std::string header) {
+          auto [indices, learned] =
+              rcc::interface::decode_sample_indices(code, count, header);
+          return std::tuple<std::vector<uint32_t>, py::bytes>(indices,
+                                                              learned);
+        },
+        py::arg("code"), py::arg("count"), py::arg("header") = py::bytes());
+  py::class_<rcc::algorithm::IndexCodingReport>(m, "IndexCodingReport")
+      .def_readonly("num_indices",
+                    &rcc::algorithm::IndexCodingReport::num_indices)
+      .def_readonly("zipf_bits", &rcc::algorithm::IndexCodingReport::zipf_bits)
+      .def_readonly("adaptive_bits",
+                    &rcc::algorithm::IndexCodingReport::adaptive_bits)
+      .def_readonly("header_bits",
+                    &rcc::algorithm::IndexCodingReport::header_bits)
+      .def_property_readonly("saved_bits",
+                             &rcc::algorithm::IndexCodingReport::saved_bits);
+  m.def("report_index_coding", &rcc::interface::report_index_coding,
+        py::arg("h"), py::arg("q_std"), py::arg("p_std"),
+        py::arg("header") = py::bytes());
+  py::class_<stats::multivariates::IndependentGaussian> gaussian(
+      m, "IndependentGaussian");
+  gaussian.def(py::init<const rcc::interface::VecType &,
+                        const rcc::interface::VecType &>());
+  add_distribution_methods(gaussian);
+  m.def("is_homoscedastic", &stats::multivariates::is_homoscedastic<double>);
+  py::class_<stats::multivariates::IndependentTruncatedGaussian>
+      truncated_gaussian(m, "IndependentTruncatedGaussian");
+  truncated_gaussian.def(py::init<
+                         const rcc::interface::VecType &,
+                         const rcc::interface::VecType &,
+                         const rcc::interface::VecType &,
+                         const rcc::interface::VecType &>());
+  add_distribution_methods(truncated_gaussian);
+  py::class_<stats::multivariates::IndependentUniform> uniform(
+      m, "IndependentUniform");
+  uniform.def(py::init<const rcc::interface::VecType &,
+                       const rcc::interface::VecType &>())
+      .def(py::init<int>());
+  add_distribution_methods(uniform);
+  py::class_<stats::multivariates::IndependentLaplace> laplace(
+      m, "IndependentLaplace");
+  laplace.def(py::init<const rcc::interface::VecType &,
+                       const rcc::interface::VecType &>())
+      .def(py::init<int>());
+  add_distribution_methods(laplace);
+  py::class_<stats::multivariates::IndependentLogistic> logistic(
+      m, "IndependentLogistic");
+  logistic.def(py::init<const rcc::interface::VecType &,
+                        const rcc::interface::VecType &>())
+      .def(py::init<int>());
+  add_distribution_methods(logistic);
+  py::class_<stats::multivariates::IndependentStudentT> student_t(
+      m, "IndependentStudentT");
+  student_t.def(py::init<const rcc::interface::VecType &,
+                         const rcc::interface::VecType &,
+                         const rcc::interface::VecType &>());
+  add_distribution_methods(student_t);
+  add_minimum_log_weight<stats::multivariates::IndependentGaussian,
+                         stats::multivariates::IndependentGaussian>(m);
+  add_minimum_log_weight<stats::multivariates::IndependentTruncatedGaussian,
+                         stats::multivariates::IndependentGaussian>(m);
+  add_minimum_log_weight<stats::multivariates::IndependentUniform,
+                         stats::multivariates::IndependentGaussian>(m);
+  add_minimum_log_weight<stats::multivariates::IndependentUniform,
+                         stats::multivariates::IndependentUniform>(m);
+  m.def("compress_weights", &rcc::interface::compress_weights,
+        py::arg("q_mean"), py::arg("q_std"), py::arg("p_mean"),
+        py::arg("p_std"), py::arg("output"), py::arg("block_size"),
+        py::arg("eps"), py::arg("seed"), py::arg("N_max"),
+        py::arg("num_workers"), py::arg("seekable") = false,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("decompress_weights", &rcc::interface::decompress_weights,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("decode_blocks", &rcc::interface::decode_blocks,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("uniform_draws", &rcc::interface::uniform_draws, py::arg("seed"),
+        py::arg("n"));
+  m.def("exponential_draws", &rcc::interface::exponential_draws,
+        py::arg("seed"), py::arg("n"));
+  m.def("normal_draws", &rcc::interface::normal_draws, py::arg("seed"),
+        py::arg("n"));
+  py::class_<rcc::pipeline::LazyDecoderMetrics>(m, "LazyDecoderMetrics")
+      .def_readonly("hits", &rcc::pipeline::LazyDecoderMetrics::hits)
+      .def_readonly("misses", &rcc::pipeline::LazyDecoderMetrics::misses)
+      .def_readonly("evictions",
+                    &rcc::pipeline::LazyDecoderMetrics::evictions)
+      .def_readonly("failures", &rcc::pipeline::LazyDecoderMetrics::failures)
+      .def_readonly("mean_decode_latency",
+                    &rcc::pipeline::LazyDecoderMetrics::mean_decode_latency)
+      .def_readonly("max_decode_latency",
+                    &rcc::pipeline::LazyDecoderMetrics::max_decode_latency)
+      .def_readonly("cached_blocks",
+                    &rcc::pipeline::LazyDecoderMetrics::cached_blocks)
+      .def_readonly("cached_bytes",
+                    &rcc::pipeline::LazyDecoderMetrics::cached_bytes);
+  py::class_<rcc::pipeline::LazyDecoder>(m, "LazyDecoder")
+      .def(py::init([](std::string input, std::string p_mean,
+                       std::string p_std, size_t cache_bytes,
+                       int num_workers) {
+             rcc::pipeline::LazyDecoderOptions options;
+             options.cache_bytes = cache_bytes;
+             if (num_workers > 0) options.num_workers = num_workers;
+             auto decoder =
+                 std::make_unique<rcc::pipeline::LazyDecoder>(options);
+             if (!decoder->open(input, p_mean, p_std))
+               throw std::runtime_error("cannot open " + input);
+             return decoder;
+           }),
+           py::arg("input"), py::arg("p_mean") = "", py::arg("p_std") = "",
+           py::arg("cache_bytes") = size_t(1) << 28,
+           py::arg("num_workers") = 0)
+      .def("num_blocks", &rcc::pipeline::LazyDecoder::num_blocks)
+      .def(
+          "block",
+          [](rcc::pipeline::LazyDecoder &decoder, uint64_t block) {
+            auto values = decoder.get(block);
+            if (!values)
+              throw std::runtime_error("cannot decode block " +
+                                       std::to_string(block));
+            return rcc::interface::VecType(*values);
+          },
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "blocks",
+          [](rcc::pipeline::LazyDecoder &decoder,
+             const std::vector<uint64_t> &blocks) {
+            std::vector<rcc::interface::VecType> arrays;
+            for (const auto &values : decoder.get(blocks)) {
+              if (!values) throw std::runtime_error("cannot decode blocks");
+              arrays.push_back(*values);
+            }
+            return arrays;
+          },
+          py::call_guard<py::gil_scoped_release>())
+      .def("clear", &rcc::pipeline::LazyDecoder::clear)
+      .def("metrics", &rcc::pipeline::LazyDecoder::metrics);
+  py::enum_<rcc::pipeline::ResultOrder>(m, "ResultOrder")
+      .value("SUBMISSION", rcc::pipeline::ResultOrder::kSubmission)
+      .value("COMPLETION", rcc::pipeline::ResultOrder::kCompletion);
+  py::class_<rcc::pipeline::StageMetrics>(m, "StageMetrics")
+      .def_readonly("count", &rcc::pipeline::StageMetrics::count)
+      .def_readonly("mean_latency", &rcc::pipeline::StageMetrics::mean_latency)
+      .def_readonly("max_latency", &rcc::pipeline::StageMetrics::max_latency)
+      .def_readonly("depth", &rcc::pipeline::StageMetrics::depth)
+      .def_readonly("max_depth", &rcc::pipeline::StageMetrics::max_depth);
+  py::class_<rcc::pipeline::PipelineMetrics>(m, "PipelineMetrics")
+      .def_readonly("queue", &rcc::pipeline::PipelineMetrics::queue)
+      .def_readonly("encode", &rcc::pipeline::PipelineMetrics::encode)
+      .def_readonly("reorder", &rcc::pipeline::PipelineMetrics::reorder)
+      .def_readonly("rejected", &rcc::pipeline::PipelineMetrics::rejected);
+  py::class_<PendingEncode>(m, "PendingEncode")
+      .def("ready", &PendingEncode::ready)
+      .def("result", &PendingEncode::result,
+           py::call_guard<py::gil_scoped_release>());
+  py::class_<rcc::pipeline::EncoderPipeline>(m, "EncoderPipeline")
+      .def(py::init([](int num_workers, size_t queue_capacity,
+                       rcc::pipeline::ResultOrder order) {
+             if (num_workers < 0 || queue_capacity == 0)
+               throw std::invalid_argument(
+                   "num_workers must not be negative and queue_capacity "
+                   "must be positive");
+             rcc::pipeline::PipelineOptions options;
+             if (num_workers > 0) options.num_workers = num_workers;
+             options.queue_capacity = queue_capacity;
+             options.order = order;
+             return std::make_unique<rcc::pipeline::EncoderPipeline>(options);
+           }),
+           py::arg("num_workers") = 0, py::arg("queue_capacity") = 1024,
+           py::arg("order") = rcc::pipeline::ResultOrder::kSubmission)
+      .def(
+          "submit",
+          [](rcc::pipeline::EncoderPipeline &pipeline, VecType q_mean,
+             VecType q_std, VecType p_mean, VecType p_std,
+             rcc::interface::SamplingAlgorithm sampling_algorithm, double eps,
+             uint64_t seed, uint32_t N_max,
+             const rcc::algorithm::HybridOptions &options) {
+            auto request = rcc::interface::make_encode_request(
+                q_mean, q_std, p_mean, p_std, sampling_algorithm, eps, seed,
+                N_max, options);
+            check_request(request);
+            return PendingEncode(pipeline.submit(std::move(request)));
+          },
+          py::arg("q_mean"), py::arg("q_std"), py::arg("p_mean"),
+          py::arg("p_std"),
+          py::arg("sampling_algorithm") =
+              rcc::interface::SamplingAlgorithm::PFR,
+          py::arg("eps") = 1e-4, py::arg("seed") = 0,
+          py::arg("N_max") = 1 << 16,
+          py::arg("options") = rcc::algorithm::HybridOptions(),
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "try_submit",
+          [](rcc::pipeline::EncoderPipeline &pipeline, VecType q_mean,
+             VecType q_std, VecType p_mean, VecType p_std,
+             rcc::interface::SamplingAlgorithm sampling_algorithm, double eps,
+             uint64_t seed, uint32_t N_max,
+             const rcc::algorithm::HybridOptions &options)
+              -> std::optional<PendingEncode> {
+            auto request = rcc::interface::make_encode_request(
+                q_mean, q_std, p_mean, p_std, sampling_algorithm, eps, seed,
+                N_max, options);
+            check_request(request);
+            std::future<rcc::pipeline::EncodeResult> future;
+            if (!pipeline.try_submit(request, &future)) return std::nullopt;
+            return PendingEncode(std::move(future));
+          },
+          py::arg("q_mean"), py::arg("q_std"), py::arg("p_mean"),
+          py::arg("p_std"),
+          py::arg("sampling_algorithm") =
+              rcc::interface::SamplingAlgorithm::PFR,
+          py::arg("eps") = 1e-4, py::arg("seed") = 0,
+          py::arg("N_max") = 1 << 16,
+          py::arg("options") = rcc::algorithm::HybridOptions(),
+          py::call_guard<py::gil_scoped_release>())
+      .def("close", &rcc::pipeline::EncoderPipeline::close,
+           py::call_guard<py::gil_scoped_release>())
+      .def("metrics", &rcc::pipeline::EncoderPipeline::metrics);
+  py::class_<rcc::pipeline::DaemonClient>(m, "DaemonClient")
+      .def(py::init([](std::string socket_path, size_t region_bytes) {
+             auto client = std::make_unique<rcc::pipeline::DaemonClient>();
+             if (!client->connect(socket_path, region_bytes))
+               throw std::runtime_error("cannot connect to " + socket_path);
+             return client;
+           }),
+           py::arg("socket_path"), py::arg("region_bytes") = size_t(1) << 24)
+      .def("max_dim", &rcc::pipeline::DaemonClient::max_dim)
+      .def("register_prior", &rcc::pipeline::DaemonClient::register_prior,
+           py::call_guard<py::gil_scoped_release>())
+      .def(
+          "sample_gaussian_hybrid",
+          [](rcc::pipeline::DaemonClient &client, VecType q_mean,
+             VecType q_std, VecType p_mean, VecType p_std, uint64_t prior,
+             rcc::interface::SamplingAlgorithm sampling_algorithm, double eps,
+             uint64_t seed, uint32_t N_max,
+             const rcc::algorithm::HybridOptions &options) {
+            auto request = rcc::interface::make_encode_request(
+                q_mean, q_std, p_mean, p_std, sampling_algorithm, eps, seed,
+                N_max, options);
+            rcc::pipeline::EncodeResult result;
+            auto status = client.encode(request, &result, prior);
+            if (status != rcc::pipeline::DaemonStatus::kOk)
+              throw std::runtime_error(daemon_error(status));
+            rcc::interface::SamplingOutput output(
+                result.sample, result.sample_index,
+                result.total_number_samples, seed, result.signal,
+                result.box_dimensions);
+            output.status_ = result.status;
+            return output;
+          },
+          py::arg("q_mean"), py::arg("q_std"), py::arg("p_mean") = VecType(),
+          py::arg("p_std") = VecType(), py::arg("prior") = 0,
+          py::arg("sampling_algorithm") =
+              rcc::interface::SamplingAlgorithm::PFR,
+          py::arg("eps") = 1e-4, py::arg("seed") = 0,
+          py::arg("N_max") = 1 << 16,
+          py::arg("options") = rcc::algorithm::HybridOptions(),
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "decode_gaussian_hybrid",
+          [](rcc::pipeline::DaemonClient &client,
+             const rcc::interface::SamplingOutput &h, VecType p_mean,
+             VecType p_std, uint64_t prior) {
+            rcc::pipeline::EncodeResult result;
+            result.seed = h.seed_;
+            result.sample_index = h.sample_index_;
+            result.signal = h.signal_;
+            result.box_dimensions = h.box_dimensions_;
+            VecType sample;
+            auto status = prior ? client.decode(result, prior, &sample)
+                                : client.decode(result, p_mean, p_std, &sample);
+            if (status != rcc::pipeline::DaemonStatus::kOk)
+              throw std::runtime_error(daemon_error(status));
+            return sample;
+          },
+          py::arg("h"), py::arg("p_mean") = VecType(),
+          py::arg("p_std") = VecType(), py::arg("prior") = 0,
+          py::call_guard<py::gil_scoped_release>());
 }
\ No newline at end of file
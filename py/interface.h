@@ -3,9 +3,21 @@
 
 #include <cstdint>
 #include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
 
 #include "Eigen/Core"
+#include "algorithm/deadline.h"
 #include "algorithm/helper.h"
+#include "algorithm/index_coder.h"
+#include "algorithm/options.h"
+#include "stats/distributions/multivariate/continuous/gaussian.h"
+#include "stats/distributions/multivariate/continuous/laplace.h"
+#include "stats/distributions/multivariate/continuous/logistic.h"
+#include "stats/distributions/multivariate/continuous/student_t.h"
+#include "stats/distributions/multivariate/continuous/uniform.h"
 #include "pybind11/detail/common.h"
 #include "pybind11/eigen.h"
 #include "pybind11/numpy.h"
@@ -13,6 +25,16 @@
 
 namespace rcc::interface {
 using VecType = Eigen::ArrayXd;
+// float32 arrays select the float samplers, see algorithm/reverse_channel.h
+// for when their precision is enough. Their outputs are still returned in
+// a SamplingOutput of doubles, which holds them exactly.
+using VecTypeF = Eigen::ArrayXf;
+using MatType = Eigen::ArrayXXd;
+// Points as rows, the layout of a C-contiguous (n, dim) NumPy array. Refs
+// of it bind to such arrays without a copy.
+using RowMatType =
+    Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+using RowMatRef = Eigen::Ref<const RowMatType>;
 
 enum class SamplingAlgorithm { PFR, SIS };
 
@@ -47,20 +69,189 @@ class SamplingOutput {
   }
   VecType box_dimensions_, sample_opt_, signal_;
   int sample_index_, total_number_samples_, seed_;
+  // How the sampler stopped; left at its defaults by samplers that do not
+  // report it.
+  rcc::algorithm::SamplerStatus status_;
 };
 
-SamplingOutput sample_gaussian_hybrid(VecType q_mean, VecType q_std,
-                                      VecType p_mean, VecType p_std,
-                                      SamplingAlgorithm sampling_algorithm,
-                                      double eps, uint64_t seed, uint32_t N_max,
-                                      bool verbose);
+// timeout is in seconds from the call, 0 for none; fallback is what a
+// block returns when the deadline fires first. Throws std::invalid_argument
+// if timeout is negative.
+SamplingOutput sample_gaussian_hybrid(
+    VecType q_mean, VecType q_std, VecType p_mean, VecType p_std,
+    SamplingAlgorithm sampling_algorithm, double eps, uint64_t seed,
+    uint32_t N_max, bool verbose,
+    const rcc::algorithm::HybridOptions &options =
+        rcc::algorithm::HybridOptions(),
+    double timeout = 0,
+    rcc::algorithm::Fallback fallback =
+        rcc::algorithm::Fallback::kBestCandidate);
+
+SamplingOutput sample_gaussian_hybrid(
+    VecTypeF q_mean, VecTypeF q_std, VecTypeF p_mean, VecTypeF p_std,
+    SamplingAlgorithm sampling_algorithm, double eps, uint64_t seed,
+    uint32_t N_max, bool verbose,
+    const rcc::algorithm::HybridOptions &options =
+        rcc::algorithm::HybridOptions(),
+    double timeout = 0,
+    rcc::algorithm::Fallback fallback =
+        rcc::algorithm::Fallback::kBestCandidate);
 
 SamplingOutput sample_gaussian(VecType q_mean, VecType q_std, VecType p_mean,
                                VecType p_std,
                                SamplingAlgorithm sampling_algorithm,
                                uint64_t seed, uint32_t N_max, bool verbose);
+SamplingOutput sample_gaussian(VecTypeF q_mean, VecTypeF q_std,
+                               VecTypeF p_mean, VecTypeF p_std,
+                               SamplingAlgorithm sampling_algorithm,
+                               uint64_t seed, uint32_t N_max, bool verbose);
 
 VecType decode_gaussian_hybrid(SamplingOutput h, VecType p_mean, VecType p_std);
+// Decodes a float32 encode in float, reproducing its sample exactly.
+VecTypeF decode_gaussian_hybrid(SamplingOutput h, VecTypeF p_mean,
+                                VecTypeF p_std);
+
+// Hybrid coding of a uniform posterior q against a Gaussian, uniform,
+// Laplace, logistic or Student's t prior p; see
+// algorithm::sample_uniform_hybrid. Blocks within single_shot_kl nats of one
+// candidate, such as a q that covers exactly one lattice cell, are coded
+// with that candidate.
+SamplingOutput sample_uniform_hybrid(
+    stats::multivariates::IndependentUniform q,
+    stats::multivariates::IndependentGaussian p,
+    SamplingAlgorithm sampling_algorithm, uint64_t seed, uint32_t N_max,
+    bool verbose, double single_shot_kl);
+SamplingOutput sample_uniform_hybrid(
+    stats::multivariates::IndependentUniform q,
+    stats::multivariates::IndependentUniform p,
+    SamplingAlgorithm sampling_algorithm, uint64_t seed, uint32_t N_max,
+    bool verbose, double single_shot_kl);
+SamplingOutput sample_uniform_hybrid(
+    stats::multivariates::IndependentUniform q,
+    stats::multivariates::IndependentLaplace p,
+    SamplingAlgorithm sampling_algorithm, uint64_t seed, uint32_t N_max,
+    bool verbose, double single_shot_kl);
+SamplingOutput sample_uniform_hybrid(
+    stats::multivariates::IndependentUniform q,
+    stats::multivariates::IndependentLogistic p,
+    SamplingAlgorithm sampling_algorithm, uint64_t seed, uint32_t N_max,
+    bool verbose, double single_shot_kl);
+SamplingOutput sample_uniform_hybrid(
+    stats::multivariates::IndependentUniform q,
+    stats::multivariates::IndependentStudentT p,
+    SamplingAlgorithm sampling_algorithm, uint64_t seed, uint32_t N_max,
+    bool verbose, double single_shot_kl);
+
+VecType decode_uniform_hybrid(SamplingOutput h,
+                              stats::multivariates::IndependentGaussian p);
+VecType decode_uniform_hybrid(SamplingOutput h,
+                              stats::multivariates::IndependentUniform p);
+VecType decode_uniform_hybrid(SamplingOutput h,
+                              stats::multivariates::IndependentLaplace p);
+VecType decode_uniform_hybrid(SamplingOutput h,
+                              stats::multivariates::IndependentLogistic p);
+VecType decode_uniform_hybrid(SamplingOutput h,
+                              stats::multivariates::IndependentStudentT p);
+
+// sample_gaussian for each posterior, the rows of q_mean and q_std, with
+// the same prior and seed, sharing the candidates between them; see
+// algorithm/multi_posterior.h. Throws std::invalid_argument if the shapes
+// do not match.
+std::vector<SamplingOutput> sample_gaussian_multi(
+    MatType q_mean, MatType q_std, VecType p_mean, VecType p_std,
+    SamplingAlgorithm sampling_algorithm, uint64_t seed, uint32_t N_max);
+
+// sample_gaussian_hybrid of every row of q_mean and q_std with the seed of
+// the same index, run by pipeline::encode_batch on num_workers threads, or
+// one per core when it is 0.
+std::vector<SamplingOutput> sample_gaussian_hybrid_batch(
+    MatType q_mean, MatType q_std, VecType p_mean, VecType p_std,
+    SamplingAlgorithm sampling_algorithm, double eps,
+    std::vector<uint64_t> seeds, uint32_t N_max,
+    const rcc::algorithm::HybridOptions &options, int num_workers);
+
+SamplingOutput sample_categorical(MatType q_probs, MatType p_probs,
+                                  SamplingAlgorithm sampling_algorithm,
+                                  uint64_t seed, uint32_t N_max, bool verbose);
+
+VecType decode_categorical(SamplingOutput h, MatType p_probs);
+
+// Progressive hybrid coding, see algorithm/layered.h. Returns one output per
+// layer of noise; the sample of each is what a decoder of the layers up to
+// it reconstructs. Throws std::invalid_argument unless noise is strictly
+// decreasing and ends with 0.
+std::vector<SamplingOutput> sample_gaussian_layered(
+    VecType q_mean, VecType q_std, VecType p_mean, VecType p_std,
+    std::vector<double> noise, SamplingAlgorithm sampling_algorithm,
+    double eps, uint64_t seed, uint32_t N_max);
+
+// Decodes a prefix of the layers of sample_gaussian_layered and returns the
+// sample after each of them.
+std::vector<VecType> decode_gaussian_layered(std::vector<SamplingOutput> h,
+                                             VecType p_mean, VecType p_std,
+                                             std::vector<double> noise);
+
+// Adaptive coding of the sample indices of a batch of blocks, see
+// algorithm/index_coder.h. header is that of the model the batch starts
+// from, empty for the default model. Both return the header of the model
+// learned from the batch, from which the next batch can start. Throw
+// std::invalid_argument if header is not a model header.
+std::tuple<std::string, std::string> encode_sample_indices(
+    std::vector<uint32_t> indices, std::string header);
+std::tuple<std::vector<uint32_t>, std::string> decode_sample_indices(
+    std::string code, int count, std::string header);
+
+// Codes the sample indices of h, e.g. the blocks of one layer, and compares
+// the cost with the Zipf estimate of internal::codingCostHyprid. Row b of
+// q_std and p_std holds the standard deviations of the Gaussian posterior
+// and prior of block b.
+rcc::algorithm::IndexCodingReport report_index_coding(
+    std::vector<SamplingOutput> h, MatType q_std, MatType p_std,
+    std::string header);
+
+// Streams raw float32 parameter files through the hybrid encoder. Returns
+// the size of the encoded stream, or with seekable of the block container,
+// in bytes, or -1 on failure.
+int64_t compress_weights(std::string q_mean, std::string q_std,
+                         std::string p_mean, std::string p_std,
+                         std::string output, uint32_t block_size, double eps,
+                         uint64_t seed, uint32_t N_max, int num_workers,
+                         bool seekable);
+
+// Writes the reconstructed float32 weights to output. Returns the number of
+// parameters, or -1 on failure.
+int64_t decompress_weights(std::string input, std::string p_mean,
+                           std::string p_std, std::string output);
+
+// Decodes blocks [first, last) of a block container. p_mean and p_std are
+// the prior of the parameters those blocks cover. Throws std::runtime_error
+// if the container can not be read.
+VecType decode_blocks(std::string input, uint64_t first, uint64_t last,
+                      VecType p_mean, VecType p_std);
+
+// The first n draws of stats::uniform01, stats::exponential_ziggurat or
+// stats::normal_ziggurat from pcg32(seed), which every encode and decode
+// depends on. Throws std::invalid_argument if n is negative.
+VecType uniform_draws(uint64_t seed, int n);
+VecType exponential_draws(uint64_t seed, int n);
+VecType normal_draws(uint64_t seed, int n);
+
+// Evaluates f(univariates[d], X(i, d)) for every point i of X, reading X in
+// place. Throws std::invalid_argument, a ValueError in Python, unless X has
+// one column per dimension.
+template <typename Distribution, typename F>
+RowMatType map_points(const Distribution &distribution, const RowMatRef &X,
+                      F f) {
+  const auto &univariates = distribution.univariates();
+  if (X.cols() != static_cast<Eigen::Index>(univariates.size()))
+    throw std::invalid_argument("expected an array of shape (n, " +
+                                std::to_string(univariates.size()) + ")");
+  RowMatType Y(X.rows(), X.cols());
+  for (Eigen::Index i = 0; i < X.rows(); i++)
+    for (Eigen::Index d = 0; d < X.cols(); d++)
+      Y(i, d) = f(univariates[d], X(i, d));
+  return Y;
+}
 }  // namespace rcc::interface
 
 void AddModules(pybind11::module &m);
@@ -3,9 +3,16 @@ from pathlib import Path
 from pybind11.setup_helpers import Pybind11Extension, build_ext
 from setuptools import setup
 
+# Directories holding standalone executables that are not part of the module.
+EXCLUDED_DIRS = ('benchmarks', 'capi', 'daemon')
+
 hybrid_rcc_module = Pybind11Extension(
     'hybrid_rcc',
-    [str(fname) for fname in Path('.').rglob('*.cc')],
+    [
+        str(fname)
+        for fname in Path('.').rglob('*.cc')
+        if fname.parts[0] not in EXCLUDED_DIRS
+    ],
     include_dirs=['.']
     + [str(f) for f in Path('third_party').glob('*') if f.is_dir()],
     extra_compile_args=['-O3'],
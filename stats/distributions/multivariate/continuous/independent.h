@@ -19,110 +19,114 @@
 
 #include <memory>
 #include <random>
+#include <utility>
 
 #include "stats/distributions/multivariate/multivariate.h"
 #include "stats/distributions/probability_distribution.h"
 #include "stats/random_number_generator/stl_urbg.h"
+#include "stats/random_number_generator/ziggurat.h"
 
 namespace stats::multivariates {
-template <typename Distribution>
+// Scalar is the floating point type of the univariates; every vector is an
+// Eigen array of it.
+template <typename Distribution,
+          typename Scalar = decltype(std::declval<Distribution>().mean())>
 class IndependentDistributions
-    : public ProbabilityDistribution<ContinuousMultiVariable> {
+    : public ProbabilityDistribution<BasicContinuousMultiVariable<Scalar>> {
  protected:
+  using Array = Eigen::Array<Scalar, Eigen::Dynamic, 1>;
+  using Matrix = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>;
+
   std::vector<Distribution> univariates_;
   int dim_;
-  Eigen::ArrayXd lower_corner_, upper_corner_, mu_, std_;
+  Array lower_corner_, upper_corner_, mu_, std_;
 
  public:
   template <typename STD_URBG>
   std::unique_ptr<RandomNumberGenerator> make_rng(STD_URBG& urbg) {
-    std::uniform_real_distribution<> d(0, 1);
-    return std::make_unique<URBG<STD_URBG, std::uniform_real_distribution<>>>(
-        urbg, d);
+    UniformDistribution d(0, 1);
+    return std::make_unique<URBG<STD_URBG, UniformDistribution>>(urbg, d);
   }
-  Eigen::ArrayXd rvs(std::unique_ptr<RandomNumberGenerator>& rng) override {
-    return ppf(rng->sample(0, dim_));
+  Array rvs(std::unique_ptr<RandomNumberGenerator>& rng) override {
+    return ppf(rng->sample(0, dim_).template cast<Scalar>());
   }
-  Eigen::ArrayXXd rvs(std::unique_ptr<RandomNumberGenerator>& rng,
-                      int n) override {
-    Eigen::ArrayXXd X(n, dim_);
+  Matrix rvs(std::unique_ptr<RandomNumberGenerator>& rng, int n) override {
+    Matrix X(n, dim_);
     for (int i = 0; i < n; i++) {
       X.row(i) = rvs(rng);
     }
     return X;
   }
-  Eigen::ArrayXd pdf(const Eigen::ArrayXd& X) const override {
-    Eigen::ArrayXd p(dim_);
+  Array pdf(const Array& X) const override {
+    Array p(dim_);
     std::transform(
         univariates_.begin(), univariates_.end(), X.begin(), p.begin(),
-        [](const Distribution& G, const double x) { return G.pdf(x); });
+        [](const Distribution& G, const Scalar x) { return G.pdf(x); });
     return p;
   }
-  Eigen::ArrayXXd pdf(const Eigen::ArrayXXd& X) const override {
+  Matrix pdf(const Matrix& X) const override {
     auto cX = X.colwise();
-    Eigen::ArrayXXd p(X.rows(), dim_);
+    Matrix p(X.rows(), dim_);
     auto cp = p.colwise();
     std::transform(univariates_.begin(), univariates_.end(), cX.begin(),
-                   cp.begin(),
-                   [](const Distribution& G, const Eigen::ArrayXd& x) {
+                   cp.begin(), [](const Distribution& G, const Array& x) {
                      return G.pdf(x);
                    });
     return p;
   }
-  Eigen::ArrayXd logpdf(const Eigen::ArrayXd& X) const override {
-    Eigen::ArrayXd p(dim_);
+  Array logpdf(const Array& X) const override {
+    Array p(dim_);
     std::transform(
         univariates_.begin(), univariates_.end(), X.begin(), p.begin(),
-        [](const Distribution& G, const double x) { return G.logpdf(x); });
+        [](const Distribution& G, const Scalar x) { return G.logpdf(x); });
     return p;
   }
-  Eigen::ArrayXXd logpdf(const Eigen::ArrayXXd& X) const override {
+  Matrix logpdf(const Matrix& X) const override {
     auto cX = X.colwise();
-    Eigen::ArrayXXd logp(X.rows(), dim_);
+    Matrix logp(X.rows(), dim_);
     auto clogp = logp.colwise();
     std::transform(univariates_.begin(), univariates_.end(), cX.begin(),
-                   clogp.begin(),
-                   [](const Distribution& G, const Eigen::ArrayXd& x) {
+                   clogp.begin(), [](const Distribution& G, const Array& x) {
                      return G.logpdf(x);
                    });
     return logp;
   }
-  Eigen::ArrayXd cdf(const Eigen::ArrayXd& X) const override {
-    Eigen::ArrayXd p(dim_);
+  Array cdf(const Array& X) const override {
+    Array p(dim_);
     std::transform(
         univariates_.begin(), univariates_.end(), X.begin(), p.begin(),
-        [](const Distribution& G, const double x) { return G.cdf(x); });
+        [](const Distribution& G, const Scalar x) { return G.cdf(x); });
     return p;
   }
-  Eigen::ArrayXXd cdf(const Eigen::ArrayXXd& X) const override {
+  Matrix cdf(const Matrix& X) const override {
     auto cX = X.colwise();
-    Eigen::ArrayXXd p(X.rows(), dim_);
+    Matrix p(X.rows(), dim_);
     auto cp = p.colwise();
     std::transform(univariates_.begin(), univariates_.end(), cX.begin(),
-                   cp.begin(),
-                   [](const Distribution& G, const Eigen::ArrayXd& x) {
+                   cp.begin(), [](const Distribution& G, const Array& x) {
                      return G.cdf(x);
                    });
     return p;
   }
-  std::tuple<Eigen::ArrayXd, Eigen::ArrayXd> support() const override {
-    return std::tuple<Eigen::ArrayXd, Eigen::ArrayXd>(lower_corner_,
-                                                      upper_corner_);
+  std::tuple<Array, Array> support() const override {
+    return std::tuple<Array, Array>(lower_corner_, upper_corner_);
   }
 
-  Eigen::ArrayXd ppf(Eigen::ArrayXd P) const override {
-    Eigen::ArrayXd X(dim_);
+  Array ppf(Array P) const override {
+    Array X(dim_);
     std::transform(
         univariates_.begin(), univariates_.end(), P.begin(), X.begin(),
-        [](const Distribution& G, const double p) { return G.ppf(p); });
+        [](const Distribution& G, const Scalar p) { return G.ppf(p); });
     return X;
   }
 
-  Eigen::ArrayXd mean() const override { return mu_; }
-  Eigen::ArrayXd std() const override { return std_; }
-  Eigen::ArrayXd var() const override { return std_ * std_; }
-  Eigen::ArrayXd entropy() const override {
-    Eigen::ArrayXd H(dim_);
+  const std::vector<Distribution>& univariates() const { return univariates_; }
+
+  Array mean() const override { return mu_; }
+  Array std() const override { return std_; }
+  Array var() const override { return std_ * std_; }
+  Array entropy() const override {
+    Array H(dim_);
     std::transform(univariates_.begin(), univariates_.end(), H.begin(),
                    [](const Distribution& N) { return N.entropy(); });
     return H;
@@ -0,0 +1,54 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_STATS_DISTRIBUTIONS_MULTIVARIATE_CONTINUOUS_LAPLACE_H_
+#define THIRD_PARTY_HYBRID_RCC_STATS_DISTRIBUTIONS_MULTIVARIATE_CONTINUOUS_LAPLACE_H_
+
+#include <cassert>
+#include <limits>
+
+#include "stats/distributions/multivariate/continuous/independent.h"
+#include "stats/distributions/univariate/continuous/laplace.h"
+#include "Eigen/Core"
+
+namespace stats::multivariates {
+template <typename Scalar>
+class BasicIndependentLaplace
+    : public IndependentDistributions<univariates::BasicLaplace<Scalar>> {
+  using Array = Eigen::Array<Scalar, Eigen::Dynamic, 1>;
+
+ public:
+  BasicIndependentLaplace(const Array& mu, const Array& scale) {
+    assert(mu.size() == scale.size());
+    this->dim_ = mu.size();
+    this->lower_corner_ = Array::Constant(
+        this->dim_, -std::numeric_limits<Scalar>::infinity());
+    this->upper_corner_ = Array::Constant(
+        this->dim_, std::numeric_limits<Scalar>::infinity());
+    this->mu_ = mu;
+    this->std_ = Array(this->dim_);
+    for (int d = 0; d < this->dim_; d++) {
+      this->univariates_.emplace_back(mu[d], scale[d]);
+      this->std_[d] = this->univariates_[d].std();
+    }
+  }
+  explicit BasicIndependentLaplace(int dim)
+      : BasicIndependentLaplace(Array::Zero(dim), Array::Ones(dim)) {}
+};
+
+using IndependentLaplace = BasicIndependentLaplace<double>;
+}  // namespace stats::multivariates
+#endif  // THIRD_PARTY_HYBRID_RCC_STATS_DISTRIBUTIONS_MULTIVARIATE_CONTINUOUS_LAPLACE_H_
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_STATS_DISTRIBUTIONS_MULTIVARIATE_CONTINUOUS_STUDENT_T_H_
+#define THIRD_PARTY_HYBRID_RCC_STATS_DISTRIBUTIONS_MULTIVARIATE_CONTINUOUS_STUDENT_T_H_
+
+#include <cassert>
+#include <limits>
+
+#include "stats/distributions/multivariate/continuous/independent.h"
+#include "stats/distributions/univariate/continuous/student_t.h"
+#include "Eigen/Core"
+
+namespace stats::multivariates {
+// Independent Student's t with per dimension degrees of freedom. mean() and
+// std() follow the univariates, so they are NaN or +inf where df <= 2.
+template <typename Scalar>
+class BasicIndependentStudentT
+    : public IndependentDistributions<univariates::BasicStudentT<Scalar>> {
+  using Array = Eigen::Array<Scalar, Eigen::Dynamic, 1>;
+
+ public:
+  BasicIndependentStudentT(const Array& mu, const Array& scale,
+                           const Array& df) {
+    assert(mu.size() == scale.size() && mu.size() == df.size());
+    this->dim_ = mu.size();
+    this->lower_corner_ = Array::Constant(
+        this->dim_, -std::numeric_limits<Scalar>::infinity());
+    this->upper_corner_ = Array::Constant(
+        this->dim_, std::numeric_limits<Scalar>::infinity());
+    this->mu_ = Array(this->dim_);
+    this->std_ = Array(this->dim_);
+    for (int d = 0; d < this->dim_; d++) {
+      this->univariates_.emplace_back(mu[d], scale[d], df[d]);
+      this->mu_[d] = this->univariates_[d].mean();
+      this->std_[d] = this->univariates_[d].std();
+    }
+  }
+};
+
+using IndependentStudentT = BasicIndependentStudentT<double>;
+}  // namespace stats::multivariates
+#endif  // THIRD_PARTY_HYBRID_RCC_STATS_DISTRIBUTIONS_MULTIVARIATE_CONTINUOUS_STUDENT_T_H_
@@ -27,25 +27,30 @@
 #include "Eigen/Core"
 
 namespace stats::multivariates {
-class IndependentTruncatedGaussian
-    : public IndependentDistributions<univariates::TruncatedGaussian> {
+template <typename Scalar>
+class BasicIndependentTruncatedGaussian
+    : public IndependentDistributions<
+          univariates::BasicTruncatedGaussian<Scalar>> {
+  using Array = Eigen::Array<Scalar, Eigen::Dynamic, 1>;
+
  public:
-  explicit IndependentTruncatedGaussian(const Eigen::ArrayXd& mu,
-                                        const Eigen::ArrayXd& std,
-                                        const Eigen::ArrayXd& _start,
-                                        const Eigen::ArrayXd& _end) {
-    dim_ = mu.size();
-    lower_corner_ = _start;
-    upper_corner_ = _end;
-    mu_ = Eigen::ArrayXd(dim_);
-    std_ = Eigen::ArrayXd(dim_);
-    for (int d = 0; d < dim_; d++) {
-      univariates_.emplace_back(mu[d], std[d], _start[d], _end[d]);
-      mu_[d] = univariates_.back().mean();
-      std_[d] = univariates_.back().std();
+  explicit BasicIndependentTruncatedGaussian(const Array& mu, const Array& std,
+                                             const Array& _start,
+                                             const Array& _end) {
+    this->dim_ = mu.size();
+    this->lower_corner_ = _start;
+    this->upper_corner_ = _end;
+    this->mu_ = Array(this->dim_);
+    this->std_ = Array(this->dim_);
+    for (int d = 0; d < this->dim_; d++) {
+      this->univariates_.emplace_back(mu[d], std[d], _start[d], _end[d]);
+      this->mu_[d] = this->univariates_.back().mean();
+      this->std_[d] = this->univariates_.back().std();
     }
   }
 };
+
+using IndependentTruncatedGaussian = BasicIndependentTruncatedGaussian<double>;
 }  // namespace stats::multivariates
 
 #endif  // THIRD_PARTY_HYBRID_RCC_STATS_DISTRIBUTIONS_MULTIVARIATE_CONTINUOUS_TRUNCATED_GAUSSIAN_H_
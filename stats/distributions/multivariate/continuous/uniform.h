@@ -27,38 +27,43 @@
 #include "Eigen/Core"
 
 namespace stats::multivariates {
-class IndependentUniform
-    : public IndependentDistributions<univariates::Uniform> {
+template <typename Scalar>
+class BasicIndependentUniform
+    : public IndependentDistributions<univariates::BasicUniform<Scalar>> {
+  using Array = Eigen::Array<Scalar, Eigen::Dynamic, 1>;
+
  public:
-  explicit IndependentUniform(const Eigen::ArrayXd& _start,
-                              const Eigen::ArrayXd& _end) {
-    dim_ = _start.size();
-    lower_corner_ = _start;
-    upper_corner_ = _end;
-    univariates_.reserve(dim_);
-    mu_ = Eigen::ArrayXd(dim_);
-    std_ = Eigen::ArrayXd(dim_);
-    for (int d = 0; d < dim_; d++) {
-      univariates_.emplace_back(_start[d], _end[d]);
-      mu_[d] = univariates_[d].mean();
-      std_[d] = univariates_[d].std();
+  explicit BasicIndependentUniform(const Array& _start, const Array& _end) {
+    this->dim_ = _start.size();
+    this->lower_corner_ = _start;
+    this->upper_corner_ = _end;
+    this->univariates_.reserve(this->dim_);
+    this->mu_ = Array(this->dim_);
+    this->std_ = Array(this->dim_);
+    for (int d = 0; d < this->dim_; d++) {
+      this->univariates_.emplace_back(_start[d], _end[d]);
+      this->mu_[d] = this->univariates_[d].mean();
+      this->std_[d] = this->univariates_[d].std();
     }
   }
-  explicit IndependentUniform(int dim) {
-    dim_ = dim;
-    lower_corner_ = Eigen::ArrayXd(dim);
-    lower_corner_ = 0;
-    upper_corner_ = Eigen::ArrayXd(dim);
-    upper_corner_ = 1;
-    mu_ = Eigen::ArrayXd(dim_);
-    std_ = Eigen::ArrayXd(dim_);
-    for (int d = 0; d < dim_; d++) {
-      univariates_.emplace_back(lower_corner_[d], upper_corner_[d]);
-      mu_[d] = univariates_[d].mean();
-      std_[d] = univariates_[d].std();
+  explicit BasicIndependentUniform(int dim) {
+    this->dim_ = dim;
+    this->lower_corner_ = Array(dim);
+    this->lower_corner_ = 0;
+    this->upper_corner_ = Array(dim);
+    this->upper_corner_ = 1;
+    this->mu_ = Array(this->dim_);
+    this->std_ = Array(this->dim_);
+    for (int d = 0; d < this->dim_; d++) {
+      this->univariates_.emplace_back(this->lower_corner_[d],
+                                      this->upper_corner_[d]);
+      this->mu_[d] = this->univariates_[d].mean();
+      this->std_[d] = this->univariates_[d].std();
     }
   }
 };
+
+using IndependentUniform = BasicIndependentUniform<double>;
 }  // namespace stats::multivariates
 
 #endif  // THIRD_PARTY_HYBRID_RCC_STATS_DISTRIBUTIONS_MULTIVARIATE_CONTINUOUS_UNIFORM_H_
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_STATS_DISTRIBUTIONS_MULTIVARIATE_DISCRETE_CATEGORICAL_H_
+#define THIRD_PARTY_HYBRID_RCC_STATS_DISTRIBUTIONS_MULTIVARIATE_DISCRETE_CATEGORICAL_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "Eigen/Core"
+#include "stats/distributions/multivariate/multivariate.h"
+#include "stats/distributions/probability_distribution.h"
+#include "stats/distributions/univariate/discrete/categorical.h"
+#include "stats/random_number_generator/stl_urbg.h"
+#include "stats/random_number_generator/ziggurat.h"
+
+namespace stats::multivariates {
+// Independent categorical distributions, one per dimension, all over
+// {0, ..., K - 1}. Categories a dimension does not use get probability 0.
+class IndependentCategorical
+    : public ProbabilityDistribution<DiscreteMultiVariable> {
+ private:
+  std::vector<univariates::Categorical> univariates_;
+  int dim_;
+  // dim x K table of log probabilities.
+  Eigen::ArrayXXd log_probs_;
+
+ public:
+  explicit IndependentCategorical(const Eigen::ArrayXXd& probs) {
+    dim_ = probs.rows();
+    log_probs_ = Eigen::ArrayXXd(dim_, probs.cols());
+    univariates_.reserve(dim_);
+    for (int d = 0; d < dim_; d++) {
+      univariates_.emplace_back(probs.row(d).transpose());
+      log_probs_.row(d) = univariates_[d].log_probs().transpose();
+    }
+  }
+
+  template <typename STD_URBG>
+  std::unique_ptr<RandomNumberGenerator> make_rng(STD_URBG& urbg) {
+    UniformDistribution d(0, 1);
+    return std::make_unique<URBG<STD_URBG, UniformDistribution>>(urbg, d);
+  }
+
+  // Maps a vector of uniform numbers in [0, 1) to a sample.
+  DiscreteMultiVariable::instanceType sample(const Eigen::ArrayXd& U) const {
+    DiscreteMultiVariable::instanceType X(dim_);
+    for (int d = 0; d < dim_; d++) X[d] = univariates_[d].sample(U[d]);
+    return X;
+  }
+
+  DiscreteMultiVariable::instanceType rvs(
+      std::unique_ptr<RandomNumberGenerator>& rng) override {
+    return sample(rng->sample(0, dim_));
+  }
+  DiscreteMultiVariable::listType rvs(
+      std::unique_ptr<RandomNumberGenerator>& rng, int n) override {
+    DiscreteMultiVariable::listType X(n, dim_);
+    for (int i = 0; i < n; i++) X.row(i) = rvs(rng).transpose();
+    return X;
+  }
+
+  Eigen::ArrayXd pdf(
+      const DiscreteMultiVariable::instanceType& X) const override {
+    return logpdf(X).exp();
+  }
+  Eigen::ArrayXXd pdf(
+      const DiscreteMultiVariable::listType& X) const override {
+    return logpdf(X).exp();
+  }
+  Eigen::ArrayXd logpdf(
+      const DiscreteMultiVariable::instanceType& X) const override {
+    Eigen::ArrayXd logp(dim_);
+    for (int d = 0; d < dim_; d++) logp[d] = univariates_[d].logpdf(X[d]);
+    return logp;
+  }
+  Eigen::ArrayXXd logpdf(
+      const DiscreteMultiVariable::listType& X) const override {
+    Eigen::ArrayXXd logp(X.rows(), dim_);
+    for (int d = 0; d < dim_; d++)
+      logp.col(d) = univariates_[d].logpdf(X.col(d));
+    return logp;
+  }
+  Eigen::ArrayXd cdf(
+      const DiscreteMultiVariable::instanceType& X) const override {
+    Eigen::ArrayXd p(dim_);
+    for (int d = 0; d < dim_; d++) p[d] = univariates_[d].cdf(X[d]);
+    return p;
+  }
+  Eigen::ArrayXXd cdf(
+      const DiscreteMultiVariable::listType& X) const override {
+    Eigen::ArrayXXd p(X.rows(), dim_);
+    for (int d = 0; d < dim_; d++) p.col(d) = univariates_[d].cdf(X.col(d));
+    return p;
+  }
+  std::vector<std::vector<int64_t>> support() const override {
+    std::vector<std::vector<int64_t>> support;
+    for (const auto& C : univariates_) support.push_back(C.support());
+    return support;
+  }
+  DiscreteMultiVariable::instanceType ppf(Eigen::ArrayXd P) const override {
+    DiscreteMultiVariable::instanceType X(dim_);
+    for (int d = 0; d < dim_; d++) X[d] = univariates_[d].ppf(P[d]);
+    return X;
+  }
+
+  int dim() const { return dim_; }
+  int64_t num_categories() const { return log_probs_.cols(); }
+  const Eigen::ArrayXXd& log_probs() const { return log_probs_; }
+  const std::vector<univariates::Categorical>& univariates() const {
+    return univariates_;
+  }
+
+  DiscreteMultiVariable::instanceType mean() const override {
+    DiscreteMultiVariable::instanceType mu(dim_);
+    for (int d = 0; d < dim_; d++) mu[d] = univariates_[d].mean();
+    return mu;
+  }
+  DiscreteMultiVariable::instanceType std() const override {
+    DiscreteMultiVariable::instanceType s(dim_);
+    for (int d = 0; d < dim_; d++) s[d] = univariates_[d].std();
+    return s;
+  }
+  DiscreteMultiVariable::instanceType var() const override {
+    DiscreteMultiVariable::instanceType v(dim_);
+    for (int d = 0; d < dim_; d++) v[d] = univariates_[d].var();
+    return v;
+  }
+  Eigen::ArrayXd entropy() const override {
+    Eigen::ArrayXd H(dim_);
+    for (int d = 0; d < dim_; d++) H[d] = univariates_[d].entropy();
+    return H;
+  }
+};
+}  // namespace stats::multivariates
+
+#endif  // THIRD_PARTY_HYBRID_RCC_STATS_DISTRIBUTIONS_MULTIVARIATE_DISCRETE_CATEGORICAL_H_
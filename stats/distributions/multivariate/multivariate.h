@@ -24,14 +24,17 @@
 #include "Eigen/Core"
 
 namespace stats {
-class ContinuousMultiVariable{
+template <typename Scalar>
+class BasicContinuousMultiVariable{
  public:
-  using instanceType = Eigen::ArrayXd;
-  using listType = Eigen::ArrayXXd;
+  using instanceType = Eigen::Array<Scalar, Eigen::Dynamic, 1>;
+  using listType = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>;
   using supportType = std::tuple<instanceType, instanceType>;
-  using pointProbabilityType = Eigen::ArrayXd;
-  using listProbabilityType = Eigen::ArrayXXd;
+  using pointProbabilityType = Eigen::Array<Scalar, Eigen::Dynamic, 1>;
+  using listProbabilityType =
+      Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>;
 };
+using ContinuousMultiVariable = BasicContinuousMultiVariable<double>;
 
 class DiscreteMultiVariable{
  public:
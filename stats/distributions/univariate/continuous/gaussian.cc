@@ -14,6 +14,7 @@
 
 #include "stats/distributions/univariate/continuous/gaussian.h"
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <limits>
@@ -22,57 +23,143 @@
 #include "unsupported/Eigen/SpecialFunctions"
 
 namespace stats::univariates {
-Gaussian::Gaussian(double mu, double std) {
+namespace {
+// AS241 for |p - 1/2| <= 0.425, written once for doubles and for arrays so
+// that both evaluate the same operations in the same order.
+template <typename T>
+T central_quantile(const T& q) {
+  T r = 0.180625 - q * q;
+  T num = (((((((2509.0809287301226727 * r + 33430.575583588128105) * r +
+                67265.770927008700853) * r + 45921.953931549871457) * r +
+              13731.693765509461125) * r + 1971.5909503065514427) * r +
+            133.14166789178437745) * r + 3.387132872796366608);
+  T den = (((((((5226.495278852545925 * r + 28729.085735721942674) * r +
+                39307.89580009271061) * r + 21213.794301586595867) * r +
+              5394.1960214247511077) * r + 687.1870074920579083) * r +
+            42.313330701600911252) * r + 1);
+  return q * num / den;
+}
+
+// AS241 for |p - 1/2| > 0.425.
+double tail_quantile(double p) {
+  p = std::min(std::max(p, std::numeric_limits<double>::min()),
+               1 - std::numeric_limits<double>::epsilon() / 2);
+  double q = p - 0.5;
+  double r = std::sqrt(-std::log(q < 0 ? p : 1 - p));
+  double x;
+  if (r <= 5) {
+    r -= 1.6;
+    x = (((((((7.7454501427834140764e-4 * r + 0.0227238449892691845833) * r +
+              0.24178072517745061177) * r + 1.27045825245236838258) * r +
+            3.64784832476320460504) * r + 5.7694972214606914055) * r +
+          4.6303378461565452959) * r + 1.42343711074968357734) /
+        (((((((1.05075007164441684324e-9 * r + 5.475938084995344946e-4) * r +
+              0.0151986665636164571966) * r + 0.14810397642748007459) * r +
+            0.68976733498510000455) * r + 1.6763848301838038494) * r +
+          2.05319162663775882187) * r + 1);
+  } else {
+    r -= 5;
+    x = (((((((2.01033439929228813265e-7 * r + 2.71155556874348757815e-5) * r +
+              0.0012426609473880784386) * r + 0.026532189526576123093) * r +
+            0.29656057182850489123) * r + 1.7848265399172913358) * r +
+          5.4637849111641143699) * r + 6.6579046435011037772) /
+        (((((((2.04426310338993978564e-15 * r + 1.4215117583164458887e-7) * r +
+              1.8463183175100546818e-5) * r + 7.868691311456132591e-4) * r +
+            0.0148753612908506148525) * r + 0.13692988092273580531) * r +
+          0.59983220655588793769) * r + 1);
+  }
+  return q < 0 ? -x : x;
+}
+}  // namespace
+
+double standard_normal_ppf(double p) {
+  double q = p - 0.5;
+  if (std::abs(q) <= 0.425) return central_quantile(q);
+  return tail_quantile(p);
+}
+
+Eigen::ArrayXd standard_normal_ppf(const Eigen::ArrayXd& P) {
+  // Fixed size chunks keep the temporaries of central_quantile in registers
+  // and on the stack.
+  using Chunk = Eigen::Array<double, 16, 1>;
+  const Eigen::Index n = P.size();
+  Eigen::ArrayXd X(n);
+  Eigen::Index i = 0;
+  for (; i + Chunk::SizeAtCompileTime <= n; i += Chunk::SizeAtCompileTime) {
+    Chunk q = P.segment<Chunk::SizeAtCompileTime>(i) - 0.5;
+    X.segment<Chunk::SizeAtCompileTime>(i) = central_quantile(q);
+    for (int j = 0; j < Chunk::SizeAtCompileTime; j++) {
+      if (!(std::abs(q[j]) <= 0.425)) X[i + j] = tail_quantile(P[i + j]);
+    }
+  }
+  for (; i < n; i++) X[i] = standard_normal_ppf(P[i]);
+  return X;
+}
+
+template <typename Scalar>
+BasicGaussian<Scalar>::BasicGaussian(Scalar mu, Scalar std) {
   mu_ = mu;
   std_ = std;
-  normal_rng_ = std::normal_distribution<>{mu_, std_};
+  normal_rng_ = NormalDistribution(mu_, std_);
 }
 
-double Gaussian::rvs(std::unique_ptr<RandomNumberGenerator>& rng) {
+// Random numbers are drawn in double whatever Scalar is, so that samplers
+// of either precision consume the same stream.
+template <typename Scalar>
+Scalar BasicGaussian<Scalar>::rvs(std::unique_ptr<RandomNumberGenerator>& rng) {
   return rng->sample(0);
 }
 
-Eigen::ArrayXd Gaussian::rvs(std::unique_ptr<RandomNumberGenerator>& rng,
-                             int n) {
-  return rng->sample(0, n);
+template <typename Scalar>
+typename BasicGaussian<Scalar>::Array BasicGaussian<Scalar>::rvs(
+    std::unique_ptr<RandomNumberGenerator>& rng, int n) {
+  return rng->sample(0, n).template cast<Scalar>();
 }
-double Gaussian::pdf(const double& x) const {
-  return std::exp(-0.5 * pow((x - mu_) / std_, 2)) / (std_ * sqrt2pi_);
+template <typename Scalar>
+Scalar BasicGaussian<Scalar>::pdf(const Scalar& x) const {
+  Scalar z = (x - mu_) / std_;
+  return std::exp(Scalar(-0.5) * z * z) / (std_ * sqrt2pi_);
 }
-double Gaussian::logpdf(const double& x) const {
-  return (-0.5 * pow((x - mu_) / std_, 2)) - std::log(std_ * sqrt2pi_);
+template <typename Scalar>
+Scalar BasicGaussian<Scalar>::logpdf(const Scalar& x) const {
+  Scalar z = (x - mu_) / std_;
+  return (Scalar(-0.5) * z * z) - std::log(std_ * sqrt2pi_);
 }
-double Gaussian::cdf(const double& x) const {
-  return 0.5 * (1 + std::erf((x - mu_) / (std_ * sqrt2_)));
+template <typename Scalar>
+Scalar BasicGaussian<Scalar>::cdf(const Scalar& x) const {
+  return Scalar(0.5) * (1 + std::erf((x - mu_) / (std_ * sqrt2_)));
 }
 
-Eigen::ArrayXd Gaussian::pdf(const Eigen::ArrayXd& X) const {
-  return (-0.5 * ((X - mu_) / std_).pow(2)).exp() / (std_ * sqrt2pi_);
+template <typename Scalar>
+typename BasicGaussian<Scalar>::Array BasicGaussian<Scalar>::pdf(
+    const Array& X) const {
+  return (Scalar(-0.5) * ((X - mu_) / std_).square()).exp() /
+         (std_ * sqrt2pi_);
 }
-Eigen::ArrayXd Gaussian::logpdf(const Eigen::ArrayXd& X) const {
-  return (-0.5 * ((X - mu_) / std_).pow(2)) - std::log(std_ * sqrt2pi_);
+template <typename Scalar>
+typename BasicGaussian<Scalar>::Array BasicGaussian<Scalar>::logpdf(
+    const Array& X) const {
+  return (Scalar(-0.5) * ((X - mu_) / std_).square()) -
+         std::log(std_ * sqrt2pi_);
 }
 
-Eigen::ArrayXd Gaussian::cdf(const Eigen::ArrayXd& X) const {
-  return (((X - mu_) / (std_ * sqrt2_)).erf() + 1) * 0.5;
+template <typename Scalar>
+typename BasicGaussian<Scalar>::Array BasicGaussian<Scalar>::cdf(
+    const Array& X) const {
+  return (((X - mu_) / (std_ * sqrt2_)).erf() + 1) * Scalar(0.5);
 }
 
-std::tuple<double, double> Gaussian::support() const {
-  return std::tuple<double, double>(-std::numeric_limits<double>::infinity(),
-                                    std::numeric_limits<double>::infinity());
+template <typename Scalar>
+std::tuple<Scalar, Scalar> BasicGaussian<Scalar>::support() const {
+  return std::tuple<Scalar, Scalar>(-std::numeric_limits<Scalar>::infinity(),
+                                    std::numeric_limits<Scalar>::infinity());
 }
 
-double Gaussian::ppf(double p) const {
-  double size = 1;
-  while (cdf(-size) > p || cdf(size) < p) size *= 2;
-  double s = -size, e = size;
-  while (e - s > 1e-12) {
-    double m = s + (e - s) / 2;
-    if (cdf(m) >= p)
-      e = m;
-    else
-      s = m;
-  }
-  return e;
+template <typename Scalar>
+Scalar BasicGaussian<Scalar>::ppf(Scalar p) const {
+  return mu_ + std_ * static_cast<Scalar>(standard_normal_ppf(p));
 }
+
+template class BasicGaussian<double>;
+template class BasicGaussian<float>;
 };  // namespace stats::univariates
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_STATS_DISTRIBUTIONS_UNIVARIATE_CONTINUOUS_LAPLACE_H_
+#define THIRD_PARTY_HYBRID_RCC_STATS_DISTRIBUTIONS_UNIVARIATE_CONTINUOUS_LAPLACE_H_
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <random>
+#include <tuple>
+
+#include "Eigen/Core"
+#include "stats/distributions/probability_distribution.h"
+#include "stats/distributions/univariate/univariate.h"
+#include "stats/random_number_generator/stl_urbg.h"
+#include "stats/random_number_generator/ziggurat.h"
+
+namespace stats::univariates {
+// Laplace distribution with location mu and scale b. The quantile is closed
+// form and samples are drawn by inversion of uniforms.
+template <typename Scalar>
+class BasicLaplace
+    : public ProbabilityDistribution<BasicContinuousSingleVariable<Scalar>> {
+ private:
+  using Array = Eigen::Array<Scalar, Eigen::Dynamic, 1>;
+  Scalar mu_, b_;
+  UniformDistribution uniform_rng_ = UniformDistribution(0, 1);
+
+ public:
+  BasicLaplace(Scalar mu, Scalar b) : mu_(mu), b_(b) {}
+
+  Scalar rvs(std::unique_ptr<RandomNumberGenerator>& rng) override {
+    return ppf(rng->sample(0));
+  }
+  Array rvs(std::unique_ptr<RandomNumberGenerator>& rng, int n) override {
+    Array X(n);
+    for (int i = 0; i < n; i++) X[i] = rvs(rng);
+    return X;
+  }
+
+  Scalar pdf(const Scalar& x) const override { return std::exp(logpdf(x)); }
+  Array pdf(const Array& X) const override { return logpdf(X).exp(); }
+  Scalar logpdf(const Scalar& x) const override {
+    return -std::abs(x - mu_) / b_ - std::log(2 * b_);
+  }
+  Array logpdf(const Array& X) const override {
+    return -(X - mu_).abs() / b_ - std::log(2 * b_);
+  }
+  Scalar cdf(const Scalar& x) const override {
+    Scalar tail = Scalar(0.5) * std::exp(-std::abs(x - mu_) / b_);
+    return x < mu_ ? tail : 1 - tail;
+  }
+  Array cdf(const Array& X) const override {
+    Array tail = Scalar(0.5) * (-(X - mu_).abs() / b_).exp();
+    return (X < mu_).select(tail, 1 - tail);
+  }
+  std::tuple<Scalar, Scalar> support() const override {
+    return std::tuple<Scalar, Scalar>(-std::numeric_limits<Scalar>::infinity(),
+                                      std::numeric_limits<Scalar>::infinity());
+  }
+
+  template <typename RNG>
+  std::unique_ptr<RandomNumberGenerator> make_rng(RNG rng) {
+    return std::make_unique<URBG<RNG, UniformDistribution>>(rng,
+                                                             uniform_rng_);
+  }
+
+  Scalar ppf(Scalar p) const override {
+    if (p < Scalar(0.5)) return mu_ + b_ * std::log(2 * p);
+    return mu_ - b_ * std::log(2 * (1 - p));
+  }
+  Scalar mean() const override { return mu_; }
+  Scalar std() const override { return std::sqrt(var()); }
+  Scalar var() const override { return 2 * b_ * b_; }
+  Scalar entropy() const override { return 1 + std::log(2 * b_); }
+  Scalar scale() const { return b_; }
+};
+
+using Laplace = BasicLaplace<double>;
+}  // namespace stats::univariates
+#endif  // THIRD_PARTY_HYBRID_RCC_STATS_DISTRIBUTIONS_UNIVARIATE_CONTINUOUS_LAPLACE_H_
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_STATS_DISTRIBUTIONS_UNIVARIATE_CONTINUOUS_LOGISTIC_H_
+#define THIRD_PARTY_HYBRID_RCC_STATS_DISTRIBUTIONS_UNIVARIATE_CONTINUOUS_LOGISTIC_H_
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <random>
+#include <tuple>
+
+#include "Eigen/Core"
+#include "stats/distributions/probability_distribution.h"
+#include "stats/distributions/univariate/univariate.h"
+#include "stats/random_number_generator/stl_urbg.h"
+#include "stats/random_number_generator/ziggurat.h"
+
+namespace stats::univariates {
+// Logistic distribution with location mu and scale s. The quantile is the
+// closed form logit and samples are drawn by inversion of uniforms. The
+// densities are evaluated on -|z| so that they do not overflow in the tails.
+template <typename Scalar>
+class BasicLogistic
+    : public ProbabilityDistribution<BasicContinuousSingleVariable<Scalar>> {
+ private:
+  using Array = Eigen::Array<Scalar, Eigen::Dynamic, 1>;
+  Scalar mu_, s_;
+  UniformDistribution uniform_rng_ = UniformDistribution(0, 1);
+
+ public:
+  BasicLogistic(Scalar mu, Scalar s) : mu_(mu), s_(s) {}
+
+  Scalar rvs(std::unique_ptr<RandomNumberGenerator>& rng) override {
+    return ppf(rng->sample(0));
+  }
+  Array rvs(std::unique_ptr<RandomNumberGenerator>& rng, int n) override {
+    Array X(n);
+    for (int i = 0; i < n; i++) X[i] = rvs(rng);
+    return X;
+  }
+
+  Scalar pdf(const Scalar& x) const override { return std::exp(logpdf(x)); }
+  Array pdf(const Array& X) const override { return logpdf(X).exp(); }
+  Scalar logpdf(const Scalar& x) const override {
+    Scalar z = -std::abs(x - mu_) / s_;
+    return z - 2 * std::log1p(std::exp(z)) - std::log(s_);
+  }
+  Array logpdf(const Array& X) const override {
+    Array z = -(X - mu_).abs() / s_;
+    return z - 2 * z.exp().log1p() - std::log(s_);
+  }
+  Scalar cdf(const Scalar& x) const override {
+    Scalar tail = 1 / (1 + std::exp(std::abs(x - mu_) / s_));
+    return x < mu_ ? tail : 1 - tail;
+  }
+  Array cdf(const Array& X) const override {
+    Array tail = 1 / (1 + ((X - mu_).abs() / s_).exp());
+    return (X < mu_).select(tail, 1 - tail);
+  }
+  std::tuple<Scalar, Scalar> support() const override {
+    return std::tuple<Scalar, Scalar>(-std::numeric_limits<Scalar>::infinity(),
+                                      std::numeric_limits<Scalar>::infinity());
+  }
+
+  template <typename RNG>
+  std::unique_ptr<RandomNumberGenerator> make_rng(RNG rng) {
+    return std::make_unique<URBG<RNG, UniformDistribution>>(rng,
+                                                             uniform_rng_);
+  }
+
+  Scalar ppf(Scalar p) const override {
+    return mu_ + s_ * (std::log(p) - std::log1p(-p));
+  }
+  Scalar mean() const override { return mu_; }
+  Scalar std() const override { return std::sqrt(var()); }
+  Scalar var() const override { return s_ * s_ * Scalar(M_PI * M_PI / 3); }
+  Scalar entropy() const override { return std::log(s_) + 2; }
+  Scalar scale() const { return s_; }
+};
+
+using Logistic = BasicLogistic<double>;
+}  // namespace stats::univariates
+#endif  // THIRD_PARTY_HYBRID_RCC_STATS_DISTRIBUTIONS_UNIVARIATE_CONTINUOUS_LOGISTIC_H_
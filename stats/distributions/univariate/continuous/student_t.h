@@ -0,0 +1,92 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_STATS_DISTRIBUTIONS_UNIVARIATE_CONTINUOUS_STUDENT_T_H_
+#define THIRD_PARTY_HYBRID_RCC_STATS_DISTRIBUTIONS_UNIVARIATE_CONTINUOUS_STUDENT_T_H_
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <tuple>
+
+#include "Eigen/Core"
+#include "stats/distributions/probability_distribution.h"
+#include "stats/distributions/univariate/univariate.h"
+#include "stats/random_number_generator/stl_urbg.h"
+#include "stats/random_number_generator/ziggurat.h"
+
+namespace stats::univariates {
+// Student's t distribution with df degrees of freedom, location mu and scale
+// sigma. The cdf is the regularized incomplete beta function. The quantile
+// starts from Hill's approximation (CACM algorithm 396) and is refined by
+// Halley steps on the lower tail, so it costs about two cdf evaluations
+// rather than the dozens of a bisection. Samples are drawn by inversion of
+// uniforms. Tail computations run in double whatever Scalar is.
+template <typename Scalar>
+class BasicStudentT
+    : public ProbabilityDistribution<BasicContinuousSingleVariable<Scalar>> {
+ private:
+  using Traits = BasicContinuousSingleVariable<Scalar>;
+  using Array = typename Traits::listType;
+
+  Scalar mu_, sigma_, df_;
+  // Log density of the standard t at 0.
+  double log_norm_;
+  UniformDistribution uniform_rng_ = UniformDistribution(0, 1);
+
+  // Lower tail probability and log density of the standard t at z.
+  double lower_tail(double z) const;
+  double standard_logpdf(double z) const;
+
+ public:
+  BasicStudentT(Scalar mu, Scalar sigma, Scalar df);
+
+  Scalar rvs(std::unique_ptr<RandomNumberGenerator>&) override;
+  Array rvs(std::unique_ptr<RandomNumberGenerator>&, int) override;
+  Scalar pdf(const Scalar&) const override;
+  Array pdf(const Array&) const override;
+  Scalar logpdf(const Scalar&) const override;
+  Array logpdf(const Array&) const override;
+  Scalar cdf(const Scalar&) const override;
+  Array cdf(const Array&) const override;
+  std::tuple<Scalar, Scalar> support() const override;
+
+  template <typename RNG>
+  std::unique_ptr<RandomNumberGenerator> make_rng(RNG rng) {
+    return std::make_unique<URBG<RNG, UniformDistribution>>(rng,
+                                                             uniform_rng_);
+  }
+
+  Scalar ppf(Scalar) const override;
+
+  // The mean is NaN for df <= 1 and the variance is +inf for 1 < df <= 2
+  // and NaN below.
+  Scalar mean() const override;
+  Scalar std() const override { return std::sqrt(var()); }
+  Scalar var() const override;
+  Scalar entropy() const override;
+  Scalar scale() const { return sigma_; }
+  Scalar df() const { return df_; }
+};
+
+// Defined in student_t.cc for these two scalar types only.
+extern template class BasicStudentT<double>;
+extern template class BasicStudentT<float>;
+
+using StudentT = BasicStudentT<double>;
+}  // namespace stats::univariates
+
+#endif  // THIRD_PARTY_HYBRID_RCC_STATS_DISTRIBUTIONS_UNIVARIATE_CONTINUOUS_STUDENT_T_H_
@@ -26,58 +26,67 @@
 
 #include "stats/distributions/univariate/continuous/gaussian.h"
 #include "stats/random_number_generator/random_number_generator.h"
+#include "stats/random_number_generator/ziggurat.h"
 
 namespace stats::univariates {
-class TruncatedGaussian : public Gaussian {
+template <typename Scalar>
+class BasicTruncatedGaussian : public BasicGaussian<Scalar> {
+ public:
+  using Gaussian = BasicGaussian<Scalar>;
+
  private:
-  double z_, cdf_a_, a_, b_, f1_, f2_;
+  using Array = Eigen::Array<Scalar, Eigen::Dynamic, 1>;
+  Scalar z_, cdf_a_, a_, b_, f1_, f2_;
 
  public:
-  TruncatedGaussian(double mu, double std, double A, double B)
+  BasicTruncatedGaussian(Scalar mu, Scalar std, Scalar A, Scalar B)
       : Gaussian(mu, std) {
     a_ = A, b_ = B;
     cdf_a_ = Gaussian::cdf(A);
     z_ = Gaussian::cdf(B) - cdf_a_;
-    double alpha = (a_ - mu) / std;
-    double beta = (b_ - mu) / std;
+    Scalar alpha = (a_ - mu) / std;
+    Scalar beta = (b_ - mu) / std;
     Gaussian phi(0, 1);
     f1_ = (alpha * phi.pdf(alpha) - beta * phi.pdf(beta)) / z_;
     f2_ = (phi.pdf(alpha) - phi.pdf(beta)) / z_;
   }
 
-  double rvs(std::unique_ptr<RandomNumberGenerator>&) override;
-  Eigen::ArrayXd rvs(std::unique_ptr<RandomNumberGenerator>&, int) override;
-  double pdf(const double& x) const override {
+  Scalar rvs(std::unique_ptr<RandomNumberGenerator>&) override;
+  Array rvs(std::unique_ptr<RandomNumberGenerator>&, int) override;
+  Scalar pdf(const Scalar& x) const override {
     return Gaussian::pdf(x) / z_ * (a_ <= x && x <= b_);
   }
-  Eigen::ArrayXd pdf(const Eigen::ArrayXd& X) const override {
-    return Gaussian::pdf(X) * (a_ <= X && X <= b_).cast<double>() / z_;
+  Array pdf(const Array& X) const override {
+    return Gaussian::pdf(X) * (a_ <= X && X <= b_).template cast<Scalar>() /
+           z_;
   }
-  double logpdf(const double& x) const override {
+  Scalar logpdf(const Scalar& x) const override {
     if (a_ <= x && x <= b_)
       return Gaussian::logpdf(x) - std::log(z_);
     else
-      return -std::numeric_limits<double>::infinity();
+      return -std::numeric_limits<Scalar>::infinity();
   }
-  Eigen::ArrayXd logpdf(const Eigen::ArrayXd& X) const override {
-    auto in_support = (a_ <= X && X <= b_).cast<double>();
+  Array logpdf(const Array& X) const override {
+    auto in_support = (a_ <= X && X <= b_).template cast<Scalar>();
     return (Gaussian::logpdf(X) - std::log(z_)) * in_support +
-           (1 - in_support) * -std::numeric_limits<double>::infinity();
+           (1 - in_support) * -std::numeric_limits<Scalar>::infinity();
   }
-  double cdf(const double& x) const override {
-    return std::min(1.0, std::max(0.0, (Gaussian::cdf(x) - cdf_a_) / z_));
+  Scalar cdf(const Scalar& x) const override {
+    return std::min(Scalar(1),
+                    std::max(Scalar(0), (Gaussian::cdf(x) - cdf_a_) / z_));
   }
-  Eigen::ArrayXd cdf(const Eigen::ArrayXd& X) const override {
+  Array cdf(const Array& X) const override {
     return ((Gaussian::cdf(X) - cdf_a_) / z_).min(1).max(0);
   }
-  std::tuple<double, double> support() const override {
-    return std::tuple<double, double>(a_, b_);
+  std::tuple<Scalar, Scalar> support() const override {
+    return std::tuple<Scalar, Scalar>(a_, b_);
   }
 
-  double ppf(double p) const override {
-    double s = a_, e = b_;
-    while (e - s > 1e-12) {
-      double m = s + (e - s) / 2;
+  Scalar ppf(Scalar p) const override {
+    Scalar s = a_, e = b_;
+    while (e - s > Scalar(1e-12)) {
+      Scalar m = s + (e - s) / 2;
+      if (m == s || m == e) break;
       if (cdf(m) >= p)
         e = m;
       else
@@ -85,38 +94,40 @@ class TruncatedGaussian : public Gaussian {
     }
     return e;
   }
-  double mean() const override {
-    double mu = Gaussian::mean();
-    double sigma = Gaussian::std();
+  Scalar mean() const override {
+    Scalar mu = Gaussian::mean();
+    Scalar sigma = Gaussian::std();
     return mu + f2_ * sigma;
   }
-  double var() const override {
-    double sigma = Gaussian::std();
+  Scalar var() const override {
+    Scalar sigma = Gaussian::std();
     return sigma * sigma * (1 + f1_ - f2_ * f2_);
   }
-  double std() const override { return std::sqrt(var()); }
-  double entropy() const override {
+  Scalar std() const override { return std::sqrt(var()); }
+  Scalar entropy() const override {
     return Gaussian::entropy() + std::log(z_) + f1_ / 2;
   }
   template <typename RNG>
   std::unique_ptr<RandomNumberGenerator> make_rng(RNG rng) {
-    std::uniform_real_distribution<> d(0, 1);
-    return std::make_unique<URBG<RNG, std::uniform_real_distribution<>>>(rng,
-                                                                         d);
+    UniformDistribution d(0, 1);
+    return std::make_unique<URBG<RNG, UniformDistribution>>(rng, d);
   }
 };
 
-inline double TruncatedGaussian::rvs(
+template <typename Scalar>
+inline Scalar BasicTruncatedGaussian<Scalar>::rvs(
     std::unique_ptr<RandomNumberGenerator>& rng) {
   return ppf(rng->sample(0));
 }
 
-inline Eigen::ArrayXd TruncatedGaussian::rvs(
-    std::unique_ptr<RandomNumberGenerator>& rng, int n) {
-  return (Eigen::ArrayXd)Eigen::ArrayXd(n)
-      .unaryExpr(
-          [this, &rng](const double) { return this->rvs(rng); })
-      .cast<double>();
+template <typename Scalar>
+inline typename BasicTruncatedGaussian<Scalar>::Array
+BasicTruncatedGaussian<Scalar>::rvs(std::unique_ptr<RandomNumberGenerator>& rng,
+                                    int n) {
+  return Array(n).unaryExpr(
+      [this, &rng](const Scalar) { return this->rvs(rng); });
 }
+
+using TruncatedGaussian = BasicTruncatedGaussian<double>;
 }  // namespace stats::univariates
 #endif  // THIRD_PARTY_HYBRID_RCC_STATS_DISTRIBUTIONS_UNIVARIATE_CONTINUOUS_TRUNCATED_GAUSSIAN_H_
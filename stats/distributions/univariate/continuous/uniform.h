@@ -27,72 +27,79 @@
 #include "stats/distributions/probability_distribution.h"
 #include "stats/distributions/univariate/univariate.h"
 #include "stats/random_number_generator/stl_urbg.h"
+#include "stats/random_number_generator/ziggurat.h"
 
 namespace stats::univariates {
-class Uniform : public ProbabilityDistribution<ContinuousSingleVariable> {
+template <typename Scalar>
+class BasicUniform
+    : public ProbabilityDistribution<BasicContinuousSingleVariable<Scalar>> {
  private:
-  std::uniform_real_distribution<> uniform_rng_;
-  double lower_end_, upper_end_;
+  using Array = Eigen::Array<Scalar, Eigen::Dynamic, 1>;
+  UniformDistribution uniform_rng_;
+  Scalar lower_end_, upper_end_;
 
  public:
-  Uniform(double s, double e) {
+  BasicUniform(Scalar s, Scalar e) {
     lower_end_ = s, upper_end_ = e;
-    uniform_rng_ = std::uniform_real_distribution<>(s, e);
+    uniform_rng_ = UniformDistribution(s, e);
   }
 
-  double rvs(std::unique_ptr<RandomNumberGenerator>& rng) override {
+  Scalar rvs(std::unique_ptr<RandomNumberGenerator>& rng) override {
     return rng->sample(0);
   }
 
-  Eigen::ArrayXd rvs(std::unique_ptr<RandomNumberGenerator>& rng,
-                     int n) override {
-    return rng->sample(0, n);
+  Array rvs(std::unique_ptr<RandomNumberGenerator>& rng, int n) override {
+    return rng->sample(0, n).template cast<Scalar>();
   }
 
-  double pdf(const double& x) const override {
+  Scalar pdf(const Scalar& x) const override {
     return (lower_end_ <= x && x <= upper_end_) / (upper_end_ - lower_end_);
   }
-  Eigen::ArrayXd pdf(const Eigen::ArrayXd& X) const override {
-    return (lower_end_ <= X && X <= upper_end_).cast<double>() /
+  Array pdf(const Array& X) const override {
+    return (lower_end_ <= X && X <= upper_end_).template cast<Scalar>() /
            (upper_end_ - lower_end_);
   }
-  double logpdf(const double& x) const override {
+  Scalar logpdf(const Scalar& x) const override {
     if (lower_end_ <= x && x <= upper_end_)
       return -std::log(upper_end_ - lower_end_);
-    return -std::numeric_limits<double>::infinity();
+    return -std::numeric_limits<Scalar>::infinity();
   }
-  Eigen::ArrayXd logpdf(const Eigen::ArrayXd& X) const override {
-    auto in_support = (lower_end_ <= X && X <= upper_end_).cast<double>() /
-                      (upper_end_ - lower_end_);
+  Array logpdf(const Array& X) const override {
+    auto in_support =
+        (lower_end_ <= X && X <= upper_end_).template cast<Scalar>() /
+        (upper_end_ - lower_end_);
     return in_support +
-           (1 - in_support) * -std::numeric_limits<double>::infinity();
+           (1 - in_support) * -std::numeric_limits<Scalar>::infinity();
   }
-  double cdf(const double& x) const override {
-    return std::min(std::max(x - lower_end_, 0.0) / (upper_end_ - lower_end_),
-                    1.0);
+  Scalar cdf(const Scalar& x) const override {
+    return std::min(
+        std::max(x - lower_end_, Scalar(0)) / (upper_end_ - lower_end_),
+        Scalar(1));
   }
-  Eigen::ArrayXd cdf(const Eigen::ArrayXd& X) const override {
+  Array cdf(const Array& X) const override {
     return ((X - lower_end_) / (upper_end_ - lower_end_)).min(1).max(0);
   }
-  std::tuple<double, double> support() const override {
-    return std::tuple<double, double>(lower_end_, upper_end_);
+  std::tuple<Scalar, Scalar> support() const override {
+    return std::tuple<Scalar, Scalar>(lower_end_, upper_end_);
   }
 
   template <typename RNG>
   std::unique_ptr<RandomNumberGenerator> make_rng(RNG rng) {
-    return std::make_unique<URBG<RNG, std::uniform_real_distribution<>>>(
-        rng, uniform_rng_);
+    return std::make_unique<URBG<RNG, UniformDistribution>>(rng,
+                                                             uniform_rng_);
   }
 
-  double ppf(double p) const override {
+  Scalar ppf(Scalar p) const override {
     return lower_end_ + (upper_end_ - lower_end_) * p;
   }
-  double mean() const override { return (lower_end_ + upper_end_) / 2.0; }
-  double std() const override { return std::sqrt(var()); }
-  double var() const override {
-    return (upper_end_ - lower_end_) * (upper_end_ - lower_end_) / 12.0;
+  Scalar mean() const override { return (lower_end_ + upper_end_) / 2; }
+  Scalar std() const override { return std::sqrt(var()); }
+  Scalar var() const override {
+    return (upper_end_ - lower_end_) * (upper_end_ - lower_end_) / 12;
   }
-  double entropy() const override { return std::log(upper_end_ - lower_end_); }
+  Scalar entropy() const override { return std::log(upper_end_ - lower_end_); }
 };
+
+using Uniform = BasicUniform<double>;
 }  // namespace stats::univariates
 #endif  // THIRD_PARTY_HYBRID_RCC_STATS_DISTRIBUTIONS_UNIVARIATE_CONTINUOUS_UNIFORM_H_
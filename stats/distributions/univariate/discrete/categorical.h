@@ -0,0 +1,156 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_STATS_DISTRIBUTIONS_UNIVARIATE_DISCRETE_CATEGORICAL_H_
+#define THIRD_PARTY_HYBRID_RCC_STATS_DISTRIBUTIONS_UNIVARIATE_DISCRETE_CATEGORICAL_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "Eigen/Core"
+#include "stats/distributions/probability_distribution.h"
+#include "stats/distributions/univariate/univariate.h"
+#include "stats/random_number_generator/stl_urbg.h"
+#include "stats/random_number_generator/ziggurat.h"
+
+namespace stats::univariates {
+// Categorical distribution over {0, ..., K - 1}.
+//
+// Sampling uses Vose's alias method so that a draw costs a single uniform
+// number and one table lookup regardless of K.
+class Categorical : public ProbabilityDistribution<DiscreteSingleVariable> {
+ private:
+  Eigen::ArrayXd probs_, log_probs_, cdf_, alias_probs_;
+  Eigen::Array<int64_t, Eigen::Dynamic, 1> alias_;
+  int64_t k_;
+
+ public:
+  explicit Categorical(const Eigen::ArrayXd& probs) {
+    assert(probs.size() > 0 && (probs >= 0).all());
+    k_ = probs.size();
+    probs_ = probs / probs.sum();
+    log_probs_ = probs_.log();
+    cdf_ = probs_;
+    std::partial_sum(cdf_.begin(), cdf_.end(), cdf_.begin());
+
+    // Vose's alias method.
+    alias_probs_ = probs_ * k_;
+    alias_ = Eigen::Array<int64_t, Eigen::Dynamic, 1>::LinSpaced(k_, 0, k_ - 1);
+    std::vector<int64_t> small, large;
+    for (int64_t i = 0; i < k_; i++)
+      (alias_probs_[i] < 1 ? small : large).push_back(i);
+    while (!small.empty() && !large.empty()) {
+      int64_t s = small.back(), l = large.back();
+      small.pop_back();
+      alias_[s] = l;
+      alias_probs_[l] -= 1 - alias_probs_[s];
+      if (alias_probs_[l] < 1) {
+        large.pop_back();
+        small.push_back(l);
+      }
+    }
+    for (int64_t i : small) alias_probs_[i] = 1;
+    for (int64_t i : large) alias_probs_[i] = 1;
+  }
+
+  // Maps a uniform number in [0, 1) to a category.
+  int64_t sample(double u) const {
+    double x = u * k_;
+    int64_t i = std::min<int64_t>(static_cast<int64_t>(x), k_ - 1);
+    return x - i < alias_probs_[i] ? i : alias_[i];
+  }
+
+  int64_t rvs(std::unique_ptr<RandomNumberGenerator>& rng) override {
+    return sample(rng->sample(0));
+  }
+  DiscreteSingleVariable::listType rvs(
+      std::unique_ptr<RandomNumberGenerator>& rng, int n) override {
+    DiscreteSingleVariable::listType X(n);
+    for (int i = 0; i < n; i++) X[i] = rvs(rng);
+    return X;
+  }
+
+  double pdf(const int64_t& x) const override {
+    return 0 <= x && x < k_ ? probs_[x] : 0;
+  }
+  Eigen::ArrayXd pdf(const DiscreteSingleVariable::listType& X) const override {
+    return X.unaryExpr([this](int64_t x) { return pdf(x); });
+  }
+  double logpdf(const int64_t& x) const override {
+    return 0 <= x && x < k_ ? log_probs_[x]
+                            : -std::numeric_limits<double>::infinity();
+  }
+  Eigen::ArrayXd logpdf(
+      const DiscreteSingleVariable::listType& X) const override {
+    return X.unaryExpr([this](int64_t x) { return logpdf(x); });
+  }
+  double cdf(const int64_t& x) const override {
+    if (x < 0) return 0;
+    return x < k_ ? cdf_[x] : 1;
+  }
+  Eigen::ArrayXd cdf(const DiscreteSingleVariable::listType& X) const override {
+    return X.unaryExpr([this](int64_t x) { return cdf(x); });
+  }
+  std::vector<int64_t> support() const override {
+    std::vector<int64_t> support;
+    for (int64_t i = 0; i < k_; i++)
+      if (probs_[i] > 0) support.push_back(i);
+    return support;
+  }
+  int64_t ppf(double p) const override {
+    return std::min<int64_t>(
+        std::lower_bound(cdf_.begin(), cdf_.end(), p) - cdf_.begin(), k_ - 1);
+  }
+
+  template <typename RNG>
+  std::unique_ptr<RandomNumberGenerator> make_rng(RNG rng) {
+    UniformDistribution d(0, 1);
+    return std::make_unique<URBG<RNG, UniformDistribution>>(rng, d);
+  }
+
+  int64_t num_categories() const { return k_; }
+  const Eigen::ArrayXd& probs() const { return probs_; }
+  const Eigen::ArrayXd& log_probs() const { return log_probs_; }
+
+  // The moments are rounded to the nearest category since instanceType is
+  // integral; use probs() for the exact values.
+  int64_t mean() const override {
+    return std::lround(
+        (probs_ * Eigen::ArrayXd::LinSpaced(k_, 0, k_ - 1)).sum());
+  }
+  int64_t var() const override {
+    Eigen::ArrayXd x = Eigen::ArrayXd::LinSpaced(k_, 0, k_ - 1);
+    double mu = (probs_ * x).sum();
+    return std::lround((probs_ * (x - mu).square()).sum());
+  }
+  int64_t std() const override {
+    Eigen::ArrayXd x = Eigen::ArrayXd::LinSpaced(k_, 0, k_ - 1);
+    double mu = (probs_ * x).sum();
+    return std::lround(std::sqrt((probs_ * (x - mu).square()).sum()));
+  }
+  double entropy() const override {
+    return -(probs_ > 0).select(probs_ * log_probs_, 0).sum();
+  }
+};
+}  // namespace stats::univariates
+#endif  // THIRD_PARTY_HYBRID_RCC_STATS_DISTRIBUTIONS_UNIVARIATE_DISCRETE_CATEGORICAL_H_
@@ -24,14 +24,17 @@
 #include "Eigen/Core"
 
 namespace stats {
-class ContinuousSingleVariable{
+template <typename Scalar>
+class BasicContinuousSingleVariable{
  public:
-  using instanceType = double;
+  using instanceType = Scalar;
   using listType = Eigen::Array<instanceType, Eigen::Dynamic, 1>;
-  using supportType = std::tuple<double, double>;
-  using pointProbabilityType = double;
-  using listProbabilityType = Eigen::ArrayXd;
+  using supportType = std::tuple<Scalar, Scalar>;
+  using pointProbabilityType = Scalar;
+  using listProbabilityType = Eigen::Array<Scalar, Eigen::Dynamic, 1>;
 };
+using ContinuousSingleVariable = BasicContinuousSingleVariable<double>;
+
 class DiscreteSingleVariable{
  public:
   using instanceType = int64_t;
@@ -0,0 +1,380 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "stats/random_number_generator/ziggurat.h"
+
+// 256-layer ziggurat tables for f(x) = exp(-x) and f(x) = exp(-x^2 / 2),
+// both with f(0) = 1. With v the common layer area and r = X[1],
+//
+//   X[0] = v / f(r),  X[i + 1] = f^-1(f(X[i]) + v / X[i]),  X[256] = 0,
+//   F[i] = f(X[i]),   F[256] = 1,
+//
+// where r solves f(X[255]) + v / X[255] = 1 with v = r f(r) + tail(r):
+// r = 7.69711747013105 for the exponential and 3.65415288536101 for the
+// normal. F[0] is never read. The tables are literals so that they do not
+// depend on the libm of the build.
+namespace stats::internal {
+const double kExponentialX[257] = {
+    0x1.164ec94bf5dc2p+3, 0x1.ec9d9297ebb83p+2, 0x1.bc39e51da71fcp+2,
+    0x1.9e9dc0d487b85p+2, 0x1.8939fe6f2ed19p+2, 0x1.78750d6eac62fp+2,
+    0x1.6aa676d4bbf72p+2, 0x1.5ee7ae17313d2p+2, 0x1.54ad83ccf73f5p+2,
+    0x1.4b9d7cd4751d0p+2, 0x1.4379766e41361p+2, 0x1.3c14ec7c8b860p+2,
+    0x1.354ee27ccf75dp+2, 0x1.2f0e38a4411f0p+2, 0x1.293f5ae49aaa5p+2,
+    0x1.23d2bb659919fp+2, 0x1.1ebbca0c9fa7cp+2, 0x1.19f03bcb3c2d6p+2,
+    0x1.156786775442ap+2, 0x1.111a8034392a6p+2, 0x1.0d031785d48a0p+2,
+    0x1.091c1cdcba54ep+2, 0x1.056118bf58eefp+2, 0x1.01ce2b362ec2ep+2,
+    0x1.fcbfe43f6c6e6p+1, 0x1.f626e9791f7a7p+1, 0x1.efcc26750ea4ap+1,
+    0x1.e9aaf2af383c1p+1, 0x1.e3bf26e190960p+1, 0x1.de050af4ef19fp+1,
+    0x1.d87946fec3becp+1, 0x1.d318d6b2738c5p+1, 0x1.cde0fecf2a97fp+1,
+    0x1.c8cf442c8c8f3p+1, 0x1.c3e1641c2e0a6p+1, 0x1.bf154de4bef76p+1,
+    0x1.ba691d276da5dp+1, 0x1.b5db15091ea0ep+1, 0x1.b1699c003b608p+1,
+    0x1.ad13382d845c3p+1, 0x1.a8d68c2ad86e8p+1, 0x1.a4b2543e84c3ap+1,
+    0x1.a0a563e49f177p+1, 0x1.9caea3a24d9e9p+1, 0x1.98cd0f18d1ad7p+1,
+    0x1.94ffb34fc2a0dp+1, 0x1.9145ad2f37543p+1, 0x1.8d9e2823b3695p+1,
+    0x1.8a085ce695baap+1, 0x1.8683906687341p+1, 0x1.830f12cc0bec3p+1,
+    0x1.7faa3e96e1412p+1, 0x1.7c5477d1476d3p+1, 0x1.790d2b56b71f9p+1,
+    0x1.75d3ce2bd71c3p+1, 0x1.72a7dce5cd218p+1, 0x1.6f88db1f42507p+1,
+    0x1.6c7652f9a7b1ep+1, 0x1.696fd4a9748eep+1, 0x1.6674f60c3f431p+1,
+    0x1.63855247b2e93p+1, 0x1.60a0897081877p+1, 0x1.5dc640388bd9cp+1,
+    0x1.5af61fa38e106p+1, 0x1.582fd4c1b4460p+1, 0x1.5573106f8a759p+1,
+    0x1.52bf871acaab1p+1, 0x1.5014f08b99508p+1, 0x1.4d7307b1cb127p+1,
+    0x1.4ad98a75da14cp+1, 0x1.4848398d39432p+1, 0x1.45bed851bc92cp+1,
+    0x1.433d2c9bd42f8p+1, 0x1.40c2fe9f5eeadp+1, 0x1.3e5018caddecfp+1,
+    0x1.3be447a8d8b83p+1, 0x1.397f59c345143p+1, 0x1.37211f88ca856p+1,
+    0x1.34c96b33bc965p+1, 0x1.327810b2aa7cfp+1, 0x1.302ce59265964p+1,
+    0x1.2de7c0e962d70p+1, 0x1.2ba87b445db50p+1, 0x1.296eee942532bp+1,
+    0x1.273af61c7daa6p+1, 0x1.250c6e6403bbap+1, 0x1.22e33524fe550p+1,
+    0x1.20bf293f0f4a2p+1, 0x1.1ea02aa9b3371p+1, 0x1.1c861a6782a5bp+1,
+    0x1.1a70da7a27821p+1, 0x1.18604dd6fae9ep+1, 0x1.1654585c404c1p+1,
+    0x1.144cdec6f3a2cp+1, 0x1.1249c6a92154bp+1, 0x1.104af660befcfp+1,
+    0x1.0e50550efcfb8p+1, 0x1.0c59ca9009470p+1, 0x1.0a673f733c81ap+1,
+    0x1.08789cf3aad0fp+1, 0x1.068dccf1126dbp+1, 0x1.04a6b9e9224a3p+1,
+    0x1.02c34ef11391bp+1, 0x1.00e377af911d5p+1, 0x1.fe0e40add09d9p+0,
+    0x1.fa5c6b3efe1e6p+0, 0x1.f6b1498515ed1p+0, 0x1.f30cb6ea0bc81p+0,
+    0x1.ef6e8fc5b9169p+0, 0x1.ebd6b154a767ap+0, 0x1.e844f9af42381p+0,
+    0x1.e4b947c16a454p+0, 0x1.e1337b426509dp+0, 0x1.ddb374ad23581p+0,
+    0x1.da391538da50cp+0, 0x1.d6c43ed1ea401p+0, 0x1.d354d4130f2b0p+0,
+    0x1.cfeab83ed7182p+0, 0x1.cc85cf395a56ep+0, 0x1.c925fd82323fep+0,
+    0x1.c5cb282eab1a7p+0, 0x1.c27534e42e02fp+0, 0x1.bf2409d2dfd87p+0,
+    0x1.bbd78db072612p+0, 0x1.b88fa7b324fb7p+0, 0x1.b54c3f8cf2543p+0,
+    0x1.b20d3d66e8bb6p+0, 0x1.aed289dcaad00p+0, 0x1.ab9c0df81657bp+0,
+    0x1.a869b32d0f310p+0, 0x1.a53b63556c691p+0, 0x1.a21108ad0592ep+0,
+    0x1.9eea8dcdde952p+0, 0x1.9bc7ddac7035ep+0, 0x1.98a8e3940bbf5p+0,
+    0x1.958d8b235828bp+0, 0x1.9275c048e73e2p+0, 0x1.8f616f3fe1514p+0,
+    0x1.8c50848cc6095p+0, 0x1.8942ecfa40f55p+0, 0x1.86389596108e8p+0,
+    0x1.83316badfe62bp+0, 0x1.802d5ccce7278p+0, 0x1.7d2c56b7d17f9p+0,
+    0x1.7a2e476b1240cp+0, 0x1.77331d177d131p+0, 0x1.743ac61fa041dp+0,
+    0x1.714531150a9fcp+0, 0x1.6e524cb59a609p+0, 0x1.6b6207e8d3ce1p+0,
+    0x1.687451bd3ebf0p+0, 0x1.65891965c9b8ep+0, 0x1.62a04e3731a30p+0,
+    0x1.5fb9dfa56cf29p+0, 0x1.5cd5bd4119337p+0, 0x1.59f3d6b4e9cfbp+0,
+    0x1.57141bc316f29p+0, 0x1.54367c42cb5fbp+0, 0x1.515ae81d900fep+0,
+    0x1.4e814f4cb45edp+0, 0x1.4ba9a1d6b18a7p+0, 0x1.48d3cfcc883c6p+0,
+    0x1.45ffc94716ca9p+0, 0x1.432d7e6466cd2p+0, 0x1.405cdf44f09c6p+0,
+    0x1.3d8ddc08d3370p+0, 0x1.3ac064ccfefffp+0, 0x1.37f469a851af3p+0,
+    0x1.3529daa8a1ba5p+0, 0x1.3260a7cfb7615p+0, 0x1.2f98c11031724p+0,
+    0x1.2cd2164a53b60p+0, 0x1.2a0c9748bcdacp+0, 0x1.274833bd018a2p+0,
+    0x1.2484db3c2a32cp+0, 0x1.21c27d3b10e07p+0, 0x1.1f01090a9c4e4p+0,
+    0x1.1c406dd3d5285p+0, 0x1.19809a93d2398p+0, 0x1.16c17e1777ffep+0,
+    0x1.140306f707dc0p+0, 0x1.114523917ac18p+0, 0x1.0e87c207a2f68p+0,
+    0x1.0bcad03710139p+0, 0x1.090e3bb4b0074p+0, 0x1.0651f1c7276fap+0,
+    0x1.0395df60db165p+0, 0x1.00d9f119a3cdcp+0, 0x1.fc3c26504a9a8p-1,
+    0x1.f6c462b57febcp-1, 0x1.f14c6e20294a7p-1, 0x1.ebd41e5e21b6ap-1,
+    0x1.e65b483cf104bp-1, 0x1.e0e1bf77c3206p-1, 0x1.db6756a42905ep-1,
+    0x1.d5ebdf1d86b94p-1, 0x1.d06f28ef0e702p-1, 0x1.caf102bc25ae2p-1,
+    0x1.c57139a70d2a6p-1, 0x1.bfef99359fea1p-1, 0x1.ba6beb33f8f91p-1,
+    0x1.b4e5f794c97a3p-1, 0x1.af5d844f224d0p-1, 0x1.a9d255396d268p-1,
+    0x1.a4442be148852p-1, 0x1.9eb2c75ff03c7p-1, 0x1.991de42ad1340p-1,
+    0x1.93853bdfda24cp-1, 0x1.8de8850d0c531p-1, 0x1.884772f2be1f3p-1,
+    0x1.82a1b53fed5a1p-1, 0x1.7cf6f7c7e8179p-1, 0x1.7746e2307797bp-1,
+    0x1.71911797990c3p-1, 0x1.6bd5362faa94bp-1, 0x1.6612d6d0c68e7p-1,
+    0x1.60498c7dd2ed6p-1, 0x1.5a78e3db8bf04p-1, 0x1.54a0629786f54p-1,
+    0x1.4ebf86bcd0b9bp-1, 0x1.48d5c5f35e71ap-1, 0x1.42e28ca706751p-1,
+    0x1.3ce53d12162a9p-1, 0x1.36dd2e26d820ap-1, 0x1.30c9aa526da53p-1,
+    0x1.2aa9ee1236813p-1, 0x1.247d26538ff36p-1, 0x1.1e426e93e49efp-1,
+    0x1.17f8ceb4bdfa9p-1, 0x1.119f38749f5b7p-1, 0x1.0b348479b8105p-1,
+    0x1.04b76ed6a7561p-1, 0x1.fc4d25d68321bp-2, 0x1.ef00ccf5f4fbdp-2,
+    0x1.e186678f1736cp-2, 0x1.d3da24df17c49p-2, 0x1.c5f7bd78c3f9ep-2,
+    0x1.b7da5dddda3dbp-2, 0x1.a97c8be5d521ap-2, 0x1.9ad80552237e8p-2,
+    0x1.8be5954d36084p-2, 0x1.7c9cdda17d031p-2, 0x1.6cf40f0a72bd4p-2,
+    0x1.5cdf89d024adcp-2, 0x1.4c515c60bfe3ap-2, 0x1.3b388fe3d6ee3p-2,
+    0x1.2980290da264dp-2, 0x1.170db24d6f68cp-2, 0x1.03bf049c65c59p-2,
+    0x1.decd8b76dbdd6p-3, 0x1.b38d1ef79b80cp-3, 0x1.85090fbc27ac4p-3,
+    0x1.522e6e54a2abfp-3, 0x1.19335a95b8e13p-3, 0x1.ad6b2495b4e06p-4,
+    0x1.0589d8b5d4242p-4, 0x0.0p+0,
+};
+const double kExponentialF[257] = {
+    0x0.0p+0, 0x1.dc31c329f0b48p-12, 0x1.fb20af78dfcb7p-11,
+    0x1.92bb5540c3e26p-10, 0x1.1946ba8e1a326p-9, 0x1.6d888f3a1fefep-9,
+    0x1.c58b381cd4b11p-9, 0x1.1073d69574045p-8, 0x1.3fa97cee32301p-8,
+    0x1.7049f37ec3627p-8, 0x1.a23e9d497483bp-8, 0x1.d5751fa745dcdp-8,
+    0x1.04ef2295fd7fbp-7, 0x1.1fb69edb37672p-7, 0x1.3b0b8c1516f63p-7,
+    0x1.56e930be416ccp-7, 0x1.734b6e6aa74f7p-7, 0x1.902ea688fa7bbp-7,
+    0x1.ad8fa5542c92dp-7, 0x1.cb6b9146e275ap-7, 0x1.e9bfdde89c7cep-7,
+    0x1.04452091e02eep-6, 0x1.13e4554725f5dp-6, 0x1.23bc9e1b93a30p-6,
+    0x1.33cd225315d82p-6, 0x1.44151ce87f0bdp-6, 0x1.5493da6ab0250p-6,
+    0x1.6548b72a24077p-6, 0x1.76331da87fc96p-6, 0x1.8752853ec9968p-6,
+    0x1.98a670f132a49p-6, 0x1.aa2e6e6924e9cp-6, 0x1.bbea150fa5871p-6,
+    0x1.cdd9054331b0fp-6, 0x1.dffae7a51746dp-6, 0x1.f24f6c7af9895p-6,
+    0x1.026b2590dfaf0p-5, 0x1.0bc7a0c7cd654p-5, 0x1.153d09f19b3a5p-5,
+    0x1.1ecb45ff312d7p-5, 0x1.28723c956c00fp-5, 0x1.3231d7e3f14b1p-5,
+    0x1.3c0a047ff1901p-5, 0x1.45fab14266b1bp-5, 0x1.5003cf296c5eep-5,
+    0x1.5a25513c5d2cdp-5, 0x1.645f2c726a043p-5, 0x1.6eb1579b6af53p-5,
+    0x1.791bcb4ab08a0p-5, 0x1.839e81c3a396dp-5, 0x1.8e3976e80776ep-5,
+    0x1.98eca827b7c4dp-5, 0x1.a3b81471bf138p-5, 0x1.ae9bbc26a8083p-5,
+    0x1.b997a10bed984p-5, 0x1.c4abc640721e8p-5, 0x1.cfd83031e7949p-5,
+    0x1.db1ce49315810p-5, 0x1.e679ea52eb2e7p-5, 0x1.f1ef49944e838p-5,
+    0x1.fd7d0ba69967cp-5, 0x1.04919d7f5c81ap-4, 0x1.0a70f19871b3fp-4,
+    0x1.105c88756ca53p-4, 0x1.165468f755395p-4, 0x1.1c589a86fa342p-4,
+    0x1.22692512c9d8dp-4, 0x1.2886110ce0571p-4, 0x1.2eaf676948dd1p-4,
+    0x1.34e5319c6e718p-4, 0x1.3b277999b9f9fp-4, 0x1.417649d25b10fp-4,
+    0x1.47d1ad343985cp-4, 0x1.4e39af290d929p-4, 0x1.54ae5b959d037p-4,
+    0x1.5b2fbed91bb40p-4, 0x1.61bde5ccadef8p-4, 0x1.6858ddc30b621p-4,
+    0x1.6f00b488416b8p-4, 0x1.75b5786193c21p-4, 0x1.7c77380d7a6f5p-4,
+    0x1.834602c3bc4bbp-4, 0x1.8a21e835a533dp-4, 0x1.910af88e574bap-4,
+    0x1.9801447336b70p-4, 0x1.9f04dd046f428p-4, 0x1.a615d3dd938b6p-4,
+    0x1.ad343b1655464p-4, 0x1.b460254356546p-4, 0x1.bb99a5771268cp-4,
+    0x1.c2e0cf42e10adp-4, 0x1.ca35b6b80fd56p-4, 0x1.d198706914dd5p-4,
+    0x1.d909116ad9396p-4, 0x1.e087af561baf8p-4, 0x1.e8146048eb9c9p-4,
+    0x1.efaf3ae83c339p-4, 0x1.f758566190412p-4, 0x1.ff0fca6cbea8bp-4,
+    0x1.036ad7a6e7f04p-3, 0x1.07550eeb7a5bfp-3, 0x1.0b4697b54b62fp-3,
+    0x1.0f3f7efec171fp-3, 0x1.133fd20c9712ep-3, 0x1.17479e6f0ae77p-3,
+    0x1.1b56f2031d665p-3, 0x1.1f6ddaf3dca63p-3, 0x1.238c67bbbe876p-3,
+    0x1.27b2a7260993ep-3, 0x1.2be0a8504cf32p-3, 0x1.30167aabe7d6cp-3,
+    0x1.34542dffa0cadp-3, 0x1.3899d2694d5c7p-3, 0x1.3ce7785f8a903p-3,
+    0x1.413d30b386a97p-3, 0x1.459b0c92dccc3p-3, 0x1.4a011d8983093p-3,
+    0x1.4e6f7583cb6f7p-3, 0x1.52e626d078c46p-3, 0x1.57654422e78f1p-3,
+    0x1.5bece0954c2b2p-3, 0x1.607d0fab06a2ep-3, 0x1.6515e5530d1a9p-3,
+    0x1.69b775ea6da26p-3, 0x1.6e61d63ee84e9p-3, 0x1.73151b91a2838p-3,
+    0x1.77d15b99f46fdp-3, 0x1.7c96ac8851badp-3, 0x1.816525094e7e4p-3,
+    0x1.863cdc48c1af8p-3, 0x1.8b1de9f5062d3p-3, 0x1.900866425bb78p-3,
+    0x1.94fc69ee6929fp-3, 0x1.99fa0e43e1621p-3, 0x1.9f016d1e4c510p-3,
+    0x1.a412a0edf5cbap-3, 0x1.a92dc4bc03c47p-3, 0x1.ae52f42eb5b0ap-3,
+    0x1.b3824b8dcef3cp-3, 0x1.b8bbe7c72e4a3p-3, 0x1.bdffe67394433p-3,
+    0x1.c34e65db9afecp-3, 0x1.c8a784fce17ffp-3, 0x1.ce0b638f6d09bp-3,
+    0x1.d37a220b431fap-3, 0x1.d8f3e1ae3eeb6p-3, 0x1.de78c48224f37p-3,
+    0x1.e408ed62f83a4p-3, 0x1.e9a48005940efp-3, 0x1.ef4ba0fe8e098p-3,
+    0x1.f4fe75c963e7bp-3, 0x1.fabd24cff9351p-3, 0x1.0043eab934768p-2,
+    0x1.032f580797c2ap-2, 0x1.0620ef05d90d0p-2, 0x1.0918c4ee93e10p-2,
+    0x1.0c16ef88f5330p-2, 0x1.0f1b852d9a669p-2, 0x1.12269ccba9fb7p-2,
+    0x1.15384dee291ecp-2, 0x1.1850b0c19197fp-2, 0x1.1b6fde19abc57p-2,
+    0x1.1e95ef77b09d8p-2, 0x1.21c2ff10b7efdp-2, 0x1.24f727d4776fbp-2,
+    0x1.2832857457626p-2, 0x1.2b75346ae225fp-2, 0x1.2ebf52039426cp-2,
+    0x1.3210fc6312430p-2, 0x1.356a528fcd0d9p-2, 0x1.38cb747b17debp-2,
+    0x1.3c34830abb281p-2, 0x1.3fa5a0230a14bp-2, 0x1.431eeeb1841dep-2,
+    0x1.46a092b80beebp-2, 0x1.4a2ab158bdad0p-2, 0x1.4dbd70e26f91ap-2,
+    0x1.5158f8dde89f2p-2, 0x1.54fd721bda3e3p-2, 0x1.58ab06c3aa9ebp-2,
+    0x1.5c61e2631ee69p-2, 0x1.602231fef5873p-2, 0x1.63ec2424827e1p-2,
+    0x1.67bfe8fc60d9cp-2, 0x1.6b9db25e4e999p-2, 0x1.6f85b3e649e99p-2,
+    0x1.7378230b08de5p-2, 0x1.77753735e72dep-2, 0x1.7b7d29dc68019p-2,
+    0x1.7f90369b6ce54p-2, 0x1.83ae9b5446133p-2, 0x1.87d8984bc3f86p-2,
+    0x1.8c0e704b75d34p-2, 0x1.905068c545cfep-2, 0x1.949ec9f9a810ap-2,
+    0x1.98f9df2097ba2p-2, 0x1.9d61f695a378cp-2, 0x1.a1d76207521eep-2,
+    0x1.a65a76aa3013ap-2, 0x1.aaeb8d6fdf6dfp-2, 0x1.af8b03428ef59p-2,
+    0x1.b439394548069p-2, 0x1.b8f6951990b82p-2, 0x1.bdc3812aeeeafp-2,
+    0x1.c2a06d00ea57cp-2, 0x1.c78dcd983fb59p-2, 0x1.cc8c1dc40e08bp-2,
+    0x1.d19bde97e1a04p-2, 0x1.d6bd97db9ed73p-2, 0x1.dbf1d88a72105p-2,
+    0x1.e139375e137f5p-2, 0x1.e6945367dd34ap-2, 0x1.ec03d4b969d89p-2,
+    0x1.f1886d1eb4246p-2, 0x1.f722d8ebfc5f3p-2, 0x1.fcd3dfe21456fp-2,
+    0x1.014e2b160f320p-1, 0x1.043e8ebd26544p-1, 0x1.073b931ee3b79p-1,
+    0x1.0a45b8854d026p-1, 0x1.0d5d8812b1e27p-1, 0x1.108394a1cc388p-1,
+    0x1.13b87bc331697p-1, 0x1.16fce6dce6feap-1, 0x1.1a518c71e3b21p-1,
+    0x1.1db7319877b85p-1, 0x1.212eaba813ec4p-1, 0x1.24b8e228c509ep-1,
+    0x1.2856d111132b8p-1, 0x1.2c098b61f4f1fp-1, 0x1.2fd23e345da59p-1,
+    0x1.33b23450e6313p-1, 0x1.37aada708ddd4p-1, 0x1.3bbdc44e1d10ep-1,
+    0x1.3fecb2bb18b7ap-1, 0x1.44399afa8e11fp-1, 0x1.48a6afb8ee062p-1,
+    0x1.4d366c151f8a7p-1, 0x1.51eba15788993p-1, 0x1.56c9882da876cp-1,
+    0x1.5bd3d694cac6ep-1, 0x1.610edc1a7af5ep-1, 0x1.667fa6d4f5bfep-1,
+    0x1.6c2c3498418bdp-1, 0x1.721bb5ba94b5ap-1, 0x1.7856e9b09d475p-1,
+    0x1.7ee8a2d24311cp-1, 0x1.85de87806c5adp-1, 0x1.8d4a376d3d224p-1,
+    0x1.95431c455aa2dp-1, 0x1.9de9715556d8ep-1, 0x1.a76baa562fad9p-1,
+    0x1.b210f0ee67f1ap-1, 0x1.be5007beb7b14p-1, 0x1.cd0a65081ffd8p-1,
+    0x1.e0545e5881114p-1, 0x1.0000000000000p+0,
+};
+const double kNormalX[257] = {
+    0x1.f493b7815d984p+1, 0x1.d3bb48209ad34p+1, 0x1.b981f3878fdb1p+1,
+    0x1.a8fdc7894775ap+1, 0x1.9cbee014057acp+1, 0x1.92ee0946f4497p+1,
+    0x1.8ab0fbfaa7c15p+1, 0x1.839030529f234p+1, 0x1.7d42df4d6ce8cp+1,
+    0x1.7799556090673p+1, 0x1.72728f05f7a34p+1, 0x1.6db6b8d09e232p+1,
+    0x1.69540be9fe5c3p+1, 0x1.653ce7b006aebp+1, 0x1.61669cf861e4dp+1,
+    0x1.5dc8a243ad100p+1, 0x1.5a5c08b718ddcp+1, 0x1.571b1a94ae41ep+1,
+    0x1.54011523a7e45p+1, 0x1.5109f53e9ac44p+1, 0x1.4e3250dcd8905p+1,
+    0x1.4b7739d6b5a2ap+1, 0x1.48d62759c43bep+1, 0x1.464ce44a73a17p+1,
+    0x1.43d9815545e95p+1, 0x1.417a49cb9e5dbp+1, 0x1.3f2dbaa60f475p+1,
+    0x1.3cf27b31704a6p+1, 0x1.3ac7570ae88fap+1, 0x1.38ab39256410ap+1,
+    0x1.369d27a33a840p+1, 0x1.349c405ae12a3p+1, 0x1.32a7b5e68a4a3p+1,
+    0x1.30becd256aeeep+1, 0x1.2ee0db1a978f5p+1, 0x1.2d0d43196db97p+1,
+    0x1.2b437532a0a52p+1, 0x1.2982ecd770e78p+1, 0x1.27cb2faa8592ep+1,
+    0x1.261bcc77658e0p+1, 0x1.24745a4ac9c24p+1, 0x1.22d477a6fd3efp+1,
+    0x1.213bc9d04cc82p+1, 0x1.1fa9fc2e2d901p+1, 0x1.1e1ebfbe4ae39p+1,
+    0x1.1c99ca971a694p+1, 0x1.1b1ad777f2f8ep+1, 0x1.19a1a564eebacp+1,
+    0x1.182df74d21261p+1, 0x1.16bf93b9deef3p+1, 0x1.1556448602e3bp+1,
+    0x1.13f1d69c4096dp+1, 0x1.129219bbb5d35p+1, 0x1.1136e04207041p+1,
+    0x1.0fdffefa69fb6p+1, 0x1.0e8d4cf116593p+1, 0x1.0d3ea34aa3d30p+1,
+    0x1.0bf3dd1eed448p+1, 0x1.0aacd7571c0c4p+1, 0x1.0969708e8a254p+1,
+    0x1.082988f632e17p+1, 0x1.06ed023a72668p+1, 0x1.05b3bf6adb37ep+1,
+    0x1.047da4e3ef5c7p+1, 0x1.034a983a902abp+1, 0x1.021a8028fc947p+1,
+    0x1.00ed447d3a075p+1, 0x1.ff859c118f60bp+0, 0x1.fd360d22fe785p+0,
+    0x1.faebb187122bfp+0, 0x1.f8a6604899782p+0, 0x1.f665f20c90168p+0,
+    0x1.f42a40fb74d6dp+0, 0x1.f1f328ac25321p+0, 0x1.efc086101eca9p+0,
+    0x1.ed9237610a73ap+0, 0x1.eb681c0f76f08p+0, 0x1.e94214b2abf0ap+0,
+    0x1.e72002f97fe25p+0, 0x1.e501c99c1d188p+0, 0x1.e2e74c4ea46f6p+0,
+    0x1.e0d06fb49d21cp+0, 0x1.debd195522e37p+0, 0x1.dcad2f8fc490fp+0,
+    0x1.daa0999206e71p+0, 0x1.d8973f4d7fba7p+0, 0x1.d691096e7f125p+0,
+    0x1.d48de1533c64ap+0, 0x1.d28db1037ef23p+0, 0x1.d0906328b8f71p+0,
+    0x1.ce95e3068e03ap+0, 0x1.cc9e1c73bd692p+0, 0x1.caa8fbd36a2adp+0,
+    0x1.c8b66e0eba619p+0, 0x1.c6c6608ec8708p+0, 0x1.c4d8c136e0d1fp+0,
+    0x1.c2ed7e5f07a2fp+0, 0x1.c10486cec16a2p+0, 0x1.bf1dc9b81ae84p+0,
+    0x1.bd3936b2ec0a4p+0, 0x1.bb56bdb852570p+0, 0x1.b9764f1e5f73fp+0,
+    0x1.b797db93f892bp+0, 0x1.b5bb541ce3d07p+0, 0x1.b3e0aa0e00c04p+0,
+    0x1.b207cf09a985fp+0, 0x1.b030b4fc3a11fp+0, 0x1.ae5b4e18bb33bp+0,
+    0x1.ac878cd5af5d2p+0, 0x1.aab563e9ff10dp+0, 0x1.a8e4c64a03142p+0,
+    0x1.a715a724aa9aap+0, 0x1.a547f9e0bbb8ep+0, 0x1.a37bb21a2c862p+0,
+    0x1.a1b0c39f93699p+0, 0x1.9fe7226fad251p+0, 0x1.9e1ec2b6f7417p+0,
+    0x1.9c5798cd5d931p+0, 0x1.9a919933f99c4p+0, 0x1.98ccb892e2a36p+0,
+    0x1.9708ebb70d5f3p+0, 0x1.954627903a28fp+0, 0x1.9384612ef0b02p+0,
+    0x1.91c38dc28834dp+0, 0x1.9003a2973b595p+0, 0x1.8e44951446a2cp+0,
+    0x1.8c865aba10ca1p+0, 0x1.8ac8e9205c049p+0, 0x1.890c35f47f733p+0,
+    0x1.875036f7a7ecbp+0, 0x1.8594e1fd1f5c3p+0, 0x1.83da2ce899f1bp+0,
+    0x1.82200dac8867dp+0, 0x1.80667a486ea25p+0, 0x1.7ead68c73deeep+0,
+    0x1.7cf4cf3db2303p+0, 0x1.7b3ca3c8b1411p+0, 0x1.7984dc8babd9ap+0,
+    0x1.77cd6faeff450p+0, 0x1.7616535e57326p+0, 0x1.745f7dc70eee3p+0,
+    0x1.72a8e516914cdp+0, 0x1.70f27f78b68f2p+0, 0x1.6f3c43161f85bp+0,
+    0x1.6d8626128d359p+0, 0x1.6bd01e8b343c3p+0, 0x1.6a1a22950b2b9p+0,
+    0x1.6864283b1313fp+0, 0x1.66ae257c9967ap+0, 0x1.64f8104b72613p+0,
+    0x1.6341de8a2b0a9p+0, 0x1.618b860a31fcap+0, 0x1.5fd4fc89f5e3ep+0,
+    0x1.5e1e37b2f8cd9p+0, 0x1.5c672d17d7344p+0, 0x1.5aafd23241b5fp+0,
+    0x1.58f81c60e851ap+0, 0x1.574000e555f7ep+0, 0x1.558774e1bb2cdp+0,
+    0x1.53ce6d56a6655p+0, 0x1.5214df20a8b60p+0, 0x1.505abef5e5567p+0,
+    0x1.4ea001638a60ap+0, 0x1.4ce49acb311e1p+0, 0x1.4b287f6024162p+0,
+    0x1.496ba32488f34p+0, 0x1.47adf9e66c33cp+0, 0x1.45ef773cac763p+0,
+    0x1.44300e83c30aap+0, 0x1.426fb2da67463p+0, 0x1.40ae571e09e7ap+0,
+    0x1.3eebede725a89p+0, 0x1.3d28698561de7p+0, 0x1.3b63bbfb83d09p+0,
+    0x1.399dd6fb2b26ap+0, 0x1.37d6abe055870p+0, 0x1.360e2baca52dbp+0,
+    0x1.3444470265ea8p+0, 0x1.3278ee1f4b937p+0, 0x1.30ac10d6e48ddp+0,
+    0x1.2edd9e8cba994p+0, 0x1.2d0d862e1b859p+0, 0x1.2b3bb62b82ee0p+0,
+    0x1.29681c719d721p+0, 0x1.2792a661dd386p+0, 0x1.25bb40ca96c03p+0,
+    0x1.23e1d7de9c326p+0, 0x1.2206572c4c6f1p+0, 0x1.2028a9940a0a8p+0,
+    0x1.1e48b93e0d436p+0, 0x1.1c666f8f82ad4p+0, 0x1.1a81b51ee6d91p+0,
+    0x1.189a71a78da3dp+0, 0x1.16b08bfc42027p+0, 0x1.14c3e9f8e914ap+0,
+    0x1.12d4707310fc7p+0, 0x1.10e20329515f7p+0, 0x1.0eec84b160875p+0,
+    0x1.0cf3d664bcc89p+0, 0x1.0af7d84bc611dp+0, 0x1.08f869071f416p+0,
+    0x1.06f565b72a01cp+0, 0x1.04eea9e16a607p+0, 0x1.02e40f5398fa4p+0,
+    0x1.00d56e04234f6p+0, 0x1.fd8537dfa2ec0p-1, 0x1.f956d9e87d7c2p-1,
+    0x1.f51f654d8f69bp-1, 0x1.f0de784f06239p-1, 0x1.ec93abdf982e1p-1,
+    0x1.e83e9337a6f14p-1, 0x1.e3debb5d2ee12p-1, 0x1.df73aa9f17666p-1,
+    0x1.dafce0023b8d7p-1, 0x1.d679d29e41f24p-1, 0x1.d1e9f0e80b75cp-1,
+    0x1.cd4c9fe72269fp-1, 0x1.c8a13a5323b77p-1, 0x1.c3e70f9594f09p-1,
+    0x1.bf1d62abf8249p-1, 0x1.ba4368e529f52p-1, 0x1.b558487427a41p-1,
+    0x1.b05b16d136cb4p-1, 0x1.ab4ad6e101649p-1, 0x1.a62676d77cd72p-1,
+    0x1.a0eccdca4a746p-1, 0x1.9b9c98e38c562p-1, 0x1.96347822c1f06p-1,
+    0x1.90b2ea94ecfb4p-1, 0x1.8b1649e7b76b5p-1, 0x1.855cc53430a94p-1,
+    0x1.7f845ad46f561p-1, 0x1.798ad10b32a96p-1, 0x1.736dad346f8c7p-1,
+    0x1.6d2a292000590p-1, 0x1.66bd261a37c5fp-1, 0x1.60231cfd97f0dp-1,
+    0x1.59580a707ceb9p-1, 0x1.52575621ad397p-1, 0x1.4b1bb363dfecdp-1,
+    0x1.439ef8dff9b7bp-1, 0x1.3bd9ec1a2b156p-1, 0x1.33c3fc057921cp-1,
+    0x1.2b52e3863d8aap-1, 0x1.227a28f7a1b22p-1, 0x1.192a6974136a8p-1,
+    0x1.0f5053b025d77p-1, 0x1.04d32278ebbe5p-1, 0x1.f32482d4cd63bp-2,
+    0x1.dac2f5a7472f6p-2, 0x1.c004d2f386289p-2, 0x1.a230c2e4cd161p-2,
+    0x1.801fce82fa7c9p-2, 0x1.57cb938443c44p-2, 0x1.250af3c2c5cdep-2,
+    0x1.b8d0be3fdfa7cp-3, 0x0.0p+0,
+};
+const double kNormalF[257] = {
+    0x0.0p+0, 0x1.4a605b6b9f704p-10, 0x1.55f9f43c1b067p-9, 0x1.08a1f03b0b1fdp-8,
+    0x1.69ea8d90cb857p-8, 0x1.ce160f8ec6830p-8, 0x1.1a59229952f8ep-7,
+    0x1.4eb96421acfe0p-7, 0x1.841040d8da478p-7, 0x1.ba48d274f8facp-7,
+    0x1.f152a4f72dd49p-7, 0x1.1490334603012p-6, 0x1.30d388dab5e13p-6,
+    0x1.4d6eaf2fbb05cp-6, 0x1.6a5daf40bbf79p-6, 0x1.879d1b600c0fap-6,
+    0x1.a529f4e22ebddp-6, 0x1.c301983cd08fdp-6, 0x1.e121adb828c57p-6,
+    0x1.ff881d718a5a4p-6, 0x1.0f1982e968000p-5, 0x1.1e9059f1f6aadp-5,
+    0x1.2e27ce83df48bp-5, 0x1.3ddf2ce98eebfp-5, 0x1.4db5d0e112757p-5,
+    0x1.5dab23cf2adcfp-5, 0x1.6dbe9b398d064p-5, 0x1.7defb77af271ep-5,
+    0x1.8e3e02a68b5abp-5, 0x1.9ea90f9295563p-5, 0x1.af30790385f70p-5,
+    0x1.bfd3e0f282a2cp-5, 0x1.d092efeadf162p-5, 0x1.e16d547b25181p-5,
+    0x1.f262c2b6c6e35p-5, 0x1.01b979e30e497p-4, 0x1.0a4ed2c159625p-4,
+    0x1.12f14d0f2179dp-4, 0x1.1ba0cbe97897dp-4, 0x1.245d344dd0d91p-4,
+    0x1.2d266cf9b3111p-4, 0x1.35fc5e4d93e6bp-4, 0x1.3edef23269a81p-4,
+    0x1.47ce1401b2213p-4, 0x1.50c9b06fa2baep-4, 0x1.59d1b577466a4p-4,
+    0x1.62e6124854d18p-4, 0x1.6c06b73694a4cp-4, 0x1.753395aaa1176p-4,
+    0x1.7e6ca013eefd6p-4, 0x1.87b1c9dbf2852p-4, 0x1.9103075a4a0abp-4,
+    0x1.9a604dc9d5b19p-4, 0x1.a3c9933ea6286p-4, 0x1.ad3ece9caf633p-4,
+    0x1.b6bff78f2e233p-4, 0x1.c04d0680b1015p-4, 0x1.c9e5f493b740ap-4,
+    0x1.d38abb9bd91e5p-4, 0x1.dd3b56176e88fp-4, 0x1.e6f7bf29aa54bp-4,
+    0x1.f0bff29520e1cp-4, 0x1.fa93ecb6b222cp-4, 0x1.0239d54067d2ap-3,
+    0x1.072f94bb8bf85p-3, 0x1.0c2b33d5209bap-3, 0x1.112cb1da26eb9p-3,
+    0x1.16340e5a82d63p-3, 0x1.1b41492757d42p-3, 0x1.2054625183c34p-3,
+    0x1.256d5a2835eb7p-3, 0x1.2a8c3137a071ap-3, 0x1.2fb0e847c2a65p-3,
+    0x1.34db805b4ab88p-3, 0x1.3a0bfaae8d7eep-3, 0x1.3f4258b6931aep-3,
+    0x1.447e9c20375d5p-3, 0x1.49c0c6cf5ce2dp-3, 0x1.4f08dade31fc1p-3,
+    0x1.5456da9c86835p-3, 0x1.59aac88f31d6cp-3, 0x1.5f04a76f883f9p-3,
+    0x1.64647a2adf19cp-3, 0x1.69ca43e21f259p-3, 0x1.6f3607e964713p-3,
+    0x1.74a7c9c7ab5a1p-3, 0x1.7a1f8d368a31dp-3, 0x1.7f9d5621f716cp-3,
+    0x1.852128a819a31p-3, 0x1.8aab091928152p-3, 0x1.903afbf74fa62p-3,
+    0x1.95d105f6a7c20p-3, 0x1.9b6d2bfd2fe55p-3, 0x1.a10f7322d7e36p-3,
+    0x1.a6b7e0b192674p-3, 0x1.ac667a25717ffp-3, 0x1.b21b452ccd135p-3,
+    0x1.b7d647a8731a5p-3, 0x1.bd9787abe189dp-3, 0x1.c35f0b7d89d3fp-3,
+    0x1.c92cd9971df4bp-3, 0x1.cf00f8a5e6fc1p-3, 0x1.d4db6f8b25142p-3,
+    0x1.dabc455c78ffdp-3, 0x1.e0a3816457177p-3, 0x1.e6912b2283cd0p-3,
+    0x1.ec854a4c99c32p-3, 0x1.f27fe6ce998c3p-3, 0x1.f88108cb83227p-3,
+    0x1.fe88b89df93b3p-3, 0x1.024b7f6c77475p-2, 0x1.0555f2242e9cfp-2,
+    0x1.0863b8f90432bp-2, 0x1.0b74d88b242cep-2, 0x1.0e895598709b7p-2,
+    0x1.11a134fcf2417p-2, 0x1.14bc7bb34ee5ep-2, 0x1.17db2ed5454dfp-2,
+    0x1.1afd539c2f047p-2, 0x1.1e22ef618810dp-2, 0x1.214c079f7cc95p-2,
+    0x1.2478a1f17de7fp-2, 0x1.27a8c414db113p-2, 0x1.2adc73e963fd2p-2,
+    0x1.2e13b7721075cp-2, 0x1.314e94d5af626p-2, 0x1.348d125f9d194p-2,
+    0x1.37cf36808136ep-2, 0x1.3b1507cf143a3p-2, 0x1.3e5e8d08ed2d0p-2,
+    0x1.41abcd1357a0dp-2, 0x1.44fccefc324f1p-2, 0x1.485199fad6ac8p-2,
+    0x1.4baa357109c96p-2, 0x1.4f06a8ebf6d83p-2, 0x1.5266fc2533bdep-2,
+    0x1.55cb3703d00f0p-2, 0x1.5933619d6eeb1p-2, 0x1.5c9f84376c235p-2,
+    0x1.600fa7480d2bap-2, 0x1.6383d377be507p-2, 0x1.66fc11a25cbd4p-2,
+    0x1.6a786ad88de12p-2, 0x1.6df8e86124c9cp-2, 0x1.717d93ba9613dp-2,
+    0x1.7506769c7b1dcp-2, 0x1.78939af9252dap-2, 0x1.7c250aff4149fp-2,
+    0x1.7fbad11b8d900p-2, 0x1.8354f7faa0dc9p-2, 0x1.86f38a8ac5aa7p-2,
+    0x1.8a9693fde917ap-2, 0x1.8e3e1fcb9f108p-2, 0x1.91ea39b33cb09p-2,
+    0x1.959aedbe09f84p-2, 0x1.995048418c0b9p-2, 0x1.9d0a55e1e93d2p-2,
+    0x1.a0c9239468431p-2, 0x1.a48cbea20c042p-2, 0x1.a85534aa4d873p-2,
+    0x1.ac2293a5f5a91p-2, 0x1.aff4e9ea18547p-2, 0x1.b3cc462b331bep-2,
+    0x1.b7a8b78071310p-2, 0x1.bb8a4d6716d86p-2, 0x1.bf7117c616a0bp-2,
+    0x1.c35d26f1d2cabp-2, 0x1.c74e8bb00d7b9p-2, 0x1.cb45573c0a83ap-2,
+    0x1.cf419b4ae5b60p-2, 0x1.d3436a1021072p-2, 0x1.d74ad6426de25p-2,
+    0x1.db57f320b56a2p-2, 0x1.df6ad477639fbp-2, 0x1.e3838ea5f9b77p-2,
+    0x1.e7a236a4ec3b8p-2, 0x1.ebc6e20bd1f46p-2, 0x1.eff1a717e8f85p-2,
+    0x1.f4229cb2f7ae4p-2, 0x1.f859da7a900bcp-2, 0x1.fc9778c7bbd93p-2,
+    0x1.006dc85b8cabdp-1, 0x1.02931e18b8223p-1, 0x1.04bbcafa63f26p-1,
+    0x1.06e7dccf03c2dp-1, 0x1.091761d995d78p-1, 0x1.0b4a68d70d9a5p-1,
+    0x1.0d81010414296p-1, 0x1.0fbb3a2325909p-1, 0x1.11f9248311f2ep-1,
+    0x1.143ad105ea991p-1, 0x1.16805128639cfp-1, 0x1.18c9b709b3c45p-1,
+    0x1.1b171573fd106p-1, 0x1.1d687fe54995ep-1, 0x1.1fbe0a9929616p-1,
+    0x1.2217ca92ff7e6p-1, 0x1.2475d5a90db78p-1, 0x1.26d84290504e1p-1,
+    0x1.293f28e93cd09p-1, 0x1.2baaa14d7953cp-1, 0x1.2e1ac55ea3be0p-1,
+    0x1.308fafd6438e2p-1, 0x1.33097c9703a29p-1, 0x1.358848bf550ddp-1,
+    0x1.380c32bda00c9p-1, 0x1.3a955a662cd02p-1, 0x1.3d23e10af3197p-1,
+    0x1.3fb7e99585b76p-1, 0x1.425198a355fd7p-1, 0x1.44f114a49366dp-1,
+    0x1.479685fdf5006p-1, 0x1.4a42172dc526cp-1, 0x1.4cf3f4f494eb4p-1,
+    0x1.4fac4e820b65bp-1, 0x1.526b55a656cc9p-1, 0x1.55313f08d9e3ap-1,
+    0x1.57fe4264c8d82p-1, 0x1.5ad29acc85c7bp-1, 0x1.5dae86f4aff5cp-1,
+    0x1.6092498802657p-1, 0x1.637e298550c0ap-1, 0x1.667272a92e315p-1,
+    0x1.696f75e513b1bp-1, 0x1.6c7589e635a7ap-1, 0x1.6f850baea7adfp-1,
+    0x1.729e5f43f6d02p-1, 0x1.75c1f0770d846p-1, 0x1.78f033ca0b0c5p-1,
+    0x1.7c29a779c6848p-1, 0x1.7f6ed4b20e2bbp-1, 0x1.82c050f56cf5dp-1,
+    0x1.861ebfc37bc9ap-1, 0x1.898ad48badef0p-1, 0x1.8d0554fe60a96p-1,
+    0x1.908f1bd31713cp-1, 0x1.94291c21b7a34p-1, 0x1.97d4657617aaep-1,
+    0x1.9b9228d24066ep-1, 0x1.9f63bee651fc4p-1, 0x1.a34aafdf5aefbp-1,
+    0x1.a748bd550c9cdp-1, 0x1.ab5fef17a24f0p-1, 0x1.af92a3f6ce88dp-1,
+    0x1.b3e3a8234dcfap-1, 0x1.b85653a8ff53bp-1, 0x1.bceeb4ee1dc6ap-1,
+    0x1.c1b1cd9eebad1p-1, 0x1.c6a5ecea97865p-1, 0x1.cbd33a8a72dd0p-1,
+    0x1.d144978a119bfp-1, 0x1.d70920657bcd3p-1, 0x1.dd36fa704de74p-1,
+    0x1.e3f11e027f053p-1, 0x1.eb7545b6ca8ecp-1, 0x1.f446ac979f055p-1,
+    0x1.0000000000000p+0,
+};
+}  // namespace stats::internal
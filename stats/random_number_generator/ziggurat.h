@@ -0,0 +1,163 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THIRD_PARTY_HYBRID_RCC_STATS_RANDOM_NUMBER_GENERATOR_ZIGGURAT_H_
+#define THIRD_PARTY_HYBRID_RCC_STATS_RANDOM_NUMBER_GENERATOR_ZIGGURAT_H_
+
+#include <cmath>
+#include <cstdint>
+
+// Library-owned replacements for std::uniform_real_distribution,
+// std::exponential_distribution and std::normal_distribution.
+//
+// The standard distributions are implementation-defined: libstdc++ and
+// libc++ consume a different number of engine steps per draw and transform
+// them differently, so an encode made with one cannot be decoded with the
+// other. These consume a fixed number of steps of any 32 or 64 bit engine
+// and transform them with fixed arithmetic:
+//  - uniform01 takes exactly one step, so a decoder can skip n uniforms by
+//    advancing the engine by n.
+//  - The exponential and normal samplers are 256-layer ziggurats
+//    (Marsaglia and Tsang, 2000) on 64 random bits, two steps of a 32-bit
+//    engine. About 99% of the draws are a table lookup and a multiply; only
+//    the rare wedge and tail draws take more steps and call exp or log.
+// The layer tables are literals in ziggurat.cc.
+namespace stats {
+namespace internal {
+// Layer i covers [0, X[i]) x [F[i], F[i + 1]) of the unnormalized density,
+// layer 0 is the base strip plus the tail beyond X[1].
+extern const double kExponentialX[257], kExponentialF[257];
+extern const double kNormalX[257], kNormalF[257];
+
+template <typename Engine>
+constexpr int engine_bits() {
+  constexpr uint64_t range =
+      static_cast<uint64_t>(Engine::max() - Engine::min());
+  static_assert(range == 0xffffffffu || range == ~uint64_t(0),
+                "only engines with 32 or 64 random bits are supported");
+  return range == 0xffffffffu ? 32 : 64;
+}
+}  // namespace internal
+
+template <typename Engine>
+inline uint64_t random_bits64(Engine &engine) {
+  if constexpr (internal::engine_bits<Engine>() == 32) {
+    uint64_t high = static_cast<uint64_t>(engine() - Engine::min());
+    uint64_t low = static_cast<uint64_t>(engine() - Engine::min());
+    return high << 32 | low;
+  } else {
+    return static_cast<uint64_t>(engine() - Engine::min());
+  }
+}
+
+// Uniform in (0, 1), never 0 or 1, from one engine step: the midpoints of
+// 2^32 cells for 32-bit engines and of 2^53 cells for 64-bit engines.
+template <typename Engine>
+inline double uniform01(Engine &engine) {
+  // Signed integers convert to double faster than unsigned ones.
+  uint64_t x = static_cast<uint64_t>(engine() - Engine::min());
+  if constexpr (internal::engine_bits<Engine>() == 32)
+    return (static_cast<int64_t>(x) + 0.5) * 0x1p-32;
+  else
+    return (static_cast<int64_t>(x >> 11) + 0.5) * 0x1p-53;
+}
+
+template <typename Engine>
+double exponential_ziggurat(Engine &engine) {
+  using internal::kExponentialF;
+  using internal::kExponentialX;
+  double shift = 0;
+  for (;;) {
+    uint64_t bits = random_bits64(engine);
+    int i = bits & 0xff;
+    double x = static_cast<int64_t>(bits >> 11) * 0x1p-53 * kExponentialX[i];
+    if (x < kExponentialX[i + 1]) return shift + x;
+    if (i == 0) {
+      // The tail of an exponential is a shifted exponential.
+      shift += kExponentialX[1];
+      continue;
+    }
+    double y = kExponentialF[i] +
+               (kExponentialF[i + 1] - kExponentialF[i]) * uniform01(engine);
+    if (y < std::exp(-x)) return shift + x;
+  }
+}
+
+template <typename Engine>
+double normal_ziggurat(Engine &engine) {
+  using internal::kNormalF;
+  using internal::kNormalX;
+  for (;;) {
+    uint64_t bits = random_bits64(engine);
+    int i = bits & 0xff;
+    double sign = 1 - 2.0 * static_cast<int>(bits >> 8 & 1);
+    double x = static_cast<int64_t>(bits >> 11) * 0x1p-53 * kNormalX[i];
+    if (x < kNormalX[i + 1]) return sign * x;
+    if (i == 0) {
+      // Marsaglia's tail method.
+      double a, b;
+      do {
+        a = -std::log(uniform01(engine)) / kNormalX[1];
+        b = -std::log(uniform01(engine));
+      } while (2 * b < a * a);
+      return sign * (kNormalX[1] + a);
+    }
+    double y =
+        kNormalF[i] + (kNormalF[i + 1] - kNormalF[i]) * uniform01(engine);
+    if (y < std::exp(-0.5 * x * x)) return sign * x;
+  }
+}
+
+// Drop-in replacements for the standard distributions, e.g. for URBG.
+class UniformDistribution {
+ public:
+  explicit UniformDistribution(double a = 0, double b = 1) : a_(a), b_(b) {}
+  template <typename Engine>
+  double operator()(Engine &engine) const {
+    return a_ + (b_ - a_) * uniform01(engine);
+  }
+
+ private:
+  double a_, b_;
+};
+
+class ExponentialDistribution {
+ public:
+  explicit ExponentialDistribution(double lambda = 1) : lambda_(lambda) {}
+  template <typename Engine>
+  double operator()(Engine &engine) const {
+    return exponential_ziggurat(engine) / lambda_;
+  }
+
+ private:
+  double lambda_;
+};
+
+class NormalDistribution {
+ public:
+  explicit NormalDistribution(double mean = 0, double stddev = 1)
+      : mean_(mean), stddev_(stddev) {}
+  template <typename Engine>
+  double operator()(Engine &engine) const {
+    return mean_ + stddev_ * normal_ziggurat(engine);
+  }
+
+ private:
+  double mean_, stddev_;
+};
+}  // namespace stats
+
+#endif  // THIRD_PARTY_HYBRID_RCC_STATS_RANDOM_NUMBER_GENERATOR_ZIGGURAT_H_